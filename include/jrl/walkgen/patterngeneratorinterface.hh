@@ -329,6 +329,16 @@ public:
 /*! Factory of Pattern generator interface. */
 WALK_GEN_JRL_EXPORT PatternGeneratorInterface *
 patternGeneratorInterfaceFactory(PinocchioRobot *);
+
+/*! Factory creating a pattern generator configured as aPGI.
+  The commands given to aPGI through ParseCmd before its first step of
+  control are replayed on the new object, which does not share any state
+  with aPGI. To run both in different threads, aRobot should have its own
+  pinocchio::Data, see PinocchioRobot::clone().
+  \return 0 if aPGI was not created by a factory or aRobot is null. */
+WALK_GEN_JRL_EXPORT PatternGeneratorInterface *
+patternGeneratorInterfaceFactory(const PatternGeneratorInterface *aPGI,
+                                 PinocchioRobot *aRobot);
 } // namespace PatternGeneratorJRL
 
 #endif /* _PATTERN_GENERATOR_INTERFACE_H_ */
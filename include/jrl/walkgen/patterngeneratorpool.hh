@@ -0,0 +1,117 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file patterngeneratorpool.hh
+  \brief Drive several independent pattern generators from a pool of
+  threads.
+*/
+
+#ifndef _PATTERN_GENERATOR_POOL_H_
+#define _PATTERN_GENERATOR_POOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <jrl/walkgen/patterngeneratorinterface.hh>
+
+namespace PatternGeneratorJRL {
+
+/** @ingroup Interface
+    Pool of threads running the same job on several pattern generators.
+    Each generator is handled by one thread at a time, so the generators
+    must not share any state: each of them should be built on its own
+    PinocchioRobot, see PinocchioRobot::clone() and the
+    patternGeneratorInterfaceFactory() cloning a configured generator.
+
+    A typical use is to call RunOneStepOfTheControlLoop on all the
+    generators at each control period:
+    \code
+    aPool.run([&](std::size_t i, PatternGeneratorInterface &aPGI) {
+      aPGI.RunOneStepOfTheControlLoop(args[i]);
+    });
+    \endcode
+*/
+class WALK_GEN_JRL_EXPORT PatternGeneratorPool {
+public:
+  typedef std::function<void(std::size_t, PatternGeneratorInterface &)> job_t;
+
+  /*! \brief Start the threads.
+    @param NbThreads: Number of threads, including the one calling run(),
+    the number of cores if 0. */
+  explicit PatternGeneratorPool(unsigned int NbThreads = 0);
+
+  /*! \brief Stop the threads. The generators are not deleted. */
+  ~PatternGeneratorPool();
+
+  /*! \brief Add a generator to the pool, which does not own it.
+    It should not be called while run() is in progress.
+    \return the index of the generator given to the jobs. */
+  std::size_t add(PatternGeneratorInterface *aPGI);
+
+  /*! \brief Number of generators. */
+  inline std::size_t size() const { return m_PGIs.size(); }
+
+  /*! \brief Number of threads, including the one calling run(). */
+  inline std::size_t NbThreads() const { return m_Threads.size() + 1; }
+
+  /*! \brief Call aJob once on each generator, and return when all the
+    calls are over. The calling thread takes part in the work.
+    aJob should not throw. */
+  void run(const job_t &aJob);
+
+private:
+  /*! \brief Loop of the threads of the pool. */
+  void worker();
+
+  /*! \brief Run the job on the generators not yet taken. */
+  void work();
+
+  PatternGeneratorPool(const PatternGeneratorPool &);
+  PatternGeneratorPool &operator=(const PatternGeneratorPool &);
+
+  /*! Generators driven by the pool. */
+  std::vector<PatternGeneratorInterface *> m_PGIs;
+
+  std::vector<std::thread> m_Threads;
+
+  /*! \name Synchronization between run() and the threads.
+    @{ */
+  std::mutex m_Mutex;
+  std::condition_variable m_JobStarted, m_JobDone;
+  /*! Job being run, 0 if none. */
+  const job_t *m_Job;
+  /*! Incremented each time a job is started. */
+  unsigned long m_JobId;
+  /*! Next generator to handle. */
+  std::size_t m_NextPGI;
+  /*! Number of threads still working on the current job. */
+  std::size_t m_NbBusyThreads;
+  bool m_Stop;
+  /*! @} */
+};
+
+} // namespace PatternGeneratorJRL
+
+#endif /* _PATTERN_GENERATOR_POOL_H_ */
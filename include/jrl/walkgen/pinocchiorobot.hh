@@ -29,6 +29,12 @@ frame work */
 #ifndef PinocchioRobot_HH
 #define PinocchioRobot_HH
 
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include "pinocchio/multibody/data.hpp"
 #include "pinocchio/multibody/model.hpp"
 #include "pinocchio/parsers/urdf.hpp"
@@ -49,6 +55,44 @@ struct PinocchioRobotFoot_t {
 };
 typedef PinocchioRobotFoot_t PRFoot;
 
+/// Waist and ankle poses of a batch of legs, for
+/// PinocchioRobot::ComputeLegsInverseKinematics. The batch is stored
+/// as a structure of arrays, one row per leg: the same coefficient of
+/// all the legs is contiguous. The rotations are stored row by row,
+/// coefficient (i,j) in the column 3*i+j.
+struct PinocchioRobotLegsBatch_t {
+  Eigen::Array<double, Eigen::Dynamic, 9> waistRotation, ankleRotation;
+  Eigen::Array<double, Eigen::Dynamic, 3> waistPosition, anklePosition;
+  /// 1 for a left leg, -1 for a right one.
+  Eigen::ArrayXd side;
+
+  inline Eigen::Index size() const { return side.rows(); }
+
+  /// Allocate n legs, the content is not initialized.
+  void resize(Eigen::Index n) {
+    waistRotation.resize(n, 9);
+    ankleRotation.resize(n, 9);
+    waistPosition.resize(n, 3);
+    anklePosition.resize(n, 3);
+    side.resize(n);
+  }
+
+  /// Set the leg i from homogeneous matrices.
+  void set(Eigen::Index i, int aSide, const Eigen::Matrix4d &waistPose,
+           const Eigen::Matrix4d &anklePose) {
+    for (int j = 0; j < 3; j++) {
+      for (int k = 0; k < 3; k++) {
+        waistRotation(i, 3 * j + k) = waistPose(j, k);
+        ankleRotation(i, 3 * j + k) = anklePose(j, k);
+      }
+      waistPosition(i, j) = waistPose(j, 3);
+      anklePosition(i, j) = anklePose(j, 3);
+    }
+    side(i) = (double)aSide;
+  }
+};
+typedef PinocchioRobotLegsBatch_t PRLegsBatch;
+
 namespace pinocchio_robot {
 const int RPY_SIZE = 6;
 const int QUATERNION_SIZE = 7;
@@ -63,6 +107,22 @@ public:
   PinocchioRobot();
   virtual ~PinocchioRobot();
 
+  /// Create a robot sharing the model of this one but owning its own
+  /// pinocchio::Data, so that both can be used from different threads.
+  /// The data in the initial pose is shared too, and the quantities
+  /// derived from the model (joint indexes, mass, legs lengths) are
+  /// copied instead of being computed again: the clone only allocates
+  /// its pinocchio::Data. The clone keeps pointers to the model given
+  /// to initializeRobotModelAndData() and to the data in initial pose
+  /// of this robot: the caller must keep this robot and that model
+  /// alive longer than every clone, for instance by holding the model
+  /// through a shared_ptr.
+  /// The feet description and the current state are copied.
+  /// Derived classes overloading the inverse kinematics should overload
+  /// this method too.
+  /// \return 0 if this robot is not initialized.
+  virtual PinocchioRobot *clone() const;
+
   /// Compute RNEA algorithm
   /// This is a front end for computeInverseDynamics(q,v,a).
   void computeInverseDynamics();
@@ -75,6 +135,30 @@ public:
   void computeInverseDynamics(Eigen::VectorXd &q, Eigen::VectorXd &v,
                               Eigen::VectorXd &a);
 
+  /// Compute the time variation of the centroidal momentum from
+  /// q, v and a given as for computeInverseDynamics(q,v,a).
+  /// This is enough for centroidalZeroMomentumPoint(), and cheaper
+  /// than the inverse dynamics which also computes the joint torques.
+  void computeCentroidalDynamics(Eigen::VectorXd &q, Eigen::VectorXd &v,
+                                 Eigen::VectorXd &a);
+
+  /// Same as computeInverseDynamics(q,v,a) and
+  /// computeCentroidalDynamics(q,v,a) with q in the pinocchio format
+  /// [position, quaternion x y z w, joints], v and a having the
+  /// format of the RPY versions. The state is used as it is, for
+  /// callers which already hold it: nothing is converted.
+  void computeInverseDynamicsFromPinocchio(const Eigen::VectorXd &q,
+                                           const Eigen::VectorXd &v,
+                                           const Eigen::VectorXd &a);
+  void computeCentroidalDynamicsFromPinocchio(const Eigen::VectorXd &q,
+                                              const Eigen::VectorXd &v,
+                                              const Eigen::VectorXd &a);
+
+  /// Convert a configuration with the free flyer orientation in RPY,
+  /// in radians, to the pinocchio format. qpino is resized.
+  void RPYToPinocchioConfiguration(const Eigen::VectorXd &qrpy,
+                                   Eigen::VectorXd &qpino) const;
+
   /// Compute the geometry of the robot.
   void computeForwardKinematics();
 
@@ -105,6 +189,48 @@ public:
                                       const Eigen::Matrix4d &jointEndPosition,
                                       Eigen::VectorXd &q);
 
+  /// \brief ComputeLegsInverseKinematics :
+  /// same as ComputeSpecializedInverseKinematics from the waist to the
+  /// ankles, for a batch of legs. The legs are solved by blocks, each
+  /// operation being done on all the legs of a block so that the
+  /// compiler vectorizes it across the legs.
+  /// param legs poses of the waist and of the ankles, and sides
+  /// param q joint values, one row per leg, resized to the batch
+  /// param feasible false for the legs whose ankle is out of reach,
+  /// q is then the closest posture as for the single leg version
+  /// \return false if the robot is not compatible, q is filled with zeros
+  bool ComputeLegsInverseKinematics(
+      const PRLegsBatch &legs, Eigen::Array<double, Eigen::Dynamic, 6> &q,
+      Eigen::Array<bool, Eigen::Dynamic, 1> &feasible) const;
+
+  /// \brief ComputeLegsInverseKinematics :
+  /// same as above for the legs [first,first+n[ of the batch only.
+  /// q and feasible are not resized and must have at least first+n
+  /// rows, so that batches of varying sizes are solved without
+  /// allocating.
+  bool ComputeLegsInverseKinematics(
+      const PRLegsBatch &legs, Eigen::Index first, Eigen::Index n,
+      Eigen::Array<double, Eigen::Dynamic, 6> &q,
+      Eigen::Array<bool, Eigen::Dynamic, 1> &feasible) const;
+
+  /// \brief ComputeLegJointRates :
+  /// velocity and acceleration of the joints of the leg from the waist
+  /// to the ankle, from the ones of the ankle relative to the waist.
+  /// They are given in the waist frame, for the origin of the ankle,
+  /// as [linear angular]. The leg Jacobian J and its time variation
+  /// dJ give dq = J^-1 V and ddq = J^-1 (A - dJ dq).
+  /// param ankle left or right ankle
+  /// param qrpy configuration with the free flyer in RPY, as for
+  /// computeInverseDynamics, only the joints of the leg are read
+  /// param v, a entries of the leg joints are set
+  /// \return false if the leg is not a chain of 6 joints or if it is
+  /// singular, v and a are then not modified
+  bool ComputeLegJointRates(pinocchio::JointIndex ankle,
+                            const Eigen::VectorXd &qrpy,
+                            const Eigen::Matrix<double, 6, 1> &V,
+                            const Eigen::Matrix<double, 6, 1> &A,
+                            Eigen::VectorXd &v, Eigen::VectorXd &a);
+
   ///
   /// \brief testArmsInverseKinematics :
   /// test if the robot arms has the good joint
@@ -155,6 +281,11 @@ private:
   void getWaistFootKinematics(const Eigen::Matrix4d &jointRootPosition,
                               const Eigen::Matrix4d &jointEndPosition,
                               Eigen::VectorXd &q, Eigen::Vector3d &Dt) const;
+  /// Legs [first,first+n[ of a batch, n being at most the block size.
+  void getWaistFootKinematicsBlock(
+      const PRLegsBatch &legs, Eigen::Index first, Eigen::Index n,
+      Eigen::Array<double, Eigen::Dynamic, 6> &q,
+      Eigen::Array<bool, Eigen::Dynamic, 1> &feasible) const;
   double ComputeXmax(double &Z);
   void getShoulderWristKinematics(const Eigen::Matrix4d &jointRootPosition,
                                   const Eigen::Matrix4d &jointEndPosition,
@@ -169,6 +300,19 @@ private:
   */
   void ComputeRootSize();
 
+  /// Allocate the data in the initial pose and the state vectors
+  /// for m_robotModel, and set the data used by the algorithms.
+  bool initializeData(pinocchio::Data *robotData);
+
+  /// Convert q, v and a with the free flyer orientation in RPY
+  /// to m_qpino, m_vpino and m_apino.
+  void RPYToPinocchioState(Eigen::VectorXd &q, Eigen::VectorXd &v,
+                           Eigen::VectorXd &a);
+
+  /// Quaternion [x y z w] of the rotation Rz(yaw) Ry(pitch) Rx(roll).
+  static void RPYToQuaternion(double roll, double pitch, double yaw,
+                              Eigen::Ref<Eigen::Vector4d> quat);
+
 public:
   /// Getters
   /// ///////
@@ -214,6 +358,18 @@ public:
     zmp(2) = 0.0; // by default
   }
 
+  /// Same as zeroMomentumPoint() after computeCentroidalDynamics().
+  /// The external wrench is the rate of the centroidal momentum minus
+  /// the gravity, moved from the CoM to the origin.
+  inline void centroidalZeroMomentumPoint(Eigen::Vector3d &zmp) {
+    m_com = m_robotData->com[0];
+    m_f = m_robotData->dhg.linear() - m_mass * m_robotModel->gravity.linear();
+    m_n = m_robotData->dhg.angular() + m_com.cross(m_f);
+    zmp(0) = -m_n(1) / m_f(2);
+    zmp(1) = m_n(0) / m_f(2);
+    zmp(2) = 0.0; // by default
+  }
+
   inline void positionCenterOfMass(Eigen::Vector3d &com) {
     m_com = m_robotData->com[0];
     com(0) = m_com(0);
@@ -266,6 +422,33 @@ public:
   bool initializeLeftFoot(PRFoot leftFoot);
   bool initializeRightFoot(PRFoot rightFoot);
 
+  /// \name Cache of the robot on disk
+  /// The model and what is derived from it at the initialization
+  /// (joint indexes, feet, legs lengths) are saved in the binary files
+  /// prefix.model and prefix.meta, with a key identifying the robot
+  /// description, e.g. the cacheKey() of its URDF and SRDF files.
+  /// prefix.meta also holds the checksum of prefix.model, and both
+  /// are written under temporary names before being renamed, so that
+  /// a partly written cache is not loaded.
+  /// @{
+  /// Hash of the content of the files.
+  static std::uint64_t cacheKey(const std::vector<std::string> &fileNames);
+  /// Save this robot, whose model and feet are initialized.
+  bool saveCache(const std::string &prefix, std::uint64_t key) const;
+  /// Load the model saved with the given key in robotModel.
+  /// \return false if there is no such cache.
+  static bool loadModelFromCache(const std::string &prefix,
+                                 std::uint64_t key,
+                                 pinocchio::Model &robotModel);
+  /// Same as initializeRobotModelAndData followed by initializeLeftFoot
+  /// and initializeRightFoot, robotModel being the one loaded by
+  /// loadModelFromCache: the checks and the detection of the limbs
+  /// are replaced by the values read in the cache.
+  bool initializeFromCache(const std::string &prefix, std::uint64_t key,
+                           pinocchio::Model *robotModel,
+                           pinocchio::Data *robotData);
+  /// @}
+
   const std::string &getName() const;
   /// Attributes
   /// //////////
@@ -273,6 +456,10 @@ private:
   pinocchio::Model *m_robotModel;
   pinocchio::Data *m_robotDataInInitialePose; // internal variable
   pinocchio::Data *m_robotData;
+  pinocchio::Data *m_ownedRobotData; // allocated by clone()
+  /// True for the clones, m_robotDataInInitialePose is then owned by
+  /// the robot they were cloned from.
+  bool m_sharedModel;
   PRFoot m_leftFoot, m_rightFoot;
   double m_mass;
   pinocchio::JointIndex m_chest, m_waist, m_leftShoulder, m_rightShoulder;
@@ -302,6 +489,9 @@ private:
   Eigen::Vector3d m_com;             // multibody CoM
   Eigen::Matrix3d m_S;
   Eigen::Vector3d m_rpy, m_drpy, m_ddrpy, m_omega, m_domega;
+  // used by ComputeLegJointRates
+  Eigen::VectorXd m_qLeg, m_vLeg;
+  Eigen::Matrix<double, 6, Eigen::Dynamic> m_JLeg, m_dJLeg;
 
   // Variables extracted form the urdf used for the analitycal inverse
   // kinematic
@@ -327,5 +517,40 @@ private:
   pinocchio::JointIndex m_PinoFreeFlyerVelSize;
 
 }; // PinocchioRobot
+
+/// Pool of clones of a robot, checked out by the threads evaluating
+/// the model in parallel. The robots share the model of the prototype,
+/// each of them owns its pinocchio::Data and temporaries, and is used
+/// by one thread at a time. The prototype and its model must outlive
+/// the pool, and must not be modified while robots are cloned from it.
+class PinocchioRobotPool {
+public:
+  /// \param aPrototype robot cloned by the pool
+  /// \param NbRobots number of robots cloned at once
+  explicit PinocchioRobotPool(const PinocchioRobot &aPrototype,
+                              std::size_t NbRobots = 0);
+  /// Delete the robots, which should all have been released.
+  ~PinocchioRobotPool();
+
+  /// A robot not used by another thread, cloned if none is free.
+  /// Its state is the one left by its previous user.
+  /// \return 0 if the prototype is not initialized.
+  PinocchioRobot *acquire();
+
+  /// Give back a robot returned by acquire().
+  void release(PinocchioRobot *aPR);
+
+  /// Number of robots cloned so far.
+  std::size_t size();
+
+private:
+  PinocchioRobotPool(const PinocchioRobotPool &);
+  PinocchioRobotPool &operator=(const PinocchioRobotPool &);
+
+  const PinocchioRobot &m_Prototype;
+  /// All the robots, and the ones not acquired.
+  std::vector<PinocchioRobot *> m_Robots, m_FreeRobots;
+  std::mutex m_Mutex;
+}; // PinocchioRobotPool
 } // namespace PatternGeneratorJRL
 #endif // PinocchioRobot_HH
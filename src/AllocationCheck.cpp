@@ -0,0 +1,72 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file AllocationCheck.cpp
+  \brief Check that a code part does not allocate.
+*/
+#include <cassert>
+#include <iostream>
+
+#include <Eigen/Core>
+
+#include "AllocationCheck.hh"
+
+using namespace PatternGeneratorJRL;
+
+namespace {
+/* Counters of the calling thread. */
+thread_local unsigned int NbActiveChecks = 0;
+thread_local std::size_t NbAllocations = 0;
+} // namespace
+
+void AllocationCheck::countAllocation() {
+  if (NbActiveChecks > 0)
+    ::NbAllocations++;
+}
+
+AllocationCheck::AllocationCheck(bool Active)
+    : m_Active(Active), m_Start(::NbAllocations), m_EigenMallocAllowed(true) {
+  if (!m_Active)
+    return;
+  NbActiveChecks++;
+#ifdef EIGEN_RUNTIME_NO_MALLOC
+  m_EigenMallocAllowed = Eigen::internal::set_is_malloc_allowed(false);
+#endif
+}
+
+AllocationCheck::~AllocationCheck() {
+  if (!m_Active)
+    return;
+  NbActiveChecks--;
+#ifdef EIGEN_RUNTIME_NO_MALLOC
+  Eigen::internal::set_is_malloc_allowed(m_EigenMallocAllowed);
+#endif
+  std::size_t lNbAllocations = NbAllocations();
+  if (lNbAllocations > 0)
+    std::cerr << "AllocationCheck: " << lNbAllocations
+              << " heap allocation(s) in a real-time section" << std::endl;
+  assert(lNbAllocations == 0);
+}
+
+std::size_t AllocationCheck::NbAllocations() const {
+  return m_Active ? ::NbAllocations - m_Start : 0;
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file AllocationCheck.hh
+  \brief Defines an object checking that a code part does not allocate.
+*/
+#ifndef _HWPG_ALLOCATION_CHECK_H_
+#define _HWPG_ALLOCATION_CHECK_H_
+#include <cstddef>
+
+namespace PatternGeneratorJRL {
+/*! \brief Check that no heap allocation happens during the life of
+  the object.
+
+  The library does not replace the global operator new. A program
+  checking its real-time sections replaces it, and calls
+  countAllocation() on each allocation (see tests/AllocationHooks.cpp).
+  Otherwise no allocation is counted.
+  The destructor asserts in debug builds that nothing was allocated.
+  Eigen allocates through malloc. The library is built with
+  EIGEN_RUNTIME_NO_MALLOC in debug, and the check forbids the Eigen
+  allocations as well: Eigen then asserts on the first one. This flag
+  of Eigen is shared by all the threads.
+*/
+class AllocationCheck {
+public:
+  /*! \brief Start the check if Active is true. */
+  explicit AllocationCheck(bool Active = true);
+
+  /*! \brief Stop the check and assert that nothing was allocated. */
+  ~AllocationCheck();
+
+  /*! \brief Number of allocations of the thread since the check
+    started. */
+  std::size_t NbAllocations() const;
+
+  /*! \brief Count an allocation of the calling thread if a check is
+    active. Called by the replaced operator new. */
+  static void countAllocation();
+
+private:
+  AllocationCheck(const AllocationCheck &);
+  AllocationCheck &operator=(const AllocationCheck &);
+
+  bool m_Active;
+  std::size_t m_Start;
+  /*! Eigen allocations were allowed when the check started. */
+  bool m_EigenMallocAllowed;
+};
+} // namespace PatternGeneratorJRL
+#endif /* _HWPG_ALLOCATION_CHECK_H_ */
@@ -25,6 +25,19 @@
 #include <exception>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+
+#ifndef _PATTERN_GENERATOR_DEBUG_FILE_MUTEX_
+#define _PATTERN_GENERATOR_DEBUG_FILE_MUTEX_
+namespace PatternGeneratorJRL {
+/*! \brief Serialize the accesses to the debug files, which are shared
+  by all the pattern generators of the process. */
+inline std::mutex &DebugFileMutex() {
+  static std::mutex aMutex;
+  return aMutex;
+}
+} // namespace PatternGeneratorJRL
+#endif
 
 #define LTHROW(x)                                                              \
   {                                                                            \
@@ -42,12 +55,16 @@
             << "):" << x << std::endl;
 #define RESETDEBUG5(y)                                                         \
   {                                                                            \
+    std::lock_guard<std::mutex> DebugFileLock(                                 \
+        PatternGeneratorJRL::DebugFileMutex());                                \
     std::ofstream DebugFile;                                                   \
     DebugFile.open(y, ofstream::out);                                          \
     DebugFile.close();                                                         \
   }
 #define ODEBUG5(x, y)                                                          \
   {                                                                            \
+    std::lock_guard<std::mutex> DebugFileLock(                                 \
+        PatternGeneratorJRL::DebugFileMutex());                                \
     std::ofstream DebugFile;                                                   \
     DebugFile.open(y, ofstream::app);                                          \
     DebugFile.precision(8);                                                    \
@@ -58,6 +75,8 @@
   }
 #define ODEBUG5SIMPLE(x, y)                                                    \
   {                                                                            \
+    std::lock_guard<std::mutex> DebugFileLock(                                 \
+        PatternGeneratorJRL::DebugFileMutex());                                \
     std::ofstream DebugFile;                                                   \
     DebugFile.open(y, ofstream::app);                                          \
     DebugFile << x << std::endl;                                               \
@@ -83,12 +102,16 @@
 #ifdef _DEBUG_MODE_ON_
 #define RESETDEBUG4(y)                                                         \
   {                                                                            \
+    std::lock_guard<std::mutex> DebugFileLock(                                 \
+        PatternGeneratorJRL::DebugFileMutex());                                \
     std::ofstream DebugFile;                                                   \
     DebugFile.open(y, ofstream::out);                                          \
     DebugFile.close();                                                         \
   }
 #define ODEBUG4(x, y)                                                          \
   {                                                                            \
+    std::lock_guard<std::mutex> DebugFileLock(                                 \
+        PatternGeneratorJRL::DebugFileMutex());                                \
     std::ofstream DebugFile;                                                   \
     DebugFile.open(y, ofstream::app);                                          \
     DebugFile << __FILE__ << ":" << __FUNCTION__ << "(#" << __LINE__           \
@@ -97,6 +120,8 @@
   }
 #define ODEBUG4SIMPLE(x, y)                                                    \
   {                                                                            \
+    std::lock_guard<std::mutex> DebugFileLock(                                 \
+        PatternGeneratorJRL::DebugFileMutex());                                \
     std::ofstream DebugFile;                                                   \
     DebugFile.open(y, ofstream::app);                                          \
     DebugFile << x << std::endl;                                               \
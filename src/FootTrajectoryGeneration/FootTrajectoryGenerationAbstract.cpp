@@ -77,8 +77,8 @@ void FootTrajectoryGenerationAbstract::CallMethod(std::string &Method,
 }
 
 void FootTrajectoryGenerationAbstract::UpdateFootPosition(
-    std::deque<FootAbsolutePosition> &, // SupportFootAbsolutePositions,
-    std::deque<FootAbsolutePosition> &, // NoneSupportFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &, // SupportFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &, // NoneSupportFootAbsolutePositions,
     int,                                // CurrentAbsoluteIndex,
     int,                                // IndexInitial,
     double,                             // ModulatedSingleSupportTime,
@@ -90,8 +90,8 @@ void FootTrajectoryGenerationAbstract::UpdateFootPosition(
 }
 
 void FootTrajectoryGenerationAbstract::UpdateFootPosition(
-    std::deque<FootAbsolutePosition> &, // SupportFootAbsolutePositions,
-    std::deque<FootAbsolutePosition> &, // NoneSupportFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &, // SupportFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &, // NoneSupportFootAbsolutePositions,
     int,                                // StartIndex,
     int,                                // k,
     double,                             // LocalInterpolationStartTime,
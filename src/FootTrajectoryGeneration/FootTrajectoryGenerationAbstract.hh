@@ -40,6 +40,7 @@
 
 /* Walking pattern generation related inclusions */
 
+#include <RingBuffer.hh>
 #include <SimplePlugin.hh>
 #include <jrl/walkgen/pgtypes.hh>
 #include <privatepgtypes.hh>
@@ -108,14 +109,14 @@ public:
     @param LeftOrRight: Specify if it is left (1) or right (-1).
   */
   virtual void UpdateFootPosition(
-      std::deque<FootAbsolutePosition> &SupportFootAbsolutePositions,
-      std::deque<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &SupportFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
       int CurrentAbsoluteIndex, int IndexInitial,
       double ModulatedSingleSupportTime, int StepType, int LeftOrRight);
 
   virtual void UpdateFootPosition(
-      std::deque<FootAbsolutePosition> &SupportFootAbsolutePositions,
-      std::deque<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &SupportFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
       int StartIndex, int k, double LocalInterpolationStartTime,
       double ModulatedSingleSupportTime, int StepType, int LeftOrRight);
 
@@ -699,8 +699,8 @@ double FootTrajectoryGenerationStandard::ComputeSecDerivative(
 }
 
 void FootTrajectoryGenerationStandard::UpdateFootPosition(
-    deque<FootAbsolutePosition> &SupportFootAbsolutePositions,
-    deque<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &SupportFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
     int CurrentAbsoluteIndex, int IndexInitial,
     double ModulatedSingleSupportTime, int StepType, int /* LeftOrRight */) {
   unsigned int k = CurrentAbsoluteIndex - IndexInitial;
@@ -855,8 +855,8 @@ void FootTrajectoryGenerationStandard::UpdateFootPosition(
 }
 
 void FootTrajectoryGenerationStandard::UpdateFootPosition(
-    deque<FootAbsolutePosition> &SupportFootAbsolutePositions,
-    deque<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &SupportFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
     int StartIndex, int k, double LocalInterpolationStartTime,
     double ModulatedSingleSupportTime, int StepType, int /* LeftOrRight */) {
   // TODO 0:Update foot position needs to be verified and cleaned
@@ -1082,7 +1082,7 @@ void FootTrajectoryGenerationStandard::UpdateFootPosition(
 
 void FootTrajectoryGenerationStandard::ComputingAbsFootPosFromQueueOfRelPos(
     deque<RelativeFootPosition> &RelativeFootPositions,
-    deque<FootAbsolutePosition> &AbsoluteFootPositions) {
+    RingBuffer<FootAbsolutePosition> &AbsoluteFootPositions) {
 
   if (AbsoluteFootPositions.size() == 0)
     AbsoluteFootPositions.resize(RelativeFootPositions.size());
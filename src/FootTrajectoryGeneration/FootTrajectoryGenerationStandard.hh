@@ -34,6 +34,7 @@
 #include <FootTrajectoryGeneration/FootTrajectoryGenerationAbstract.hh>
 #include <Mathematics/Bsplines.hh>
 #include <Mathematics/PolynomeFoot.hh>
+#include <RingBuffer.hh>
 namespace PatternGeneratorJRL {
 
 /** @ingroup foottrajectorygeneration
@@ -101,14 +102,14 @@ public:
     @param LeftOrRight: Specify if it is left (1) or right (-1).
   */
   virtual void UpdateFootPosition(
-      deque<FootAbsolutePosition> &SupportFootAbsolutePositions,
-      deque<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &SupportFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
       int CurrentAbsoluteIndex, int IndexInitial,
       double ModulatedSingleSupportTime, int StepType, int LeftOrRight);
 
   virtual void UpdateFootPosition(
-      deque<FootAbsolutePosition> &SupportFootAbsolutePositions,
-      deque<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &SupportFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
       int StartIndex, int k, double LocalInterpolationStartTime,
       double ModulatedSingleSupportTime, int StepType, int LeftOrRight);
 
@@ -238,7 +239,7 @@ public:
   */
   void ComputingAbsFootPosFromQueueOfRelPos(
       deque<RelativeFootPosition> &RelativeFootPositions,
-      deque<FootAbsolutePosition> &AbsoluteFootPositions);
+      RingBuffer<FootAbsolutePosition> &AbsoluteFootPositions);
 
   /*! Methods to compute a set of positions for the feet according to the
     discrete time given in parameters and the phase of walking.
@@ -170,7 +170,7 @@ void LeftAndRightFootTrajectoryGenerationMultiple::InitializeFromRelativeSteps(
     deque<RelativeFootPosition> &RelativeFootPositions,
     FootAbsolutePosition &LeftFootInitialPosition,
     FootAbsolutePosition &RightFootInitialPosition,
-    deque<FootAbsolutePosition> &SupportFootAbsoluteFootPositions,
+    RingBuffer<FootAbsolutePosition> &SupportFootAbsoluteFootPositions,
     bool IgnoreFirst, bool Continuity) {
   ODEBUG("LeftFootInitialPosition.stepType: "
          << LeftFootInitialPosition.stepType
@@ -185,7 +185,7 @@ void LeftAndRightFootTrajectoryGenerationMultiple::InitializeFromRelativeSteps(
       RelativeFootPositions.size();
   /*! It is assumed that a set of relative positions for the support foot
     are given as an input. */
-  deque<FootAbsolutePosition> AbsoluteFootPositions;
+  RingBuffer<FootAbsolutePosition> AbsoluteFootPositions;
 
   /*! Those two variables are needed to compute intermediate
     initial positions for the feet. */
@@ -647,7 +647,7 @@ void LeftAndRightFootTrajectoryGenerationMultiple::
         deque<RelativeFootPosition> &RelativeFootPositions,
         FootAbsolutePosition &LeftFootInitialPosition,
         FootAbsolutePosition &RightFootInitialPosition,
-        deque<FootAbsolutePosition> &SupportFootAbsoluteFootPositions) {
+        RingBuffer<FootAbsolutePosition> &SupportFootAbsoluteFootPositions) {
   FootAbsolutePosition aSupportFootAbsolutePosition;
 
   if (RelativeFootPositions[0].sy > 0) {
@@ -668,7 +668,7 @@ void LeftAndRightFootTrajectoryGenerationMultiple::
     ComputeAbsoluteStepsFromRelativeSteps(
         deque<RelativeFootPosition> &RelativeFootPositions,
         FootAbsolutePosition &SupportFootInitialAbsolutePosition,
-        deque<FootAbsolutePosition> &SupportFootAbsoluteFootPositions) {
+        RingBuffer<FootAbsolutePosition> &SupportFootAbsoluteFootPositions) {
   /*! Makes sure the size of the SupportFootAbsolutePositions is the same than
     the relative foot positions. */
   if (SupportFootAbsoluteFootPositions.size() != RelativeFootPositions.size())
@@ -677,7 +677,7 @@ void LeftAndRightFootTrajectoryGenerationMultiple::
   long unsigned int lNbOfIntervals = RelativeFootPositions.size();
   /*! It is assumed that a set of relative positions for the support foot
     are given as an input. */
-  deque<FootAbsolutePosition> AbsoluteFootPositions;
+  RingBuffer<FootAbsolutePosition> AbsoluteFootPositions;
 
   AbsoluteFootPositions.resize(lNbOfIntervals);
   lNbOfIntervals = 2 * lNbOfIntervals + 1;
@@ -785,7 +785,7 @@ void LeftAndRightFootTrajectoryGenerationMultiple::
 void LeftAndRightFootTrajectoryGenerationMultiple::ChangeRelStepsFromAbsSteps(
     deque<RelativeFootPosition> &RelativeFootPositions,
     FootAbsolutePosition &SupportFootInitialPosition,
-    deque<FootAbsolutePosition> &SupportFootAbsoluteFootPositions,
+    RingBuffer<FootAbsolutePosition> &SupportFootAbsoluteFootPositions,
     unsigned int ChangedInterval) {
   if (ChangedInterval >= SupportFootAbsoluteFootPositions.size()) {
     LTHROW("Pb: ChangedInterval is after the size of absolute foot stack.");
@@ -932,7 +932,7 @@ bool LeftAndRightFootTrajectoryGenerationMultiple::
   ComputeAnAbsoluteFootPosition
   (int LeftOrRight,
   double time,
-  deque<FootAbsolutePosition> & adFAP,
+  RingBuffer<FootAbsolutePosition> & adFAP,
   unsigned int IndexInterval)
   {
 
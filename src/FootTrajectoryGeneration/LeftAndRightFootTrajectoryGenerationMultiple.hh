@@ -36,6 +36,7 @@
 /* Walking Pattern Generator inclusion */
 
 #include <FootTrajectoryGeneration/FootTrajectoryGenerationMultiple.hh>
+#include <RingBuffer.hh>
 #include <SimplePlugin.hh>
 
 namespace PatternGeneratorJRL {
@@ -101,7 +102,7 @@ public:
       deque<RelativeFootPosition> &RelativeFootPositions,
       FootAbsolutePosition &LeftFootInitialPosition,
       FootAbsolutePosition &RightFootInitialPosition,
-      deque<FootAbsolutePosition> &SupportFootAbsoluteFootPositions,
+      RingBuffer<FootAbsolutePosition> &SupportFootAbsoluteFootPositions,
       bool IgnoreFirst, bool Continuity);
 
   /*! \brief Method to compute the absolute position of the foot.
@@ -138,7 +139,7 @@ public:
   /*
     bool ComputeAnAbsoluteFootPosition(int LeftOrRight,
     double time,
-    std::deque<FootAbsolutePosition> & adFAP,
+    RingBuffer<FootAbsolutePosition> & adFAP,
     unsigned int IndexInterval);*/
 
   /*! \brief Method to compute absolute feet positions from a set of
@@ -157,7 +158,7 @@ public:
       deque<RelativeFootPosition> &RelativeFootPositions,
       FootAbsolutePosition &LeftFootInitialPosition,
       FootAbsolutePosition &RightFootInitialPosition,
-      deque<FootAbsolutePosition> &SupportFootAbsoluteFootPositions);
+      RingBuffer<FootAbsolutePosition> &SupportFootAbsoluteFootPositions);
 
   /*! \brief Method to compute absolute feet positions from a set of
     relative one.
@@ -173,7 +174,7 @@ public:
   void ComputeAbsoluteStepsFromRelativeSteps(
       deque<RelativeFootPosition> &RelativeFootPositions,
       FootAbsolutePosition &SupportFootInitialPosition,
-      deque<FootAbsolutePosition> &SupportFootAbsoluteFootPositions);
+      RingBuffer<FootAbsolutePosition> &SupportFootAbsoluteFootPositions);
 
   /*! \brief Method to compute relative feet positions from a set of absolute
     one where one has changed.
@@ -190,7 +191,7 @@ public:
   void ChangeRelStepsFromAbsSteps(
       deque<RelativeFootPosition> &RelativeFootPositions,
       FootAbsolutePosition &SupportFootInitialPosition,
-      deque<FootAbsolutePosition> &SupportFootAbsoluteFootPositions,
+      RingBuffer<FootAbsolutePosition> &SupportFootAbsoluteFootPositions,
       unsigned int ChangedInterval);
 
   /*! Returns foot */
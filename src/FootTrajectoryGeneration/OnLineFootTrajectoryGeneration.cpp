@@ -78,8 +78,8 @@ void OnLineFootTrajectoryGeneration::ComputeXYThetaFootPosition(
 }
 
 void OnLineFootTrajectoryGeneration::UpdateFootPosition(
-    deque<FootAbsolutePosition> &SupportFootAbsolutePositions,
-    deque<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &SupportFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
     int StartIndex, int k, double LocalInterpolationStartTime,
     double UnlockedSwingPeriod, int StepType, int /* LeftOrRight */) {
   // Local time
@@ -236,10 +236,11 @@ void OnLineFootTrajectoryGeneration::interpret_solution(
 }
 
 void OnLineFootTrajectoryGeneration::interpolate_feet_positions(
-    double Time, const deque<support_state_t> &PrwSupportStates_deq,
-    const solution_t &Solution, const deque<double> &PreviewedSupportAngles_deq,
-    deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-    deque<FootAbsolutePosition> &FinalRightFootTraj_deq) {
+    double Time, const RingBuffer<support_state_t> &PrwSupportStates_deq,
+    const solution_t &Solution,
+    const RingBuffer<double> &PreviewedSupportAngles_deq,
+    RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+    RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq) {
   support_state_t CurrentSupport = PrwSupportStates_deq.front();
 
   double FPx(0.0), FPy(0.0);
@@ -362,8 +363,8 @@ void OnLineFootTrajectoryGeneration::interpolate_feet_positions(
     double Time, unsigned CurrentIndex, const support_state_t &CurrentSupport,
     std::vector<double> FootStepX, std::vector<double> FootStepY,
     std::vector<double> FootStepYaw,
-    deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-    deque<FootAbsolutePosition> &FinalRightFootTraj_deq) {
+    RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+    RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq) {
   --CurrentIndex;
   int StepType = 1;
   FootAbsolutePosition *LastSFP; // LastSwingFootPosition
@@ -31,6 +31,7 @@
 #define _ONLINE_FOOT_TRAJECTORY_GENERATION_H_
 
 #include <FootTrajectoryGeneration/FootTrajectoryGenerationStandard.hh>
+#include <RingBuffer.hh>
 
 namespace PatternGeneratorJRL {
 
@@ -57,19 +58,19 @@ public:
   /// \param[out] FinalLeftFootTraj_deq Left foot trajectory
   /// \param[out] FinalRightFootTraj_deq Right foot trajectory
   virtual void interpolate_feet_positions(
-      double Time, const deque<support_state_t> &PrwSupportStates_deq,
+      double Time, const RingBuffer<support_state_t> &PrwSupportStates_deq,
       const solution_t &Solution,
-      const deque<double> &PreviewedSupportAngles_deq,
-      deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-      deque<FootAbsolutePosition> &FinalRightFootTraj_deq);
+      const RingBuffer<double> &PreviewedSupportAngles_deq,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq);
 
   virtual void interpolate_feet_positions(
       double Time, unsigned CurrentIndex,
       const PatternGeneratorJRL::support_state_t &CurrentSupport,
       std::vector<double> FootStepX, std::vector<double> FootStepY,
       std::vector<double> FootStepYaw,
-      deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-      deque<FootAbsolutePosition> &FinalRightFootTraj_deq);
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq);
 
   /// \name Accessors
   /// \{
@@ -114,8 +115,8 @@ protected:
   /// of steps (for book-keeping). \param LeftOrRight: Specify if it is left (1)
   /// or right (-1).
   virtual void
-  UpdateFootPosition(deque<FootAbsolutePosition> &SupportFootTraj_deq,
-                     deque<FootAbsolutePosition> &StanceFootTraj_deq,
+  UpdateFootPosition(RingBuffer<FootAbsolutePosition> &SupportFootTraj_deq,
+                     RingBuffer<FootAbsolutePosition> &StanceFootTraj_deq,
                      int StartIndex, int k, double LocalInterpolationStartTime,
                      double UnlockedSwingPeriod, int StepType, int LeftOrRight);
 
@@ -192,10 +192,10 @@ int CoMAndFootOnlyStrategy::EndOfMotion() {
 }
 
 void CoMAndFootOnlyStrategy::Setup(
-    deque<ZMPPosition> &,          // aZMPPositions,
-    deque<COMState> &,             // aCOMBuffer,
-    deque<FootAbsolutePosition> &, // aLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &) // aRightFootAbsolutePositions)
+    RingBuffer<ZMPPosition> &,          // aZMPPositions,
+    RingBuffer<COMState> &,             // aCOMBuffer,
+    RingBuffer<FootAbsolutePosition> &, // aLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &) // aRightFootAbsolutePositions)
 {}
 
 void CoMAndFootOnlyStrategy::CallMethod(std::string &,        // Method,
@@ -26,6 +26,7 @@
   only foot, ZMP reference and CoM trajectories position every 5 ms.
 */
 
+#include <RingBuffer.hh>
 #include <SimplePlugin.hh>
 #include <jrl/walkgen/pgtypes.hh>
 
@@ -124,9 +125,10 @@ public:
   void CallMethod(std::string &Method, std::istringstream &astrm);
 
   /*! */
-  void Setup(deque<ZMPPosition> &aZMPPositions, deque<COMState> &aCOMBuffer,
-             deque<FootAbsolutePosition> &aLeftFootAbsolutePositions,
-             deque<FootAbsolutePosition> &aRightFootAbsolutePositions);
+  void Setup(RingBuffer<ZMPPosition> &aZMPPositions,
+             RingBuffer<COMState> &aCOMBuffer,
+             RingBuffer<FootAbsolutePosition> &aLeftFootAbsolutePositions,
+             RingBuffer<FootAbsolutePosition> &aRightFootAbsolutePositions);
 
   /*! \brief Initialization of the inter objects relationship. */
   int InitInterObjects(PinocchioRobot *aPR,
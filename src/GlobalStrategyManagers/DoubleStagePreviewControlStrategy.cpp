@@ -277,9 +277,9 @@ void DoubleStagePreviewControlStrategy::CallMethod(std::string &Method,
 }
 
 void DoubleStagePreviewControlStrategy::Setup(
-    deque<ZMPPosition> &aZMPPositions, deque<COMState> &aCOMBuffer,
-    deque<FootAbsolutePosition> &aLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &aRightFootAbsolutePositions) {
+    RingBuffer<ZMPPosition> &aZMPPositions, RingBuffer<COMState> &aCOMBuffer,
+    RingBuffer<FootAbsolutePosition> &aLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &aRightFootAbsolutePositions) {
   m_ZMPpcwmbz->Setup(aZMPPositions, aCOMBuffer, aLeftFootAbsolutePositions,
                      aRightFootAbsolutePositions);
 }
@@ -28,6 +28,7 @@
 
 #include <GlobalStrategyManagers/GlobalStrategyManager.hh>
 #include <PreviewControl/ZMPPreviewControlWithMultiBodyZMP.hh>
+#include <RingBuffer.hh>
 #include <SimplePlugin.hh>
 
 #ifndef _DOUBLE_STAGE_PREVIEW_CONTROL_STRATEGY_H_
@@ -137,9 +138,10 @@ public:
     @param[out] aRightFootAbsolutePositions: Trajectory of absolute positions
     for the right foot.
   */
-  void Setup(deque<ZMPPosition> &aZMPositions, deque<COMState> &aCOMBuffer,
-             deque<FootAbsolutePosition> &aLeftFootAbsolutePositions,
-             deque<FootAbsolutePosition> &aRightFootAbsolutePositions);
+  void Setup(RingBuffer<ZMPPosition> &aZMPositions,
+             RingBuffer<COMState> &aCOMBuffer,
+             RingBuffer<FootAbsolutePosition> &aLeftFootAbsolutePositions,
+             RingBuffer<FootAbsolutePosition> &aRightFootAbsolutePositions);
 
   /*! \brief Get Waist state. */
   bool getWaistState(WaistState &aWaistState);
@@ -37,9 +37,9 @@ GlobalStrategyManager::GlobalStrategyManager(
     : SimplePlugin(aPluginManager) {}
 
 void GlobalStrategyManager::SetBufferPositions(
-    deque<ZMPPosition> *aZMPPositions, deque<COMState> *aCOMBuffer,
-    deque<FootAbsolutePosition> *aLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> *aRightFootAbsolutePositions) {
+    RingBuffer<ZMPPosition> *aZMPPositions, RingBuffer<COMState> *aCOMBuffer,
+    RingBuffer<FootAbsolutePosition> *aLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> *aRightFootAbsolutePositions) {
   m_ZMPPositions = aZMPPositions;
   m_COMBuffer = aCOMBuffer;
   m_LeftFootPositions = aLeftFootAbsolutePositions;
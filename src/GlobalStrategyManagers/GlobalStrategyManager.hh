@@ -33,6 +33,7 @@
 
 // PG
 #include <PreviewControl/PreviewControl.hh>
+#include <RingBuffer.hh>
 #include <SimplePlugin.hh>
 #include <jrl/walkgen/pgtypes.hh>
 
@@ -134,16 +135,16 @@ public:
     buffer of the right foot.
   */
   void
-  SetBufferPositions(deque<ZMPPosition> *aZMPositions,
-                     deque<COMState> *aCOMBuffer,
-                     deque<FootAbsolutePosition> *aLeftFootAbsolutePositions,
-                     deque<FootAbsolutePosition> *aRightFootAbsolutePositions);
+  SetBufferPositions(
+      RingBuffer<ZMPPosition> *aZMPositions, RingBuffer<COMState> *aCOMBuffer,
+      RingBuffer<FootAbsolutePosition> *aLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> *aRightFootAbsolutePositions);
 
   /*! Prepare the buffers at the beginning of the foot positions. */
   virtual void
-  Setup(deque<ZMPPosition> &aZMPositions, deque<COMState> &aCOMBuffer,
-        deque<FootAbsolutePosition> &aLeftFootAbsolutePositions,
-        deque<FootAbsolutePosition> &aRightFootAbsolutePositions) = 0;
+  Setup(RingBuffer<ZMPPosition> &aZMPositions, RingBuffer<COMState> &aCOMBuffer,
+        RingBuffer<FootAbsolutePosition> &aLeftFootAbsolutePositions,
+        RingBuffer<FootAbsolutePosition> &aRightFootAbsolutePositions) = 0;
 
 protected:
   /*! \name Positions buffers.
@@ -151,13 +152,13 @@ protected:
   */
 
   /*! Buffer of ZMP positions */
-  deque<ZMPPosition> *m_ZMPPositions;
+  RingBuffer<ZMPPosition> *m_ZMPPositions;
 
   /*! Buffer for the COM position. */
-  deque<COMState> *m_COMBuffer;
+  RingBuffer<COMState> *m_COMBuffer;
 
   /*! Buffer of absolute foot position. */
-  deque<FootAbsolutePosition> *m_LeftFootPositions, *m_RightFootPositions;
+  RingBuffer<FootAbsolutePosition> *m_LeftFootPositions, *m_RightFootPositions;
 
   /* @} */
 
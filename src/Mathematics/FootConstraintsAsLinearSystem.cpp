@@ -218,8 +218,8 @@ int FootConstraintsAsLinearSystem::ComputeLinearSystem(
 }
 
 int FootConstraintsAsLinearSystem::BuildLinearConstraintInequalities(
-    deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
     deque<LinearConstraintInequality_t *> &QueueOfLConstraintInequalities,
     double ConstraintOnX, double ConstraintOnY) {
   // Find the convex hull for each of the position,
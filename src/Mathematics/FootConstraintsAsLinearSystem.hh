@@ -39,6 +39,7 @@
 #include <jrl/walkgen/pinocchiorobot.hh>
 
 #include <Mathematics/ConvexHull.hh>
+#include <RingBuffer.hh>
 #include <SimplePlugin.hh>
 #include <jrl/walkgen/pgtypes.hh>
 
@@ -70,8 +71,8 @@ public:
     Foot Absolute Position.
   */
   int BuildLinearConstraintInequalities(
-      std::deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-      std::deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
       std::deque<LinearConstraintInequality_t *>
           &QueueOfLConstraintInequalities,
       double ConstraintOnX, double ConstraintOnY);
@@ -79,8 +80,8 @@ public:
   /*!  Build a queue of constraint Inequalities based on a list
     of Foot Absolute Position.  */
   int BuildLinearConstraintInequalities2(
-      std::deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-      std::deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
       std::deque<LinearConstraintInequality_t *>
           &QueueOfLConstraintInequalities,
       double ConstraintOnX, double ConstraintOnY);
@@ -0,0 +1,388 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \brief Dual active-set solver for strictly convex quadratic programs.
+
+  The notations follow Goldfarb and Idnani, "A numerically stable dual
+  method for solving strictly convex quadratic programs", 1983:
+  with \f$ Q = L L^\top \f$ and \f$ N \f$ the normals of the active
+  constraints, \f$ J = L^{-\top} \bar{Q} \f$ where
+  \f$ L^{-1} N = \bar{Q} [R^\top \; 0]^\top \f$.
+  Adding or removing a constraint updates \f$ J \f$ and \f$ R \f$ with
+  Givens rotations.
+
+  With the invariant block \f$ A \f$ of the Hessian
+  \f$ Q = [A \; B; B^\top \; C] \f$ factorized once,
+  \f$ L^{-\top} = [L_A^{-\top} \; -L_A^{-\top} W^\top L_S^{-\top};
+  0 \; L_S^{-\top}] \f$ with \f$ W^\top = L_A^{-1} B \f$ and
+  \f$ L_S \f$ the factor of \f$ S = C - W W^\top \f$.
+ */
+
+#include <cmath>
+#include <limits>
+
+#include <Mathematics/dual-active-set.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+namespace {
+/// Bounds beyond this value are ignored, as the default ones of QPProblem.
+const double InfiniteBound = 1e8;
+/// Tolerance on the constraint violation.
+const double FeasibilityTol = 1e-9;
+/// Relative tolerance of the linear dependency test.
+const double DependencyTol = 1e-12;
+
+/// Apply the Givens rotation (c,s) to the columns j and j+1 of J
+inline void rotate_columns(Eigen::MatrixXd &J, int j, double c, double s) {
+  for (int i = 0; i < J.rows(); i++) {
+    double a = J(i, j), b = J(i, j + 1);
+    J(i, j) = c * a + s * b;
+    J(i, j + 1) = -s * a + c * b;
+  }
+}
+} // namespace
+
+DualActiveSet::DualActiveSet()
+    : Q_(0), DU_(0), D_(0), DS_(0), XL_(0), XU_(0), n_(0), m_(0), NbEq_(0),
+      FactorizationValid_(false), NbInvariant_(0), InvariantValid_(false),
+      NbActive_(0), NbActiveEq_(0),
+      MaxIterations_(0), NbIterations_(0) {}
+
+DualActiveSet::~DualActiveSet() {}
+
+void DualActiveSet::resize(int NbVariables, int NbConstraints) {
+  if (NbVariables != J_.rows()) {
+    J_.resize(NbVariables, NbVariables);
+    R_.resize(NbVariables, NbVariables);
+    X_.resize(NbVariables);
+    u_.resize(NbVariables);
+    np_.resize(NbVariables);
+    d_.resize(NbVariables);
+    z_.resize(NbVariables);
+    r_.resize(NbVariables);
+    b_.resize(NbVariables);
+    Active_.resize(NbVariables);
+    FactorizationValid_ = false;
+  }
+  if (NbConstraints != Slack_.size())
+    Slack_.resize(NbConstraints);
+  if (NbConstraints + 2 * NbVariables != Lagr_.size()) {
+    Lagr_.resize(NbConstraints + 2 * NbVariables);
+    Position_.resize(NbConstraints + 2 * NbVariables);
+  }
+}
+
+bool DualActiveSet::factorize(const const_matrix_view_t &Q) {
+  QFactorized_ = Q;
+  const int k = (int)NbInvariant_;
+  if ((k == 0) || (k >= n_)) {
+    LLT_.compute(QFactorized_);
+    if (LLT_.info() != Eigen::Success)
+      return false;
+    J0_.setIdentity(n_, n_);
+    LLT_.matrixU().solveInPlace(J0_);
+    return true;
+  }
+
+  if (!InvariantValid_ || (QInvariant_.rows() != k) ||
+      !(QInvariant_ == Q.topLeftCorner(k, k))) {
+    QInvariant_ = Q.topLeftCorner(k, k);
+    LLTInvariant_.compute(QInvariant_);
+    InvariantValid_ = (LLTInvariant_.info() == Eigen::Success);
+    if (!InvariantValid_)
+      return false;
+    JInvariant_.setIdentity(k, k);
+    LLTInvariant_.matrixU().solveInPlace(JInvariant_);
+  }
+
+  const int ns = n_ - k;
+  WT_ = Q.topRightCorner(k, ns);
+  LLTInvariant_.matrixL().solveInPlace(WT_);
+  Schur_ = Q.bottomRightCorner(ns, ns);
+  Schur_.noalias() -= WT_.transpose() * WT_;
+  LLTSchur_.compute(Schur_);
+  if (LLTSchur_.info() != Eigen::Success)
+    return false;
+  JSchur_.setIdentity(ns, ns);
+  LLTSchur_.matrixU().solveInPlace(JSchur_);
+
+  J0_.resize(n_, n_);
+  J0_.topLeftCorner(k, k) = JInvariant_;
+  J0_.bottomLeftCorner(ns, k).setZero();
+  J0_.bottomRightCorner(ns, ns) = JSchur_;
+  // The product by the triangular JSchur_ reuses WT_ as output.
+  WT_ = WT_ * JSchur_.triangularView<Eigen::Upper>();
+  J0_.topRightCorner(k, ns).setZero();
+  J0_.topRightCorner(k, ns).noalias() -=
+      JInvariant_.triangularView<Eigen::Upper>() * WT_;
+  return true;
+}
+
+double DualActiveSet::normal(int Constraint, Eigen::VectorXd &Normal) const {
+  if (Constraint < m_) {
+    Normal = DU_->row(Constraint).transpose();
+    return (*DS_)(Constraint);
+  }
+  Normal.setZero();
+  if (Constraint < m_ + n_) {
+    Normal(Constraint - m_) = 1.0;
+    return -(*XL_)(Constraint - m_);
+  }
+  Normal(Constraint - m_ - n_) = -1.0;
+  return (*XU_)(Constraint - m_ - n_);
+}
+
+double DualActiveSet::slack(int Constraint) const {
+  if (Constraint < m_)
+    return DU_->row(Constraint).dot(X_) + (*DS_)(Constraint);
+  if (Constraint < m_ + n_)
+    return X_(Constraint - m_) - (*XL_)(Constraint - m_);
+  return (*XU_)(Constraint - m_ - n_) - X_(Constraint - m_ - n_);
+}
+
+double DualActiveSet::step_directions() {
+  const int q = NbActive_;
+  d_.noalias() = J_.transpose() * np_;
+  double d2 = d_.tail(n_ - q).squaredNorm();
+  if (d2 <= DependencyTol * d_.squaredNorm())
+    d2 = 0.0;
+  z_.noalias() = J_.rightCols(n_ - q) * d_.tail(n_ - q);
+  r_.head(q) = R_.topLeftCorner(q, q).triangularView<Eigen::Upper>().solve(
+      d_.head(q));
+  return d2;
+}
+
+void DualActiveSet::add_to_factorization(int Constraint) {
+  const int q = NbActive_;
+  // Rotate J such that only the first q+1 components of J'n are non zero.
+  for (int j = n_ - 1; j > q; j--) {
+    if (d_(j) == 0.0)
+      continue;
+    double h = std::sqrt(d_(j - 1) * d_(j - 1) + d_(j) * d_(j));
+    double c = d_(j - 1) / h, s = d_(j) / h;
+    d_(j - 1) = h;
+    d_(j) = 0.0;
+    rotate_columns(J_, j - 1, c, s);
+  }
+  R_.col(q).head(q + 1) = d_.head(q + 1);
+  Active_[q] = Constraint;
+  Position_[Constraint] = q;
+  NbActive_++;
+}
+
+void DualActiveSet::drop(int Position) {
+  Position_[Active_[Position]] = -1;
+  for (int k = Position; k < NbActive_ - 1; k++) {
+    R_.col(k).head(k + 2) = R_.col(k + 1).head(k + 2);
+    u_(k) = u_(k + 1);
+    Active_[k] = Active_[k + 1];
+    Position_[Active_[k]] = k;
+  }
+  NbActive_--;
+  // Restore the triangular form of R.
+  for (int j = Position; j < NbActive_; j++) {
+    double a = R_(j, j), b = R_(j + 1, j);
+    if (b == 0.0)
+      continue;
+    double h = std::sqrt(a * a + b * b);
+    double c = a / h, s = b / h;
+    for (int k = j; k < NbActive_; k++) {
+      double rj = R_(j, k), rj1 = R_(j + 1, k);
+      R_(j, k) = c * rj + s * rj1;
+      R_(j + 1, k) = -s * rj + c * rj1;
+    }
+    rotate_columns(J_, j, c, s);
+  }
+}
+
+bool DualActiveSet::force(int Constraint) {
+  normal(Constraint, np_);
+  double zn = step_directions();
+  if (zn == 0.0)
+    return false;
+  double t = -slack(Constraint) / zn;
+  X_ += t * z_;
+  u_.head(NbActive_) -= t * r_.head(NbActive_);
+  int q = NbActive_;
+  add_to_factorization(Constraint);
+  u_(q) = t;
+  return true;
+}
+
+void DualActiveSet::update_from_active_set() {
+  const int q = NbActive_;
+  for (int k = 0; k < q; k++)
+    b_(k) = -normal(Active_[k], np_);
+  // x = J1 y1 - J2 J2' d with R' y1 = -b, and R u = y1 + J1' d.
+  d_.noalias() = J_.transpose() * (*D_);
+  r_.head(q) =
+      R_.topLeftCorner(q, q).transpose().triangularView<Eigen::Lower>().solve(
+          b_.head(q));
+  X_.noalias() = J_.leftCols(q) * r_.head(q);
+  X_.noalias() -= J_.rightCols(n_ - q) * d_.tail(n_ - q);
+  r_.head(q) += d_.head(q);
+  u_.head(q) =
+      R_.topLeftCorner(q, q).triangularView<Eigen::Upper>().solve(r_.head(q));
+}
+
+int DualActiveSet::solve(const const_matrix_view_t &Q,
+                         const const_vector_view_t &D,
+                         const const_matrix_view_t &DU,
+                         const const_vector_view_t &DS,
+                         const const_vector_view_t &XL,
+                         const const_vector_view_t &XU,
+                         unsigned int NbEqConstraints,
+                         const std::vector<int> &ActiveSet) {
+  Q_ = &Q;
+  D_ = &D;
+  DU_ = &DU;
+  DS_ = &DS;
+  XL_ = &XL;
+  XU_ = &XU;
+  n_ = (int)Q.rows();
+  m_ = (int)DU.rows();
+  NbEq_ = (int)NbEqConstraints;
+  NbIterations_ = 0;
+  resize(n_, m_);
+
+  // Factorize the Hessian only when it changed.
+  if (!FactorizationValid_ || !(QFactorized_ == Q)) {
+    FactorizationValid_ = factorize(Q);
+    if (!FactorizationValid_)
+      return NOT_POSITIVE_DEFINITE;
+  }
+  J_ = J0_;
+  NbActive_ = 0;
+  std::fill(Position_.begin(), Position_.end(), -1);
+  Lagr_.setZero();
+
+  // Unconstrained minimum
+  d_.noalias() = J_.transpose() * D;
+  X_.noalias() = -J_ * d_;
+
+  // Equality constraints
+  for (int i = 0; i < NbEq_; i++) {
+    if (!force(i) && std::fabs(slack(i)) > FeasibilityTol)
+      return INFEASIBLE;
+  }
+  NbActiveEq_ = NbActive_;
+
+  // Hot start: minimum on the initial active set, then release the
+  // constraints with negative multipliers.
+  for (std::size_t i = 0; i < ActiveSet.size() && NbActive_ < n_; i++) {
+    int Constraint = ActiveSet[i];
+    if ((Constraint < NbEq_) || (Constraint >= m_ + 2 * n_) ||
+        (Position_[Constraint] >= 0))
+      continue;
+    if ((Constraint >= m_) &&
+        (std::fabs(normal(Constraint, np_)) >= InfiniteBound))
+      continue;
+    force(Constraint);
+  }
+  if (NbActive_ > NbActiveEq_) {
+    for (;;) {
+      update_from_active_set();
+      int Worst = -1;
+      double uMin = 0.0;
+      for (int k = NbActiveEq_; k < NbActive_; k++)
+        if (u_(k) < uMin) {
+          uMin = u_(k);
+          Worst = k;
+        }
+      if (Worst < 0)
+        break;
+      drop(Worst);
+    }
+  }
+
+  const double Inf = std::numeric_limits<double>::infinity();
+  for (;;) {
+    // Most violated constraint
+    Slack_.noalias() = DU * X_;
+    Slack_ += DS;
+    int p = -1;
+    double sp = -FeasibilityTol;
+    for (int i = NbEq_; i < m_; i++)
+      if ((Slack_(i) < sp) && (Position_[i] < 0)) {
+        sp = Slack_(i);
+        p = i;
+      }
+    for (int j = 0; j < n_; j++) {
+      if ((XL(j) > -InfiniteBound) && (X_(j) - XL(j) < sp) &&
+          (Position_[m_ + j] < 0)) {
+        sp = X_(j) - XL(j);
+        p = m_ + j;
+      }
+      if ((XU(j) < InfiniteBound) && (XU(j) - X_(j) < sp) &&
+          (Position_[m_ + n_ + j] < 0)) {
+        sp = XU(j) - X_(j);
+        p = m_ + n_ + j;
+      }
+    }
+    if (p < 0)
+      break;
+
+    // Make p active, releasing the constraints which block the dual step.
+    normal(p, np_);
+    double up = 0.0;
+    for (;;) {
+      if ((MaxIterations_ > 0) && (NbIterations_ >= MaxIterations_)) {
+        for (int k = 0; k < NbActive_; k++)
+          Lagr_(Active_[k]) = u_(k);
+        return MAX_ITERATIONS;
+      }
+      NbIterations_++;
+
+      const int q = NbActive_;
+      double zn = step_directions();
+      double t1 = Inf;
+      int l = -1;
+      for (int k = NbActiveEq_; k < q; k++)
+        if ((r_(k) > 0.0) && (u_(k) / r_(k) < t1)) {
+          t1 = u_(k) / r_(k);
+          l = k;
+        }
+      double t2 = (zn > 0.0) ? -sp / zn : Inf;
+      double t = std::min(t1, t2);
+      if (t == Inf)
+        return INFEASIBLE;
+
+      if (zn > 0.0)
+        X_ += t * z_;
+      u_.head(q) -= t * r_.head(q);
+      up += t;
+      if (t2 <= t1) {
+        add_to_factorization(p);
+        u_(q) = up;
+        break;
+      }
+      u_(l) = 0.0;
+      drop(l);
+      sp = slack(p);
+    }
+  }
+
+  for (int k = 0; k < NbActive_; k++)
+    Lagr_(Active_[k]) = u_(k);
+  return SUCCESS;
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \brief Dual active-set solver for strictly convex quadratic programs
+  (Goldfarb and Idnani, 1983) which can be hot started.
+ */
+
+#ifndef _DUAL_ACTIVE_SET_
+#define _DUAL_ACTIVE_SET_
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace PatternGeneratorJRL {
+
+/// \brief Dual active-set QP solver.
+///
+/// Solve \f$ \min \frac{1}{2} x^\top Q x + d^\top x \f$ subject to
+/// \f$ DU_i x + DS_i = 0 \f$ for the first NbEqConstraints rows,
+/// \f$ DU_i x + DS_i \geq 0 \f$ for the other rows and
+/// \f$ XL \leq x \leq XU \f$, with the conventions of QLD.
+/// Bounds whose absolute value is larger than 1e8 are ignored.
+///
+/// The solver starts from the minimum of the problem restricted to
+/// an initial active set, typically the active set of the last cycle,
+/// instead of the unconstrained minimum.
+/// The inverse Cholesky factor of the Hessian is kept between two calls
+/// and recomputed only when the Hessian changes.
+/// When the leading block of the Hessian is invariant, as the jerk block
+/// of the walking problem, its factor is kept as well and only the Schur
+/// complement of the remaining rows and columns is factorized.
+class DualActiveSet {
+public:
+  typedef Eigen::Map<const Eigen::MatrixXd, Eigen::Unaligned,
+                     Eigen::OuterStride<> >
+      const_matrix_view_t;
+  typedef Eigen::Map<const Eigen::VectorXd> const_vector_view_t;
+
+  /// \brief Termination reasons
+  enum status_e {
+    SUCCESS = 0,
+    MAX_ITERATIONS = 1,
+    NOT_POSITIVE_DEFINITE = 2,
+    INFEASIBLE = 3
+  };
+
+  DualActiveSet();
+  ~DualActiveSet();
+
+  /// \brief Solve the problem
+  ///
+  /// \param[in] Q Hessian
+  /// \param[in] D Gradient
+  /// \param[in] DU Constraint matrix
+  /// \param[in] DS Constraint vector
+  /// \param[in] XL Lower bounds
+  /// \param[in] XU Upper bounds
+  /// \param[in] NbEqConstraints Number of equality constraints
+  /// \param[in] ActiveSet Initial active set: indices of rows of DU,
+  /// of lower bounds offset by the number of rows and of upper bounds
+  /// offset by the number of rows plus the number of variables.
+  /// \return Termination reason
+  int solve(const const_matrix_view_t &Q, const const_vector_view_t &D,
+            const const_matrix_view_t &DU, const const_vector_view_t &DS,
+            const const_vector_view_t &XL, const const_vector_view_t &XU,
+            unsigned int NbEqConstraints, const std::vector<int> &ActiveSet);
+
+  /// \name Accessors and mutators
+  /// \{
+  /// \brief Solution of the last call
+  inline const Eigen::VectorXd &Solution() const { return X_; };
+
+  /// \brief Lagrange multipliers of the last call, ordered as the
+  /// indices of the active set (same layout as the U array of QLD)
+  inline const Eigen::VectorXd &Lagr() const { return Lagr_; };
+
+  /// \brief Number of iterations of the last call
+  inline unsigned int NbIterations() const { return NbIterations_; };
+
+  /// \brief Maximal number of iterations, 0 for no limit.
+  /// When the limit is reached the last iterate is returned,
+  /// it is optimal for the constraints added so far but may violate others.
+  inline void MaxIterations(unsigned int MaxIterations) {
+    MaxIterations_ = MaxIterations;
+  };
+  inline unsigned int MaxIterations() const { return MaxIterations_; };
+
+  /// \brief Size of the leading block of the Hessian which does not
+  /// change between two calls, 0 if none.
+  inline void NbInvariantVariables(unsigned int NbInvariantVariables) {
+    NbInvariant_ = NbInvariantVariables;
+  };
+  inline unsigned int NbInvariantVariables() const { return NbInvariant_; };
+  /// \}
+
+  //
+  // Private methods
+  //
+private:
+  /// \brief Allocate the workspace
+  void resize(int NbVariables, int NbConstraints);
+
+  /// \brief Normal and constant of a constraint
+  double normal(int Constraint, Eigen::VectorXd &Normal) const;
+
+  /// \brief Value of a constraint at the current iterate
+  double slack(int Constraint) const;
+
+  /// \brief Compute J0_ from the Hessian
+  ///
+  /// \return false if the Hessian is not positive definite
+  bool factorize(const const_matrix_view_t &Q);
+
+  /// \brief Compute the primal step direction z_ and the dual one r_
+  /// for the normal np_
+  ///
+  /// \return \f$ z^\top n \f$, 0 if the constraint is linearly dependent
+  /// on the active ones
+  double step_directions();
+
+  /// \brief Add a constraint to the factorization once d_ has been computed
+  void add_to_factorization(int Constraint);
+
+  /// \brief Remove the active constraint at position Position
+  void drop(int Position);
+
+  /// \brief Add a constraint with a full step, whatever the sign of its
+  /// multiplier
+  ///
+  /// \return false if the constraint is linearly dependent
+  bool force(int Constraint);
+
+  /// \brief Recompute the iterate and the multipliers from the
+  /// factorization of the active set
+  void update_from_active_set();
+
+  //
+  // Private members
+  //
+private:
+  /// \brief Problem being solved
+  /// \{
+  const const_matrix_view_t *Q_, *DU_;
+  const const_vector_view_t *D_, *DS_, *XL_, *XU_;
+  int n_, m_, NbEq_;
+  /// \}
+
+  /// \brief Hessian of the last factorization and its inverse factor
+  /// \f$ L^{-\top} \f$
+  Eigen::MatrixXd QFactorized_, J0_;
+  Eigen::LLT<Eigen::MatrixXd> LLT_;
+  bool FactorizationValid_;
+
+  /// \brief Invariant block of the last factorization and its inverse
+  /// factor \f$ L_A^{-\top} \f$
+  unsigned int NbInvariant_;
+  Eigen::MatrixXd QInvariant_, JInvariant_;
+  Eigen::LLT<Eigen::MatrixXd> LLTInvariant_;
+  bool InvariantValid_;
+  /// \brief \f$ L_A^{-1} B \f$, Schur complement
+  /// \f$ C - B^\top A^{-1} B \f$ and its factorization
+  Eigen::MatrixXd WT_, Schur_, JSchur_;
+  Eigen::LLT<Eigen::MatrixXd> LLTSchur_;
+
+  /// \brief Orthogonal factorization of the active normals
+  /// \f$ J^\top N = [R^\top \; 0]^\top \f$
+  Eigen::MatrixXd J_, R_;
+
+  /// \brief Iterate, multipliers of the active set and work vectors
+  Eigen::VectorXd X_, u_, np_, d_, z_, r_, b_, Slack_, Lagr_;
+
+  /// \brief Active constraints, in the order of the factorization
+  std::vector<int> Active_;
+  /// \brief Position of each constraint in Active_, -1 if inactive
+  std::vector<int> Position_;
+  int NbActive_, NbActiveEq_;
+
+  unsigned int MaxIterations_, NbIterations_;
+};
+
+} // namespace PatternGeneratorJRL
+
+#endif /* _DUAL_ACTIVE_SET_ */
@@ -29,6 +29,7 @@
 #ifndef _COM_AND_FOOT_REALIZATION_H_
 #define _COM_AND_FOOT_REALIZATION_H_
 
+#include <RingBuffer.hh>
 #include <SimplePlugin.hh>
 #include <StepStackHandler.hh>
 #include <jrl/walkgen/pinocchiorobot.hh>
@@ -158,7 +159,7 @@ public:
     for the upper body motion are correctly setup.
   */
   virtual bool InitializationUpperBody(
-      deque<ZMPPosition> &inZMPPositions, deque<COMPosition> &inCOMBuffer,
+      RingBuffer<ZMPPosition> &inZMPPositions, deque<COMPosition> &inCOMBuffer,
       deque<RelativeFootPosition> lRelativeFootPositions) = 0;
 
   /* @} */
@@ -47,6 +47,8 @@ ComAndFootRealizationByGeometry::ComAndFootRealizationByGeometry(
   m_LeftShoulder = 0;
   m_RightShoulder = 0;
   ShiftFoot_ = true;
+  m_LegsJoints = 0;
+  m_LegsJointsRow = 0;
   RegisterMethods();
 
   for (unsigned int i = 0; i < 3; i++)
@@ -488,7 +490,7 @@ bool ComAndFootRealizationByGeometry::InitializationCoM(
 }
 
 bool ComAndFootRealizationByGeometry::InitializationUpperBody(
-    deque<ZMPPosition> &inZMPPositions, deque<COMPosition> &inCOMBuffer,
+    RingBuffer<ZMPPosition> &inZMPPositions, deque<COMPosition> &inCOMBuffer,
     deque<RelativeFootPosition> lRelativeFootPositions) {
 
   // Check pre-condition.
@@ -516,7 +518,7 @@ bool ComAndFootRealizationByGeometry::InitializationUpperBody(
   // of control"
   // in order to take the arm swing motion into account in the second
   // preview loop
-  deque<ZMPPosition> aZMPBuffer;
+  RingBuffer<ZMPPosition> aZMPBuffer;
 
   aZMPBuffer.resize(inCOMBuffer.size());
 
@@ -568,25 +570,38 @@ bool ComAndFootRealizationByGeometry::InitializationUpperBody(
   return true;
 }
 
-bool ComAndFootRealizationByGeometry::KinematicsForOneLeg(
-    Eigen::Matrix3d &Body_R, Eigen::Vector3d &Body_P, Eigen::VectorXd &aFoot,
-    Eigen::Vector3d &lDt, Eigen::VectorXd &aCoMPosition,
-    Eigen::Vector3d &ToTheHip, int LeftOrRight, Eigen::VectorXd &lq,
-    int Stage) {
+void ComAndFootRealizationByGeometry::BodyOrientation(
+    const Eigen::VectorXd &aCoMPosition, Eigen::Matrix3d &Body_R) {
+  // Angles for the COM
+  double COMtheta = aCoMPosition(5);
+  double COMomega = aCoMPosition(4);
 
-  // Foot Orientation
-  Eigen::Matrix3d Foot_R;
-  // Foot position
-  Eigen::Vector3d Foot_P;
+  ODEBUG("COMtheta: " << COMtheta);
+  double CosTheta = cos(COMtheta * M_PI / 180.0);
+  double SinTheta = sin(COMtheta * M_PI / 180.0);
+  double CosOmega = cos(COMomega * M_PI / 180.0);
+  double SinOmega = sin(COMomega * M_PI / 180.0);
+
+  Body_R(0, 0) = CosTheta * CosOmega;
+  Body_R(0, 1) = -SinTheta;
+  Body_R(0, 2) = CosTheta * SinOmega;
+
+  Body_R(1, 0) = SinTheta * CosOmega;
+  Body_R(1, 1) = CosTheta;
+  Body_R(1, 2) = SinTheta * SinOmega;
+
+  Body_R(2, 0) = -SinOmega;
+  Body_R(2, 1) = 0;
+  Body_R(2, 2) = CosOmega;
+}
 
-  // LEFT Foot.
+void ComAndFootRealizationByGeometry::AnklePose(const Eigen::VectorXd &aFoot,
+                                                int LeftOrRight,
+                                                Eigen::Matrix4d &FootPose) {
   double FootPositiontheta = aFoot(3);
   double FootPositionomega = aFoot(4);
   double c, s, co, so;
 
-  // This is just to make the flag WERROR happy.
-  c = aCoMPosition(2) + ToTheHip(2) + lDt(2);
-
   ODEBUG("FootPositiontheta: " << FootPositiontheta);
   c = cos(FootPositiontheta * M_PI / 180.0);
   s = sin(FootPositiontheta * M_PI / 180.0);
@@ -595,6 +610,7 @@ bool ComAndFootRealizationByGeometry::KinematicsForOneLeg(
   so = sin(FootPositionomega * M_PI / 180.0);
 
   // Orientation
+  Eigen::Matrix3d Foot_R;
   Foot_R(0, 0) = c * co;
   Foot_R(0, 1) = -s;
   Foot_R(0, 2) = c * so;
@@ -606,56 +622,61 @@ bool ComAndFootRealizationByGeometry::KinematicsForOneLeg(
   Foot_R(2, 2) = co;
 
   // position
+  Eigen::Vector3d Foot_P;
   Foot_P(0) = aFoot(0);
   Foot_P(1) = aFoot(1);
   Foot_P(2) = aFoot(2);
 
-  Eigen::Vector3d Foot_Shift;
+  if (ShiftFoot_) {
+    if (LeftOrRight == -1)
+      Foot_P = Foot_P + Foot_R * m_AnklePositionRight;
+    else if (LeftOrRight == 1)
+      Foot_P = Foot_P + Foot_R * m_AnklePositionLeft;
+  }
+
+  FootPose.setIdentity();
+  FootPose.topLeftCorner<3, 3>() = Foot_R;
+  FootPose.topRightCorner<3, 1>() = Foot_P;
+}
+
+bool ComAndFootRealizationByGeometry::KinematicsForOneLeg(
+    Eigen::Matrix3d &Body_R, Eigen::Vector3d &Body_P, Eigen::VectorXd &aFoot,
+    Eigen::Vector3d &lDt, Eigen::VectorXd &aCoMPosition,
+    Eigen::Vector3d &ToTheHip, int LeftOrRight, Eigen::VectorXd &lq,
+    int Stage) {
+
+  // This is just to make the flag WERROR happy.
+  double c = aCoMPosition(2) + ToTheHip(2) + lDt(2);
+  (void)c;
+
+  // Homogeneous matrix
+  Eigen::Matrix4d BodyPose, FootPose;
+  AnklePose(aFoot, LeftOrRight, FootPose);
+  BodyPose.setIdentity();
+  BodyPose.topLeftCorner<3, 3>() = Body_R;
+  BodyPose.topRightCorner<3, 1>() = Body_P;
 
   pinocchio::JointIndex Ankle = 0;
-  if (LeftOrRight == -1) {
-    Foot_Shift = Foot_R * m_AnklePositionRight;
+  if (LeftOrRight == -1)
     Ankle = getPinocchioRobot()->rightFoot()->associatedAnkle;
-  } else if (LeftOrRight == 1) {
-    Foot_Shift = Foot_R * m_AnklePositionLeft;
+  else if (LeftOrRight == 1)
     Ankle = getPinocchioRobot()->leftFoot()->associatedAnkle;
-  }
 
-  if (ShiftFoot_) {
-    Foot_P = Foot_P + Foot_Shift;
-  }
   //  Foot_P(2)-=(aCoMPosition(2) + ToTheHip(2));
-  ODEBUG("Body_P:" << endl << Body_P);
-  ODEBUG("Body_R:" << endl << Body_R);
-  ODEBUG("Foot_P" << Foot_P);
-  ODEBUG("Foot_R" << Foot_R);
+  ODEBUG("BodyPose:" << endl << BodyPose);
+  ODEBUG("FootPose:" << endl << FootPose);
   // Compute the inverse kinematics.
   if ((LeftOrRight == 1) && (Stage == 0)) {
     ODEBUG4SIMPLE(Body_P[0] << " " << Body_P[1] << " " << Body_P[2] << " "
-                            << Foot_P[0] << " " << Foot_P[1] << " " << Foot_P[2]
-                            << " ",
+                            << FootPose(0, 3) << " " << FootPose(1, 3) << " "
+                            << FootPose(2, 3) << " ",
                   "DebugDataIK.dat");
   }
 
-  ODEBUG4("Body_P " << Body_P, "DebugDataIK.dat");
-  ODEBUG4("Body_R " << Body_R, "DebugDataIK.dat");
-  ODEBUG4("Foot_P " << Foot_P, "DebugDataIK.dat");
-  ODEBUG4("Foot_R " << Foot_R, "DebugDataIK.dat");
+  ODEBUG4("BodyPose " << BodyPose, "DebugDataIK.dat");
+  ODEBUG4("FootPose " << FootPose, "DebugDataIK.dat");
   ODEBUG4("lDt " << lDt, "DebugDataIK.dat");
 
-  // Homogeneous matrix
-  Eigen::Matrix4d BodyPose, FootPose;
-  for (unsigned int i = 0; i < 3; i++) {
-    for (unsigned int j = 0; j < 3; j++) {
-      BodyPose(i, j) = Body_R(i, j);
-      FootPose(i, j) = Foot_R(i, j);
-    }
-    BodyPose(i, 3) = Body_P(i);
-    FootPose(i, 3) = Foot_P(i);
-  }
-  BodyPose(3, 3) = 1.0;
-  FootPose(3, 3) = 1.0;
-
   pinocchio::JointIndex Waist = getPinocchioRobot()->waist();
 
   ODEBUG("Typeid of humanoid: " << typeid(getHumanoidDynamicRobot()).name());
@@ -666,6 +687,36 @@ bool ComAndFootRealizationByGeometry::KinematicsForOneLeg(
   return true;
 }
 
+void ComAndFootRealizationByGeometry::LegsPoses(
+    const Eigen::VectorXd &aCoMPosition, const Eigen::VectorXd &aLeftFoot,
+    const Eigen::VectorXd &aRightFoot, PRLegsBatch &legs, Eigen::Index row) {
+  Eigen::Matrix3d Body_R;
+  BodyOrientation(aCoMPosition, Body_R);
+
+  Eigen::Matrix4d BodyPose, FootPose;
+  BodyPose.setIdentity();
+  BodyPose.topLeftCorner<3, 3>() = Body_R;
+
+  // The hips are placed as in KinematicsForTheLegs.
+  Eigen::Vector3d ToTheHip = Body_R * m_TranslationToTheLeftHip;
+  for (unsigned int i = 0; i < 3; i++)
+    BodyPose(i, 3) = aCoMPosition(i) + ToTheHip(i);
+  AnklePose(aLeftFoot, 1, FootPose);
+  legs.set(row, 1, BodyPose, FootPose);
+
+  ToTheHip = Body_R * m_TranslationToTheRightHip;
+  for (unsigned int i = 0; i < 3; i++)
+    BodyPose(i, 3) = aCoMPosition(i) + ToTheHip(i);
+  AnklePose(aRightFoot, -1, FootPose);
+  legs.set(row + 1, -1, BodyPose, FootPose);
+}
+
+void ComAndFootRealizationByGeometry::UseLegsJoints(
+    const Eigen::Array<double, Eigen::Dynamic, 6> *q, Eigen::Index row) {
+  m_LegsJoints = q;
+  m_LegsJointsRow = row;
+}
+
 bool ComAndFootRealizationByGeometry::KinematicsForTheLegs(
     Eigen::VectorXd &aCoMPosition, Eigen::VectorXd &aLeftFoot,
     Eigen::VectorXd &aRightFoot, int Stage, Eigen::VectorXd &ql,
@@ -678,38 +729,8 @@ bool ComAndFootRealizationByGeometry::KinematicsForTheLegs(
   // To the hip
   Eigen::Vector3d ToTheHip;
 
-  // Angles for the COM
-  double COMtheta, COMomega;
-
-  // Extract the angles from the input.
-  COMtheta = aCoMPosition(5);
-  COMomega = aCoMPosition(4);
-
-  ODEBUG("COMtheta: " << COMtheta);
-  // Cos and sinus for theta.
-  double CosTheta, SinTheta;
-
-  // Cos and sinus for Omega.
-  double CosOmega, SinOmega;
-
-  CosTheta = cos(COMtheta * M_PI / 180.0);
-  SinTheta = sin(COMtheta * M_PI / 180.0);
-
-  CosOmega = cos(COMomega * M_PI / 180.0);
-  SinOmega = sin(COMomega * M_PI / 180.0);
-
   // COM Orientation
-  Body_R(0, 0) = CosTheta * CosOmega;
-  Body_R(0, 1) = -SinTheta;
-  Body_R(0, 2) = CosTheta * SinOmega;
-
-  Body_R(1, 0) = SinTheta * CosOmega;
-  Body_R(1, 1) = CosTheta;
-  Body_R(1, 2) = SinTheta * SinOmega;
-
-  Body_R(2, 0) = -SinOmega;
-  Body_R(2, 1) = 0;
-  Body_R(2, 2) = CosOmega;
+  BodyOrientation(aCoMPosition, Body_R);
 
   // COM position
 
@@ -723,17 +744,7 @@ bool ComAndFootRealizationByGeometry::KinematicsForTheLegs(
   /* If this is the second call, (stage =1)
      it is the final desired CoM */
   if (Stage == 1) {
-    m_FinalDesiredCOMPose(0, 0) = CosTheta * CosOmega;
-    m_FinalDesiredCOMPose(0, 1) = -SinTheta;
-    m_FinalDesiredCOMPose(0, 2) = CosTheta * SinOmega;
-
-    m_FinalDesiredCOMPose(1, 0) = SinTheta * CosOmega;
-    m_FinalDesiredCOMPose(1, 1) = CosTheta;
-    m_FinalDesiredCOMPose(1, 2) = SinTheta * SinOmega;
-
-    m_FinalDesiredCOMPose(2, 0) = -SinOmega;
-    m_FinalDesiredCOMPose(2, 1) = 0;
-    m_FinalDesiredCOMPose(2, 2) = CosOmega;
+    m_FinalDesiredCOMPose.topLeftCorner<3, 3>() = Body_R;
 
     m_FinalDesiredCOMPose(0, 3) = aCoMPosition(0);
     m_FinalDesiredCOMPose(1, 3) = aCoMPosition(1);
@@ -748,8 +759,11 @@ bool ComAndFootRealizationByGeometry::KinematicsForTheLegs(
   // Kinematics for the left leg.
   ODEBUG4("Stage " << Stage, "DebugDataIK.dat");
   ODEBUG4("* Left Lego *", "DebugDataIK.dat");
-  KinematicsForOneLeg(Body_R, Body_P, aLeftFoot, m_DtLeft, aCoMPosition,
-                      ToTheHip, 1, ql, Stage);
+  if (m_LegsJoints != 0)
+    ql = m_LegsJoints->row(m_LegsJointsRow).transpose().matrix();
+  else
+    KinematicsForOneLeg(Body_R, Body_P, aLeftFoot, m_DtLeft, aCoMPosition,
+                        ToTheHip, 1, ql, Stage);
 
   // Kinematics for the right leg.
   ToTheHip = Body_R * m_TranslationToTheRightHip;
@@ -758,8 +772,11 @@ bool ComAndFootRealizationByGeometry::KinematicsForTheLegs(
   Body_P(2) = aCoMPosition(2) + ToTheHip(2);
 
   ODEBUG4("* Right Leg *", "DebugDataIK.dat");
-  KinematicsForOneLeg(Body_R, Body_P, aRightFoot, m_DtRight, aCoMPosition,
-                      ToTheHip, -1, qr, Stage);
+  if (m_LegsJoints != 0)
+    qr = m_LegsJoints->row(m_LegsJointsRow + 1).transpose().matrix();
+  else
+    KinematicsForOneLeg(Body_R, Body_P, aRightFoot, m_DtRight, aCoMPosition,
+                        ToTheHip, -1, qr, Stage);
 
   ODEBUG4("**************", "DebugDataIK.dat");
   /* Should compute now the Waist Position */
@@ -772,13 +789,10 @@ bool ComAndFootRealizationByGeometry::KinematicsForTheLegs(
   return true;
 }
 
-bool ComAndFootRealizationByGeometry::ComputePostureForGivenCoMAndFeetPosture(
-    Eigen::VectorXd &aCoMPosition, Eigen::VectorXd &aCoMSpeed,
-    Eigen::VectorXd &aCoMAcc, Eigen::VectorXd &aLeftFoot,
+void ComAndFootRealizationByGeometry::ComputeConfigurationForPosture(
+    Eigen::VectorXd &aCoMPosition, Eigen::VectorXd &aLeftFoot,
     Eigen::VectorXd &aRightFoot, Eigen::VectorXd &CurrentConfiguration,
-    Eigen::VectorXd &CurrentVelocity, Eigen::VectorXd &CurrentAcceleration,
-    unsigned long int IterationNumber, int Stage) {
-  Eigen::Vector3d AbsoluteWaistPosition;
+    Eigen::Vector3d &AbsoluteWaistPosition, int Stage) {
   Eigen::VectorXd lqr(6);
   Eigen::VectorXd lql(6);
 
@@ -862,6 +876,86 @@ bool ComAndFootRealizationByGeometry::ComputePostureForGivenCoMAndFeetPosture(
   for (unsigned int i = 0; i < qArml.size(); i++)
     CurrentConfiguration[m_LeftArmIndexinConfiguration[i]] = qArml[i];
 
+  ODEBUG("lql: " << lql << " lqr: " << lqr);
+
+  string aDebugFileName;
+
+  ODEBUG4((1.0 / M_PI) * 180.0 * lql[0] << " " << (1.0 / M_PI) * 180.0 * lql[1]
+                                        << " " << (1.0 / M_PI) * 180.0 * lql[2]
+                                        << " " << (1.0 / M_PI) * 180.0 * lql[3]
+                                        << " " << (1.0 / M_PI) * 180.0 * lql[4]
+                                        << " " << (1.0 / M_PI) * 180.0 * lql[5],
+          (char *)aDebugFileName.c_str());
+}
+
+void ComAndFootRealizationByGeometry::ComputeWaistVelocityAndAcceleration(
+    Eigen::VectorXd &aCoMPosition, Eigen::VectorXd &aCoMSpeed,
+    Eigen::VectorXd &aCoMAcc, Eigen::Vector3d &AbsoluteWaistPosition,
+    Eigen::VectorXd &CurrentVelocity, Eigen::VectorXd &CurrentAcceleration) {
+  Eigen::Vector3d waistCom;
+  for (int i = 0; i < 3; i++)
+    waistCom(i) = aCoMPosition(i) - AbsoluteWaistPosition(i);
+
+  // v_waist = v_com + waist-com x omega :
+  CurrentVelocity[0] =
+      aCoMSpeed(0) + (waistCom(1) * aCoMSpeed(5) - waistCom(2) * aCoMSpeed(4));
+  CurrentVelocity[1] =
+      aCoMSpeed(1) + (waistCom(2) * aCoMSpeed(3) - waistCom(0) * aCoMSpeed(5));
+  CurrentVelocity[2] =
+      aCoMSpeed(2) + (waistCom(0) * aCoMSpeed(4) - waistCom(1) * aCoMSpeed(3));
+
+  // omega_waist = omega_com
+  for (int i = 3; i < 6; i++)
+    CurrentVelocity[i] = aCoMSpeed(i);
+
+  // (omega x waist-com) x omega = waist-com ( omega . omega )
+  // - omega ( omega . waist-com )
+  Eigen::Vector3d coriolis;
+  double omega_dot_omega = aCoMSpeed(3) * aCoMSpeed(3) +
+                           aCoMSpeed(4) * aCoMSpeed(4) +
+                           aCoMSpeed(5) * aCoMSpeed(5);
+  double omega_dot_waistCom = aCoMSpeed(3) * waistCom(0) +
+                              aCoMSpeed(4) * waistCom(1) +
+                              aCoMSpeed(5) * waistCom(2);
+
+  coriolis(0) =
+      waistCom(0) * omega_dot_omega - aCoMSpeed(3) * omega_dot_waistCom;
+  coriolis(1) =
+      waistCom(1) * omega_dot_omega - aCoMSpeed(4) * omega_dot_waistCom;
+  coriolis(2) =
+      waistCom(2) * omega_dot_omega - aCoMSpeed(5) * omega_dot_waistCom;
+
+  // a_waist = a_com + waist-com x d omega/dt + (omega x waist-com) x omega
+  CurrentAcceleration[0] =
+      aCoMAcc(0) + (waistCom(1) * aCoMAcc(5) - waistCom(2) * aCoMAcc(4)) +
+      coriolis(0);
+  CurrentAcceleration[1] =
+      aCoMAcc(1) + (waistCom(2) * aCoMAcc(3) - waistCom(0) * aCoMAcc(5)) +
+      coriolis(1);
+  CurrentAcceleration[2] =
+      aCoMAcc(2) + (waistCom(0) * aCoMAcc(4) - waistCom(1) * aCoMAcc(3)) +
+      coriolis(2);
+
+  // d omega_waist /dt = d omega_com /dt
+  // cout << "CFRG : " ;
+  for (int i = 3; i < 6; i++) {
+    // cout << aCoMAcc(i) << " "  ;
+    CurrentAcceleration[i] = aCoMAcc(i);
+  } // cout << endl ;
+}
+
+bool ComAndFootRealizationByGeometry::ComputePostureForGivenCoMAndFeetPosture(
+    Eigen::VectorXd &aCoMPosition, Eigen::VectorXd &aCoMSpeed,
+    Eigen::VectorXd &aCoMAcc, Eigen::VectorXd &aLeftFoot,
+    Eigen::VectorXd &aRightFoot, Eigen::VectorXd &CurrentConfiguration,
+    Eigen::VectorXd &CurrentVelocity, Eigen::VectorXd &CurrentAcceleration,
+    unsigned long int IterationNumber, int Stage) {
+  Eigen::Vector3d AbsoluteWaistPosition;
+
+  ComputeConfigurationForPosture(aCoMPosition, aLeftFoot, aRightFoot,
+                                 CurrentConfiguration, AbsoluteWaistPosition,
+                                 Stage);
+
   // Update the speed values.
   /* If this is the first call ( stage = 0)
      we should update the current stored values.  */
@@ -906,7 +1000,6 @@ bool ComAndFootRealizationByGeometry::ComputePostureForGivenCoMAndFeetPosture(
     m_prev_Configuration = CurrentConfiguration;
     m_prev_Velocity = CurrentVelocity;
   } else if (Stage == 1) {
-    ODEBUG("lql: " << lql << " lqr: " << lqr);
     if (IterationNumber > 0) {
       /* Compute the speed */
       for (unsigned int i = 6; i < m_prev_Configuration1.size() - diffVelSize;
@@ -928,7 +1021,6 @@ bool ComAndFootRealizationByGeometry::ComputePostureForGivenCoMAndFeetPosture(
     m_prev_Configuration1 = CurrentConfiguration;
     m_prev_Velocity1 = CurrentVelocity;
   } else if (Stage == 2) {
-    ODEBUG("lql: " << lql << " lqr: " << lqr);
     if (IterationNumber > 0) {
       /* Compute the speed */
       for (unsigned int i = 6; i < m_prev_Configuration2.size() - diffVelSize;
@@ -952,69 +1044,13 @@ bool ComAndFootRealizationByGeometry::ComputePostureForGivenCoMAndFeetPosture(
     m_prev_Velocity2 = CurrentVelocity;
   }
 
-  Eigen::Vector3d waistCom;
-  for (int i = 0; i < 3; i++)
-    waistCom(i) = aCoMPosition(i) - AbsoluteWaistPosition(i);
-
-  // v_waist = v_com + waist-com x omega :
-  CurrentVelocity[0] =
-      aCoMSpeed(0) + (waistCom(1) * aCoMSpeed(5) - waistCom(2) * aCoMSpeed(4));
-  CurrentVelocity[1] =
-      aCoMSpeed(1) + (waistCom(2) * aCoMSpeed(3) - waistCom(0) * aCoMSpeed(5));
-  CurrentVelocity[2] =
-      aCoMSpeed(2) + (waistCom(0) * aCoMSpeed(4) - waistCom(1) * aCoMSpeed(3));
-
-  // omega_waist = omega_com
-  for (int i = 3; i < 6; i++)
-    CurrentVelocity[i] = aCoMSpeed(i);
-
-  // (omega x waist-com) x omega = waist-com ( omega . omega )
-  // - omega ( omega . waist-com )
-  Eigen::Vector3d coriolis;
-  double omega_dot_omega = aCoMSpeed(3) * aCoMSpeed(3) +
-                           aCoMSpeed(4) * aCoMSpeed(4) +
-                           aCoMSpeed(5) * aCoMSpeed(5);
-  double omega_dot_waistCom = aCoMSpeed(3) * waistCom(0) +
-                              aCoMSpeed(4) * waistCom(1) +
-                              aCoMSpeed(5) * waistCom(2);
-
-  coriolis(0) =
-      waistCom(0) * omega_dot_omega - aCoMSpeed(3) * omega_dot_waistCom;
-  coriolis(1) =
-      waistCom(1) * omega_dot_omega - aCoMSpeed(4) * omega_dot_waistCom;
-  coriolis(2) =
-      waistCom(2) * omega_dot_omega - aCoMSpeed(5) * omega_dot_waistCom;
-
-  // a_waist = a_com + waist-com x d omega/dt + (omega x waist-com) x omega
-  CurrentAcceleration[0] =
-      aCoMAcc(0) + (waistCom(1) * aCoMAcc(5) - waistCom(2) * aCoMAcc(4)) +
-      coriolis(0);
-  CurrentAcceleration[1] =
-      aCoMAcc(1) + (waistCom(2) * aCoMAcc(3) - waistCom(0) * aCoMAcc(5)) +
-      coriolis(1);
-  CurrentAcceleration[2] =
-      aCoMAcc(2) + (waistCom(0) * aCoMAcc(4) - waistCom(1) * aCoMAcc(3)) +
-      coriolis(2);
-
-  // d omega_waist /dt = d omega_com /dt
-  // cout << "CFRG : " ;
-  for (int i = 3; i < 6; i++) {
-    // cout << aCoMAcc(i) << " "  ;
-    CurrentAcceleration[i] = aCoMAcc(i);
-  } // cout << endl ;
+  ComputeWaistVelocityAndAcceleration(aCoMPosition, aCoMSpeed, aCoMAcc,
+                                      AbsoluteWaistPosition, CurrentVelocity,
+                                      CurrentAcceleration);
 
   ODEBUG("CurrentVelocity :" << endl << CurrentVelocity);
   ODEBUG4("SamplingPeriod " << getSamplingPeriod(), "LegsSpeed.dat");
 
-  string aDebugFileName;
-
-  ODEBUG4((1.0 / M_PI) * 180.0 * lql[0] << " " << (1.0 / M_PI) * 180.0 * lql[1]
-                                        << " " << (1.0 / M_PI) * 180.0 * lql[2]
-                                        << " " << (1.0 / M_PI) * 180.0 * lql[3]
-                                        << " " << (1.0 / M_PI) * 180.0 * lql[4]
-                                        << " " << (1.0 / M_PI) * 180.0 * lql[5],
-          (char *)aDebugFileName.c_str());
-
   ODEBUG4(CurrentVelocity, "DebugDataVelocity.dat");
 
   ODEBUG4(aCoMPosition[0] << " " << aCoMPosition[1], "COMPC1.dat");
@@ -1022,6 +1058,107 @@ bool ComAndFootRealizationByGeometry::ComputePostureForGivenCoMAndFeetPosture(
   return true;
 }
 
+bool ComAndFootRealizationByGeometry::ComputePostureForGivenCoMAndFeetPosture(
+    Eigen::VectorXd &aCoMPosition, Eigen::VectorXd &aCoMSpeed,
+    Eigen::VectorXd &aCoMAcc, Eigen::VectorXd &aLeftFoot,
+    Eigen::VectorXd &aLeftFootSpeed, Eigen::VectorXd &aLeftFootAcc,
+    Eigen::VectorXd &aRightFoot, Eigen::VectorXd &aRightFootSpeed,
+    Eigen::VectorXd &aRightFootAcc, Eigen::VectorXd &CurrentConfiguration,
+    Eigen::VectorXd &CurrentVelocity, Eigen::VectorXd &CurrentAcceleration,
+    int Stage) {
+  Eigen::Vector3d AbsoluteWaistPosition;
+  ComputeConfigurationForPosture(aCoMPosition, aLeftFoot, aRightFoot,
+                                 CurrentConfiguration, AbsoluteWaistPosition,
+                                 Stage);
+
+  CurrentVelocity.setZero();
+  CurrentAcceleration.setZero();
+  if (!ComputeLegJointRates(aCoMPosition, aCoMSpeed, aCoMAcc, aLeftFoot,
+                            aLeftFootSpeed, aLeftFootAcc, 1,
+                            CurrentConfiguration, CurrentVelocity,
+                            CurrentAcceleration))
+    ODEBUG("Singular left leg, its joint rates are set to zero");
+  if (!ComputeLegJointRates(aCoMPosition, aCoMSpeed, aCoMAcc, aRightFoot,
+                            aRightFootSpeed, aRightFootAcc, -1,
+                            CurrentConfiguration, CurrentVelocity,
+                            CurrentAcceleration))
+    ODEBUG("Singular right leg, its joint rates are set to zero");
+
+  ComputeWaistVelocityAndAcceleration(aCoMPosition, aCoMSpeed, aCoMAcc,
+                                      AbsoluteWaistPosition, CurrentVelocity,
+                                      CurrentAcceleration);
+  return true;
+}
+
+/*! Angular velocity and acceleration of Rz(yaw) Ry(pitch), the
+  orientation of the body and of the feet, from the derivatives of the
+  angles in degrees. */
+static void YawPitchRates(double yaw, double dyaw, double ddyaw,
+                          double dpitch, double ddpitch,
+                          Eigen::Vector3d &omega, Eigen::Vector3d &domega) {
+  const double d2r = M_PI / 180.0;
+  double c = cos(yaw * d2r), s = sin(yaw * d2r);
+  dyaw *= d2r;
+  ddyaw *= d2r;
+  dpitch *= d2r;
+  ddpitch *= d2r;
+  // The pitch is about Rz(yaw) y.
+  omega << -s * dpitch, c * dpitch, dyaw;
+  domega << -s * ddpitch - c * dyaw * dpitch, c * ddpitch - s * dyaw * dpitch,
+      ddyaw;
+}
+
+bool ComAndFootRealizationByGeometry::ComputeLegJointRates(
+    const Eigen::VectorXd &aCoMPosition, const Eigen::VectorXd &aCoMSpeed,
+    const Eigen::VectorXd &aCoMAcc, const Eigen::VectorXd &aFoot,
+    const Eigen::VectorXd &aFootSpeed, const Eigen::VectorXd &aFootAcc,
+    int LeftOrRight, const Eigen::VectorXd &CurrentConfiguration,
+    Eigen::VectorXd &CurrentVelocity, Eigen::VectorXd &CurrentAcceleration) {
+  const double d2r = M_PI / 180.0;
+
+  // Body B, which holds the CoM, as in KinematicsForTheLegs.
+  Eigen::Vector3d wB, dwB;
+  YawPitchRates(aCoMPosition(5), aCoMSpeed(5), aCoMAcc(5), aCoMSpeed(4),
+                aCoMAcc(4), wB, dwB);
+  Eigen::Matrix3d Body_R;
+  Body_R = Eigen::AngleAxisd(aCoMPosition(5) * d2r, Eigen::Vector3d::UnitZ()) *
+           Eigen::AngleAxisd(aCoMPosition(4) * d2r, Eigen::Vector3d::UnitY());
+
+  // Foot F, as in KinematicsForOneLeg.
+  Eigen::Vector3d wF, dwF;
+  YawPitchRates(aFoot(3), aFootSpeed(3), aFootAcc(3), aFootSpeed(4),
+                aFootAcc(4), wF, dwF);
+  Eigen::Matrix3d Foot_R;
+  Foot_R = Eigen::AngleAxisd(aFoot(3) * d2r, Eigen::Vector3d::UnitZ()) *
+           Eigen::AngleAxisd(aFoot(4) * d2r, Eigen::Vector3d::UnitY());
+  Eigen::Vector3d r = Eigen::Vector3d::Zero();
+  if (ShiftFoot_)
+    r = Foot_R *
+        ((LeftOrRight == 1) ? m_AnklePositionLeft : m_AnklePositionRight);
+
+  // Ankle relative to the CoM, and its derivatives in the world frame.
+  Eigen::Vector3d d = aFoot.head<3>() + r - aCoMPosition.head<3>();
+  Eigen::Vector3d dd =
+      aFootSpeed.head<3>() + wF.cross(r) - aCoMSpeed.head<3>();
+  Eigen::Vector3d ddd = aFootAcc.head<3>() + dwF.cross(r) +
+                        wF.cross(wF.cross(r)) - aCoMAcc.head<3>();
+
+  // Motion of the ankle relative to B, in the frame of B.
+  Eigen::Matrix<double, 6, 1> V, A;
+  V.head<3>() = Body_R.transpose() * (dd - wB.cross(d));
+  V.tail<3>() = Body_R.transpose() * (wF - wB);
+  A.head<3>() = Body_R.transpose() * (ddd - dwB.cross(d) -
+                                      2.0 * wB.cross(dd) +
+                                      wB.cross(wB.cross(d)));
+  A.tail<3>() = Body_R.transpose() * (dwF - dwB - wB.cross(wF - wB));
+
+  pinocchio::JointIndex Ankle =
+      (LeftOrRight == 1) ? getPinocchioRobot()->leftFoot()->associatedAnkle
+                         : getPinocchioRobot()->rightFoot()->associatedAnkle;
+  return getPinocchioRobot()->ComputeLegJointRates(
+      Ankle, CurrentConfiguration, V, A, CurrentVelocity, CurrentAcceleration);
+}
+
 int ComAndFootRealizationByGeometry::EvaluateStartingCoM(
     Eigen::VectorXd &BodyAngles, Eigen::Vector3d &aStartingCOMPosition,
     FootAbsolutePosition &InitLeftFootPosition,
@@ -1201,6 +1338,27 @@ Eigen::Vector3d ComAndFootRealizationByGeometry::GetCOGInitialAnkles() {
   return m_COGInitialAnkles;
 }
 
+void ComAndFootRealizationByGeometry::CopyParameters(
+    const ComAndFootRealizationByGeometry &aCFR) {
+  SetHeightOfTheCoM(aCFR.GetHeightOfTheCoM());
+  m_DtRight = aCFR.m_DtRight;
+  m_DtLeft = aCFR.m_DtLeft;
+  m_TranslationToTheLeftHip = aCFR.m_TranslationToTheLeftHip;
+  m_TranslationToTheRightHip = aCFR.m_TranslationToTheRightHip;
+  m_StartingCOMPosition = aCFR.m_StartingCOMPosition;
+  m_FinalDesiredCOMPose = aCFR.m_FinalDesiredCOMPose;
+  m_AnklePositionRight = aCFR.m_AnklePositionRight;
+  m_AnklePositionLeft = aCFR.m_AnklePositionLeft;
+  m_DiffBetweenComAndWaist = aCFR.m_DiffBetweenComAndWaist;
+  m_ComAndWaistInRefFrame = aCFR.m_ComAndWaistInRefFrame;
+  m_Xmax = aCFR.m_Xmax;
+  m_ZARM = aCFR.m_ZARM;
+  m_GainFactor = aCFR.m_GainFactor;
+  m_UpperBodyMotion = aCFR.m_UpperBodyMotion;
+  m_COGInitialAnkles = aCFR.m_COGInitialAnkles;
+  ShiftFoot_ = aCFR.ShiftFoot_;
+}
+
 ostream &PatternGeneratorJRL::operator<<(ostream &os,
                                          const ComAndFootRealization &obj) {
 
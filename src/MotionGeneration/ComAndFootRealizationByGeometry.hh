@@ -35,6 +35,7 @@
 #include <MotionGeneration/StepOverPlanner.hh>
 #include <MotionGeneration/UpperBodyMotion.hh>
 #include <MotionGeneration/WaistHeightVariation.hh>
+#include <RingBuffer.hh>
 #include <jrl/walkgen/pgtypes.hh>
 
 namespace PatternGeneratorJRL {
@@ -104,6 +105,26 @@ public:
       Eigen::VectorXd &CurrentVelocity, Eigen::VectorXd &CurrentAcceleration,
       unsigned long int IterationNumber, int Stage);
 
+  /*! Compute the robot state for a given CoM and feet state.
+    The configuration is the same as the one of the method above.
+    The joint velocities and accelerations of the legs are derived from
+    the velocities and accelerations of the CoM and of the feet with the
+    Jacobians of the legs, instead of finite differences with the
+    previous postures: each sample is independent from the previous
+    ones, and no history is kept.
+    @param[in] aLeftFootSpeed, aLeftFootAcc velocity and acceleration
+    of the left foot, following the convention of \a LeftFoot.
+    @param[in] aRightFootSpeed, aRightFootAcc idem for the right foot.
+  */
+  bool ComputePostureForGivenCoMAndFeetPosture(
+      Eigen::VectorXd &CoMPosition, Eigen::VectorXd &aCoMSpeed,
+      Eigen::VectorXd &aCoMAcc, Eigen::VectorXd &LeftFoot,
+      Eigen::VectorXd &aLeftFootSpeed, Eigen::VectorXd &aLeftFootAcc,
+      Eigen::VectorXd &RightFoot, Eigen::VectorXd &aRightFootSpeed,
+      Eigen::VectorXd &aRightFootAcc, Eigen::VectorXd &CurrentConfiguration,
+      Eigen::VectorXd &CurrentVelocity, Eigen::VectorXd &CurrentAcceleration,
+      int Stage);
+
   /*! \name Initialization of the walking.
     @{
   */
@@ -145,7 +166,7 @@ public:
     for the upper body motion are correctly setup.
   */
   bool
-  InitializationUpperBody(deque<ZMPPosition> &inZMPPositions,
+  InitializationUpperBody(RingBuffer<ZMPPosition> &inZMPPositions,
                           deque<COMPosition> &inCOMBuffer,
                           deque<RelativeFootPosition> lRelativeFootPositions);
 
@@ -230,6 +251,23 @@ public:
                             Eigen::VectorXd &ql, Eigen::VectorXd &qr,
                             Eigen::Vector3d &AbsoluteWaistPosition);
 
+  /*! Poses of the hips and of the ankles reached by
+    KinematicsForTheLegs for the same inputs, stored in the rows
+    \a row (left leg) and \a row+1 (right leg) of \a legs, to solve
+    the legs of several postures at once with
+    PinocchioRobot::ComputeLegsInverseKinematics. */
+  void LegsPoses(const Eigen::VectorXd &aCoMPosition,
+                 const Eigen::VectorXd &aLeftFoot,
+                 const Eigen::VectorXd &aRightFoot, PRLegsBatch &legs,
+                 Eigen::Index row);
+
+  /*! Take the joints of the legs of the next postures from the rows
+    \a row (left leg) and \a row+1 (right leg) of \a q, as solved
+    from LegsPoses, instead of solving the inverse kinematics of each
+    leg. q is not copied. Give 0 to solve each leg again. */
+  void UseLegsJoints(const Eigen::Array<double, Eigen::Dynamic, 6> *q,
+                     Eigen::Index row);
+
   /*! \brief Implement the Plugin part to receive information from
     PatternGeneratorInterface.
   */
@@ -348,6 +386,12 @@ public:
   inline bool ShiftFoot() { return ShiftFoot_; }
   inline void ShiftFoot(bool ShiftFoot) { ShiftFoot_ = ShiftFoot; }
 
+  /*! \brief Copy the parameters of the posture computation
+    set by the initialization and the commands of aCFR.
+    The history of the postures used for the finite differences
+    is not copied. Both objects must handle the same robot model. */
+  void CopyParameters(const ComAndFootRealizationByGeometry &aCFR);
+
   /*! \brief Get the COG of the ankles at the starting position. */
   virtual Eigen::Vector3d GetCOGInitialAnkles();
 
@@ -382,7 +426,46 @@ protected:
   /* Register methods. */
   void RegisterMethods();
 
+  /*! Fill the free flyer position, the legs and the arms of
+    CurrentConfiguration for a given CoM and feet posture. */
+  void ComputeConfigurationForPosture(Eigen::VectorXd &aCoMPosition,
+                                      Eigen::VectorXd &aLeftFoot,
+                                      Eigen::VectorXd &aRightFoot,
+                                      Eigen::VectorXd &CurrentConfiguration,
+                                      Eigen::Vector3d &AbsoluteWaistPosition,
+                                      int Stage);
+
+  /*! Velocity and acceleration of the free flyer from the ones
+    of the CoM. */
+  void ComputeWaistVelocityAndAcceleration(
+      Eigen::VectorXd &aCoMPosition, Eigen::VectorXd &aCoMSpeed,
+      Eigen::VectorXd &aCoMAcc, Eigen::Vector3d &AbsoluteWaistPosition,
+      Eigen::VectorXd &CurrentVelocity, Eigen::VectorXd &CurrentAcceleration);
+
+  /*! Velocity and acceleration of the joints of one leg, from the ones
+    of the CoM and of the foot, CurrentConfiguration holding the joints
+    found by the inverse kinematics. The angles are in degrees, as for
+    KinematicsForTheLegs.
+    \return false if the leg is singular, CurrentVelocity and
+    CurrentAcceleration are then not modified. */
+  bool ComputeLegJointRates(
+      const Eigen::VectorXd &aCoMPosition, const Eigen::VectorXd &aCoMSpeed,
+      const Eigen::VectorXd &aCoMAcc, const Eigen::VectorXd &aFoot,
+      const Eigen::VectorXd &aFootSpeed, const Eigen::VectorXd &aFootAcc,
+      int LeftOrRight, const Eigen::VectorXd &CurrentConfiguration,
+      Eigen::VectorXd &CurrentVelocity, Eigen::VectorXd &CurrentAcceleration);
+
 private:
+  /*! Orientation of the body from the yaw and the pitch of the CoM,
+    in degrees. */
+  void BodyOrientation(const Eigen::VectorXd &aCoMPosition,
+                       Eigen::Matrix3d &Body_R);
+
+  /*! Pose of the ankle of the foot (x,y,z,theta,omega), the angles
+    being in degrees, shifted from the sole if ShiftFoot() is set. */
+  void AnklePose(const Eigen::VectorXd &aFoot, int LeftOrRight,
+                 Eigen::Matrix4d &FootPose);
+
   /*! \name Objects for stepping over.
     @{
   */
@@ -514,6 +597,11 @@ private:
   pinocchio::JointIndex m_LeftShoulder, m_RightShoulder;
 
   bool ShiftFoot_;
+
+  /*! Joints of the legs given by UseLegsJoints, 0 if the inverse
+    kinematics is solved for each leg. */
+  const Eigen::Array<double, Eigen::Dynamic, 6> *m_LegsJoints;
+  Eigen::Index m_LegsJointsRow;
 };
 
 ostream &operator<<(ostream &os, const ComAndFootRealization &obj);
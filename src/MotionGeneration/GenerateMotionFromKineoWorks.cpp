@@ -161,8 +161,8 @@ void GenerateMotionFromKineoWorks::DisplayModelAndPath() {
 }
 
 void GenerateMotionFromKineoWorks::CreateBufferFirstPreview(
-    deque<ZMPPosition> &ZMPRefBuffer) {
-  deque<ZMPPosition> aFIFOZMPRefPositions;
+    RingBuffer<ZMPPosition> &ZMPRefBuffer) {
+  RingBuffer<ZMPPosition> aFIFOZMPRefPositions;
   Eigen::MatrixXd aPC1x;
   Eigen::MatrixXd aPC1y;
   double aSxzmp, aSyzmp;
@@ -38,6 +38,7 @@
 #include <vector>
 
 #include <PreviewControl/PreviewControl.hh>
+#include <RingBuffer.hh>
 #include <ZMPRefTrajectoryGeneration/ZMPDiscretization.hh>
 
 namespace PatternGeneratorJRL {
@@ -84,7 +85,7 @@ public:
   void CreateUpperBodyMotion();
 
   /*! Create a trajectory for COM  */
-  void CreateBufferFirstPreview(deque<ZMPPosition> &ZMPRefBuffer);
+  void CreateBufferFirstPreview(RingBuffer<ZMPPosition> &ZMPRefBuffer);
 
   /*! Update the link towards the Preview Control object in
     order to simulate the trajectory. */
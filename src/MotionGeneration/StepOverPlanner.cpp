@@ -649,10 +649,11 @@ void StepOverPlanner::DoubleSupportFeasibility() {
   }
 }
 
-void StepOverPlanner::PolyPlanner(deque<COMState> &aCOMBuffer,
-                                  deque<FootAbsolutePosition> &aLeftFootBuffer,
-                                  deque<FootAbsolutePosition> &aRightFootBuffer,
-                                  deque<ZMPPosition> &aZMPPositions) {
+void StepOverPlanner::PolyPlanner(
+    RingBuffer<COMState> &aCOMBuffer,
+    RingBuffer<FootAbsolutePosition> &aLeftFootBuffer,
+    RingBuffer<FootAbsolutePosition> &aRightFootBuffer,
+    RingBuffer<ZMPPosition> &aZMPPositions) {
   m_RightFootBuffer = aRightFootBuffer;
   m_LeftFootBuffer = aLeftFootBuffer;
   m_COMBuffer = aCOMBuffer;
@@ -768,7 +769,7 @@ void StepOverPlanner::PolyPlanner(deque<COMState> &aCOMBuffer,
 }
 
 void StepOverPlanner::PolyPlannerFirstStep(
-    deque<FootAbsolutePosition> &aStepOverFootBuffer) {
+    RingBuffer<FootAbsolutePosition> &aStepOverFootBuffer) {
 
   Eigen::Matrix<double, 8, 1> aBoundCondZ;
   Eigen::Matrix<double, 8, 1> aBoundCondY;
@@ -1087,7 +1088,7 @@ void StepOverPlanner::PolyPlannerFirstStep(
 }
 
 void StepOverPlanner::PolyPlannerSecondStep(
-    deque<FootAbsolutePosition> &aStepOverFootBuffer) {
+    RingBuffer<FootAbsolutePosition> &aStepOverFootBuffer) {
 
   Eigen::Matrix<double, 8, 1> aBoundCondZ;
   Eigen::Matrix<double, 8, 1> aBoundCondY;
@@ -1485,33 +1486,33 @@ void StepOverPlanner::PolyPlannerHip() {
 }
 
 void StepOverPlanner::SetExtraBuffer(
-    deque<COMState> aExtraCOMBuffer,
-    deque<FootAbsolutePosition> aExtraRightFootBuffer,
-    deque<FootAbsolutePosition> aExtraLeftFootBuffer) {
+    RingBuffer<COMState> aExtraCOMBuffer,
+    RingBuffer<FootAbsolutePosition> aExtraRightFootBuffer,
+    RingBuffer<FootAbsolutePosition> aExtraLeftFootBuffer) {
   m_ExtraCOMBuffer = aExtraCOMBuffer;
   m_ExtraRightFootBuffer = aExtraRightFootBuffer;
   m_ExtraLeftFootBuffer = aExtraLeftFootBuffer;
 }
 
 void StepOverPlanner::GetExtraBuffer(
-    deque<COMState> &aExtraCOMBuffer,
-    deque<FootAbsolutePosition> &aExtraRightFootBuffer,
-    deque<FootAbsolutePosition> &aExtraLeftFootBuffer) {
+    RingBuffer<COMState> &aExtraCOMBuffer,
+    RingBuffer<FootAbsolutePosition> &aExtraRightFootBuffer,
+    RingBuffer<FootAbsolutePosition> &aExtraLeftFootBuffer) {
   aExtraCOMBuffer = m_ExtraCOMBuffer;
   aExtraRightFootBuffer = m_ExtraRightFootBuffer;
   aExtraLeftFootBuffer = m_ExtraLeftFootBuffer;
 }
 
 void StepOverPlanner::SetFootBuffers(
-    deque<FootAbsolutePosition> aLeftFootBuffer,
-    deque<FootAbsolutePosition> aRightFootBuffer) {
+    RingBuffer<FootAbsolutePosition> aLeftFootBuffer,
+    RingBuffer<FootAbsolutePosition> aRightFootBuffer) {
   m_RightFootBuffer = aRightFootBuffer;
   m_LeftFootBuffer = aLeftFootBuffer;
 }
 
 void StepOverPlanner::GetFootBuffers(
-    deque<FootAbsolutePosition> &aRightFootBuffer,
-    deque<FootAbsolutePosition> &aLeftFootBuffer) {
+    RingBuffer<FootAbsolutePosition> &aRightFootBuffer,
+    RingBuffer<FootAbsolutePosition> &aLeftFootBuffer) {
   aRightFootBuffer = m_RightFootBuffer;
   aLeftFootBuffer = m_LeftFootBuffer;
 }
@@ -1604,9 +1605,9 @@ void StepOverPlanner::SetDeltaStepOverCOMHeightMax(
 }
 
 void StepOverPlanner::CreateBufferFirstPreview(
-    deque<COMState> &m_COMBuffer, deque<ZMPPosition> &m_ZMPBuffer,
-    deque<ZMPPosition> &m_ZMPRefBuffer) {
-  deque<ZMPPosition> aFIFOZMPRefPositions;
+    RingBuffer<COMState> &m_COMBuffer, RingBuffer<ZMPPosition> &m_ZMPBuffer,
+    RingBuffer<ZMPPosition> &m_ZMPRefBuffer) {
+  RingBuffer<ZMPPosition> aFIFOZMPRefPositions;
   Eigen::MatrixXd aPC1x;
   Eigen::MatrixXd aPC1y;
   double aSxzmp, aSyzmp;
@@ -46,7 +46,7 @@ WaistHeightVariation::~WaistHeightVariation() {
 
 void WaistHeightVariation::PolyPlanner(deque<COMPosition> &aCOMBuffer,
                                        deque<RelativeFootPosition> &aFootHolds,
-                                       deque<ZMPPosition> aZMPPosition) {
+                                       RingBuffer<ZMPPosition> aZMPPosition) {
 
   unsigned int u_start = 0;
   int stepnumber = 0;
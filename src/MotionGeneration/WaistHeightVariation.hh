@@ -50,6 +50,7 @@
 
 #include <Mathematics/Polynome.hh>
 #include <PreviewControl/PreviewControl.hh>
+#include <RingBuffer.hh>
 #include <ZMPRefTrajectoryGeneration/ZMPDiscretization.hh>
 
 //#include <PolynomeFoot.h>
@@ -86,7 +87,7 @@ public:
   /// call for polynomial planning of both steps during the obstacle stepover
   void PolyPlanner(deque<COMPosition> &aCOMBuffer,
                    deque<RelativeFootPosition> &aFootHolds,
-                   deque<ZMPPosition> aZMPPosition);
+                   RingBuffer<ZMPPosition> aZMPPosition);
 
 protected:
   deque<RelativeFootPosition> m_FootHolds;
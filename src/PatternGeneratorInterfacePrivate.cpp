@@ -42,6 +42,7 @@
 #include <Windows.h>
 #endif /* WIN32 */
 
+#include <AllocationCheck.hh>
 #include <Debug.hh>
 #include <patterngeneratorinterfaceprivate.hh>
 
@@ -61,6 +62,7 @@ PatternGeneratorInterfacePrivate::PatternGeneratorInterfacePrivate(
   m_ObstacleDetected = false;
   m_AutoFirstStep = false;
   m_feedBackControl = false;
+  m_RealTime = false;
 
   // Initialization of obstacle parameters informations.
   m_ObstaclePars.x = 1.0;
@@ -164,6 +166,9 @@ PatternGeneratorInterfacePrivate::PatternGeneratorInterfacePrivate(
     m_ZMPInitialPoint(i) = 0.0;
   m_ZMPInitialPointSet = false;
 
+  m_ParseCmdDepth = 0;
+  m_RecordCommands = true;
+
   RegisterPluginMethods();
 }
 
@@ -174,7 +179,7 @@ void PatternGeneratorInterfacePrivate::AllowFPE() {
 }
 
 void PatternGeneratorInterfacePrivate::RegisterPluginMethods() {
-#define number_of_method 18
+#define number_of_method 19
   std::string aMethodName[number_of_method] = {":LimitsFeasibility",
                                                ":ZMPShiftParameters",
                                                ":TimeDistributionParameters",
@@ -192,7 +197,8 @@ void PatternGeneratorInterfacePrivate::RegisterPluginMethods() {
                                                ":NaveauOnline",
                                                ":setVelReference",
                                                ":setCoMPerturbationForce",
-                                               ":feedBackControl"};
+                                               ":feedBackControl",
+                                               ":realtime"};
 
   for (int i = 0; i < number_of_method; i++) {
     if (!SimplePlugin::RegisterMethod(aMethodName[i])) {
@@ -918,7 +924,7 @@ void PatternGeneratorInterfacePrivate::FinishAndRealizeStepSequence() {
 
   ODEBUG("First m_ZMPPositions" << m_ZMPPositions[0].px << " "
                                 << m_ZMPPositions[0].py);
-  deque<ZMPPosition> aZMPBuffer;
+  RingBuffer<ZMPPosition> aZMPBuffer;
 
   // Option : Use Wieber06's algorithm to compute a new ZMP
   // profil. Suppose to preempt the first stage of control.
@@ -1016,17 +1022,44 @@ void PatternGeneratorInterfacePrivate::m_ReadFileFromKineoWorks(
 }
 
 int PatternGeneratorInterfacePrivate::ParseCmd(istringstream &strm) {
+  if ((m_RecordCommands) && (m_ParseCmdDepth == 0)) {
+    streampos aPos = strm.tellg();
+    if (aPos >= 0)
+      m_ConfigurationCommands.push_back(strm.str().substr(aPos));
+  }
+
   string aCmd;
   strm >> aCmd;
 
   ODEBUG("PARSECMD");
 
+  m_ParseCmdDepth++;
   if (SimplePluginManager::CallMethod(aCmd, strm)) {
     ODEBUG("Method " << aCmd << " found and handled.");
   }
+  m_ParseCmdDepth--;
 
   return 0;
 }
+
+void PatternGeneratorInterfacePrivate::ReplayConfiguration(
+    const PatternGeneratorInterfacePrivate &aPGI) {
+  for (unsigned int i = 0; i < aPGI.m_ConfigurationCommands.size(); i++) {
+    istringstream strm(aPGI.m_ConfigurationCommands[i]);
+    ParseCmd(strm);
+  }
+  m_ZMPInitialPoint = aPGI.m_ZMPInitialPoint;
+  m_ZMPInitialPointSet = aPGI.m_ZMPInitialPointSet;
+}
+void PatternGeneratorInterfacePrivate::getPlugins(
+    const std::string &MethodName, std::vector<SimplePlugin *> &Plugins) const {
+  Plugins.clear();
+  std::multimap<std::string, SimplePlugin *, ltstr>::const_iterator it;
+  for (it = m_SimplePlugins.lower_bound(MethodName);
+       it != m_SimplePlugins.upper_bound(MethodName); ++it)
+    Plugins.push_back(it->second);
+}
+
 void PatternGeneratorInterfacePrivate::ChangeOnLineStep(istringstream &strm,
                                                         double &newtime) {
   if (m_AlgorithmforZMPCOM == ZMPCOM_MORISAWA_2007) {
@@ -1103,6 +1136,14 @@ void PatternGeneratorInterfacePrivate::CallMethod(string &aCmd,
     else if (lFeedBack == "false")
       m_feedBackControl = false;
     ODEBUG("feedBackControl: " << m_feedBackControl);
+  } else if (aCmd == ":realtime") {
+    std::string lRealTime;
+    strm >> lRealTime;
+    if (lRealTime == "true")
+      m_RealTime = true;
+    else if (lRealTime == "false")
+      m_RealTime = false;
+    ODEBUG("realtime: " << m_RealTime);
   } else if (aCmd == ":setCoMPerturbationForce") {
     setCoMPerturbationForce(strm);
   }
@@ -1228,6 +1269,10 @@ bool PatternGeneratorInterfacePrivate::RunOneStepOfTheControlLoop(
     Eigen::VectorXd &CurrentAcceleration, Eigen::VectorXd &ZMPTarget,
     COMState &finalCOMState, FootAbsolutePosition &LeftFootPosition,
     FootAbsolutePosition &RightFootPosition) {
+  m_RecordCommands = false;
+  // Check that the real-time mode does not allocate, where the program
+  // counts the allocations.
+  AllocationCheck aAllocationCheck(m_RealTime);
   m_InternalClock += m_SamplingPeriod;
   if ((!m_ShouldBeRunning) || (m_GlobalStrategyManager->EndOfMotion() < 0)) {
 
@@ -1813,4 +1858,18 @@ patternGeneratorInterfaceFactory(PinocchioRobot *aRobot) {
   return new PatternGeneratorInterfacePrivate(aRobot);
 }
 
+PatternGeneratorInterface *
+patternGeneratorInterfaceFactory(const PatternGeneratorInterface *aPGI,
+                                 PinocchioRobot *aRobot) {
+  const PatternGeneratorInterfacePrivate *aPGIP =
+      dynamic_cast<const PatternGeneratorInterfacePrivate *>(aPGI);
+  if ((aPGIP == 0) || (aRobot == 0))
+    return 0;
+
+  PatternGeneratorInterfacePrivate *aClone =
+      new PatternGeneratorInterfacePrivate(aRobot);
+  aClone->ReplayConfiguration(*aPGIP);
+  return aClone;
+}
+
 } // namespace PatternGeneratorJRL
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file PatternGeneratorPool.cpp
+  \brief Drive several independent pattern generators from a pool of
+  threads.
+*/
+
+#include <jrl/walkgen/patterngeneratorpool.hh>
+
+using namespace PatternGeneratorJRL;
+
+PatternGeneratorPool::PatternGeneratorPool(unsigned int NbThreads)
+    : m_Job(0), m_JobId(0), m_NextPGI(0), m_NbBusyThreads(0), m_Stop(false) {
+  if (NbThreads == 0)
+    NbThreads = std::thread::hardware_concurrency();
+  if (NbThreads == 0)
+    NbThreads = 1;
+
+  // The thread calling run() is the last one.
+  m_Threads.reserve(NbThreads - 1);
+  for (unsigned int i = 0; i + 1 < NbThreads; i++)
+    m_Threads.push_back(std::thread(&PatternGeneratorPool::worker, this));
+}
+
+PatternGeneratorPool::~PatternGeneratorPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stop = true;
+  }
+  m_JobStarted.notify_all();
+  for (unsigned int i = 0; i < m_Threads.size(); i++)
+    m_Threads[i].join();
+}
+
+std::size_t PatternGeneratorPool::add(PatternGeneratorInterface *aPGI) {
+  m_PGIs.push_back(aPGI);
+  return m_PGIs.size() - 1;
+}
+
+void PatternGeneratorPool::run(const job_t &aJob) {
+  if (m_PGIs.empty())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Job = &aJob;
+    m_NextPGI = 0;
+    m_NbBusyThreads = m_Threads.size();
+    m_JobId++;
+  }
+  m_JobStarted.notify_all();
+
+  work();
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_JobDone.wait(lock, [this] { return m_NbBusyThreads == 0; });
+  m_Job = 0;
+}
+
+void PatternGeneratorPool::worker() {
+  unsigned long lastJobId = 0;
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  while (true) {
+    m_JobStarted.wait(lock,
+                      [&] { return m_Stop || (m_JobId != lastJobId); });
+    if (m_Stop)
+      return;
+    lastJobId = m_JobId;
+
+    lock.unlock();
+    work();
+    lock.lock();
+
+    if (--m_NbBusyThreads == 0)
+      m_JobDone.notify_all();
+  }
+}
+
+void PatternGeneratorPool::work() {
+  while (true) {
+    std::size_t i;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      if (m_NextPGI >= m_PGIs.size())
+        return;
+      i = m_NextPGI++;
+    }
+    (*m_Job)(i, *m_PGIs[i]);
+  }
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file CartTableModel.hh
+  \brief Fixed-size matrices of the discretized cart table model.
+*/
+#ifndef _CART_TABLE_MODEL_H_
+#define _CART_TABLE_MODEL_H_
+
+#include <Eigen/Dense>
+
+namespace PatternGeneratorJRL {
+/*! \brief Types of a discrete linear system with N states, a scalar
+  input and a scalar output:
+  \f{eqnarray*}
+  {\bf x}_{k+1} & = & {\bf A} {\bf x}_k + {\bf B} u_k \\
+  p_k & = & {\bf C} {\bf x}_k
+  \f}
+  The sizes are known at compile time, so that the products are
+  unrolled and do not allocate.
+*/
+template <int N> struct DiscreteLinearSystem {
+  typedef Eigen::Matrix<double, N, N> matrix_t;
+  /*! State, and input vector B. */
+  typedef Eigen::Matrix<double, N, 1> state_t;
+  /*! Output vector C, and state feedback gain. */
+  typedef Eigen::Matrix<double, 1, N> row_t;
+
+  /*! \f$ {\bf x} \leftarrow {\bf A} {\bf x} + {\bf B} u \f$ */
+  static inline void integrate(const matrix_t &A, const state_t &B,
+                               Eigen::Ref<state_t> x, double u) {
+    x = A * x + u * B;
+  }
+};
+
+/*! \brief Cart table model: the state along one axis is the position,
+  velocity and acceleration of the CoM, the input is the jerk and the
+  output is the ZMP. */
+typedef DiscreteLinearSystem<3> CartTable;
+
+/*! \brief Fill the matrices of the cart table model for the sampling
+  period T and the height of the CoM Zc. */
+inline void CartTableModel(double T, double Zc, CartTable::matrix_t &A,
+                           CartTable::state_t &B, CartTable::row_t &C) {
+  A << 1.0, T, T * T / 2.0, 0.0, 1.0, T, 0.0, 0.0, 1.0;
+  B << T * T * T / 6.0, T * T / 2.0, T;
+  C << 1.0, 0.0, -Zc / 9.81;
+}
+} // namespace PatternGeneratorJRL
+#endif /* _CART_TABLE_MODEL_H_ */
@@ -28,6 +28,7 @@
 
 //#define _DEBUG_MODE_ON_
 
+#include <cassert>
 #include <fstream>
 #include <iostream>
 
@@ -42,9 +43,9 @@ LinearizedInvertedPendulum2D::LinearizedInvertedPendulum2D() {
   m_ComHeight = -1.0;
   m_SamplingPeriod = -1.0;
   m_InterpolationInterval = -1;
-  m_A.resize(3, 3);
-  m_B.resize(3, 1);
-  m_C.resize(1, 3);
+  m_A.setZero();
+  m_B.setZero();
+  m_C.setZero();
 
   m_xk.resize(6);
   m_CoM.x.resize(3);
@@ -74,6 +75,7 @@ void LinearizedInvertedPendulum2D::SetSimulationControlPeriod(
   if (m_SamplingPeriod != 0.0) {
     double dinterval = m_T / m_SamplingPeriod;
     m_InterpolationInterval = (int)dinterval;
+    UpdateInterpolationBlock();
   }
 }
 
@@ -88,6 +90,7 @@ void LinearizedInvertedPendulum2D::SetRobotControlPeriod(const double &aT) {
 
     double dinterval = m_T / m_SamplingPeriod;
     m_InterpolationInterval = (int)dinterval;
+    UpdateInterpolationBlock();
   }
 }
 
@@ -137,38 +140,51 @@ int LinearizedInvertedPendulum2D::InitializeSystem() {
   if (m_ComHeight == -1.0)
     return -2;
 
-  for (int i = 0; i < 3; i++) {
-    m_B(i, 0) = 0.0;
-    m_C(0, i) = 0.0;
-    for (int j = 0; j < 3; j++)
-      m_A(i, j) = 0.0;
-  }
-
-  m_A(0, 0) = 1.0;
-  m_A(0, 1) = m_T;
-  m_A(0, 2) = m_T * m_T / 2.0;
-  m_A(1, 0) = 0.0;
-  m_A(1, 1) = 1.0;
-  m_A(1, 2) = m_T;
-  m_A(2, 0) = 0.0;
-  m_A(2, 1) = 0.0;
-  m_A(2, 2) = 1.0;
+  CartTableModel(m_T, m_ComHeight, m_A, m_B, m_C);
 
-  m_B(0, 0) = m_T * m_T * m_T / 6.0;
-  m_B(1, 0) = m_T * m_T / 2.0;
-  m_B(2, 0) = m_T;
+  return 0;
+}
 
-  m_C(0, 0) = 1.0;
-  m_C(0, 1) = 0.0;
-  m_C(0, 2) = -m_ComHeight / 9.81;
+/* Integrate the jerk command from the state of one axis, for the first
+   n samples of the time powers. */
+static void IntegrateJerk(const COMStateBlock::axis_t &lTimePowers,
+                          Eigen::Index n, const Eigen::VectorXd &lState,
+                          double lJerk, COMStateBlock::axis_t &lAxis) {
+  lAxis.col(0).head(n).array() =
+      lState(0) +                                       // Position
+      lTimePowers.col(0).head(n).array() * lState(1) +  // Speed
+      lTimePowers.col(1).head(n).array() * lState(2) +  // Acceleration
+      lTimePowers.col(2).head(n).array() * lJerk / 6.0; // Jerk
+
+  lAxis.col(1).head(n).array() =
+      lState(1) +                                      // Speed
+      lTimePowers.col(0).head(n).array() * lState(2) + // Acceleration
+      lTimePowers.col(1).head(n).array() * lJerk;      // Jerk
+
+  lAxis.col(2).head(n).array() =
+      lState(2) +                                 // Acceleration
+      lTimePowers.col(0).head(n).array() * lJerk; // Jerk
+}
 
-  return 0;
+void LinearizedInvertedPendulum2D::UpdateInterpolationBlock() {
+  if (m_InterpolationInterval <= 0) {
+    m_TimePowers.resize(0, 3);
+    m_Interpolation.resize(0);
+    return;
+  }
+  m_TimePowers.resize(m_InterpolationInterval, 3);
+  for (int lk = 0; lk < m_InterpolationInterval; lk++) {
+    double lkSP = (lk + 1) * m_SamplingPeriod;
+    m_TimePowers(lk, 0) = lkSP;
+    m_TimePowers(lk, 1) = 0.5 * lkSP * lkSP;
+    m_TimePowers(lk, 2) = lkSP * lkSP * lkSP;
+  }
+  m_Interpolation.resize((std::size_t)m_InterpolationInterval);
 }
 
 int LinearizedInvertedPendulum2D::Interpolation(
-    deque<COMState> &COMStates, deque<ZMPPosition> &ZMPRefPositions,
+    RingBuffer<COMState> &COMStates, RingBuffer<ZMPPosition> &ZMPRefPositions,
     int CurrentPosition, double CX, double CY) {
-  int lCurrentPosition = CurrentPosition;
   // Fill the queues with the interpolated CoM values.
   // TODO: with TestHerdt, it is mandatory to use COMStates.size()-1, or it will
   // crash.
@@ -179,35 +195,21 @@ int LinearizedInvertedPendulum2D::Interpolation(
   // PG ?
   int loopEnd = std::min<int>(m_InterpolationInterval - 1,
                               ((int)COMStates.size()) - 1 - CurrentPosition);
+  if (loopEnd < 0)
+    return 0;
+
+  // The CoM along x and y is computed for the whole interval at once,
+  // sample per row.
+  Eigen::Index n = loopEnd + 1;
+  IntegrateJerk(m_TimePowers, n, m_CoM.x, CX, m_Interpolation.x);
+  IntegrateJerk(m_TimePowers, n, m_CoM.y, CY, m_Interpolation.y);
+  m_Interpolation.store(COMStates, (std::size_t)CurrentPosition,
+                        (std::size_t)n, COM_XY);
+
+  int lCurrentPosition = CurrentPosition;
   for (int lk = 0; lk <= loopEnd; lk++, lCurrentPosition++) {
     ODEBUG("lCurrentPosition: " << lCurrentPosition);
     COMState &aCOMPos = COMStates[lCurrentPosition];
-    double lkSP;
-    lkSP = (lk + 1) * m_SamplingPeriod;
-
-    aCOMPos.x[0] = m_CoM.x[0] +                     // Position
-                   lkSP * m_CoM.x[1] +              // Speed
-                   0.5 * lkSP * lkSP * m_CoM.x[2] + // Acceleration
-                   lkSP * lkSP * lkSP * CX / 6.0;   // Jerk
-
-    aCOMPos.x[1] = m_CoM.x[1] +            // Speed
-                   lkSP * m_CoM.x[2] +     // Acceleration
-                   0.5 * lkSP * lkSP * CX; // Jerk
-
-    aCOMPos.x[2] = m_CoM.x[2] + // Acceleration
-                   lkSP * CX;   // Jerk
-
-    aCOMPos.y[0] = m_CoM.y[0] +                     // Position
-                   lkSP * m_CoM.y[1] +              // Speed
-                   0.5 * lkSP * lkSP * m_CoM.y[2] + // Acceleration
-                   lkSP * lkSP * lkSP * CY / 6.0;   // Jerk
-
-    aCOMPos.y[1] = m_CoM.y[1] +            // Speed
-                   lkSP * m_CoM.y[2] +     // Acceleration
-                   0.5 * lkSP * lkSP * CY; // Jerk
-
-    aCOMPos.y[2] = m_CoM.y[2] + // Acceleration
-                   lkSP * CY;   // Jerk
 
     aCOMPos.yaw[0] = ZMPRefPositions[lCurrentPosition].theta;
 
@@ -216,11 +218,9 @@ int LinearizedInvertedPendulum2D::Interpolation(
     aCOMPos.z[2] = 0;
     // Compute ZMP position and orientation.
     ZMPPosition &aZMPPos = ZMPRefPositions[lCurrentPosition];
-    aZMPPos.px = m_C(0, 0) * aCOMPos.x[0] + m_C(0, 1) * aCOMPos.x[1] +
-                 m_C(0, 2) * aCOMPos.x[2];
+    aZMPPos.px = m_C.dot(Eigen::Map<const CartTable::state_t>(aCOMPos.x));
 
-    aZMPPos.py = m_C(0, 0) * aCOMPos.y[0] + m_C(0, 1) * aCOMPos.y[1] +
-                 m_C(0, 2) * aCOMPos.y[2];
+    aZMPPos.py = m_C.dot(Eigen::Map<const CartTable::state_t>(aCOMPos.y));
 
     aZMPPos.pz = 0.0;
 
@@ -229,37 +229,28 @@ int LinearizedInvertedPendulum2D::Interpolation(
                          << aCOMPos.y[2] << " " << aCOMPos.yaw << " "
                          << aZMPPos.px << " " << aZMPPos.py << " "
                          << aZMPPos.theta << " " << CX << " " << CY << " "
-                         << lkSP << " " << m_T,
+                         << m_TimePowers(lk, 0) << " " << m_T,
             "DebugInterpol.dat");
   }
   return 0;
 }
 
 com_t LinearizedInvertedPendulum2D::OneIteration(double ux, double uy) {
-  Eigen::VectorXd Bux(3);
-  Eigen::VectorXd Buy(3);
-
-  Bux[0] = ux * m_B(0, 0);
-  Bux[1] = ux * m_B(1, 0);
-  Bux[2] = ux * m_B(2, 0);
+  assert((m_CoM.x.size() == 3) && (m_CoM.y.size() == 3));
 
-  Buy[0] = uy * m_B(0, 0);
-  Buy[1] = uy * m_B(1, 0);
-  Buy[2] = uy * m_B(2, 0);
+  Eigen::Map<CartTable::state_t> lx(m_CoM.x.data()), ly(m_CoM.y.data());
 
   // Simulate the dynamical system
-  m_CoM.x = m_A * m_CoM.x;
-  m_CoM.x = m_CoM.x + Bux;
-  m_CoM.y = m_A * m_CoM.y;
-  m_CoM.y = m_CoM.y + Buy;
+  CartTable::integrate(m_A, m_B, lx, ux);
+  CartTable::integrate(m_A, m_B, ly, uy);
 
   // Modif. from Dimitar: Initially a mistake regarding the ordering.
   ODEBUG4(m_xk[0] << " " << m_xk[1] << " " << m_xk[2] << " " << m_xk[3] << " "
                   << m_xk[4] << " " << m_xk[5] << " " << m_CoM.x << " "
                   << m_CoM.y << " " << m_zk[0] << " " << m_zk[1] << " "
-                  << Bux[0] << " " << Bux[1] << " " << Bux[2] << " " << Buy[0]
-                  << " " << Buy[1] << " " << Buy[2] << " " << m_B(0, 0) << " "
-                  << m_B(1, 0) << " " << m_B(2, 0) << " ",
+                  << ux * m_B.transpose() << " " << uy * m_B.transpose()
+                  << " " << m_B(0, 0) << " " << m_B(1, 0) << " " << m_B(2, 0)
+                  << " ",
           "Debug2DLIPM.dat");
 
   return m_CoM;
@@ -34,6 +34,9 @@
 
 /*! Framework includes */
 
+#include <PreviewControl/CartTableModel.hh>
+#include <RingBuffer.hh>
+#include <TrajectoryBlock.hh>
 #include <jrl/walkgen/pgtypes.hh>
 #include <privatepgtypes.hh>
 
@@ -65,8 +68,8 @@ public:
     \param[in]: CX: command parameter in the forward direction.
     \param[in]: CY: command parameter in the perpendicular direction.
   */
-  int Interpolation(std::deque<COMState> &COMStates,
-                    std::deque<ZMPPosition> &ZMPRefPositions,
+  int Interpolation(RingBuffer<COMState> &COMStates,
+                    RingBuffer<ZMPPosition> &ZMPRefPositions,
                     int CurrentPosition, double CX, double CY);
 
   /*! \brief Simulate one iteration of the LIPM
@@ -92,16 +95,27 @@ private:
   /*! \brief Interval for robot control */
   double m_SamplingPeriod;
 
+  /*! \brief Powers of the time since the beginning of the interval
+    for each interpolated sample: \f$ t, t^2/2, t^3 \f$. */
+  COMStateBlock::axis_t m_TimePowers;
+
+  /*! \brief CoM interpolated over one interval. */
+  COMStateBlock m_Interpolation;
+
+  /*! \brief Allocate the interpolation buffers and compute the powers
+    of the time, when the interval changes. */
+  void UpdateInterpolationBlock();
+
   /*! @}*/
   /* !  Matrices for the dynamical system.
      @{
   */
   /* ! Matrix regarding the state of the CoM (pos, velocity, acceleration) */
-  Eigen::MatrixXd m_A;
+  CartTable::matrix_t m_A;
   /* ! Vector for the command */
-  Eigen::MatrixXd m_B;
+  CartTable::state_t m_B;
   /* ! Vector for the ZMP. */
-  Eigen::MatrixXd m_C;
+  CartTable::row_t m_C;
 
   /*! \brief State of the LIPM at the \f$k\f$ eme iteration
     \f$ x_k = [ c_x \dot{c}_x \ddot{c}_x c_y \dot{c}_y \ddot{c}_y\f$ */
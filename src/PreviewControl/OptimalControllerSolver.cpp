@@ -174,7 +174,7 @@ bool OptimalControllerSolver::GeneralizedSchur(MatrixRXd &A, MatrixRXd &B,
   }
 }
 
-void OptimalControllerSolver::ComputeWeights(unsigned int Mode) {
+bool OptimalControllerSolver::SolveRiccatiBySchur(MatrixRXd &P) {
   // Compute the symplectic matrix related
   // to the discrete dynamical system given in parameters.
 
@@ -239,7 +239,8 @@ void OptimalControllerSolver::ComputeWeights(unsigned int Mode) {
   // The eigenvalues ( a matrix to handle complex eigenvalues).
   Eigen::VectorXd GS(2 * n);
 
-  if (!GeneralizedSchur(H, E, WR, WI, GS, ZH, ZE)) {
+  bool lSchur = GeneralizedSchur(H, E, WR, WI, GS, ZH, ZE);
+  if (!lSchur) {
     std::cerr << "Something is wrong with the weights "
               << "for the preview control !" << std::endl;
   }
@@ -250,7 +251,6 @@ void OptimalControllerSolver::ComputeWeights(unsigned int Mode) {
   ODEBUG("ZE:" << ZE);
 
   // Computes P the solution of the Riccati equation.
-  MatrixRXd P;
   MatrixRXd Z11(n, n);
   MatrixRXd Z21(n, n);
 
@@ -266,8 +266,57 @@ void OptimalControllerSolver::ComputeWeights(unsigned int Mode) {
   iZ11 = Z11.inverse();
   P = Z21 * iZ11;
 
+  return lSchur;
+}
+
+bool OptimalControllerSolver::SolveRiccatiByDoubling(MatrixRXd &P) {
+  // Structure-preserving doubling: with G = b R^-1 b^T and
+  // H = c^T Q c, each iteration doubles the horizon of the
+  // Riccati recursion
+  //   W = I + G_k H_k
+  //   A_k+1 = A_k W^-1 A_k
+  //   G_k+1 = G_k + A_k W^-1 G_k A_k^T
+  //   H_k+1 = H_k + A_k^T H_k W^-1 A_k
+  // and H_k converges quadratically towards P.
+  Eigen::Index n = m_A.rows();
+  Eigen::MatrixXd Ak = m_A;
+  Eigen::MatrixXd G = m_b * (1 / m_R) * m_b.transpose();
+  Eigen::MatrixXd H = m_c.transpose() * m_Q * m_c;
+  Eigen::MatrixXd I = Eigen::MatrixXd::Identity(n, n);
+
+  for (int k = 0; k < 64; k++) {
+    Eigen::PartialPivLU<Eigen::MatrixXd> W(I + G * H);
+    Eigen::MatrixXd WA = W.solve(Ak);
+    Eigen::MatrixXd WG = W.solve(G);
+    Eigen::MatrixXd Hn = H + Ak.transpose() * H * WA;
+    G += Ak * WG * Ak.transpose();
+    Ak = Ak * WA;
+    double lVariation = (Hn - H).norm();
+    H = Hn;
+    if (!H.allFinite())
+      break;
+    if (lVariation <= 1e-14 * H.norm()) {
+      // Symmetrize to remove the rounding errors.
+      P = 0.5 * (H + H.transpose());
+      return true;
+    }
+  }
+  ODEBUG("The doubling algorithm did not converge.");
+  return false;
+}
+
+void OptimalControllerSolver::ComputeWeights(unsigned int Mode,
+                                             unsigned int Solver) {
+  // Computes P the solution of the Riccati equation.
+  MatrixRXd P;
+  if ((Solver != SOLVER_DOUBLING) || !SolveRiccatiByDoubling(P))
+    SolveRiccatiBySchur(P);
+
   ODEBUG("P: " << endl << P);
 
+  MatrixRXd tm_b;
+  tm_b = m_b.transpose();
+
   // Compute the weights.
   MatrixRXd r;
 
@@ -146,6 +146,11 @@ public:
   static const unsigned int MODE_WITHOUT_INITIALPOS = 1;
   static const unsigned int MODE_WITH_INITIALPOS = 0;
 
+  /*! Generalized Schur form of the symplectic pencil \ref Laub1979. */
+  static const unsigned int SOLVER_SCHUR = 0;
+  /*! Structure-preserving doubling, see SolveRiccatiByDoubling(). */
+  static const unsigned int SOLVER_DOUBLING = 1;
+
   /*! A constructor */
   OptimalControllerSolver(Eigen::MatrixXd &A, Eigen::MatrixXd &b,
                           Eigen::MatrixXd &c, double Q, double R,
@@ -157,8 +162,10 @@ public:
   /*! Compute the weights
     Following the mode, there is a the inclusion
     of the P matrix inside the weights.
+    The Riccati equation is solved with Solver, SOLVER_DOUBLING
+    falls back to SOLVER_SCHUR if it does not converge.
   */
-  void ComputeWeights(unsigned int Mode);
+  void ComputeWeights(unsigned int Mode, unsigned int Solver = SOLVER_SCHUR);
 
   /*! Display the weights */
   void DisplayWeights();
@@ -201,6 +208,17 @@ protected:
   bool GeneralizedSchur(MatrixRXd &A, MatrixRXd &B, Eigen::VectorXd &alphar,
                         Eigen::VectorXd &alphai, Eigen::VectorXd &beta,
                         MatrixRXd &L, MatrixRXd &R);
+
+  /*! Solve the Riccati equation with the Schur vectors of the
+    symplectic pencil, through LAPACK. */
+  bool SolveRiccatiBySchur(MatrixRXd &P);
+
+  /*! Solve the Riccati equation with the structure-preserving
+    doubling algorithm. The systems of the preview control are small
+    (3 or 4 states, one input), each iteration is a few small matrix
+    products and it converges quadratically, in about ten iterations.
+    @return false if it does not converge. */
+  bool SolveRiccatiByDoubling(MatrixRXd &P);
 };
 
 /*!
@@ -27,6 +27,7 @@
 /** Object to perform preview control on a cart model.
  */
 
+#include <cassert>
 #include <fstream>
 //#define _DEBUG_MODE_ON_
 #include <Debug.hh>
@@ -34,6 +35,7 @@
 #include <iomanip> // !!!!!! manip pour debug a jareter !!!!!!!!!
 
 #include <PreviewControl/PreviewControl.hh>
+#include <PreviewControl/PreviewGainCache.hh>
 
 using namespace ::PatternGeneratorJRL;
 
@@ -50,18 +52,22 @@ PreviewControl::PreviewControl(SimplePluginManager *lSPM,
   m_Zc = 0.0;
   m_SizeOfPreviewWindow = 0;
 
-  m_A.resize(3, 3);
-  m_B.resize(3, 1);
-  m_C.resize(1, 3);
+  m_A.setZero();
+  m_B.setZero();
+  m_C.setZero();
 
-  m_Kx.resize(1, 3);
+  m_Kx.setZero();
   m_Ks = 0;
 
+  m_ScheduleZcMin = 0.0;
+  m_ScheduleZcStep = 0.0;
+
   ODEBUG("Identification: " << this);
-  std::string aMethodName[3] = {":samplingperiod", ":previewcontroltime",
-                                ":comheight"};
+  std::string aMethodName[5] = {":samplingperiod", ":previewcontroltime",
+                                ":comheight", ":previewgaincache",
+                                ":previewgainschedule"};
 
-  for (int i = 0; i < 3; i++) {
+  for (int i = 0; i < 5; i++) {
     if (!RegisterMethod(aMethodName[i])) {
       std::cerr << "Unable to register " << aMethodName << std::endl;
     } else {
@@ -81,8 +87,10 @@ double PreviewControl::PreviewControlTime() const {
 double PreviewControl::GetHeightOfCoM() const { return m_Zc; }
 
 void PreviewControl::SetSamplingPeriod(double lSamplingPeriod) {
-  if (m_SamplingPeriod != lSamplingPeriod)
+  if (m_SamplingPeriod != lSamplingPeriod) {
     m_Coherent = false;
+    m_ScheduleGains.clear();
+  }
 
   m_SamplingPeriod = lSamplingPeriod;
 
@@ -91,8 +99,10 @@ void PreviewControl::SetSamplingPeriod(double lSamplingPeriod) {
 }
 
 void PreviewControl::SetPreviewControlTime(double lPreviewControlTime) {
-  if (m_PreviewControlTime != lPreviewControlTime)
+  if (m_PreviewControlTime != lPreviewControlTime) {
     m_Coherent = false;
+    m_ScheduleGains.clear();
+  }
 
   m_PreviewControlTime = lPreviewControlTime;
 
@@ -108,12 +118,81 @@ void PreviewControl::SetHeightOfCoM(double lHeightOfCom) {
 
   m_Zc = lHeightOfCom;
 
+  if (InterpolateGains(m_Zc))
+    return;
+
   if (m_AutoComputeWeights)
     ComputeOptimalWeights(m_DefaultWeightComputationMode);
 }
 
+void PreviewControl::ComputeGainSchedule(double ZcMin, double ZcMax,
+                                         unsigned int NbOfHeights,
+                                         unsigned int mode) {
+  m_ScheduleGains.clear();
+  if ((NbOfHeights < 2) || (ZcMax <= ZcMin) || (m_SamplingPeriod == 0.0) ||
+      (m_PreviewControlTime == 0.0))
+    return;
+
+  double lZc = m_Zc;
+  m_ScheduleZcMin = ZcMin;
+  m_ScheduleZcStep = (ZcMax - ZcMin) / (NbOfHeights - 1);
+  std::vector<PreviewGains> lScheduleGains(NbOfHeights);
+  for (unsigned int k = 0; k < NbOfHeights; k++) {
+    // The heights of the schedule are not kept in the shared table.
+    m_Zc = ZcMin + k * m_ScheduleZcStep;
+    SolveOptimalWeights(mode, OptimalControllerSolver::SOLVER_DOUBLING,
+                        false);
+    lScheduleGains[k].Ks = m_Ks;
+    for (int i = 0; i < 3; i++)
+      lScheduleGains[k].Kx(i) = m_Kx(0, i);
+    lScheduleGains[k].F = m_F;
+  }
+  m_ScheduleGains.swap(lScheduleGains);
+
+  // Restore the gains of the current height.
+  m_Zc = lZc;
+  if (!InterpolateGains(m_Zc))
+    ComputeOptimalWeights(mode);
+}
+
+bool PreviewControl::InterpolateGains(double lZc) {
+  if (m_ScheduleGains.size() < 2)
+    return false;
+  double lIndex = (lZc - m_ScheduleZcMin) / m_ScheduleZcStep;
+  std::size_t lLast = m_ScheduleGains.size() - 1;
+  // Tolerate the rounding errors on the bounds.
+  if ((lIndex < -1e-9) || (lIndex > lLast + 1e-9))
+    return false;
+
+  std::size_t i = (lIndex <= 0.0) ? 0 : (std::size_t)lIndex;
+  if (i >= lLast)
+    i = lLast - 1;
+  double a = lIndex - (double)i;
+  if (a < 0.0)
+    a = 0.0;
+  else if (a > 1.0)
+    a = 1.0;
+  const PreviewGains &G0 = m_ScheduleGains[i];
+  const PreviewGains &G1 = m_ScheduleGains[i + 1];
+
+  m_Ks = (1 - a) * G0.Ks + a * G1.Ks;
+  for (int j = 0; j < 3; j++)
+    m_Kx(0, j) = (1 - a) * G0.Kx(j) + a * G1.Kx(j);
+  m_F = (1 - a) * G0.F + a * G1.F;
+  CartTableModel(m_SamplingPeriod, lZc, m_A, m_B, m_C);
+  m_Coherent = true;
+  return true;
+}
+
 bool PreviewControl::IsCoherent() { return m_Coherent; }
 
+void PreviewControl::GetGains(PreviewGains &aGains) const {
+  aGains.Ks = m_Ks;
+  for (int i = 0; i < 3; i++)
+    aGains.Kx(i) = m_Kx(0, i);
+  aGains.F = m_F;
+}
+
 void PreviewControl::ReadPrecomputedFile(string aFileName) {
   std::ifstream aif;
 
@@ -141,24 +220,7 @@ void PreviewControl::ReadPrecomputedFile(string aFileName) {
       m_F(i, 0) = r;
     }
     //      cout << (*m_F) << endl;
-    double T = m_SamplingPeriod;
-    m_A(0, 0) = 1.0;
-    m_A(0, 1) = T;
-    m_A(0, 2) = T * T / 2.0;
-    m_A(1, 0) = 0.0;
-    m_A(1, 1) = 1.0;
-    m_A(1, 2) = T;
-    m_A(2, 0) = 0.0;
-    m_A(2, 1) = 0.0;
-    m_A(2, 2) = 1.0;
-
-    m_B(0, 0) = T * T * T / 6.0;
-    m_B(1, 0) = T * T / 2.0;
-    m_B(2, 0) = T;
-
-    m_C(0, 0) = 1.0;
-    m_C(0, 1) = 0.0;
-    m_C(0, 2) = -m_Zc / 9.81;
+    CartTableModel(m_SamplingPeriod, m_Zc, m_A, m_B, m_C);
 
     m_Coherent = true;
 
@@ -167,28 +229,19 @@ void PreviewControl::ReadPrecomputedFile(string aFileName) {
     cerr << "PreviewControl - Unable to open " << aFileName << endl;
 }
 
-void PreviewControl::ComputeOptimalWeights(unsigned int mode) {
+void PreviewControl::ComputeOptimalWeights(unsigned int mode,
+                                           unsigned int solver) {
+  SolveOptimalWeights(mode, solver, true);
+}
+
+void PreviewControl::SolveOptimalWeights(unsigned int mode,
+                                         unsigned int solver,
+                                         bool lUseCache) {
   /*! \brief Solver to compute optimal weights */
   OptimalControllerSolver *anOCS;
 
   double T = m_SamplingPeriod;
-  m_A(0, 0) = 1.0;
-  m_A(0, 1) = T;
-  m_A(0, 2) = T * T / 2.0;
-  m_A(1, 0) = 0.0;
-  m_A(1, 1) = 1.0;
-  m_A(1, 2) = T;
-  m_A(2, 0) = 0.0;
-  m_A(2, 1) = 0.0;
-  m_A(2, 2) = 1.0;
-
-  m_B(0, 0) = T * T * T / 6.0;
-  m_B(1, 0) = T * T / 2.0;
-  m_B(2, 0) = T;
-
-  m_C(0, 0) = 1.0;
-  m_C(0, 1) = 0.0;
-  m_C(0, 2) = -m_Zc / 9.81;
+  CartTableModel(T, m_Zc, m_A, m_B, m_C);
   ODEBUG(" m_Zc: " << m_Zc << " m_C(0,2)" << m_C(0, 2));
 
   Eigen::MatrixXd lF, lK;
@@ -204,19 +257,35 @@ void PreviewControl::ComputeOptimalWeights(unsigned int mode) {
   Nl = (int)(m_PreviewControlTime / T);
 
   if (mode == OptimalControllerSolver::MODE_WITHOUT_INITIALPOS) {
-    ODEBUG("COMPUTATION WITHOUT INITIALPOS !");
     Q = 1;
     R = 1e-6;
+  } else if (mode == OptimalControllerSolver::MODE_WITH_INITIALPOS) {
+    Q = 1.0;
+    R = 1e-5;
+  }
+
+  // The gains only depend on these parameters, look for them
+  // before solving the Riccati equation.
+  PreviewGainKey aKey = {m_Zc, T, m_PreviewControlTime, Q, R, mode, solver};
+  PreviewGains aGains;
+  bool lComputed = false;
+
+  if (lUseCache && PreviewGainCache::shared().find(aKey, aGains)) {
+    ODEBUG("GAINS FOUND IN THE CACHE !");
+    m_Ks = aGains.Ks;
+    for (int i = 0; i < 3; i++)
+      m_Kx(0, i) = aGains.Kx(i);
+    m_F = aGains.F;
+  } else if (mode == OptimalControllerSolver::MODE_WITHOUT_INITIALPOS) {
+    ODEBUG("COMPUTATION WITHOUT INITIALPOS !");
 
     // Build the derivated system
     Eigen::MatrixXd Ax(4, 4);
     Ax.setZero();
-    Eigen::MatrixXd tmpA;
     Eigen::MatrixXd bx(4, 1);
-    Eigen::MatrixXd tmpb;
     Eigen::MatrixXd cx(1, 4);
 
-    tmpA = m_C * m_A;
+    CartTable::row_t tmpA = m_C * m_A;
 
     Ax(0, 0) = 1.0;
     for (int i = 0; i < 3; i++) {
@@ -226,8 +295,7 @@ void PreviewControl::ComputeOptimalWeights(unsigned int mode) {
         Ax(i + 1, j + 1) = m_A(i, j);
     }
 
-    tmpb = m_C * m_B;
-    bx(0, 0) = tmpb(0, 0);
+    bx(0, 0) = m_C.dot(m_B);
     for (int i = 0; i < 3; i++) {
       bx(i + 1, 0) = m_B(i, 0);
     }
@@ -242,7 +310,8 @@ void PreviewControl::ComputeOptimalWeights(unsigned int mode) {
     anOCS =
         new PatternGeneratorJRL::OptimalControllerSolver(Ax, bx, cx, Q, R, Nl);
 
-    anOCS->ComputeWeights(OptimalControllerSolver::MODE_WITHOUT_INITIALPOS);
+    anOCS->ComputeWeights(OptimalControllerSolver::MODE_WITHOUT_INITIALPOS,
+                          solver);
 
     anOCS->GetF(m_F);
 
@@ -253,15 +322,16 @@ void PreviewControl::ComputeOptimalWeights(unsigned int mode) {
       m_Kx(0, i) = lK(0, i + 1);
 
     delete anOCS;
+    lComputed = true;
   } else if (mode == OptimalControllerSolver::MODE_WITH_INITIALPOS) {
-    Q = 1.0;
-    R = 1e-5;
     ODEBUG("COMPUTATION WITH INITIALPOS !");
-    anOCS = new PatternGeneratorJRL::OptimalControllerSolver(m_A, m_B, m_C, Q,
-                                                             R, Nl);
+    Eigen::MatrixXd lA = m_A, lB = m_B, lC = m_C;
+    anOCS =
+        new PatternGeneratorJRL::OptimalControllerSolver(lA, lB, lC, Q, R, Nl);
 
     anOCS->ComputeWeights(
-        PatternGeneratorJRL::OptimalControllerSolver::MODE_WITH_INITIALPOS);
+        PatternGeneratorJRL::OptimalControllerSolver::MODE_WITH_INITIALPOS,
+        solver);
 
     anOCS->GetF(m_F);
 
@@ -273,6 +343,15 @@ void PreviewControl::ComputeOptimalWeights(unsigned int mode) {
       m_Kx(0, i) = lK(0, i);
 
     delete anOCS;
+    lComputed = true;
+  }
+
+  if (lComputed && lUseCache) {
+    aGains.Ks = m_Ks;
+    for (int i = 0; i < 3; i++)
+      aGains.Kx(i) = m_Kx(0, i);
+    aGains.F = m_F;
+    PreviewGainCache::shared().insert(aKey, aGains);
   }
 
   ODEBUG("Nl:" << Nl);
@@ -296,39 +375,42 @@ void PreviewControl::ComputeOptimalWeights(unsigned int mode) {
 
 int PreviewControl::OneIterationOfPreview(
     Eigen::MatrixXd &x, Eigen::MatrixXd &y, double &sxzmp, double &syzmp,
-    deque<PatternGeneratorJRL::ZMPPosition> &ZMPPositions,
+    RingBuffer<PatternGeneratorJRL::ZMPPosition> &ZMPPositions,
     unsigned long int lindex, double &zmpx2, double &zmpy2, bool Simulation) {
+  assert((x.size() == 3) && (y.size() == 3));
+  Eigen::Map<CartTable::state_t> lx(x.data()), ly(y.data());
+  return OneIterationOfPreview(lx, ly, sxzmp, syzmp, ZMPPositions, lindex,
+                               zmpx2, zmpy2, Simulation);
+}
 
-  double ux = 0.0, uy = 0.0;
-
-  Eigen::Matrix<double, 1, 1> r;
+int PreviewControl::OneIterationOfPreview(
+    Eigen::Ref<CartTable::state_t> x, Eigen::Ref<CartTable::state_t> y,
+    double &sxzmp, double &syzmp,
+    RingBuffer<PatternGeneratorJRL::ZMPPosition> &ZMPPositions,
+    unsigned long int lindex, double &zmpx2, double &zmpy2, bool Simulation) {
 
   // Compute the command.
-  r = m_Kx * x;
-  ux = -r(0, 0) + m_Ks * sxzmp;
+  double ux = -m_Kx.dot(x) + m_Ks * sxzmp;
 
   if (ZMPPositions.size() < m_SizeOfPreviewWindow) {
     LTHROW("ZMPPositions.size()<m_SizeOfPreviewWindow:");
   }
 
-  for (unsigned int i = 0; i < m_SizeOfPreviewWindow; i++)
-    ux += m_F(i, 0) * ZMPPositions[lindex + i].px;
-
-  r = m_Kx * y;
-  uy = -r(0, 0) + m_Ks * syzmp;
+  double uy = -m_Kx.dot(y) + m_Ks * syzmp;
 
-  for (unsigned int i = 0; i < m_SizeOfPreviewWindow; i++)
-    uy += m_F(i, 0) * ZMPPositions[lindex + i].py;
+  // Both axes in one pass over the queue.
+  const double *lF = m_F.data();
+  for (unsigned int i = 0; i < m_SizeOfPreviewWindow; i++) {
+    const ZMPPosition &aZMPPosition = ZMPPositions[lindex + i];
+    ux += lF[i] * aZMPPosition.px;
+    uy += lF[i] * aZMPPosition.py;
+  }
 
-  x = m_A * x + ux * m_B;
-  y = m_A * y + uy * m_B;
+  CartTable::integrate(m_A, m_B, x, ux);
+  CartTable::integrate(m_A, m_B, y, uy);
 
-  zmpx2 = 0.0;
-  for (unsigned int i = 0; i < x.rows(); i++)
-    zmpx2 += m_C(0, i) * x(i, 0);
-  zmpy2 = 0.0;
-  for (unsigned int i = 0; i < y.rows(); i++)
-    zmpy2 += m_C(0, i) * y(i, 0);
+  zmpx2 = m_C.dot(x);
+  zmpy2 = m_C.dot(y);
 
   if (Simulation) {
     sxzmp += (ZMPPositions[lindex].px - zmpx2);
@@ -338,18 +420,72 @@ int PreviewControl::OneIterationOfPreview(
   return 0;
 }
 
+int PreviewControl::OneIterationOfPreview(
+    Eigen::MatrixXd &x, Eigen::MatrixXd &y, double &sxzmp, double &syzmp,
+    const ZMPWindow &ZMPPositions, std::size_t NbOfRows,
+    unsigned long int lindex, double &zmpx2, double &zmpy2, bool Simulation) {
+  assert((x.size() == 3) && (y.size() == 3));
+  Eigen::Map<CartTable::state_t> lx(x.data()), ly(y.data());
+  return OneIterationOfPreview(lx, ly, sxzmp, syzmp, ZMPPositions, NbOfRows,
+                               lindex, zmpx2, zmpy2, Simulation);
+}
+
+int PreviewControl::OneIterationOfPreview(
+    Eigen::Ref<CartTable::state_t> x, Eigen::Ref<CartTable::state_t> y,
+    double &sxzmp, double &syzmp, const ZMPWindow &ZMPPositions,
+    std::size_t NbOfRows, unsigned long int lindex, double &zmpx2,
+    double &zmpy2, bool Simulation) {
+
+  assert(NbOfRows <= (std::size_t)ZMPPositions.rows());
+  if (NbOfRows < lindex + m_SizeOfPreviewWindow) {
+    LTHROW("NbOfRows<lindex+m_SizeOfPreviewWindow:");
+  }
+
+  // Feed-forward: the rows are (px, py) pairs, so the product is
+  // one pass accumulating both axes in a SIMD register.
+  Eigen::Index NL = (Eigen::Index)m_SizeOfPreviewWindow;
+  Eigen::RowVector2d u = m_F.col(0).head(NL).transpose() *
+                         ZMPPositions.middleRows((Eigen::Index)lindex, NL);
+
+  double ux = u(0) - m_Kx.dot(x) + m_Ks * sxzmp;
+  double uy = u(1) - m_Kx.dot(y) + m_Ks * syzmp;
+
+  CartTable::integrate(m_A, m_B, x, ux);
+  CartTable::integrate(m_A, m_B, y, uy);
+
+  zmpx2 = m_C.dot(x);
+  zmpy2 = m_C.dot(y);
+
+  if (Simulation) {
+    sxzmp += (ZMPPositions((Eigen::Index)lindex, 0) - zmpx2);
+    syzmp += (ZMPPositions((Eigen::Index)lindex, 1) - zmpy2);
+  }
+
+  return 0;
+}
+
+void PreviewControl::LoadZMPWindow(
+    const RingBuffer<PatternGeneratorJRL::ZMPPosition> &ZMPPositions,
+    std::size_t first, std::size_t n, ZMPWindow &aZMPWindow) {
+  if ((std::size_t)aZMPWindow.rows() < n)
+    aZMPWindow.resize((Eigen::Index)n, 2);
+  for (std::size_t i = 0; i < n; i++) {
+    const ZMPPosition &aZMPPosition = ZMPPositions[first + i];
+    aZMPWindow((Eigen::Index)i, 0) = aZMPPosition.px;
+    aZMPWindow((Eigen::Index)i, 1) = aZMPPosition.py;
+  }
+}
+
 int PreviewControl::OneIterationOfPreview1D(Eigen::MatrixXd &x, double &sxzmp,
                                             deque<double> &ZMPPositions,
                                             unsigned long int lindex,
                                             double &zmpx2, bool Simulation) {
 
-  double ux = 0.0;
-
-  Eigen::Matrix<double, 1, 1> r;
+  assert(x.size() == 3);
+  Eigen::Map<CartTable::state_t> lx(x.data());
 
   // Compute the command.
-  r = m_Kx * x;
-  ux = -r(0, 0) + m_Ks * sxzmp;
+  double ux = -m_Kx.dot(lx) + m_Ks * sxzmp;
 
   ODEBUG("x: " << x);
   ODEBUG(" ux phase 1: " << ux);
@@ -362,11 +498,9 @@ int PreviewControl::OneIterationOfPreview1D(Eigen::MatrixXd &x, double &sxzmp,
   for (unsigned int i = 0; i < m_SizeOfPreviewWindow; i++)
     ux += m_F(i, 0) * ZMPPositions[lindex + i];
   ODEBUG(" ux preview window phase: " << ux);
-  x = m_A * x + ux * m_B;
+  CartTable::integrate(m_A, m_B, lx, ux);
 
-  zmpx2 = 0.0;
-  for (unsigned int i = 0; i < x.rows(); i++)
-    zmpx2 += m_C(0, i) * x(i, 0);
+  zmpx2 = m_C.dot(lx);
 
   if (Simulation) {
     sxzmp += (ZMPPositions[lindex] - zmpx2);
@@ -384,13 +518,11 @@ int PreviewControl::OneIterationOfPreview1D(Eigen::MatrixXd &x, double &sxzmp,
                                             unsigned long int lindex,
                                             double &zmpx2, bool Simulation) {
 
-  double ux = 0.0;
-
-  Eigen::Matrix<double, 1, 1> r;
+  assert(x.size() == 3);
+  Eigen::Map<CartTable::state_t> lx(x.data());
 
   // Compute the command.
-  r = m_Kx * x;
-  ux = -r(0, 0) + m_Ks * sxzmp;
+  double ux = -m_Kx.dot(lx) + m_Ks * sxzmp;
 
   ODEBUG("x: " << x);
   ODEBUG(" ux phase 1: " << ux);
@@ -403,8 +535,11 @@ int PreviewControl::OneIterationOfPreview1D(Eigen::MatrixXd &x, double &sxzmp,
   long int TestSize = ZMPPositions.size() - lindex - m_SizeOfPreviewWindow;
 
   if (TestSize >= 0) {
-    for (unsigned int i = 0; i < m_SizeOfPreviewWindow; i++)
-      ux += m_F(i, 0) * ZMPPositions[lindex + i];
+    ux += m_F.col(0)
+              .head((Eigen::Index)m_SizeOfPreviewWindow)
+              .dot(Eigen::Map<const Eigen::VectorXd>(
+                  &ZMPPositions[lindex],
+                  (Eigen::Index)m_SizeOfPreviewWindow));
   } else {
     ODEBUG("Case where TestSize<0 (lindex:"
            << lindex << " , ZMPPositions.size(): " << ZMPPositions.size()
@@ -418,11 +553,9 @@ int PreviewControl::OneIterationOfPreview1D(Eigen::MatrixXd &x, double &sxzmp,
       ux += m_F(i, 0) * ZMPPositions[i];
   }
   ODEBUG(" ux preview window phase: " << ux);
-  x = m_A * x + ux * m_B;
+  CartTable::integrate(m_A, m_B, lx, ux);
 
-  zmpx2 = 0.0;
-  for (unsigned int i = 0; i < x.rows(); i++)
-    zmpx2 += m_C(0, i) * x(i, 0);
+  zmpx2 = m_C.dot(lx);
 
   if (Simulation) {
     sxzmp += (ZMPPositions[lindex] - zmpx2);
@@ -482,5 +615,23 @@ void PreviewControl::CallMethod(std::string &Method, std::istringstream &strm) {
       else if (initialpos == "withoutinitialpos")
         ComputeOptimalWeights(OptimalControllerSolver::MODE_WITHOUT_INITIALPOS);
     }
+  } else if (Method == ":previewgaincache") {
+    // The table is shared, loading it once is enough.
+    std::string lFileName;
+    if (strm.good())
+      strm >> lFileName;
+    PreviewGainCache::shared().attach(lFileName);
+  } else if (Method == ":previewgainschedule") {
+    // :previewgainschedule zcmin zcmax nbofheights
+    double lZcMin = 0.0, lZcMax = 0.0;
+    unsigned int lNbOfHeights = 0;
+    if (strm.good())
+      strm >> lZcMin;
+    if (strm.good())
+      strm >> lZcMax;
+    if (strm.good())
+      strm >> lNbOfHeights;
+    ComputeGainSchedule(lZcMin, lZcMax, lNbOfHeights,
+                        m_DefaultWeightComputationMode);
   }
 }
@@ -35,7 +35,10 @@
 
 using namespace ::std;
 
+#include <PreviewControl/CartTableModel.hh>
 #include <PreviewControl/OptimalControllerSolver.hh>
+#include <PreviewControl/PreviewGainCache.hh>
+#include <RingBuffer.hh>
 #include <SimplePlugin.hh>
 #include <jrl/walkgen/pgtypes.hh>
 
@@ -47,6 +50,11 @@ namespace PatternGeneratorJRL {
 */
 class PreviewControl : public SimplePlugin {
 public:
+  /*! \brief ZMP references stored contiguously, one row per sample
+    with px and py, as used by the fused OneIterationOfPreview(). */
+  typedef Eigen::Matrix<double, Eigen::Dynamic, 2, Eigen::RowMajor>
+      ZMPWindow;
+
   /*! Constructor */
   PreviewControl(
       SimplePluginManager *lSPM,
@@ -61,12 +69,51 @@ public:
       Ks, Kx, and F. */
   void ReadPrecomputedFile(string aFileName);
 
-  /*! \brief One iteration of the preview control. */
+  /*! \brief One iteration of the preview control.
+    \param [in][out] x, y: Position, velocity and acceleration of the
+    CoM along each axis. */
+  int OneIterationOfPreview(
+      Eigen::Ref<CartTable::state_t> x, Eigen::Ref<CartTable::state_t> y,
+      double &sxzmp, double &syzmp,
+      RingBuffer<PatternGeneratorJRL::ZMPPosition> &ZMPPositions,
+      unsigned long int lindex, double &zmpx2, double &zmpy2, bool Simulation);
+
+  /*! \brief Same as above with x and y as 3x1 dynamic matrices. */
   int OneIterationOfPreview(
       Eigen::MatrixXd &x, Eigen::MatrixXd &y, double &sxzmp, double &syzmp,
-      deque<PatternGeneratorJRL::ZMPPosition> &ZMPPositions,
+      RingBuffer<PatternGeneratorJRL::ZMPPosition> &ZMPPositions,
       unsigned long int lindex, double &zmpx2, double &zmpy2, bool Simulation);
 
+  /*! \brief One iteration of the preview control on both axes,
+    with the ZMP references in contiguous storage. The feed-forward
+    of both axes is one vectorized pass over the rows lindex to
+    lindex + NL of ZMPPositions: each row holds px and py. Loading
+    a queue once with LoadZMPWindow() and calling this for
+    consecutive values of lindex reuses the loaded references.
+    \param [in] NbOfRows: number of rows loaded in ZMPPositions, the
+    next ones are left from a longer load and are never read.
+  */
+  int OneIterationOfPreview(Eigen::Ref<CartTable::state_t> x,
+                            Eigen::Ref<CartTable::state_t> y, double &sxzmp,
+                            double &syzmp, const ZMPWindow &ZMPPositions,
+                            std::size_t NbOfRows, unsigned long int lindex,
+                            double &zmpx2, double &zmpy2, bool Simulation);
+
+  /*! \brief Same as above with x and y as 3x1 dynamic matrices. */
+  int OneIterationOfPreview(Eigen::MatrixXd &x, Eigen::MatrixXd &y,
+                            double &sxzmp, double &syzmp,
+                            const ZMPWindow &ZMPPositions,
+                            std::size_t NbOfRows, unsigned long int lindex,
+                            double &zmpx2, double &zmpy2, bool Simulation);
+
+  /*! \brief Copy px and py of the n samples of ZMPPositions starting at
+    first in the first n rows of aZMPWindow, which is enlarged if
+    needed and never shrunk: n is the number of rows to give to
+    OneIterationOfPreview(). */
+  static void LoadZMPWindow(
+      const RingBuffer<PatternGeneratorJRL::ZMPPosition> &ZMPPositions,
+      std::size_t first, std::size_t n, ZMPWindow &aZMPWindow);
+
   /*! \brief One iteration of the preview control
     along one axis (using queues)*/
   int OneIterationOfPreview1D(Eigen::MatrixXd &x, double &sxzmp,
@@ -107,11 +154,15 @@ public:
   /*! \biref Setter for the preview control time. */
   void SetPreviewControlTime(double lPreviewControlTime);
 
-  /*! Getter for the height position of the CoM. */
+  /*! Setter for the height position of the CoM. Inside the range of the
+    gain schedule, the gains are interpolated. */
   void SetHeightOfCoM(double lZc);
   /*! \brief Indicates if the weights are coherent with the parameters. */
   bool IsCoherent();
 
+  /*! \brief Gains in use, solved or interpolated from the schedule. */
+  void GetGains(PreviewGains &aGains) const;
+
   /*! @} */
 
   /*! \brief Compute optimal weights.
@@ -120,7 +171,23 @@ public:
     without initial position (OptimalControllerSolver::
     MODE_WITHOUT_INITIALPOS).
   */
-  void ComputeOptimalWeights(unsigned int mode);
+  void ComputeOptimalWeights(
+      unsigned int mode,
+      unsigned int solver = OptimalControllerSolver::SOLVER_SCHUR);
+
+  /*! \brief Precompute the gains for NbOfHeights heights of the CoM
+    regularly spaced between ZcMin and ZcMax, to track a varying height.
+    While the height set by SetHeightOfCoM() stays in this range, the
+    gains are interpolated linearly instead of solving the Riccati
+    equation. The table is removed when the sampling period or the
+    preview control time change, or when NbOfHeights < 2. The gains of
+    the schedule are not added to PreviewGainCache::shared().
+    With a 2 cm step, the interpolated gains are within 5e-5, relative,
+    of the solved ones.
+    \param [in] mode: as for ComputeOptimalWeights().
+  */
+  void ComputeGainSchedule(double ZcMin, double ZcMax,
+                           unsigned int NbOfHeights, unsigned int mode);
 
   /*! \brief Overloading of << operator. */
   void print();
@@ -130,15 +197,15 @@ public:
 
 private:
   /*! \brief Matrices for preview control. */
-  Eigen::MatrixXd m_A;
-  Eigen::MatrixXd m_B;
-  Eigen::MatrixXd m_C;
+  CartTable::matrix_t m_A;
+  CartTable::state_t m_B;
+  CartTable::row_t m_C;
 
   /** \name Control parameters.
       @{ */
 
   /*! Gain on the current state of the CoM. */
-  Eigen::MatrixXd m_Kx;
+  CartTable::row_t m_Kx;
   /*! Gain on the current ZMP. */
   double m_Ks;
   /*! Window  */
@@ -168,6 +235,24 @@ private:
 
   /*! \brief Default Mode. */
   unsigned int m_DefaultWeightComputationMode;
+
+  /*! \name Gain schedule over the height of the CoM.
+    @{ */
+  /*! Lowest height and step between two heights. */
+  double m_ScheduleZcMin, m_ScheduleZcStep;
+  /*! Gains for each height. */
+  std::vector<PreviewGains> m_ScheduleGains;
+  /*! @} */
+
+  /*! \brief Solve the gains for the current parameters, looking them
+    up in PreviewGainCache::shared() and adding them to it if
+    lUseCache is true. */
+  void SolveOptimalWeights(unsigned int mode, unsigned int solver,
+                           bool lUseCache);
+
+  /*! \brief Set the gains for the height lZc from the schedule.
+    \return false if lZc is out of the schedule. */
+  bool InterpolateGains(double lZc);
 };
 } // namespace PatternGeneratorJRL
 #include <ZMPRefTrajectoryGeneration/ZMPDiscretization.hh>
@@ -0,0 +1,235 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file PreviewGainCache.cpp
+  \brief Table of preview control gains shared by the preview controls.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include <PreviewControl/PreviewGainCache.hh>
+
+using namespace PatternGeneratorJRL;
+
+namespace {
+const char GainCacheMagic[8] = {'P', 'V', 'G', 'A', 'I', 'N', '0', '2'};
+
+/// Larger windows are taken as a corrupted file.
+const std::uint64_t MaxWindowSize = 1 << 20;
+
+template <typename T> void writeGain(std::ostream &os, const T &value) {
+  os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> void readGain(std::istream &is, T &value) {
+  is.read(reinterpret_cast<char *>(&value), sizeof(T));
+}
+} // namespace
+
+bool PreviewGainKey::operator<(const PreviewGainKey &aKey) const {
+  if (Zc != aKey.Zc)
+    return Zc < aKey.Zc;
+  if (SamplingPeriod != aKey.SamplingPeriod)
+    return SamplingPeriod < aKey.SamplingPeriod;
+  if (PreviewControlTime != aKey.PreviewControlTime)
+    return PreviewControlTime < aKey.PreviewControlTime;
+  if (Q != aKey.Q)
+    return Q < aKey.Q;
+  if (R != aKey.R)
+    return R < aKey.R;
+  if (Mode != aKey.Mode)
+    return Mode < aKey.Mode;
+  return Solver < aKey.Solver;
+}
+
+PreviewGainCache::PreviewGainCache() : m_Modified(false) {}
+
+PreviewGainCache::~PreviewGainCache() { flush(); }
+
+PreviewGainCache &PreviewGainCache::shared() {
+  static PreviewGainCache aPreviewGainCache;
+  return aPreviewGainCache;
+}
+
+bool PreviewGainCache::find(const PreviewGainKey &aKey,
+                            PreviewGains &aGains) const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  gains_t::const_iterator it = m_Gains.find(aKey);
+  if (it == m_Gains.end())
+    return false;
+  aGains = it->second;
+  return true;
+}
+
+void PreviewGainCache::insert(const PreviewGainKey &aKey,
+                              const PreviewGains &aGains) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Gains[aKey] = aGains;
+  m_Modified = true;
+}
+
+std::size_t PreviewGainCache::size() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Gains.size();
+}
+
+void PreviewGainCache::clear() {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Gains.clear();
+}
+
+bool PreviewGainCache::load(const std::string &aFileName) {
+  gains_t someGains;
+  if (!read(aFileName, someGains))
+    return false;
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  for (gains_t::const_iterator it = someGains.begin(); it != someGains.end();
+       ++it)
+    m_Gains[it->first] = it->second;
+  return true;
+}
+
+bool PreviewGainCache::save(const std::string &aFileName) const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return write(aFileName, m_Gains);
+}
+
+void PreviewGainCache::attach(const std::string &aFileName) {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    // Every preview control receives the command.
+    if (aFileName == m_FileName)
+      return;
+  }
+  flush();
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_FileName = aFileName;
+    m_Modified = false;
+  }
+  if (!aFileName.empty())
+    load(aFileName);
+}
+
+bool PreviewGainCache::flush() {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if (m_FileName.empty() || !m_Modified)
+    return true;
+  if (!write(m_FileName, m_Gains)) {
+    std::cerr << "PreviewGainCache - Unable to write " << m_FileName
+              << std::endl;
+    return false;
+  }
+  m_Modified = false;
+  return true;
+}
+
+bool PreviewGainCache::read(const std::string &aFileName,
+                            gains_t &someGains) {
+  std::ifstream aif(aFileName.c_str(), std::ios::in | std::ios::binary);
+  if (!aif.is_open())
+    return false;
+
+  char lMagic[sizeof(GainCacheMagic)];
+  std::uint64_t lNbGains = 0;
+  aif.read(lMagic, sizeof(lMagic));
+  readGain(aif, lNbGains);
+  if (!aif.good() ||
+      !std::equal(lMagic, lMagic + sizeof(lMagic), GainCacheMagic)) {
+    std::cerr << "PreviewGainCache - " << aFileName
+              << " is not a table of gains" << std::endl;
+    return false;
+  }
+
+  for (std::uint64_t i = 0; i < lNbGains; i++) {
+    PreviewGainKey aKey;
+    PreviewGains aGains;
+    std::uint64_t lMode = 0, lSolver = 0, lWindowSize = 0;
+    readGain(aif, aKey.Zc);
+    readGain(aif, aKey.SamplingPeriod);
+    readGain(aif, aKey.PreviewControlTime);
+    readGain(aif, aKey.Q);
+    readGain(aif, aKey.R);
+    readGain(aif, lMode);
+    readGain(aif, lSolver);
+    readGain(aif, lWindowSize);
+    if (!aif.good() || (lWindowSize > MaxWindowSize))
+      break;
+    aKey.Mode = (unsigned int)lMode;
+    aKey.Solver = (unsigned int)lSolver;
+    readGain(aif, aGains.Ks);
+    aif.read(reinterpret_cast<char *>(aGains.Kx.data()), 3 * sizeof(double));
+    aGains.F.resize((Eigen::Index)lWindowSize);
+    aif.read(reinterpret_cast<char *>(aGains.F.data()),
+             (std::streamsize)(lWindowSize * sizeof(double)));
+    if (!aif.good())
+      break;
+    someGains[aKey] = aGains;
+  }
+  if (someGains.size() != lNbGains) {
+    std::cerr << "PreviewGainCache - " << aFileName << " is truncated"
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool PreviewGainCache::write(const std::string &aFileName,
+                             const gains_t &someGains) {
+  // Another process may read aFileName meanwhile.
+  std::string lTemporaryName = aFileName + ".tmp";
+  std::ofstream aof(lTemporaryName.c_str(),
+                    std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!aof.is_open())
+    return false;
+
+  aof.write(GainCacheMagic, sizeof(GainCacheMagic));
+  writeGain(aof, (std::uint64_t)someGains.size());
+  for (gains_t::const_iterator it = someGains.begin(); it != someGains.end();
+       ++it) {
+    const PreviewGainKey &aKey = it->first;
+    const PreviewGains &aGains = it->second;
+    writeGain(aof, aKey.Zc);
+    writeGain(aof, aKey.SamplingPeriod);
+    writeGain(aof, aKey.PreviewControlTime);
+    writeGain(aof, aKey.Q);
+    writeGain(aof, aKey.R);
+    writeGain(aof, (std::uint64_t)aKey.Mode);
+    writeGain(aof, (std::uint64_t)aKey.Solver);
+    writeGain(aof, (std::uint64_t)aGains.F.size());
+    writeGain(aof, aGains.Ks);
+    aof.write(reinterpret_cast<const char *>(aGains.Kx.data()),
+              3 * sizeof(double));
+    aof.write(reinterpret_cast<const char *>(aGains.F.data()),
+              (std::streamsize)(aGains.F.size() * sizeof(double)));
+  }
+  aof.close();
+  if (aof.fail() ||
+      (std::rename(lTemporaryName.c_str(), aFileName.c_str()) != 0)) {
+    std::remove(lTemporaryName.c_str());
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file PreviewGainCache.hh
+  \brief Table of preview control gains shared by the preview controls.
+*/
+#ifndef _PREVIEW_GAIN_CACHE_H_
+#define _PREVIEW_GAIN_CACHE_H_
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <Eigen/Dense>
+
+namespace PatternGeneratorJRL {
+/*! \brief Parameters from which the gains of a preview control
+  are computed. The values are compared exactly. */
+struct PreviewGainKey {
+  /*! Height of the CoM. */
+  double Zc;
+  double SamplingPeriod;
+  double PreviewControlTime;
+  /*! Weights of the criteria. */
+  double Q, R;
+  /*! OptimalControllerSolver::MODE_WITH_INITIALPOS or
+    OptimalControllerSolver::MODE_WITHOUT_INITIALPOS. */
+  unsigned int Mode;
+  /*! OptimalControllerSolver::SOLVER_SCHUR or
+    OptimalControllerSolver::SOLVER_DOUBLING, whose gains differ by
+    the precision of the solvers. */
+  unsigned int Solver;
+
+  bool operator<(const PreviewGainKey &aKey) const;
+};
+
+/*! \brief Gains of a preview control as used by PreviewControl. */
+struct PreviewGains {
+  /*! Gain on the summed ZMP error. */
+  double Ks;
+  /*! Gain on the state of the CoM. */
+  Eigen::Vector3d Kx;
+  /*! Gains on the preview window. */
+  Eigen::VectorXd F;
+};
+
+/*! \brief Table of preview control gains.
+
+  Solving the Riccati equation is needed each time the height of the
+  CoM, the sampling period or the preview time changes. The table
+  keeps the gains already computed, and PreviewControl looks them up
+  before solving. The table returned by shared() is used by all the
+  instances of PreviewControl in the process, and can be kept in a
+  file between two runs. The file is only written by flush(), so that
+  computing new gains does no file I/O.
+
+  The file is a header, the magic number "PVGAIN02" and the number of
+  entries as a 64 bits integer, followed by the entries. Each entry is
+  Zc, SamplingPeriod, PreviewControlTime, Q and R as doubles, Mode,
+  Solver and the size of the window as 64 bits integers, Ks, Kx and F
+  as doubles.
+  All the fields are 8 bytes long in the host byte order, so that the
+  file can be mapped in memory as well.
+*/
+class PreviewGainCache {
+public:
+  PreviewGainCache();
+
+  /*! Flush the table in the attached file. */
+  ~PreviewGainCache();
+
+  /*! Table used by PreviewControl. */
+  static PreviewGainCache &shared();
+
+  /*! Copy the gains of aKey in aGains.
+    @return false if they are not in the table. */
+  bool find(const PreviewGainKey &aKey, PreviewGains &aGains) const;
+
+  /*! Add the gains of aKey. The attached file is written by the
+    next flush(). */
+  void insert(const PreviewGainKey &aKey, const PreviewGains &aGains);
+
+  std::size_t size() const;
+
+  void clear();
+
+  /*! Add the gains stored in aFileName to the table.
+    @return false if the file can not be read, the table is then
+    unchanged. */
+  bool load(const std::string &aFileName);
+
+  /*! Write the table in aFileName. The table is written in a
+    temporary file first, then renamed, so that aFileName is either
+    the previous table or the new one. */
+  bool save(const std::string &aFileName) const;
+
+  /*! Load aFileName if it exists, and write the table in it at the
+    next flush(). An empty name detaches the file. The previous file
+    is flushed before. */
+  void attach(const std::string &aFileName);
+
+  /*! Write the table in the attached file if gains were inserted
+    since it was attached or flushed.
+    @return false if the file can not be written. */
+  bool flush();
+
+private:
+  typedef std::map<PreviewGainKey, PreviewGains> gains_t;
+
+  static bool read(const std::string &aFileName, gains_t &someGains);
+  static bool write(const std::string &aFileName, const gains_t &someGains);
+
+  mutable std::mutex m_Mutex;
+  gains_t m_Gains;
+  std::string m_FileName;
+  /*! Gains were inserted since the last flush. */
+  bool m_Modified;
+};
+} // namespace PatternGeneratorJRL
+#endif /* _PREVIEW_GAIN_CACHE_H_ */
@@ -32,6 +32,7 @@
   and the desired ZMP based on a sequence of steps.
 */
 
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -91,6 +92,16 @@ ZMPPreviewControlWithMultiBodyZMP::ZMPPreviewControlWithMultiBodyZMP(
       m_FinalDesiredCOMPose(i, j) = 0.0;
 
   m_NumberOfIterations = 0;
+
+  m_MultiBodyZMPDecimation = 1;
+  m_CentroidalMultiBodyZMP = false;
+  m_AuditMultiBodyZMP = false;
+  m_IterationsSinceMultiBodyZMP = 0;
+  m_LastZMPMultiBody.setZero();
+  m_ZMPMultiBodySlope.setZero();
+  m_MaxZMPMultiBodyError = 0.0;
+  m_SumSquaredZMPMultiBodyError = 0.0;
+  m_NbZMPMultiBodyErrors = 0;
 }
 
 ZMPPreviewControlWithMultiBodyZMP::~ZMPPreviewControlWithMultiBodyZMP() {}
@@ -201,13 +212,31 @@ int ZMPPreviewControlWithMultiBodyZMP::OneGlobalStepOfControl(
                     << aRightFAP.x << " " << aRightFAP.y << " " << aRightFAP.z,
                 "1ststage.dat");
 
+  // With a decimated evaluation of the multibody ZMP, the posture of
+  // the first stage is only needed for the evaluation. It is computed
+  // for the two previous iterations as well, because the velocity and
+  // the acceleration are obtained by finite differences.
+  bool EvaluateZMP = false, RealizePosture = true;
+  if (m_StageStrategy != ZMPCOM_TRAJECTORY_FIRST_STAGE_ONLY) {
+    m_IterationsSinceMultiBodyZMP++;
+    EvaluateZMP = m_IterationsSinceMultiBodyZMP >= m_MultiBodyZMPDecimation;
+    RealizePosture =
+        m_AuditMultiBodyZMP ||
+        (m_IterationsSinceMultiBodyZMP + 2 >= m_MultiBodyZMPDecimation);
+  }
+
   int StageOfTheAlgorithm = 0;
-  CallToComAndFootRealization(
-      acompos, aLeftFAP, aRightFAP, CurrentConfiguration, CurrentVelocity,
-      CurrentAcceleration, m_NumberOfIterations, StageOfTheAlgorithm);
+  if (RealizePosture)
+    CallToComAndFootRealization(
+        acompos, aLeftFAP, aRightFAP, CurrentConfiguration, CurrentVelocity,
+        CurrentAcceleration, m_NumberOfIterations, StageOfTheAlgorithm);
 
-  if (m_StageStrategy != ZMPCOM_TRAJECTORY_FIRST_STAGE_ONLY)
-    EvaluateMultiBodyZMP(-1);
+  if (m_StageStrategy != ZMPCOM_TRAJECTORY_FIRST_STAGE_ONLY) {
+    if (EvaluateZMP)
+      EvaluateMultiBodyZMP(-1);
+    else
+      HoldMultiBodyZMP();
+  }
 
   aLeftFAP = m_FIFOLeftFootPosition[0];
   aRightFAP = m_FIFORightFootPosition[0];
@@ -396,12 +425,27 @@ int ZMPPreviewControlWithMultiBodyZMP::FirstStageOfControl(
 int ZMPPreviewControlWithMultiBodyZMP::EvaluateMultiBodyZMP(
     int /* StartingIteration */) {
   ODEBUG("Start EvaluateMultiBodyZMP");
-  m_PinocchioRobot->computeInverseDynamics();
-
   // Call the Humanoid Dynamic Multi Body robot model to
   // compute the ZMP related to the motion found by CoMAndZMPRealization.
   Eigen::Vector3d ZMPmultibody;
-  m_PinocchioRobot->zeroMomentumPoint(ZMPmultibody);
+  if (m_CentroidalMultiBodyZMP) {
+    m_PinocchioRobot->computeCentroidalDynamics(
+        m_PinocchioRobot->currentRPYConfiguration(),
+        m_PinocchioRobot->currentRPYVelocity(),
+        m_PinocchioRobot->currentRPYAcceleration());
+    m_PinocchioRobot->centroidalZeroMomentumPoint(ZMPmultibody);
+  } else {
+    m_PinocchioRobot->computeInverseDynamics();
+    m_PinocchioRobot->zeroMomentumPoint(ZMPmultibody);
+  }
+  if (m_AuditMultiBodyZMP) {
+    Eigen::Vector3d ZMPReference = ZMPmultibody;
+    if (m_CentroidalMultiBodyZMP) {
+      m_PinocchioRobot->computeInverseDynamics();
+      m_PinocchioRobot->zeroMomentumPoint(ZMPReference);
+    }
+    m_AuditZMPMultiBody.push_back(ZMPReference);
+  }
   ODEBUG5(ZMPmultibody[0] << " " << ZMPmultibody[1] << " "
                           << m_FIFOZMPRefPositions[0].px << " "
                           << m_FIFOZMPRefPositions[0].py,
@@ -425,15 +469,102 @@ int ZMPPreviewControlWithMultiBodyZMP::EvaluateMultiBodyZMP(
 
   ODEBUG("Stage 4");
   m_FIFODeltaZMPPositions.push_back(aZMPpos);
+  InterpolateMultiBodyZMP(ZMPmultibody);
   m_StartingNewSequence = false;
   ODEBUG("Final");
   return 1;
 }
 
+void ZMPPreviewControlWithMultiBodyZMP::HoldMultiBodyZMP() {
+  // The whole queue is previewed by the second stage: extrapolate
+  // along the slope between the two last evaluations rather than
+  // repeating the last one.
+  Eigen::Vector3d lZMPmultibody =
+      m_LastZMPMultiBody +
+      (double)m_IterationsSinceMultiBodyZMP * m_ZMPMultiBodySlope;
+  ZMPPosition aZMPpos;
+  aZMPpos.px = m_FIFOZMPRefPositions[0].px - lZMPmultibody[0];
+  aZMPpos.py = m_FIFOZMPRefPositions[0].py - lZMPmultibody[1];
+  aZMPpos.pz = 0.0;
+  aZMPpos.theta = 0.0;
+  aZMPpos.stepType = 1;
+  aZMPpos.time = m_FIFOZMPRefPositions[0].time;
+  m_FIFODeltaZMPPositions.push_back(aZMPpos);
+
+  if (m_AuditMultiBodyZMP) {
+    Eigen::Vector3d ZMPReference;
+    m_PinocchioRobot->computeInverseDynamics();
+    m_PinocchioRobot->zeroMomentumPoint(ZMPReference);
+    m_AuditZMPMultiBody.push_back(ZMPReference);
+  }
+}
+
+void ZMPPreviewControlWithMultiBodyZMP::InterpolateMultiBodyZMP(
+    const Eigen::Vector3d &ZMPmultibody) {
+  // The last n values of the queue are the iterations since the
+  // previous evaluation, the current one being the last.
+  unsigned int n = m_IterationsSinceMultiBodyZMP;
+  Eigen::Vector3d lSlope = ZMPmultibody - m_LastZMPMultiBody;
+  if (n > 1)
+    lSlope /= (double)n;
+
+  // The held values were extrapolated along m_ZMPMultiBodySlope.
+  Eigen::Vector3d lCorrection = lSlope - m_ZMPMultiBodySlope;
+  std::size_t lSize = m_FIFODeltaZMPPositions.size();
+  for (unsigned int j = 1; j < n; j++) {
+    if (n - j >= lSize)
+      continue;
+    ZMPPosition &aZMPpos = m_FIFODeltaZMPPositions[lSize - 1 - (n - j)];
+    aZMPpos.px -= j * lCorrection[0];
+    aZMPpos.py -= j * lCorrection[1];
+  }
+
+  if (m_AuditMultiBodyZMP && (n > 0) && (m_AuditZMPMultiBody.size() == n)) {
+    for (unsigned int j = 1; j <= n; j++) {
+      Eigen::Vector3d lError = m_LastZMPMultiBody + (double)j * lSlope -
+                               m_AuditZMPMultiBody[j - 1];
+      double lDistance = lError.head<2>().norm();
+      if (lDistance > m_MaxZMPMultiBodyError)
+        m_MaxZMPMultiBodyError = lDistance;
+      m_SumSquaredZMPMultiBodyError += lDistance * lDistance;
+      m_NbZMPMultiBodyErrors++;
+    }
+  }
+  m_AuditZMPMultiBody.clear();
+
+  // No slope across the start of a new sequence.
+  if (m_StartingNewSequence)
+    m_ZMPMultiBodySlope.setZero();
+  else
+    m_ZMPMultiBodySlope = lSlope;
+  m_LastZMPMultiBody = ZMPmultibody;
+  m_IterationsSinceMultiBodyZMP = 0;
+}
+
+void ZMPPreviewControlWithMultiBodyZMP::SetMultiBodyZMPEvaluation(
+    unsigned int Decimation, bool Centroidal, bool Audit) {
+  m_MultiBodyZMPDecimation = (Decimation == 0) ? 1 : Decimation;
+  m_CentroidalMultiBodyZMP = Centroidal;
+  m_AuditMultiBodyZMP = Audit;
+  m_AuditZMPMultiBody.clear();
+  m_AuditZMPMultiBody.reserve(m_MultiBodyZMPDecimation);
+}
+
+unsigned long int
+ZMPPreviewControlWithMultiBodyZMP::GetMultiBodyZMPAccuracyLoss(
+    double &MaxError, double &RMSError) const {
+  MaxError = m_MaxZMPMultiBodyError;
+  RMSError = 0.0;
+  if (m_NbZMPMultiBodyErrors > 0)
+    RMSError = sqrt(m_SumSquaredZMPMultiBodyError /
+                    (double)m_NbZMPMultiBodyErrors);
+  return m_NbZMPMultiBodyErrors;
+}
+
 int ZMPPreviewControlWithMultiBodyZMP::Setup(
-    deque<ZMPPosition> &ZMPRefPositions, deque<COMState> &COMStates,
-    deque<FootAbsolutePosition> &LeftFootPositions,
-    deque<FootAbsolutePosition> &RightFootPositions) {
+    RingBuffer<ZMPPosition> &ZMPRefPositions, RingBuffer<COMState> &COMStates,
+    RingBuffer<FootAbsolutePosition> &LeftFootPositions,
+    RingBuffer<FootAbsolutePosition> &RightFootPositions) {
   m_NumberOfIterations = 0;
   Eigen::VectorXd CurrentConfiguration =
       m_PinocchioRobot->currentRPYConfiguration();
@@ -454,9 +585,9 @@ int ZMPPreviewControlWithMultiBodyZMP::Setup(
 }
 
 int ZMPPreviewControlWithMultiBodyZMP::SetupFirstPhase(
-    deque<ZMPPosition> &ZMPRefPositions, deque<COMState> &,
-    deque<FootAbsolutePosition> &LeftFootPositions,
-    deque<FootAbsolutePosition> &RightFootPositions) {
+    RingBuffer<ZMPPosition> &ZMPRefPositions, RingBuffer<COMState> &,
+    RingBuffer<FootAbsolutePosition> &LeftFootPositions,
+    RingBuffer<FootAbsolutePosition> &RightFootPositions) {
   ODEBUG6("Beginning of Setup 0 ", "DebugData.txt");
   ODEBUG("Setup");
   // double zmpx2, zmpy2;
@@ -508,6 +639,12 @@ int ZMPPreviewControlWithMultiBodyZMP::SetupFirstPhase(
   m_FIFODeltaZMPPositions.clear();
   m_FIFOCOMStates.clear();
 
+  m_IterationsSinceMultiBodyZMP = 0;
+  m_AuditZMPMultiBody.clear();
+  m_MaxZMPMultiBodyError = 0.0;
+  m_SumSquaredZMPMultiBodyError = 0.0;
+  m_NbZMPMultiBodyErrors = 0;
+
   Eigen::VectorXd CurrentConfiguration;
   Eigen::VectorXd CurrentVelocity;
   Eigen::VectorXd CurrentAcceleration;
@@ -529,9 +666,9 @@ int ZMPPreviewControlWithMultiBodyZMP::SetupFirstPhase(
 }
 
 int ZMPPreviewControlWithMultiBodyZMP::SetupIterativePhase(
-    deque<ZMPPosition> &ZMPRefPositions, deque<COMState> &COMStates,
-    deque<FootAbsolutePosition> &LeftFootPositions,
-    deque<FootAbsolutePosition> &RightFootPositions,
+    RingBuffer<ZMPPosition> &ZMPRefPositions, RingBuffer<COMState> &COMStates,
+    RingBuffer<FootAbsolutePosition> &LeftFootPositions,
+    RingBuffer<FootAbsolutePosition> &RightFootPositions,
     Eigen::VectorXd &CurrentConfiguration, Eigen::VectorXd &CurrentVelocity,
     Eigen::VectorXd &CurrentAcceleration, int localindex) {
 
@@ -575,11 +712,12 @@ int ZMPPreviewControlWithMultiBodyZMP::SetupIterativePhase(
   return 0;
 }
 void ZMPPreviewControlWithMultiBodyZMP::CreateExtraCOMBuffer(
-    deque<COMState> &m_ExtraCOMBuffer, deque<ZMPPosition> &m_ExtraZMPBuffer,
-    deque<ZMPPosition> &m_ExtraZMPRefBuffer)
+    RingBuffer<COMState> &m_ExtraCOMBuffer,
+    RingBuffer<ZMPPosition> &m_ExtraZMPBuffer,
+    RingBuffer<ZMPPosition> &m_ExtraZMPRefBuffer)
 
 {
-  deque<ZMPPosition> aFIFOZMPRefPositions;
+  RingBuffer<ZMPPosition> aFIFOZMPRefPositions;
   Eigen::MatrixXd aPC1x;
   Eigen::MatrixXd aPC1y;
   double aSxzmp, aSyzmp;
@@ -730,10 +868,11 @@ int ZMPPreviewControlWithMultiBodyZMP::GetStrategyForPCStages() {
 }
 
 void ZMPPreviewControlWithMultiBodyZMP::RegisterMethods() {
-  std::string aMethodName[3] = {":samplingperiod", ":previewcontroltime",
-                                ":comheight"};
+  std::string aMethodName[5] = {":samplingperiod", ":previewcontroltime",
+                                ":comheight", ":multibodyzmpevaluation",
+                                ":multibodyzmpaccuracy"};
 
-  for (int i = 0; i < 3; i++) {
+  for (int i = 0; i < 5; i++) {
     if (!RegisterMethod(aMethodName[i])) {
       std::cerr << "Unable to register " << aMethodName << std::endl;
     } else {
@@ -776,5 +915,24 @@ void ZMPPreviewControlWithMultiBodyZMP::CallMethod(std::string &Method,
       strm >> lpreviewcontroltime;
       SetPreviewControlTime(lpreviewcontroltime);
     }
+  } else if (Method == ":multibodyzmpevaluation") {
+    // :multibodyzmpevaluation decimation [rnea|centroidal] [audit]
+    unsigned int lDecimation = 1;
+    std::string lEngine, lAudit;
+    if (strm.good())
+      strm >> lDecimation;
+    if (strm.good())
+      strm >> lEngine;
+    if (strm.good())
+      strm >> lAudit;
+    SetMultiBodyZMPEvaluation(lDecimation, lEngine == "centroidal",
+                              lAudit == "audit" || lAudit == "true");
+  } else if (Method == ":multibodyzmpaccuracy") {
+    double lMaxError, lRMSError;
+    unsigned long int lNbSamples =
+        GetMultiBodyZMPAccuracyLoss(lMaxError, lRMSError);
+    std::cout << "Multibody ZMP accuracy loss: max " << lMaxError << " rms "
+              << lRMSError << " over " << lNbSamples << " samples"
+              << std::endl;
   }
 }
@@ -33,9 +33,11 @@
 #define _ZMPREVIEWCONTROLWITHMULTIBODYZMP_H_
 
 #include <deque>
+#include <vector>
 
 #include <MotionGeneration/ComAndFootRealization.hh>
 #include <PreviewControl/PreviewControl.hh>
+#include <RingBuffer.hh>
 #include <SimplePlugin.hh>
 #include <jrl/walkgen/pgtypes.hh>
 
@@ -97,19 +99,19 @@ private:
   //@}
 
   /*! Fifo for the ZMP ref. */
-  deque<ZMPPosition> m_FIFOZMPRefPositions;
+  RingBuffer<ZMPPosition> m_FIFOZMPRefPositions;
 
   /*! Fifo for the ZMP ref. */
-  deque<ZMPPosition> m_FIFODeltaZMPPositions;
+  RingBuffer<ZMPPosition> m_FIFODeltaZMPPositions;
 
   /*! Fifo for the COM reference. */
-  deque<COMState> m_FIFOCOMStates;
+  RingBuffer<COMState> m_FIFOCOMStates;
 
   /*! Fifo for the positionning of the left foot. */
-  deque<FootAbsolutePosition> m_FIFOLeftFootPosition;
+  RingBuffer<FootAbsolutePosition> m_FIFOLeftFootPosition;
 
   /*! Fifo for the positionning of the right foot. */
-  deque<FootAbsolutePosition> m_FIFORightFootPosition;
+  RingBuffer<FootAbsolutePosition> m_FIFORightFootPosition;
 
   /*! Error on preview control for the cart model. */
   double m_sxzmp, m_syzmp;
@@ -129,7 +131,7 @@ private:
   bool m_StartingNewSequence;
 
   /*! Keep the ZMP reference. */
-  deque<ZMPPosition> m_FIFOTmpZMPPosition;
+  RingBuffer<ZMPPosition> m_FIFOTmpZMPPosition;
 
   /*!extra COMState buffer calculated to give to the stepover planner  */
   std::vector<COMState> m_ExtraCOMBuffer;
@@ -166,9 +168,50 @@ private:
   /*! Sampling period. */
   double m_SamplingPeriod;
 
+  /*! \name Decimated evaluation of the multibody ZMP.
+    @{ */
+  /*! Number of iterations between two evaluations. */
+  unsigned int m_MultiBodyZMPDecimation;
+
+  /*! Use the centroidal dynamics instead of the inverse dynamics. */
+  bool m_CentroidalMultiBodyZMP;
+
+  /*! Compare the evaluated and interpolated values with the
+    inverse dynamics at each iteration. */
+  bool m_AuditMultiBodyZMP;
+
+  /*! Iterations since the last evaluation. */
+  unsigned int m_IterationsSinceMultiBodyZMP;
+
+  /*! Multibody ZMP of the last evaluation. */
+  Eigen::Vector3d m_LastZMPMultiBody;
+
+  /*! Change of the multibody ZMP per iteration between the two last
+    evaluations. */
+  Eigen::Vector3d m_ZMPMultiBodySlope;
+
+  /*! Multibody ZMP given by the inverse dynamics at the iterations
+    without evaluation, in audit mode. */
+  std::vector<Eigen::Vector3d> m_AuditZMPMultiBody;
+
+  /*! Accuracy loss measured in audit mode. */
+  double m_MaxZMPMultiBodyError, m_SumSquaredZMPMultiBodyError;
+  unsigned long int m_NbZMPMultiBodyErrors;
+  /*! @} */
+
   /*! Register method. */
   void RegisterMethods();
 
+  /*! Push the multibody ZMP extrapolated from the two last
+    evaluations in the queue of ZMP difference at an iteration
+    without evaluation. */
+  void HoldMultiBodyZMP();
+
+  /*! Replace the values pushed by HoldMultiBodyZMP() since the last
+    evaluation by a linear interpolation up to ZMPmultibody,
+    and measure the error in audit mode. */
+  void InterpolateMultiBodyZMP(const Eigen::Vector3d &ZMPmultibody);
+
   /*! Set the sampling period and update NL.*/
   void SetSamplingPeriod(double lSamplingPeriod);
 
@@ -290,6 +333,35 @@ public:
   */
   int EvaluateMultiBodyZMP(int StartingIteration);
 
+  /*! Evaluate the multibody ZMP only every Decimation iterations,
+    with the inverse dynamics or with the centroidal dynamics.
+    In between, the queue of ZMP difference receives a linear
+    extrapolation of the two last values, replaced by a linear
+    interpolation at the next evaluation. The second stage previews
+    the whole queue, so the extrapolated values of its tail enter its
+    feed-forward term. The posture of the first stage
+    is then only computed for the iterations needed by the finite
+    differences of the evaluation.
+
+    @param[in] Decimation: 1 evaluates at each iteration (default).
+    @param[in] Centroidal: Use the centroidal dynamics.
+    @param[in] Audit: Compute the inverse dynamics at each iteration
+    to measure the accuracy loss, see GetMultiBodyZMPAccuracyLoss().
+  */
+  void SetMultiBodyZMPEvaluation(unsigned int Decimation, bool Centroidal,
+                                 bool Audit);
+
+  /*! Distance between the multibody ZMP used by the second stage and
+    the one given by the inverse dynamics, measured in audit mode
+    since the last Setup().
+
+    @param[out] MaxError: Largest distance in meters.
+    @param[out] RMSError: Root mean square of the distance.
+    @return The number of samples.
+  */
+  unsigned long int GetMultiBodyZMPAccuracyLoss(double &MaxError,
+                                                double &RMSError) const;
+
   /*! Second stage of the control, i.e. preview control on the Delta ZMP.
     COM correction, and computation of the final robot state
     (only the left and right legs).
@@ -361,9 +433,10 @@ public:
     @param[in] RightFootPositions: idem than the previous one but for the
     right foot.
   */
-  int Setup(deque<ZMPPosition> &ZMPRefPositions, deque<COMState> &COMStates,
-            deque<FootAbsolutePosition> &LeftFootPositions,
-            deque<FootAbsolutePosition> &RightFootPositions);
+  int Setup(RingBuffer<ZMPPosition> &ZMPRefPositions,
+            RingBuffer<COMState> &COMStates,
+            RingBuffer<FootAbsolutePosition> &LeftFootPositions,
+            RingBuffer<FootAbsolutePosition> &RightFootPositions);
 
   /*! Method to perform the First Phase. It initializes properly
     the internal fields of ZMPPreviewControlWithMultiBodyZMP
@@ -378,10 +451,10 @@ public:
     @param[in] RightFootPositions: idem than the previous one but for the
     right foot.
   */
-  int SetupFirstPhase(deque<ZMPPosition> &ZMPRefPositions,
-                      deque<COMState> &COMStates,
-                      deque<FootAbsolutePosition> &LeftFootPositions,
-                      deque<FootAbsolutePosition> &RightFootPositions);
+  int SetupFirstPhase(RingBuffer<ZMPPosition> &ZMPRefPositions,
+                      RingBuffer<COMState> &COMStates,
+                      RingBuffer<FootAbsolutePosition> &LeftFootPositions,
+                      RingBuffer<FootAbsolutePosition> &RightFootPositions);
 
   /*! Method to call while feeding the 2 preview windows.
     It updates the first values of the Preview control
@@ -407,10 +480,10 @@ public:
     feet position instance.
     @param[in] localindex: Value of the index which goes from 0 to 2 * m_NL.
   */
-  int SetupIterativePhase(deque<ZMPPosition> &ZMPRefPositions,
-                          deque<COMState> &COMStates,
-                          deque<FootAbsolutePosition> &LeftFootPositions,
-                          deque<FootAbsolutePosition> &RightFootPositions,
+  int SetupIterativePhase(RingBuffer<ZMPPosition> &ZMPRefPositions,
+                          RingBuffer<COMState> &COMStates,
+                          RingBuffer<FootAbsolutePosition> &LeftFootPositions,
+                          RingBuffer<FootAbsolutePosition> &RightFootPositions,
                           Eigen::VectorXd &CurrentConfiguration,
                           Eigen::VectorXd &CurrentVelocity,
                           Eigen::VectorXd &CurrentAcceleration, int localindex);
@@ -424,9 +497,9 @@ public:
     first preview control).
     @param[out] ExtraZMPRefBuffer: Extra FIFO for the ZMP ref positions.
   */
-  void CreateExtraCOMBuffer(deque<COMState> &ExtraCOMBuffer,
-                            deque<ZMPPosition> &ExtraZMPBuffer,
-                            deque<ZMPPosition> &ExtraZMPRefBuffer);
+  void CreateExtraCOMBuffer(RingBuffer<COMState> &ExtraCOMBuffer,
+                            RingBuffer<ZMPPosition> &ExtraZMPBuffer,
+                            RingBuffer<ZMPPosition> &ExtraZMPRefBuffer);
 
   /*! Evaluate Starting CoM for a given position.
     @param[in] BodyAnglesInit: The state vector used to compute the CoM.
@@ -155,7 +155,7 @@ int RigidBodySystem::initialize_trajectories() {
 }
 
 int RigidBodySystem::precompute_trajectories(
-    const deque<support_state_t> &SupportStates_deq) {
+    const RingBuffer<support_state_t> &SupportStates_deq) {
 
   // Precompute vertical foot trajectories
   // The lowest height is the height of the ankle:
@@ -163,7 +163,7 @@ int RigidBodySystem::precompute_trajectories(
   Eigen::Vector3d LocalAnklePosition;
   LocalAnklePosition = PR_->leftFoot()->anklePosition;
 
-  deque<support_state_t>::const_iterator SS_it = SupportStates_deq.begin();
+  RingBuffer<support_state_t>::const_iterator SS_it = SupportStates_deq.begin();
   SS_it++; // First support phase is current support phase
   deque<rigid_body_state_t>::iterator LFTraj_it =
       LeftFoot_.Trajectory().begin();
@@ -214,9 +214,9 @@ int RigidBodySystem::precompute_trajectories(
 }
 
 int RigidBodySystem::update(
-    const std::deque<support_state_t> &SupportStates_deq,
-    const std::deque<FootAbsolutePosition> &LeftFootTraj_deq,
-    const std::deque<FootAbsolutePosition> &RightFootTraj_deq) {
+    const RingBuffer<support_state_t> &SupportStates_deq,
+    const RingBuffer<FootAbsolutePosition> &LeftFootTraj_deq,
+    const RingBuffer<FootAbsolutePosition> &RightFootTraj_deq) {
 
   unsigned nbStepsPreviewed = SupportStates_deq.back().StepNumber;
   if (multiBody_) {
@@ -472,7 +472,7 @@ int RigidBodySystem::compute_dyn_cjerk(linear_dynamics_t &Dynamics) {
 }
 
 int RigidBodySystem::compute_foot_zero_dynamics(
-    const std::deque<support_state_t> &SupportStates_deq,
+    const RingBuffer<support_state_t> &SupportStates_deq,
     linear_dynamics_t &LeftFootDynamics, linear_dynamics_t &RightFootDynamics) {
 
   // Resize the matrices:
@@ -496,7 +496,7 @@ int RigidBodySystem::compute_foot_zero_dynamics(
   linear_dynamics_t *FFDynamics;
   double Spbar[3] = {0.0, 0.0, 0.0}; //, Sabar[3];
   double Upbar[2] = {0.0, 0.0};      //, Uabar[2];
-  std::deque<support_state_t>::const_iterator SS_it = SupportStates_deq.begin();
+  RingBuffer<support_state_t>::const_iterator SS_it = SupportStates_deq.begin();
   SS_it++;
   for (unsigned int i = 0; i < N_; i++) {
     if (SS_it->Foot == LEFT) {
@@ -572,7 +572,7 @@ int RigidBodySystem::compute_foot_zero_dynamics(
 }
 
 int RigidBodySystem::compute_foot_pol_dynamics(
-    const std::deque<support_state_t> &SupportStates_deq,
+    const RingBuffer<support_state_t> &SupportStates_deq,
     linear_dynamics_t &LeftFootDynamics, linear_dynamics_t &RightFootDynamics) {
 
   // Resize the matrices:
@@ -596,7 +596,7 @@ int RigidBodySystem::compute_foot_pol_dynamics(
   linear_dynamics_t *FFDynamics;
   double Spbar[3], Sabar[3];
   double Upbar[2], Uabar[2];
-  std::deque<support_state_t>::const_iterator SS_it = SupportStates_deq.begin();
+  RingBuffer<support_state_t>::const_iterator SS_it = SupportStates_deq.begin();
   SS_it++;
   for (unsigned int i = 0; i < N_; i++) {
 
@@ -738,10 +738,10 @@ int RigidBodySystem::compute_foot_pol_dynamics(
 
 int RigidBodySystem::generate_trajectories(
     double Time, const solution_t &Solution,
-    const std::deque<support_state_t> &PrwSupportStates_deq,
-    const std::deque<double> &PreviewedSupportAngles_deq,
-    std::deque<FootAbsolutePosition> &LeftFootTraj_deq,
-    std::deque<FootAbsolutePosition> &RightFootTraj_deq) {
+    const RingBuffer<support_state_t> &PrwSupportStates_deq,
+    const RingBuffer<double> &PreviewedSupportAngles_deq,
+    RingBuffer<FootAbsolutePosition> &LeftFootTraj_deq,
+    RingBuffer<FootAbsolutePosition> &RightFootTraj_deq) {
 
   OFTG_->interpolate_feet_positions(Time, PrwSupportStates_deq, Solution,
                                     PreviewedSupportAngles_deq,
@@ -28,6 +28,7 @@
 #include <FootTrajectoryGeneration/OnLineFootTrajectoryGeneration.h>
 #include <PreviewControl/SupportFSM.hh>
 #include <PreviewControl/rigid-body.hh>
+#include <RingBuffer.hh>
 #include <jrl/walkgen/pinocchiorobot.hh>
 #include <privatepgtypes.hh>
 
@@ -55,10 +56,10 @@ public:
   /// \param[in] FinalRightFootTraj_deq
   ///
   /// \return 0
-  int interpolate(solution_t Result, std::deque<ZMPPosition> &FinalZMPTraj_deq,
-                  std::deque<COMState> &FinalCOMTraj_deq,
-                  std::deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-                  std::deque<FootAbsolutePosition> &FinalRightFootTraj_deq);
+  int interpolate(solution_t Result, RingBuffer<ZMPPosition> &FinalZMPTraj_deq,
+                  RingBuffer<COMState> &FinalCOMTraj_deq,
+                  RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+                  RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq);
 
   /// \brief Update feet matrices
   ///
@@ -67,9 +68,9 @@ public:
   /// \param[in] RightFootTraj_deq Final foot trajectory (right foot)
   ///
   /// \return 0
-  int update(const std::deque<support_state_t> &SupportStates_deq,
-             const std::deque<FootAbsolutePosition> &LeftFootTraj_deq,
-             const std::deque<FootAbsolutePosition> &RightFootTraj_deq);
+  int update(const RingBuffer<support_state_t> &SupportStates_deq,
+             const RingBuffer<FootAbsolutePosition> &LeftFootTraj_deq,
+             const RingBuffer<FootAbsolutePosition> &RightFootTraj_deq);
 
   /// \brief Initialize dynamics of the body center
   /// Suppose a piecewise constant jerk
@@ -90,10 +91,10 @@ public:
   /// return 0
   int generate_trajectories(
       double time, const solution_t &Result,
-      const std::deque<support_state_t> &SupportStates_deq,
-      const std::deque<double> &PreviewedSupportAngles_deq,
-      std::deque<FootAbsolutePosition> &LeftFootTraj_deq,
-      std::deque<FootAbsolutePosition> &RightFootTraj_deq);
+      const RingBuffer<support_state_t> &SupportStates_deq,
+      const RingBuffer<double> &PreviewedSupportAngles_deq,
+      RingBuffer<FootAbsolutePosition> &LeftFootTraj_deq,
+      RingBuffer<FootAbsolutePosition> &RightFootTraj_deq);
 
   /// \name Accessors and mutators
   /// \{
@@ -160,7 +161,7 @@ private:
   ///
   /// return 0
   int compute_foot_zero_dynamics(
-      const std::deque<support_state_t> &SupportStates_deq,
+      const RingBuffer<support_state_t> &SupportStates_deq,
       linear_dynamics_t &LeftFootDynamics,
       linear_dynamics_t &RightFootDynamics);
 
@@ -172,7 +173,7 @@ private:
   ///
   /// return 0
   int compute_foot_pol_dynamics(
-      const std::deque<support_state_t> &SupportStates_deq,
+      const RingBuffer<support_state_t> &SupportStates_deq,
       linear_dynamics_t &LeftFootDynamics,
       linear_dynamics_t &RightFootDynamics);
 
@@ -184,7 +185,7 @@ private:
   ///
   /// return 0
   int compute_foot_cjerk_dynamics(
-      const std::deque<support_state_t> &SupportStates_deq,
+      const RingBuffer<support_state_t> &SupportStates_deq,
       linear_dynamics_t &LeftFootDynamics,
       linear_dynamics_t &RightFootDynamics);
 
@@ -194,7 +195,7 @@ private:
   /// \brief Compute predefined trajectories
   /// \param[in] SupportStates_deq Previewed support states
   int precompute_trajectories(
-      const std::deque<support_state_t> &SupportStates_deq);
+      const RingBuffer<support_state_t> &SupportStates_deq);
 
   /// \brief Compute a row of the dynamic matrices Sp and Sa
   /// \param[out] Spbar
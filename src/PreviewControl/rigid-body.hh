@@ -25,6 +25,7 @@
 #ifndef _RIGID_BODY_
 #define _RIGID_BODY_
 
+#include <RingBuffer.hh>
 #include <deque>
 #include <jrl/walkgen/pgtypes.hh>
 #include <privatepgtypes.hh>
@@ -91,8 +92,8 @@ public:
   ~RigidBody();
 
   /// \brief Interpolate
-  int interpolate(std::deque<COMState> &COMStates,
-                  std::deque<ZMPPosition> &ZMPRefPositions, int CurrentPosition,
+  int interpolate(RingBuffer<COMState> &COMStates,
+                  RingBuffer<ZMPPosition> &ZMPRefPositions, int CurrentPosition,
                   double CX, double CY);
 
   /// \brief Initialize
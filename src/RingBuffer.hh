@@ -0,0 +1,402 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file RingBuffer.hh
+  \brief Contiguous double-ended queue used for the trajectories.
+*/
+#ifndef _HWPG_RING_BUFFER_H_
+#define _HWPG_RING_BUFFER_H_
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace PatternGeneratorJRL {
+/*! \brief Double-ended queue stored in one contiguous circular array.
+
+  The interface is the one of std::deque used by the pattern generator.
+  Adding or removing elements at both ends is index arithmetic, and
+  operator[] is a single indirection. The storage only grows when the
+  capacity is exceeded, to the next power of two; once reserve() has been
+  called with the largest size reached by the queue, no operation
+  allocates. The elements out of the queue stay constructed, so T should
+  be cheap to copy, as the trajectory structures are.
+*/
+template <typename T> class RingBuffer {
+public:
+  typedef T value_type;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef T &reference;
+  typedef const T &const_reference;
+  typedef T *pointer;
+  typedef const T *const_pointer;
+
+  /*! \brief Random access iterator, Const selects the const version. */
+  template <bool Const> class iterator_base {
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef typename std::conditional<Const, const T *, T *>::type pointer;
+    typedef typename std::conditional<Const, const T &, T &>::type reference;
+    typedef typename std::conditional<Const, const RingBuffer *,
+                                      RingBuffer *>::type buffer_pointer;
+
+    iterator_base() : m_Buffer(0), m_Index(0) {}
+    iterator_base(buffer_pointer aBuffer, size_type anIndex)
+        : m_Buffer(aBuffer), m_Index(anIndex) {}
+    /// Conversion from iterator to const_iterator.
+    template <bool OtherConst>
+    iterator_base(const iterator_base<OtherConst> &it,
+                  typename std::enable_if<Const && !OtherConst>::type * = 0)
+        : m_Buffer(it.m_Buffer), m_Index(it.m_Index) {}
+
+    reference operator*() const { return (*m_Buffer)[m_Index]; }
+    pointer operator->() const { return &(*m_Buffer)[m_Index]; }
+    reference operator[](difference_type n) const {
+      return (*m_Buffer)[m_Index + n];
+    }
+
+    iterator_base &operator++() {
+      ++m_Index;
+      return *this;
+    }
+    iterator_base operator++(int) {
+      iterator_base tmp(*this);
+      ++m_Index;
+      return tmp;
+    }
+    iterator_base &operator--() {
+      --m_Index;
+      return *this;
+    }
+    iterator_base operator--(int) {
+      iterator_base tmp(*this);
+      --m_Index;
+      return tmp;
+    }
+    iterator_base &operator+=(difference_type n) {
+      m_Index += n;
+      return *this;
+    }
+    iterator_base &operator-=(difference_type n) {
+      m_Index -= n;
+      return *this;
+    }
+    iterator_base operator+(difference_type n) const {
+      return iterator_base(m_Buffer, m_Index + n);
+    }
+    friend iterator_base operator+(difference_type n,
+                                   const iterator_base &it) {
+      return it + n;
+    }
+    iterator_base operator-(difference_type n) const {
+      return iterator_base(m_Buffer, m_Index - n);
+    }
+    template <bool OtherConst>
+    difference_type operator-(const iterator_base<OtherConst> &it) const {
+      return (difference_type)m_Index - (difference_type)it.m_Index;
+    }
+
+    template <bool OtherConst>
+    bool operator==(const iterator_base<OtherConst> &it) const {
+      return m_Index == it.m_Index;
+    }
+    template <bool OtherConst>
+    bool operator!=(const iterator_base<OtherConst> &it) const {
+      return m_Index != it.m_Index;
+    }
+    template <bool OtherConst>
+    bool operator<(const iterator_base<OtherConst> &it) const {
+      return m_Index < it.m_Index;
+    }
+    template <bool OtherConst>
+    bool operator>(const iterator_base<OtherConst> &it) const {
+      return m_Index > it.m_Index;
+    }
+    template <bool OtherConst>
+    bool operator<=(const iterator_base<OtherConst> &it) const {
+      return m_Index <= it.m_Index;
+    }
+    template <bool OtherConst>
+    bool operator>=(const iterator_base<OtherConst> &it) const {
+      return m_Index >= it.m_Index;
+    }
+
+  private:
+    template <bool> friend class iterator_base;
+    friend class RingBuffer;
+    buffer_pointer m_Buffer;
+    /// Position in the queue, not in the storage.
+    size_type m_Index;
+  };
+
+  typedef iterator_base<false> iterator;
+  typedef iterator_base<true> const_iterator;
+  typedef std::reverse_iterator<iterator> reverse_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  /// \name Constructors
+  /// \{
+  RingBuffer() : m_Head(0), m_Size(0), m_Mask(0) {}
+
+  explicit RingBuffer(size_type n, const T &value = T())
+      : m_Head(0), m_Size(0), m_Mask(0) {
+    assign(n, value);
+  }
+
+  template <typename InputIterator>
+  RingBuffer(InputIterator first, InputIterator last,
+             typename std::enable_if<
+                 !std::is_integral<InputIterator>::value>::type * = 0)
+      : m_Head(0), m_Size(0), m_Mask(0) {
+    assign(first, last);
+  }
+
+  RingBuffer(const RingBuffer &aRB) : m_Head(0), m_Size(0), m_Mask(0) {
+    assign(aRB.begin(), aRB.end());
+  }
+
+  /// Copy the elements, the storage is kept if it is large enough.
+  RingBuffer &operator=(const RingBuffer &aRB) {
+    if (this != &aRB)
+      assign(aRB.begin(), aRB.end());
+    return *this;
+  }
+  /// \}
+
+  /// \name Size and capacity
+  /// \{
+  inline size_type size() const { return m_Size; }
+  inline bool empty() const { return m_Size == 0; }
+  inline size_type capacity() const { return m_Data.size(); }
+  inline size_type max_size() const { return m_Data.max_size(); }
+
+  /// Make room for n elements.
+  void reserve(size_type n) {
+    if (n <= m_Data.size())
+      return;
+    size_type lCapacity = 16;
+    while (lCapacity < n)
+      lCapacity *= 2;
+    std::vector<T> lData(lCapacity);
+    for (size_type i = 0; i < m_Size; i++)
+      lData[i] = (*this)[i];
+    m_Data.swap(lData);
+    m_Head = 0;
+    m_Mask = lCapacity - 1;
+  }
+
+  void resize(size_type n, const T &value = T()) {
+    reserve(n);
+    for (size_type i = m_Size; i < n; i++)
+      slot(i) = value;
+    m_Size = n;
+  }
+
+  /// Remove all the elements, the storage is kept.
+  inline void clear() {
+    m_Head = 0;
+    m_Size = 0;
+  }
+  /// \}
+
+  /// \name Element access
+  /// \{
+  inline reference operator[](size_type i) {
+    assert(i < m_Size);
+    return m_Data[(m_Head + i) & m_Mask];
+  }
+  inline const_reference operator[](size_type i) const {
+    assert(i < m_Size);
+    return m_Data[(m_Head + i) & m_Mask];
+  }
+  reference at(size_type i) {
+    if (i >= m_Size)
+      throw std::out_of_range("RingBuffer::at");
+    return (*this)[i];
+  }
+  const_reference at(size_type i) const {
+    if (i >= m_Size)
+      throw std::out_of_range("RingBuffer::at");
+    return (*this)[i];
+  }
+  inline reference front() { return (*this)[0]; }
+  inline const_reference front() const { return (*this)[0]; }
+  inline reference back() { return (*this)[m_Size - 1]; }
+  inline const_reference back() const { return (*this)[m_Size - 1]; }
+  /// \}
+
+  /// \name Iterators
+  /// \{
+  inline iterator begin() { return iterator(this, 0); }
+  inline iterator end() { return iterator(this, m_Size); }
+  inline const_iterator begin() const { return const_iterator(this, 0); }
+  inline const_iterator end() const { return const_iterator(this, m_Size); }
+  inline const_iterator cbegin() const { return begin(); }
+  inline const_iterator cend() const { return end(); }
+  inline reverse_iterator rbegin() { return reverse_iterator(end()); }
+  inline reverse_iterator rend() { return reverse_iterator(begin()); }
+  inline const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  inline const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+  /// \}
+
+  /// \name Modifiers
+  /// \{
+  void push_back(const T &value) {
+    if (m_Size == m_Data.size())
+      reserve(m_Size + 1);
+    slot(m_Size) = value;
+    m_Size++;
+  }
+
+  void push_front(const T &value) {
+    if (m_Size == m_Data.size())
+      reserve(m_Size + 1);
+    m_Head = (m_Head - 1) & m_Mask;
+    m_Data[m_Head] = value;
+    m_Size++;
+  }
+
+  inline void pop_back() {
+    assert(m_Size > 0);
+    m_Size--;
+  }
+
+  inline void pop_front() {
+    assert(m_Size > 0);
+    m_Head = (m_Head + 1) & m_Mask;
+    m_Size--;
+  }
+
+  void assign(size_type n, const T &value) {
+    clear();
+    resize(n, value);
+  }
+
+  template <typename InputIterator>
+  typename std::enable_if<!std::is_integral<InputIterator>::value>::type
+  assign(InputIterator first, InputIterator last) {
+    assign_range(
+        first, last,
+        typename std::iterator_traits<InputIterator>::iterator_category());
+  }
+
+  iterator insert(const_iterator pos, const T &value) {
+    return insert(pos, 1, value);
+  }
+
+  iterator insert(const_iterator pos, size_type n, const T &value) {
+    size_type lIndex = pos.m_Index;
+    size_type lOldSize = m_Size;
+    resize(m_Size + n);
+    std::copy_backward(begin() + lIndex, begin() + lOldSize, end());
+    std::fill(begin() + lIndex, begin() + lIndex + n, value);
+    return begin() + lIndex;
+  }
+
+  template <typename InputIterator>
+  typename std::enable_if<!std::is_integral<InputIterator>::value,
+                          iterator>::type
+  insert(const_iterator pos, InputIterator first, InputIterator last) {
+    size_type lIndex = pos.m_Index;
+    size_type lOldSize = m_Size;
+    for (; first != last; ++first)
+      push_back(*first);
+    std::rotate(begin() + lIndex, begin() + lOldSize, end());
+    return begin() + lIndex;
+  }
+
+  iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    size_type lFirst = first.m_Index, lLast = last.m_Index;
+    if (lFirst == 0) {
+      m_Head = (m_Head + lLast) & m_Mask;
+      m_Size -= lLast;
+      return begin();
+    }
+    std::copy(begin() + lLast, end(), begin() + lFirst);
+    m_Size -= lLast - lFirst;
+    return begin() + lFirst;
+  }
+
+  /// Exchange the contents, without copying the elements.
+  void swap(RingBuffer &aRB) {
+    m_Data.swap(aRB.m_Data);
+    std::swap(m_Head, aRB.m_Head);
+    std::swap(m_Size, aRB.m_Size);
+    std::swap(m_Mask, aRB.m_Mask);
+  }
+  /// \}
+
+private:
+  inline T &slot(size_type i) { return m_Data[(m_Head + i) & m_Mask]; }
+
+  template <typename InputIterator>
+  void assign_range(InputIterator first, InputIterator last,
+                    std::input_iterator_tag) {
+    clear();
+    for (; first != last; ++first)
+      push_back(*first);
+  }
+
+  template <typename ForwardIterator>
+  void assign_range(ForwardIterator first, ForwardIterator last,
+                    std::forward_iterator_tag) {
+    size_type n = (size_type)std::distance(first, last);
+    clear();
+    reserve(n);
+    for (size_type i = 0; first != last; ++first, ++i)
+      m_Data[i] = *first;
+    m_Size = n;
+  }
+
+  /// Storage, its size is zero or a power of two.
+  std::vector<T> m_Data;
+  /// Position of the front element in the storage.
+  size_type m_Head;
+  size_type m_Size;
+  /// Capacity minus one.
+  size_type m_Mask;
+};
+
+template <typename T>
+inline void swap(RingBuffer<T> &aRB1, RingBuffer<T> &aRB2) {
+  aRB1.swap(aRB2);
+}
+
+template <typename T>
+bool operator==(const RingBuffer<T> &aRB1, const RingBuffer<T> &aRB2) {
+  return (aRB1.size() == aRB2.size()) &&
+         std::equal(aRB1.begin(), aRB1.end(), aRB2.begin());
+}
+} // namespace PatternGeneratorJRL
+#endif /* _HWPG_RING_BUFFER_H_ */
@@ -1,11 +1,18 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <typeinfo>
 using namespace std;
 
 #include "pinocchio/algorithm/center-of-mass.hpp"
+#include "pinocchio/algorithm/centroidal.hpp"
+#include "pinocchio/algorithm/jacobian.hpp"
 #include "pinocchio/algorithm/kinematics.hpp"
 #include "pinocchio/algorithm/rnea.hpp"
+#include "pinocchio/serialization/model.hpp"
 #include <Debug.hh>
 #include <jrl/walkgen/pinocchiorobot.hh>
 using namespace PatternGeneratorJRL;
@@ -30,6 +37,8 @@ PinocchioRobot::PinocchioRobot() {
   m_robotModel = 0;
   m_robotData = 0;
   m_robotDataInInitialePose = 0;
+  m_ownedRobotData = 0;
+  m_sharedModel = false;
 
   // init quaternion as unit zero rotation
   m_quat = Eigen::Quaterniond(Eigen::AngleAxisd(0.0, Eigen::Vector3d::UnitZ()) *
@@ -83,10 +92,69 @@ PinocchioRobot::PinocchioRobot() {
 }
 
 PinocchioRobot::~PinocchioRobot() {
-  if (m_robotDataInInitialePose != 0) {
+  if ((m_robotDataInInitialePose != 0) && !m_sharedModel) {
     delete m_robotDataInInitialePose;
     m_robotDataInInitialePose = 0;
   }
+  if (m_ownedRobotData != 0) {
+    delete m_ownedRobotData;
+    m_ownedRobotData = 0;
+  }
+}
+
+PinocchioRobot *PinocchioRobot::clone() const {
+  if (!(m_boolModel && m_boolData && m_boolLeftFoot && m_boolRightFoot))
+    return 0;
+
+  PinocchioRobot *aPR = new PinocchioRobot(*this);
+  aPR->m_sharedModel = true;
+  aPR->m_ownedRobotData = new pinocchio::Data(*m_robotModel);
+  aPR->m_robotData = aPR->m_ownedRobotData;
+  aPR->m_robotData->v[0] = pinocchio::Motion::Zero();
+  aPR->m_robotData->a[0] = -m_robotModel->gravity;
+  return aPR;
+}
+
+PinocchioRobotPool::PinocchioRobotPool(const PinocchioRobot &aPrototype,
+                                       std::size_t NbRobots)
+    : m_Prototype(aPrototype) {
+  for (std::size_t i = 0; i < NbRobots; i++) {
+    PinocchioRobot *aPR = m_Prototype.clone();
+    if (aPR == 0)
+      break;
+    m_Robots.push_back(aPR);
+    m_FreeRobots.push_back(aPR);
+  }
+}
+
+PinocchioRobotPool::~PinocchioRobotPool() {
+  for (std::size_t i = 0; i < m_Robots.size(); i++)
+    delete m_Robots[i];
+}
+
+PinocchioRobot *PinocchioRobotPool::acquire() {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if (!m_FreeRobots.empty()) {
+    PinocchioRobot *aPR = m_FreeRobots.back();
+    m_FreeRobots.pop_back();
+    return aPR;
+  }
+  PinocchioRobot *aPR = m_Prototype.clone();
+  if (aPR != 0)
+    m_Robots.push_back(aPR);
+  return aPR;
+}
+
+void PinocchioRobotPool::release(PinocchioRobot *aPR) {
+  if (aPR == 0)
+    return;
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_FreeRobots.push_back(aPR);
+}
+
+std::size_t PinocchioRobotPool::size() {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Robots.size();
 }
 
 bool PinocchioRobot::checkModel(pinocchio::Model *robotModel) {
@@ -171,7 +239,20 @@ bool PinocchioRobot::initializeRobotModelAndData(pinocchio::Model *robotModel,
 
   ComputeRootSize();
 
+  if (!initializeData(robotData))
+    return false;
+
+  if (testLegsInverseKinematics())
+    initializeLegsInverseKinematics();
+
+  return true;
+}
+
+bool PinocchioRobot::initializeData(pinocchio::Data *robotData) {
   // intialize the "initial pose" (q=[0]) data
+  if ((m_robotDataInInitialePose != 0) && !m_sharedModel)
+    delete m_robotDataInInitialePose;
+  m_sharedModel = false;
   m_robotDataInInitialePose = new pinocchio::Data(*m_robotModel);
   m_robotDataInInitialePose->v[0] = pinocchio::Motion::Zero();
   m_robotDataInInitialePose->a[0] = -m_robotModel->gravity;
@@ -193,6 +274,11 @@ bool PinocchioRobot::initializeRobotModelAndData(pinocchio::Model *robotModel,
 
   m_tau.resize(m_robotModel->nv);
   m_tau.setZero();
+
+  m_qLeg = m_qpino;
+  m_vLeg.setZero(m_robotModel->nv);
+  m_JLeg.setZero(6, m_robotModel->nv);
+  m_dJLeg.setZero(6, m_robotModel->nv);
   pinocchio::forwardKinematics(*m_robotModel, *m_robotDataInInitialePose,
                                m_qpino);
 
@@ -212,10 +298,6 @@ bool PinocchioRobot::initializeRobotModelAndData(pinocchio::Model *robotModel,
   m_robotData = robotData;
   m_robotData->v[0] = pinocchio::Motion::Zero();
   m_robotData->a[0] = -m_robotModel->gravity;
-
-  if (testLegsInverseKinematics())
-    initializeLegsInverseKinematics();
-
   return true;
 }
 
@@ -231,6 +313,193 @@ bool PinocchioRobot::initializeRightFoot(PRFoot rightFoot) {
   return true;
 }
 
+namespace {
+/// Tag and version of the files written by PinocchioRobot::saveCache.
+const char CacheMagic[8] = {'P', 'R', 'C', 'A', 'C', 'H', 'E', '2'};
+
+template <typename T> void writeCache(std::ostream &os, const T &value) {
+  os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> void readCache(std::istream &is, T &value) {
+  is.read(reinterpret_cast<char *>(&value), sizeof(T));
+}
+
+void writeCache(std::ostream &os, const Eigen::Vector3d &value) {
+  os.write(reinterpret_cast<const char *>(value.data()), 3 * sizeof(double));
+}
+
+void readCache(std::istream &is, Eigen::Vector3d &value) {
+  is.read(reinterpret_cast<char *>(value.data()), 3 * sizeof(double));
+}
+
+void writeCache(std::ostream &os, const PRFoot &aFoot) {
+  writeCache(os, aFoot.associatedAnkle);
+  writeCache(os, aFoot.soleDepth);
+  writeCache(os, aFoot.soleWidth);
+  writeCache(os, aFoot.soleHeight);
+  writeCache(os, aFoot.anklePosition);
+}
+
+void readCache(std::istream &is, PRFoot &aFoot) {
+  readCache(is, aFoot.associatedAnkle);
+  readCache(is, aFoot.soleDepth);
+  readCache(is, aFoot.soleWidth);
+  readCache(is, aFoot.soleHeight);
+  readCache(is, aFoot.anklePosition);
+}
+
+/// Checksum of the model file of a cache.
+std::uint64_t modelChecksum(const std::string &fileName) {
+  return PinocchioRobot::cacheKey(std::vector<std::string>(1, fileName));
+}
+
+/// Open the description of a cache, and check that it was saved
+/// with this version and the given key, along with the model file.
+bool openCache(const std::string &prefix, std::uint64_t key,
+               std::ifstream &aif) {
+  aif.open((prefix + ".meta").c_str(), std::ios::in | std::ios::binary);
+  if (!aif.is_open())
+    return false;
+  char lMagic[sizeof(CacheMagic)];
+  std::uint64_t lKey = 0, lChecksum = 0;
+  aif.read(lMagic, sizeof(lMagic));
+  readCache(aif, lKey);
+  readCache(aif, lChecksum);
+  return aif.good() &&
+         std::equal(lMagic, lMagic + sizeof(lMagic), CacheMagic) &&
+         (lKey == key) && (lChecksum == modelChecksum(prefix + ".model"));
+}
+} // namespace
+
+std::uint64_t
+PinocchioRobot::cacheKey(const std::vector<std::string> &fileNames) {
+  // FNV-1a on the content of the files.
+  std::uint64_t lKey = 14695981039346656037ULL;
+  for (std::size_t i = 0; i < fileNames.size(); i++) {
+    std::ifstream aif(fileNames[i].c_str(), std::ios::in | std::ios::binary);
+    std::istreambuf_iterator<char> it(aif), end;
+    for (; it != end; ++it) {
+      lKey ^= (unsigned char)*it;
+      lKey *= 1099511628211ULL;
+    }
+    // Separate the files, so that moving bytes between them
+    // changes the key.
+    lKey ^= 0xff;
+    lKey *= 1099511628211ULL;
+  }
+  return lKey;
+}
+
+bool PinocchioRobot::saveCache(const std::string &prefix,
+                               std::uint64_t key) const {
+  if (!(m_boolModel && m_boolLeftFoot && m_boolRightFoot))
+    return false;
+  // Both files are written under temporary names, then renamed.
+  // The description holds the checksum of the model: a reader
+  // between both renames, or after an interruption, finds that
+  // they do not match.
+  std::string lModelName = prefix + ".model", lMetaName = prefix + ".meta";
+  std::string lModelTmpName = lModelName + ".tmp";
+  std::string lMetaTmpName = lMetaName + ".tmp";
+  try {
+    m_robotModel->saveToBinary(lModelTmpName);
+  } catch (std::exception &e) {
+    std::cerr << "PinocchioRobot: unable to save the model in "
+              << lModelTmpName << ": " << e.what() << std::endl;
+    std::remove(lModelTmpName.c_str());
+    return false;
+  }
+
+  std::ofstream aof(lMetaTmpName.c_str(),
+                    std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!aof.is_open()) {
+    std::remove(lModelTmpName.c_str());
+    return false;
+  }
+  aof.write(CacheMagic, sizeof(CacheMagic));
+  writeCache(aof, key);
+  writeCache(aof, modelChecksum(lModelTmpName));
+  writeCache(aof, m_chest);
+  writeCache(aof, m_waist);
+  writeCache(aof, m_leftShoulder);
+  writeCache(aof, m_rightShoulder);
+  writeCache(aof, m_leftWrist);
+  writeCache(aof, m_rightWrist);
+  writeCache(aof, m_leftFoot);
+  writeCache(aof, m_rightFoot);
+  writeCache(aof, m_PinoFreeFlyerSize);
+  writeCache(aof, m_PinoFreeFlyerVelSize);
+  writeCache(aof, m_isLegInverseKinematic);
+  writeCache(aof, m_modeLegInverseKinematic);
+  writeCache(aof, m_isArmInverseKinematic);
+  writeCache(aof, m_leftDt);
+  writeCache(aof, m_rightDt);
+  writeCache(aof, m_femurLength);
+  writeCache(aof, m_tibiaLengthZ);
+  writeCache(aof, m_tibiaLengthY);
+  aof.close();
+  if (aof.fail() ||
+      (std::rename(lModelTmpName.c_str(), lModelName.c_str()) != 0) ||
+      (std::rename(lMetaTmpName.c_str(), lMetaName.c_str()) != 0)) {
+    std::remove(lModelTmpName.c_str());
+    std::remove(lMetaTmpName.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool PinocchioRobot::loadModelFromCache(const std::string &prefix,
+                                        std::uint64_t key,
+                                        pinocchio::Model &robotModel) {
+  std::ifstream aif;
+  if (!openCache(prefix, key, aif))
+    return false;
+  try {
+    robotModel.loadFromBinary(prefix + ".model");
+  } catch (std::exception &e) {
+    std::cerr << "PinocchioRobot: unable to load the model from " << prefix
+              << ".model: " << e.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool PinocchioRobot::initializeFromCache(const std::string &prefix,
+                                         std::uint64_t key,
+                                         pinocchio::Model *robotModel,
+                                         pinocchio::Data *robotData) {
+  std::ifstream aif;
+  if (!openCache(prefix, key, aif))
+    return false;
+  readCache(aif, m_chest);
+  readCache(aif, m_waist);
+  readCache(aif, m_leftShoulder);
+  readCache(aif, m_rightShoulder);
+  readCache(aif, m_leftWrist);
+  readCache(aif, m_rightWrist);
+  readCache(aif, m_leftFoot);
+  readCache(aif, m_rightFoot);
+  readCache(aif, m_PinoFreeFlyerSize);
+  readCache(aif, m_PinoFreeFlyerVelSize);
+  readCache(aif, m_isLegInverseKinematic);
+  readCache(aif, m_modeLegInverseKinematic);
+  readCache(aif, m_isArmInverseKinematic);
+  readCache(aif, m_leftDt);
+  readCache(aif, m_rightDt);
+  readCache(aif, m_femurLength);
+  readCache(aif, m_tibiaLengthZ);
+  readCache(aif, m_tibiaLengthY);
+  if (!aif.good())
+    return false;
+
+  m_robotModel = robotModel;
+  m_boolModel = true;
+  m_boolLeftFoot = true;
+  m_boolRightFoot = true;
+  return initializeData(robotData);
+}
+
 bool PinocchioRobot::testOneModeOfLegsInverseKinematics(
     std::vector<std::string> &leftLegJointName,
     std::vector<std::string> &rightLegJointName) {
@@ -383,6 +652,21 @@ void PinocchioRobot::initializeLegsInverseKinematics() {
   return;
 }
 
+void PinocchioRobot::RPYToQuaternion(double roll, double pitch, double yaw,
+                                     Eigen::Ref<Eigen::Vector4d> quat) {
+  // Product of the half angle rotations about z, y and x, in the
+  // pinocchio order [x y z w]: same as the AngleAxis product, without
+  // going through the rotation matrix.
+  double cr, sr, cp, sp, cy, sy;
+  pinocchio::SINCOS(0.5 * roll, &sr, &cr);
+  pinocchio::SINCOS(0.5 * pitch, &sp, &cp);
+  pinocchio::SINCOS(0.5 * yaw, &sy, &cy);
+  quat(0) = sr * cp * cy - cr * sp * sy;
+  quat(1) = cr * sp * cy + sr * cp * sy;
+  quat(2) = cr * cp * sy - sr * sp * cy;
+  quat(3) = cr * cp * cy + sr * sp * sy;
+}
+
 void PinocchioRobot::RPYToSpatialFreeFlyer(
     Eigen::Vector3d &rpy, Eigen::Vector3d &drpy, Eigen::Vector3d &ddrpy,
     Eigen::Quaterniond &quat, Eigen::Vector3d &omega, Eigen::Vector3d &domega) {
@@ -419,25 +703,16 @@ void PinocchioRobot::currentPinoConfiguration(Eigen::VectorXd &conf) {
 
 void PinocchioRobot::currentRPYConfiguration(Eigen::VectorXd &conf) {
   m_qrpy = conf;
+  RPYToPinocchioConfiguration(conf, m_qpino);
+}
 
-  m_quat =
-      Eigen::Quaterniond(Eigen::AngleAxisd(conf(5), Eigen::Vector3d::UnitZ()) *
-                         Eigen::AngleAxisd(conf(4), Eigen::Vector3d::UnitY()) *
-                         Eigen::AngleAxisd(conf(3), Eigen::Vector3d::UnitX()));
-  m_quat.normalize();
-
-  for (unsigned i = 0; i < 3; ++i) {
-    m_qpino(i) = conf(i);
-  }
-  // fill up m_q following the pinocchio standard : [pos quarternion DoFs]
-  m_qpino(3) = m_quat.x();
-  m_qpino(4) = m_quat.y();
-  m_qpino(5) = m_quat.z();
-  m_qpino(6) = m_quat.w();
-
-  for (unsigned i = 6; i < conf.size(); ++i) {
-    m_qpino(i + 1) = conf(i);
-  }
+void PinocchioRobot::RPYToPinocchioConfiguration(const Eigen::VectorXd &qrpy,
+                                                 Eigen::VectorXd &qpino) const {
+  qpino.resize(qrpy.size() + 1);
+  qpino.head<3>() = qrpy.head<3>();
+  // fill up q following the pinocchio standard : [pos quarternion DoFs]
+  RPYToQuaternion(qrpy(3), qrpy(4), qrpy(5), qpino.segment<4>(3));
+  qpino.tail(qrpy.size() - 6) = qrpy.tail(qrpy.size() - 6);
 }
 
 void PinocchioRobot::computeInverseDynamics() {
@@ -447,41 +722,48 @@ void PinocchioRobot::computeInverseDynamics() {
 void PinocchioRobot::computeInverseDynamics(Eigen::VectorXd &q,
                                             Eigen::VectorXd &v,
                                             Eigen::VectorXd &a) {
-  //  for(unsigned i=0;i<3;++i)
-  //  {
-  //    m_rpy   (i) = q(3+i);
-  //    m_drpy  (i) = v(3+i);
-  //    m_ddrpy (i) = a(3+i);
-  //  }
-  //  RPYToSpatialFreeFlyer(m_rpy,m_drpy,m_ddrpy,
-  //                        m_quat,m_omega,m_domega);
-  // euler to quaternion :
-  m_quat =
-      Eigen::Quaterniond(Eigen::AngleAxisd(q(5), Eigen::Vector3d::UnitZ()) *
-                         Eigen::AngleAxisd(q(4), Eigen::Vector3d::UnitY()) *
-                         Eigen::AngleAxisd(q(3), Eigen::Vector3d::UnitX()));
-  for (unsigned i = 0; i < 3; ++i) {
-    m_qpino(i) = q(i);
-  }
-  m_rot = m_quat.toRotationMatrix().transpose();
-  m_vpino.segment<3>(0) = m_rot * m_vpino.segment<3>(0);
-  m_apino.segment<3>(0) = m_rot * m_apino.segment<3>(0);
-
-  // fill up m_q following the pinocchio standard : [pos quarternion DoFs]
-  m_qpino(3) = m_quat.x();
-  m_qpino(4) = m_quat.y();
-  m_qpino(5) = m_quat.z();
-  m_qpino(6) = m_quat.w();
-
-  // fill up the velocity and acceleration vectors
-  m_vpino = v;
-  m_apino = a;
+  RPYToPinocchioState(q, v, a);
 
   // performing the inverse dynamics
   m_tau =
       pinocchio::rnea(*m_robotModel, *m_robotData, m_qpino, m_vpino, m_apino);
 }
 
+void PinocchioRobot::computeCentroidalDynamics(Eigen::VectorXd &q,
+                                               Eigen::VectorXd &v,
+                                               Eigen::VectorXd &a) {
+  RPYToPinocchioState(q, v, a);
+  pinocchio::computeCentroidalMomentumTimeVariation(
+      *m_robotModel, *m_robotData, m_qpino, m_vpino, m_apino);
+}
+
+void PinocchioRobot::computeInverseDynamicsFromPinocchio(
+    const Eigen::VectorXd &q, const Eigen::VectorXd &v,
+    const Eigen::VectorXd &a) {
+  m_tau = pinocchio::rnea(*m_robotModel, *m_robotData, q, v, a);
+}
+
+void PinocchioRobot::computeCentroidalDynamicsFromPinocchio(
+    const Eigen::VectorXd &q, const Eigen::VectorXd &v,
+    const Eigen::VectorXd &a) {
+  pinocchio::computeCentroidalMomentumTimeVariation(*m_robotModel,
+                                                    *m_robotData, q, v, a);
+}
+
+void PinocchioRobot::RPYToPinocchioState(Eigen::VectorXd &q,
+                                         Eigen::VectorXd &v,
+                                         Eigen::VectorXd &a) {
+  // The velocity and the acceleration of the free flyer are already
+  // spatial, only its orientation is converted. The joints are the
+  // ones of the last configuration given to the robot.
+  m_qpino.head<3>() = q.head<3>();
+  RPYToQuaternion(q(3), q(4), q(5), m_qpino.segment<4>(3));
+
+  // fill up the velocity and acceleration vectors
+  m_vpino = v;
+  m_apino = a;
+}
+
 std::vector<pinocchio::JointIndex>
 PinocchioRobot::fromRootToIt(pinocchio::JointIndex it) {
   std::vector<pinocchio::JointIndex> fromRootToIt;
@@ -703,6 +985,194 @@ void PinocchioRobot::getWaistFootKinematics(
   }
 }
 
+namespace {
+/// Legs solved together by ComputeLegsInverseKinematics.
+const int NbLanes = 8;
+typedef Eigen::Array<double, NbLanes, 1> lanes_t;
+
+void atan2Lanes(const lanes_t &y, const lanes_t &x, lanes_t &r) {
+  for (int l = 0; l < NbLanes; l++)
+    r(l) = std::atan2(y(l), x(l));
+}
+} // namespace
+
+bool PinocchioRobot::ComputeLegsInverseKinematics(
+    const PRLegsBatch &legs, Eigen::Array<double, Eigen::Dynamic, 6> &q,
+    Eigen::Array<bool, Eigen::Dynamic, 1> &feasible) const {
+  Eigen::Index n = legs.size();
+  if (q.rows() != n)
+    q.resize(n, 6);
+  if (feasible.rows() != n)
+    feasible.resize(n);
+  return ComputeLegsInverseKinematics(legs, 0, n, q, feasible);
+}
+
+bool PinocchioRobot::ComputeLegsInverseKinematics(
+    const PRLegsBatch &legs, Eigen::Index first, Eigen::Index n,
+    Eigen::Array<double, Eigen::Dynamic, 6> &q,
+    Eigen::Array<bool, Eigen::Dynamic, 1> &feasible) const {
+  if (!m_isLegInverseKinematic) {
+    q.middleRows(first, n).setZero();
+    feasible.segment(first, n).setConstant(false);
+    return false;
+  }
+  for (Eigen::Index i = first; i < first + n; i += NbLanes)
+    getWaistFootKinematicsBlock(
+        legs, i, std::min<Eigen::Index>(NbLanes, first + n - i), q, feasible);
+  return true;
+}
+
+bool PinocchioRobot::ComputeLegJointRates(
+    pinocchio::JointIndex ankle, const Eigen::VectorXd &qrpy,
+    const Eigen::Matrix<double, 6, 1> &V, const Eigen::Matrix<double, 6, 1> &A,
+    Eigen::VectorXd &v, Eigen::VectorXd &a) {
+  // First joint of the leg, the joints of the leg are consecutive in
+  // the velocity.
+  pinocchio::JointIndex hip = ankle;
+  while ((hip != 0) && (m_robotModel->parents[hip] != m_waist))
+    hip = m_robotModel->parents[hip];
+  if (hip == 0)
+    return false;
+  int first = pinocchio::idx_v(m_robotModel->joints[hip]);
+  if (pinocchio::idx_v(m_robotModel->joints[ankle]) +
+          pinocchio::nv(m_robotModel->joints[ankle]) - first !=
+      6)
+    return false;
+
+  // The free flyer is left at the identity: the jacobians are the ones
+  // of the ankle in the waist frame.
+  m_qLeg.setZero();
+  m_qLeg[6] = 1.0;
+  m_qLeg.tail(qrpy.size() - 6) = qrpy.tail(qrpy.size() - 6);
+  pinocchio::computeJointJacobians(*m_robotModel, *m_robotData, m_qLeg);
+  m_JLeg.setZero();
+  pinocchio::getJointJacobian(*m_robotModel, *m_robotData, ankle,
+                              pinocchio::LOCAL_WORLD_ALIGNED, m_JLeg);
+  Eigen::PartialPivLU<Eigen::Matrix<double, 6, 6> > lJ(
+      m_JLeg.middleCols<6>(first));
+  if (std::fabs(lJ.determinant()) < 1e-12)
+    return false;
+  Eigen::Matrix<double, 6, 1> dq = lJ.solve(V);
+
+  m_vLeg.setZero();
+  m_vLeg.segment<6>(first) = dq;
+  pinocchio::computeJointJacobiansTimeVariation(*m_robotModel, *m_robotData,
+                                                m_qLeg, m_vLeg);
+  m_dJLeg.setZero();
+  pinocchio::getJointJacobianTimeVariation(*m_robotModel, *m_robotData,
+                                           ankle,
+                                           pinocchio::LOCAL_WORLD_ALIGNED,
+                                           m_dJLeg);
+  v.segment<6>(first) = dq;
+  a.segment<6>(first) = lJ.solve(A - m_dJLeg.middleCols<6>(first) * dq);
+  return true;
+}
+
+void PinocchioRobot::getWaistFootKinematicsBlock(
+    const PRLegsBatch &legs, Eigen::Index first, Eigen::Index n,
+    Eigen::Array<double, Eigen::Dynamic, 6> &q,
+    Eigen::Array<bool, Eigen::Dynamic, 1> &feasible) const {
+  const double _epsilon = 1.0e-6;
+  const double A = m_femurLength;
+  const double B = m_tibiaLengthZ;
+  const double C = m_tibiaLengthY;
+
+  // Gather the block, the lanes after the last leg repeat it.
+  lanes_t Body_R[9], Foot_R[9], Body_P[3], Foot_P[3], side;
+  for (int k = 0; k < 9; k++)
+    for (int l = 0; l < NbLanes; l++) {
+      Eigen::Index i = first + std::min<Eigen::Index>(l, n - 1);
+      Body_R[k](l) = legs.waistRotation(i, k);
+      Foot_R[k](l) = legs.ankleRotation(i, k);
+    }
+  for (int k = 0; k < 3; k++)
+    for (int l = 0; l < NbLanes; l++) {
+      Eigen::Index i = first + std::min<Eigen::Index>(l, n - 1);
+      Body_P[k](l) = legs.waistPosition(i, k);
+      Foot_P[k](l) = legs.anklePosition(i, k);
+    }
+  for (int l = 0; l < NbLanes; l++)
+    side(l) = legs.side(first + std::min<Eigen::Index>(l, n - 1));
+
+  lanes_t Dt[3];
+  for (int k = 0; k < 3; k++)
+    Dt[k] = (side > 0.0).select(lanes_t::Constant(m_leftDt(k)),
+                                lanes_t::Constant(m_rightDt(k)));
+  lanes_t OppSignOfDtY =
+      (Dt[1] < 0.0).select(lanes_t::Constant(1.0), lanes_t::Constant(-1.0));
+
+  // d3 = Body_P + Body_R * Dt - Foot_P
+  lanes_t d3[3];
+  for (int k = 0; k < 3; k++)
+    d3[k] = Body_P[k] + Body_R[3 * k] * Dt[0] + Body_R[3 * k + 1] * Dt[1] +
+            Body_R[3 * k + 2] * Dt[2] - Foot_P[k];
+
+  lanes_t l0 = (d3[0] * d3[0] + d3[1] * d3[1] + d3[2] * d3[2] - C * C).sqrt();
+  lanes_t c5 = 0.5 * (l0 * l0 - A * A - B * B) / (A * B);
+  lanes_t q3 = (c5 > 1.0 - _epsilon)
+                   .select(lanes_t::Zero(),
+                           (c5 < -1.0 + _epsilon)
+                               .select(lanes_t::Constant(M_PI), c5.acos()));
+
+  // r3 = Foot_R^T * d3
+  lanes_t r3[3];
+  for (int k = 0; k < 3; k++)
+    r3[k] = Foot_R[k] * d3[0] + Foot_R[3 + k] * d3[1] + Foot_R[6 + k] * d3[2];
+
+  lanes_t q6a = ((A / l0) * (M_PI - q3).sin()).asin();
+
+  lanes_t l3 = (r3[1] * r3[1] + r3[2] * r3[2]).sqrt();
+  lanes_t l4 = (l3 * l3 - C * C).sqrt();
+
+  lanes_t phi, psi1, psi3;
+  atan2Lanes(r3[0], l4, phi);
+  lanes_t q4 = -phi - q6a;
+
+  atan2Lanes(r3[1], r3[2], psi1);
+  psi1 *= OppSignOfDtY;
+  lanes_t psi2 = 0.5 * M_PI - psi1;
+  atan2Lanes(l4, lanes_t::Constant(C), psi3);
+  lanes_t q5 = (psi3 - psi2) * OppSignOfDtY;
+  q5 = (q5 > 0.5 * M_PI)
+           .select(q5 - M_PI, (q5 < -0.5 * M_PI).select(q5 + M_PI, q5));
+
+  // Only the coefficients of R = Body_R^T * Foot_R * Rroll * Rpitch
+  // used below.
+  lanes_t M[9];
+  for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 3; j++)
+      M[3 * i + j] = Body_R[i] * Foot_R[j] + Body_R[3 + i] * Foot_R[3 + j] +
+                     Body_R[6 + i] * Foot_R[6 + j];
+  lanes_t c = q5.cos(), s = q5.sin();
+  lanes_t cp = (q4 + q3).cos(), sp = (q4 + q3).sin();
+  lanes_t R01 = M[1] * c - M[2] * s;
+  lanes_t R11 = M[4] * c - M[5] * s;
+  lanes_t R21 = M[7] * c - M[8] * s;
+  lanes_t R20 = M[6] * cp + (M[7] * s + M[8] * c) * sp;
+  lanes_t R22 = -M[6] * sp + (M[7] * s + M[8] * c) * cp;
+
+  lanes_t q0, q1, q2;
+  atan2Lanes(-R01, R11, q0);
+  atan2Lanes(R21, -R01 * q0.sin() + R11 * q0.cos(), q1);
+  atan2Lanes(-R20, R22, q2);
+
+  const lanes_t *lq[6] = {&q0, &q1, &q2, &q3, &q4, &q5};
+  if (m_modeLegInverseKinematic == 1) {
+    lq[0] = &q1;
+    lq[1] = &q2;
+    lq[2] = &q0;
+  }
+  Eigen::Array<bool, NbLanes, 1> lFeasible =
+      (c5 >= -1.0 + _epsilon) && (c5 <= 1.0 - _epsilon) && (l3 >= C);
+  for (int j = 0; j < 6; j++) {
+    lFeasible = lFeasible && lq[j]->isFinite();
+    for (Eigen::Index l = 0; l < n; l++)
+      q(first + l, j) = (*lq[j])(l);
+  }
+  for (Eigen::Index l = 0; l < n; l++)
+    feasible(first + l) = lFeasible(l);
+}
+
 double PinocchioRobot::ComputeXmax(double &Z) {
   double A = 0.25, B = 0.25;
   double Xmax;
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file SPSCQueue.hh
+  \brief Bounded queue between one producer and one consumer thread.
+*/
+#ifndef _HWPG_SPSC_QUEUE_H_
+#define _HWPG_SPSC_QUEUE_H_
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace PatternGeneratorJRL {
+/*! \brief Lock-free queue with a single producer and a single consumer.
+
+  The elements are allocated once by the constructor and stay in place:
+  the producer fills the slot returned by back() and publishes it with
+  push(), the consumer reads front() and releases it with pop(). Slots
+  are reused, so elements owning storage (RingBuffer, Eigen matrices)
+  do not allocate once they have reached their largest size.
+
+  Neither side blocks; a thread waiting for the other one has to be
+  woken up by other means.
+*/
+template <typename T> class SPSCQueue {
+public:
+  typedef std::size_t size_type;
+
+  explicit SPSCQueue(size_type capacity = 1)
+      : m_Slots(capacity + 1), m_Head(0), m_Tail(0) {
+    assert(capacity > 0);
+  }
+
+  /// Maximal number of elements in the queue.
+  inline size_type capacity() const { return m_Slots.size() - 1; }
+
+  /// \name Producer side
+  /// \{
+  /// Slot to fill before push(), 0 if the queue is full.
+  T *back() {
+    size_type lTail = m_Tail.load(std::memory_order_relaxed);
+    if (next(lTail) == m_Head.load(std::memory_order_acquire))
+      return 0;
+    return &m_Slots[lTail];
+  }
+
+  /// Publish the slot returned by back().
+  void push() {
+    size_type lTail = m_Tail.load(std::memory_order_relaxed);
+    assert(next(lTail) != m_Head.load(std::memory_order_acquire));
+    m_Tail.store(next(lTail), std::memory_order_release);
+  }
+  /// \}
+
+  /// \name Consumer side
+  /// \{
+  /// Oldest published element, 0 if the queue is empty.
+  T *front() {
+    size_type lHead = m_Head.load(std::memory_order_relaxed);
+    if (lHead == m_Tail.load(std::memory_order_acquire))
+      return 0;
+    return &m_Slots[lHead];
+  }
+
+  /// Give the slot returned by front() back to the producer.
+  void pop() {
+    size_type lHead = m_Head.load(std::memory_order_relaxed);
+    assert(lHead != m_Tail.load(std::memory_order_acquire));
+    m_Head.store(next(lHead), std::memory_order_release);
+  }
+  /// \}
+
+  /// Empty the queue, only when neither thread uses it.
+  void clear() {
+    m_Head.store(0, std::memory_order_relaxed);
+    m_Tail.store(0, std::memory_order_relaxed);
+  }
+
+private:
+  inline size_type next(size_type i) const {
+    return (i + 1 == m_Slots.size()) ? 0 : i + 1;
+  }
+
+  /// One slot stays free to tell a full queue from an empty one.
+  std::vector<T> m_Slots;
+  /// Next slot to read, written by the consumer.
+  std::atomic<size_type> m_Head;
+  /// Next slot to write, written by the producer.
+  std::atomic<size_type> m_Tail;
+};
+} // namespace PatternGeneratorJRL
+#endif /* _HWPG_SPSC_QUEUE_H_ */
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+
+/*! \file TrajectoryBlock.hh
+  \brief Structure of arrays storage for blocks of trajectory samples.
+*/
+#ifndef _HWPG_TRAJECTORY_BLOCK_H_
+#define _HWPG_TRAJECTORY_BLOCK_H_
+#include <cassert>
+#include <cstddef>
+
+#include <Eigen/Dense>
+
+#include <jrl/walkgen/pgtypes.hh>
+
+namespace PatternGeneratorJRL {
+/*! Fields of COMState, combined as a mask to select the ones
+  transferred between a COMStateBlock and a queue of COMState. */
+enum com_field_e {
+  COM_X = 1,
+  COM_Y = 2,
+  COM_Z = 4,
+  COM_YAW = 8,
+  COM_PITCH = 16,
+  COM_ROLL = 32,
+  COM_XY = COM_X | COM_Y,
+  COM_ALL = 63
+};
+
+/*! \brief Block of CoM states stored as a structure of arrays.
+
+  Each axis is a matrix with one row per sample and one column per
+  derivative, stored column-major: a pass over the position of all the
+  samples along x reads contiguous memory, and Eigen vectorizes it.
+  The conversions from and to the public COMState only touch the fields
+  given in the mask, and work on any queue with operator[]
+  (RingBuffer, std::deque, std::vector).
+
+  The storage is only allocated by resize(), the other methods work
+  on the first samples of the block.
+*/
+struct COMStateBlock {
+  typedef Eigen::Matrix<double, Eigen::Dynamic, 3> axis_t;
+
+  axis_t x, y, z;
+  axis_t yaw, pitch, roll;
+
+  inline std::size_t size() const { return (std::size_t)x.rows(); }
+
+  /// Allocate n samples, the content is not initialized.
+  void resize(std::size_t n) {
+    for (unsigned int k = 0; k < 6; k++)
+      axis(k).resize((Eigen::Index)n, 3);
+  }
+
+  void setZero(unsigned int fields = COM_ALL) {
+    for (unsigned int k = 0; k < 6; k++)
+      if (fields & (1u << k))
+        axis(k).setZero();
+  }
+
+  /// Copy the n samples of aQueue starting at first in the block.
+  template <typename Queue>
+  void load(const Queue &aQueue, std::size_t first, std::size_t n,
+            unsigned int fields = COM_ALL) {
+    assert(n <= size());
+    for (unsigned int k = 0; k < 6; k++) {
+      if (!(fields & (1u << k)))
+        continue;
+      axis_t &lAxis = axis(k);
+      double(COMState::*lMember)[3] = member(k);
+      for (std::size_t i = 0; i < n; i++)
+        for (int j = 0; j < 3; j++)
+          lAxis((Eigen::Index)i, j) = (aQueue[first + i].*lMember)[j];
+    }
+  }
+
+  /// Copy the first n samples of the block in aQueue starting at first.
+  template <typename Queue>
+  void store(Queue &aQueue, std::size_t first, std::size_t n,
+             unsigned int fields = COM_ALL) const {
+    assert(n <= size());
+    for (unsigned int k = 0; k < 6; k++) {
+      if (!(fields & (1u << k)))
+        continue;
+      const axis_t &lAxis = axis(k);
+      double(COMState::*lMember)[3] = member(k);
+      for (std::size_t i = 0; i < n; i++)
+        for (int j = 0; j < 3; j++)
+          (aQueue[first + i].*lMember)[j] = lAxis((Eigen::Index)i, j);
+    }
+  }
+
+  /// Add the first n samples of the block to aQueue starting at first.
+  template <typename Queue>
+  void addTo(Queue &aQueue, std::size_t first, std::size_t n,
+             unsigned int fields = COM_ALL) const {
+    assert(n <= size());
+    for (unsigned int k = 0; k < 6; k++) {
+      if (!(fields & (1u << k)))
+        continue;
+      const axis_t &lAxis = axis(k);
+      double(COMState::*lMember)[3] = member(k);
+      for (std::size_t i = 0; i < n; i++)
+        for (int j = 0; j < 3; j++)
+          (aQueue[first + i].*lMember)[j] += lAxis((Eigen::Index)i, j);
+    }
+  }
+
+  /// Sample i as a COMState.
+  COMState operator()(std::size_t i) const {
+    COMState aCOMState;
+    for (unsigned int k = 0; k < 6; k++)
+      for (int j = 0; j < 3; j++)
+        (aCOMState.*member(k))[j] = axis(k)((Eigen::Index)i, j);
+    return aCOMState;
+  }
+
+  void set(std::size_t i, const COMState &aCOMState) {
+    for (unsigned int k = 0; k < 6; k++)
+      for (int j = 0; j < 3; j++)
+        axis(k)((Eigen::Index)i, j) = (aCOMState.*member(k))[j];
+  }
+
+private:
+  /// Axis k, in the order of com_field_e.
+  inline axis_t &axis(unsigned int k) {
+    axis_t *lAxes[6] = {&x, &y, &z, &yaw, &pitch, &roll};
+    return *lAxes[k];
+  }
+  inline const axis_t &axis(unsigned int k) const {
+    const axis_t *lAxes[6] = {&x, &y, &z, &yaw, &pitch, &roll};
+    return *lAxes[k];
+  }
+
+  /// Field of COMState matching axis k.
+  static inline double (COMState::*member(unsigned int k))[3] {
+    static double(COMState::*const lMembers[6])[3] = {
+        &COMState::x,   &COMState::y,     &COMState::z,
+        &COMState::yaw, &COMState::pitch, &COMState::roll};
+    return lMembers[k];
+  }
+};
+} // namespace PatternGeneratorJRL
+#endif /* _HWPG_TRAJECTORY_BLOCK_H_ */
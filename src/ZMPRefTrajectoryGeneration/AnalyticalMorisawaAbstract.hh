@@ -37,6 +37,7 @@
 #include <Mathematics/ConvexHull.hh>
 #include <Mathematics/PolynomeFoot.hh>
 #include <PreviewControl/PreviewControl.hh>
+#include <RingBuffer.hh>
 #include <ZMPRefTrajectoryGeneration/ZMPRefTrajectoryGeneration.hh>
 
 namespace PatternGeneratorJRL {
@@ -109,10 +110,10 @@ public:
 
   */
   virtual void GetZMPDiscretization(
-      deque<ZMPPosition> &ZMPPositions, deque<COMState> &CoMStates,
+      RingBuffer<ZMPPosition> &ZMPPositions, RingBuffer<COMState> &CoMStates,
       deque<RelativeFootPosition> &RelativeFootPositions,
-      deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-      deque<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
       COMState &lStartingCOMState, Eigen::Vector3d &lStartingZMPPosition,
       FootAbsolutePosition &InitLeftFootAbsolutePosition,
       FootAbsolutePosition &InitRightFootAbsolutePosition) = 0;
@@ -129,9 +130,10 @@ public:
     the queue of ZMP, and foot positions.
   */
   virtual std::size_t
-  InitOnLine(deque<ZMPPosition> &FinalZMPPositions, deque<COMState> &CoMStates,
-             deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-             deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+  InitOnLine(RingBuffer<ZMPPosition> &FinalZMPPositions,
+             RingBuffer<COMState> &CoMStates,
+             RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+             RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
              FootAbsolutePosition &InitLeftFootAbsolutePosition,
              FootAbsolutePosition &InitRightFootAbsolutePosition,
              deque<RelativeFootPosition> &RelativeFootPositions,
@@ -140,31 +142,33 @@ public:
 
   /* ! \brief Method to update the stacks on-line */
   virtual void
-  OnLine(double time, deque<ZMPPosition> &FinalZMPPositions,
-         deque<COMState> &CoMStates,
-         deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-         deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions) = 0;
+  OnLine(double time, RingBuffer<ZMPPosition> &FinalZMPPositions,
+         RingBuffer<COMState> &CoMStates,
+         RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+         RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions) = 0;
 
   /* ! Methods to update the stack on-line by
      inserting a new foot position. */
   virtual void
-  OnLineAddFoot(RelativeFootPosition &NewRelativeFootPosition,
-                deque<ZMPPosition> &FinalZMPPositions,
-                deque<COMState> &CoMStates,
-                deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-                deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
-                bool EndSequence) = 0;
+  OnLineAddFoot(
+      RelativeFootPosition &NewRelativeFootPosition,
+      RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &CoMStates,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+      bool EndSequence) = 0;
 
   /* ! \brief Method to change on line the landing position of a foot.
      @return If the method failed it returns -1, 0 otherwise.
   */
   virtual int
-  OnLineFootChange(double time, FootAbsolutePosition &aFootAbsolutePosition,
-                   deque<ZMPPosition> &FinalZMPPositions,
-                   deque<COMState> &CoMStates,
-                   deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-                   deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
-                   StepStackHandler *aStepStackHandler) = 0;
+  OnLineFootChange(
+      double time, FootAbsolutePosition &aFootAbsolutePosition,
+      RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &CoMStates,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+      StepStackHandler *aStepStackHandler) = 0;
 
   /*! \brief Method to stop walking.
     @param[out] ZMPPositions: The queue of ZMP reference positions.
@@ -175,9 +179,10 @@ public:
     The queue of right foot absolute positions.
   */
   virtual void EndPhaseOfTheWalking(
-      deque<ZMPPosition> &ZMPPositions, deque<COMState> &FinalCOMStates,
-      deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-      deque<FootAbsolutePosition> &RightFootAbsolutePositions) = 0;
+      RingBuffer<ZMPPosition> &ZMPPositions,
+      RingBuffer<COMState> &FinalCOMStates,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions) = 0;
   /*! @} */
 
   /*! \name Methods specifics to our current implementation.
@@ -33,44 +33,30 @@
 
 #include <Debug.hh>
 #include <ZMPRefTrajectoryGeneration/AnalyticalMorisawaCompact.hh>
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 
-#include <boost/version.hpp>
-
 typedef double doublereal;
 typedef int integer;
 
 extern "C" {
-extern int dgesvx_(char *, char *,          /* 0 FACT TRANS */
-                   integer *, integer *,    /* 2 N NHRS */
-                   doublereal *, integer *, /* 4 A LDA */
-                   doublereal *, integer *, /* 6 AF LDAF */
-                   integer *,               /* 7 IPIV */
-                   char *,                  /* 8 EQUED */
-                   doublereal *,            /* 9 R */
-                   doublereal *,            /* 10 C */
-                   doublereal *,            /* 11 B */
-                   integer *,               /* 12 LDB */
-                   doublereal *,            /* 13 X */
-                   integer *,               /* 14 LDX */
-                   doublereal *,            /* 15 RCOND */
-                   doublereal *,            /* 16 FERR */
-                   doublereal *,            /* 17 BERR */
-                   doublereal *,            /* 18 WORK */
-                   integer *,               /* 19 IWORK */
-                   integer *                /* 20 INFO */
+extern void dgbtrf_(integer *, integer *,    /* M N */
+                    integer *, integer *,    /* KL KU */
+                    doublereal *, integer *, /* AB LDAB */
+                    integer *,               /* IPIV */
+                    integer *                /* INFO */
 );
 
-#if BOOST_VERSION >= 104000
-extern void dgetrf_(integer *m,    /* M */
-                    integer *n,    /* N */
-                    doublereal *A, /* A */
-                    integer *lda,  /* LDA */
-                    integer *ipiv, /* IPIV */
-                    integer *info  /* info */
+extern void dgbtrs_(char *,                  /* TRANS */
+                    integer *,               /* N */
+                    integer *, integer *,    /* KL KU */
+                    integer *,               /* NRHS */
+                    doublereal *, integer *, /* AB LDAB */
+                    integer *,               /* IPIV */
+                    doublereal *, integer *, /* B LDB */
+                    integer *                /* INFO */
 );
-#endif
 }
 
 namespace PatternGeneratorJRL {
@@ -217,95 +203,49 @@ bool AnalyticalMorisawaCompact::InitializeBasicVariables() {
 }
 
 void AnalyticalMorisawaCompact::ComputePolynomialWeights() {
-  Eigen::MatrixXd iZ;
-  iZ = m_Z.inverse();
-
-  // Compute the weights.
-  m_y = iZ + m_w;
-
-  if (m_VerboseLevel >= 2) {
-    std::ofstream ofs;
-    ofs.open("YMatrix.dat", ofstream::out);
-    ofs.precision(10);
-
-    for (unsigned int i = 0; i < m_y.size(); i++) {
-      ofs << m_y[i] << " ";
-    }
-    ofs << endl;
-    ofs.close();
-  }
+  m_NeedToReset = true;
+  ComputePolynomialWeights2();
 }
 
 void AnalyticalMorisawaCompact::ResetTheResolutionOfThePolynomial() {
-  long int SizeOfZ = m_Z.rows();
-
-  m_AF.resize(SizeOfZ, 2 * SizeOfZ);
-  m_IPIV.resize(SizeOfZ);
-  m_AF.setZero();
-  m_IPIV.setZero();
-
   m_NeedToReset = true;
 }
 
 void AnalyticalMorisawaCompact::ComputePolynomialWeights2() {
-  int SizeOfZ = (int)m_Z.rows(), LDA, LDAF, LDB;
+  int SizeOfZ = (int)m_Z.rows();
+  int KL = Z_LOWER_BANDWIDTH, KU = Z_UPPER_BANDWIDTH;
+  int LDAB = 2 * KL + KU + 1;
   int NRHS = 1;
-
-  char EQUED = 'N';
-
-  Eigen::MatrixXd tZ;
-  tZ = m_Z.transpose();
-
-  Eigen::VectorXd lR;
-  lR.resize(SizeOfZ);
-  Eigen::VectorXd lC;
-  lC.resize(SizeOfZ);
-
-  m_y.resize(SizeOfZ);
-  // Eigen::VectorXd m_X;
-  // b m_X.resize(SizeOfZ);
-  LDA = SizeOfZ;
-  LDAF = SizeOfZ;
-  LDB = SizeOfZ;
-
-  double lRCOND;
-
-  Eigen::VectorXd lFERR, lBERR;
-  lFERR.resize(SizeOfZ);
-  lBERR.resize(SizeOfZ);
-
-  int lwork = 4 * SizeOfZ;
-  double *work = new double[lwork];
-  int *iwork = new int[SizeOfZ];
-  int lsizeofx = SizeOfZ;
   int info = 0;
 
+  // Z only couples consecutive intervals: its LU decomposition in
+  // band storage is linear in the number of intervals, and is kept
+  // until Z is built again.
   if (m_NeedToReset) {
-    m_AF = m_Z.transpose();
-    dgetrf_(&SizeOfZ,   /* M */
-            &SizeOfZ,   /* N here M=N=SizeOfZ */
-            &m_AF(0),   /* A */
-            &SizeOfZ,   /* Leading dimension cf before */
-            &m_IPIV(0), /* IPIV */
-            &info       /* info */
-    );
+    m_AF.resize(LDAB, SizeOfZ);
+    m_AF.setZero();
+    m_IPIV.resize(SizeOfZ);
+    for (int j = 0; j < SizeOfZ; j++) {
+      int lFirstRow = std::max(0, j - KU);
+      int lLastRow = std::min(SizeOfZ - 1, j + KL);
+      for (int i = lFirstRow; i <= lLastRow; i++)
+        m_AF(KL + KU + i - j, j) = m_Z(i, j);
+    }
+    dgbtrf_(&SizeOfZ, &SizeOfZ, &KL, &KU, &m_AF(0), &LDAB, &m_IPIV(0), &info);
+    if (info != 0)
+      std::cerr << "AnalyticalMorisawaCompact - Z is singular (" << info << ")"
+                << std::endl;
     m_NeedToReset = false;
   }
 
-  char lF[2] = "F";
+  // Solve Z y = w. The rows of Z are the conditions on the intervals.
+  m_y = m_w;
   char lN[2] = "N";
-  dgesvx_(lF,       /* Specify that AF and IPIV should be used. */
-          lN,       /* A * X = B */
-          &SizeOfZ, /* Size of A */
-          &NRHS,    /*Nb of columns for X et B */
-          &tZ(0),   /* Access to A */
-          &LDA,     /* Leading size of A */
-          &m_AF(0), &LDAF, &m_IPIV(0), &EQUED, &lR(0), &lC(0), &m_w(0), &LDB,
-          &m_y(0), &lsizeofx, &lRCOND, &lFERR(0), &lBERR(0), work, iwork,
-          &info);
-
-  // Compute the weights.
-  // m_y=iZ+m_w;
+  dgbtrs_(lN, &SizeOfZ, &KL, &KU, &NRHS, &m_AF(0), &LDAB, &m_IPIV(0), &m_y(0),
+          &SizeOfZ, &info);
+  if (info != 0)
+    std::cerr << "AnalyticalMorisawaCompact - wrong argument " << -info
+              << " in the solve of the Z system" << std::endl;
 
   if (m_VerboseLevel >= 2) {
     std::ofstream ofs;
@@ -318,9 +258,6 @@ void AnalyticalMorisawaCompact::ComputePolynomialWeights2() {
     ofs << endl;
     ofs.close();
   }
-
-  delete[] work;
-  delete[] iwork;
 }
 
 int AnalyticalMorisawaCompact::BuildAndSolveCOMZMPForASetOfSteps(
@@ -474,10 +411,10 @@ int AnalyticalMorisawaCompact::BuildAndSolveCOMZMPForASetOfSteps(
 }
 
 void AnalyticalMorisawaCompact::GetZMPDiscretization(
-    deque<ZMPPosition> &ZMPPositions, deque<COMState> &COMStates,
+    RingBuffer<ZMPPosition> &ZMPPositions, RingBuffer<COMState> &COMStates,
     deque<RelativeFootPosition> &RelativeFootPositions,
-    deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &RightFootAbsolutePositions, double,
+    RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions, double,
     COMState &lStartingCOMState, Eigen::Vector3d &,
     FootAbsolutePosition &InitLeftFootAbsolutePosition,
     FootAbsolutePosition &InitRightFootAbsolutePosition) {
@@ -628,7 +565,7 @@ void AnalyticalMorisawaCompact::GetZMPDiscretization(
     }
 
     // Filter the trajectory
-    deque<COMState> outputDeltaCOMTraj_deq(n);
+    RingBuffer<COMState> outputDeltaCOMTraj_deq(n);
     m_kajitaDynamicFilter->OffLinefilter(
         COMStates, ZMPPositions, LeftFootAbsolutePositions,
         RightFootAbsolutePositions, vector<Eigen::VectorXd>(1, UpperConfig),
@@ -666,9 +603,10 @@ void AnalyticalMorisawaCompact::GetZMPDiscretization(
 }
 
 std::size_t AnalyticalMorisawaCompact::InitOnLine(
-    deque<ZMPPosition> &FinalZMPPositions, deque<COMState> &FinalCoMPositions,
-    deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+    RingBuffer<ZMPPosition> &FinalZMPPositions,
+    RingBuffer<COMState> &FinalCoMPositions,
+    RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
     FootAbsolutePosition &InitLeftFootAbsolutePosition,
     FootAbsolutePosition &InitRightFootAbsolutePosition,
     deque<RelativeFootPosition> &RelativeFootPositions,
@@ -775,10 +713,10 @@ std::size_t AnalyticalMorisawaCompact::InitOnLine(
 }
 
 void AnalyticalMorisawaCompact::OnLine(
-    double time, deque<ZMPPosition> &FinalZMPPositions,
-    deque<COMState> &FinalCOMStates,
-    deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions) {
+    double time, RingBuffer<ZMPPosition> &FinalZMPPositions,
+    RingBuffer<COMState> &FinalCOMStates,
+    RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions) {
   unsigned int lIndexInterval;
   if (time < m_UpperTimeLimitToUpdateStacks) {
     if (m_AnalyticalZMPCoGTrajectoryX->GetIntervalIndexFromTime(
@@ -859,9 +797,10 @@ void AnalyticalMorisawaCompact::OnLine(
 
 void AnalyticalMorisawaCompact::OnLineAddFoot(
     RelativeFootPosition &NewRelativeFootPosition,
-    deque<ZMPPosition> &FinalZMPPositions, deque<COMState> &FinalCoMPositions,
-    deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions, bool) {
+    RingBuffer<ZMPPosition> &FinalZMPPositions,
+    RingBuffer<COMState> &FinalCoMPositions,
+    RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions, bool) {
   ODEBUG("****************** Begin OnLineAddFoot **************************");
   unsigned int StartingIndexInterval;
   m_AnalyticalZMPCoGTrajectoryX->GetIntervalIndexFromTime(
@@ -885,7 +824,7 @@ void AnalyticalMorisawaCompact::OnLineAddFoot(
   m_RelativeFootPositions.pop_front();
   m_RelativeFootPositions.push_back(NewRelativeFootPosition);
 
-  deque<FootAbsolutePosition> aQAFP;
+  RingBuffer<FootAbsolutePosition> aQAFP;
 
   m_FeetTrajectoryGenerator->ComputeAbsoluteStepsFromRelativeSteps(
       m_RelativeFootPositions, FinalLeftFootAbsolutePositions[0],
@@ -1245,6 +1184,10 @@ void AnalyticalMorisawaCompact::BuildingTheZMatrix() {
   // Computing Zm
   ComputeZm(m_NumberOfIntervals - 1, colindex, rowindex);
 
+  if (!ZIsBanded())
+    std::cerr << "AnalyticalMorisawaCompact - Z has entries outside of its "
+              << "bandwidths" << std::endl;
+
   if (m_VerboseLevel >= 2) {
     std::ofstream ofs;
     ofs.open("ZCompactMatrix.dat", ofstream::out);
@@ -1259,6 +1202,15 @@ void AnalyticalMorisawaCompact::BuildingTheZMatrix() {
   }
 }
 
+bool AnalyticalMorisawaCompact::ZIsBanded() const {
+  for (Eigen::Index j = 0; j < m_Z.cols(); j++)
+    for (Eigen::Index i = 0; i < m_Z.rows(); i++)
+      if ((m_Z(i, j) != 0.0) &&
+          ((i - j > Z_LOWER_BANDWIDTH) || (j - i > Z_UPPER_BANDWIDTH)))
+        return false;
+  return true;
+}
+
 void AnalyticalMorisawaCompact::TransfertTheCoefficientsToTrajectories(
     AnalyticalZMPCOGTrajectory &aAZCT, vector<double> &lCoMZ,
     vector<double> &lZMPZ, double &lZMPInit, double &lZMPEnd, bool) {
@@ -1466,7 +1418,7 @@ void AnalyticalMorisawaCompact::ConstraintsChange(
       /*! Remove the first step still in the stack. */
       lRelativeFootPositions.pop_front();
 
-      deque<FootAbsolutePosition> lAbsoluteSupportFootPositions;
+      RingBuffer<FootAbsolutePosition> lAbsoluteSupportFootPositions;
       int lLastIndex = (int)(m_AbsoluteSupportFootPositions.size() - 1);
       m_FeetTrajectoryGenerator->ComputeAbsoluteStepsFromRelativeSteps(
           lRelativeFootPositions, m_AbsoluteSupportFootPositions[lLastIndex],
@@ -1899,11 +1851,11 @@ AnalyticalMorisawaCompact::GetFeetTrajectoryGenerator() {
 
 int AnalyticalMorisawaCompact::OnLineFootChange(
     double time, FootAbsolutePosition &aFootAbsolutePosition,
-    deque<ZMPPosition> &ZMPPositions, deque<COMState> &CoMPositions,
-    deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+    RingBuffer<ZMPPosition> &ZMPPositions, RingBuffer<COMState> &CoMPositions,
+    RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
     StepStackHandler *aStepStackHandler) {
-  deque<FootAbsolutePosition> NewFeetAbsolutePosition;
+  RingBuffer<FootAbsolutePosition> NewFeetAbsolutePosition;
   NewFeetAbsolutePosition.push_back(aFootAbsolutePosition);
   return OnLineFootChanges(time, NewFeetAbsolutePosition, ZMPPositions,
                            CoMPositions, LeftFootAbsolutePositions,
@@ -1911,10 +1863,10 @@ int AnalyticalMorisawaCompact::OnLineFootChange(
 }
 
 int AnalyticalMorisawaCompact::OnLineFootChanges(
-    double time, deque<FootAbsolutePosition> &aFootAbsolutePosition,
-    deque<ZMPPosition> &ZMPPositions, deque<COMState> &CoMPositions,
-    deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+    double time, RingBuffer<FootAbsolutePosition> &aFootAbsolutePosition,
+    RingBuffer<ZMPPosition> &ZMPPositions, RingBuffer<COMState> &CoMPositions,
+    RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
     StepStackHandler *aStepStackHandler) {
 
   ODEBUG("***** Begin OnLineFootChange *****");
@@ -1960,7 +1912,7 @@ int AnalyticalMorisawaCompact::OnLineFootChanges(
   /* Backup data structures */
   FootAbsolutePosition BackUpm_AbsoluteCurrentSupportFootPosition =
       m_AbsoluteCurrentSupportFootPosition;
-  deque<FootAbsolutePosition> BackUpm_AbsoluteSupportFootPositions =
+  RingBuffer<FootAbsolutePosition> BackUpm_AbsoluteSupportFootPositions =
       m_AbsoluteSupportFootPositions;
   deque<RelativeFootPosition> BackUpm_RelativeFootPositions =
       m_RelativeFootPositions;
@@ -2020,7 +1972,7 @@ int AnalyticalMorisawaCompact::OnLineFootChanges(
           aFootAbsolutePosition[i].theta;
     }
 
-    deque<FootAbsolutePosition> lAbsoluteSupportFootPositions;
+    RingBuffer<FootAbsolutePosition> lAbsoluteSupportFootPositions;
     m_FeetTrajectoryGenerator->ComputeAbsoluteStepsFromRelativeSteps(
         m_RelativeFootPositions, LeftFootAbsolutePositions[0],
         RightFootAbsolutePositions[0], lAbsoluteSupportFootPositions);
@@ -2093,9 +2045,10 @@ int AnalyticalMorisawaCompact::ReturnOptimalTimeToRegenerateAStep() {
 }
 
 void AnalyticalMorisawaCompact::EndPhaseOfTheWalking(
-    deque<ZMPPosition> &FinalZMPPositions, deque<COMState> &FinalCoMPositions,
-    deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions) {
+    RingBuffer<ZMPPosition> &FinalZMPPositions,
+    RingBuffer<COMState> &FinalCoMPositions,
+    RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions) {
 
   m_OnLineMode = true;
   bool DoNotPrepareLastFoot = false;
@@ -2233,9 +2186,10 @@ void AnalyticalMorisawaCompact::PropagateAbsoluteReferenceTime(double x) {
 
 void AnalyticalMorisawaCompact::FillQueues(
     double samplingPeriod, double StartingTime, double EndTime,
-    deque<ZMPPosition> &FinalZMPPositions, deque<COMState> &FinalCoMPositions,
-    deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions) {
+    RingBuffer<ZMPPosition> &FinalZMPPositions,
+    RingBuffer<COMState> &FinalCoMPositions,
+    RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions) {
   unsigned int lIndexInterval, lPrevIndexInterval;
   m_AnalyticalZMPCoGTrajectoryX->GetIntervalIndexFromTime(
       m_AbsoluteTimeReference, lIndexInterval);
@@ -2337,7 +2291,7 @@ void AnalyticalMorisawaCompact::ComputeCoMz(COMState &CoM,
 
 void AnalyticalMorisawaCompact::ComputeCoMz(
     double t, unsigned int lIndexInterval, COMState &CoM,
-    deque<COMState> &FinalCoMPositions) {
+    RingBuffer<COMState> &FinalCoMPositions) {
   double *CoMz = CoM.z;
   double moving_time =
       m_RelativeFootPositions[0].SStime + m_RelativeFootPositions[0].DStime;
@@ -2585,10 +2539,11 @@ void AnalyticalMorisawaCompact::ComputeZMPz(double t, ZMPPosition &ZMPz,
 }
 
 void AnalyticalMorisawaCompact::FillQueues(
-    double StartingTime, double EndTime, deque<ZMPPosition> &FinalZMPPositions,
-    deque<COMState> &FinalCoMPositions,
-    deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions) {
+    double StartingTime, double EndTime,
+    RingBuffer<ZMPPosition> &FinalZMPPositions,
+    RingBuffer<COMState> &FinalCoMPositions,
+    RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions) {
   FillQueues(m_SamplingPeriod, StartingTime, EndTime, FinalZMPPositions,
              FinalCoMPositions, FinalLeftFootAbsolutePositions,
              FinalRightFootAbsolutePositions);
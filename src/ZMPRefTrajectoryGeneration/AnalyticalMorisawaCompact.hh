@@ -44,6 +44,7 @@
 #include <Mathematics/ConvexHull.hh>
 #include <Mathematics/PolynomeFoot.hh>
 #include <PreviewControl/PreviewControl.hh>
+#include <RingBuffer.hh>
 #include <ZMPRefTrajectoryGeneration/AnalyticalMorisawaAbstract.hh>
 #include <ZMPRefTrajectoryGeneration/DynamicFilter.hh>
 
@@ -156,10 +157,10 @@ public:
     of the right foot.
   */
   void GetZMPDiscretization(
-      deque<ZMPPosition> &ZMPPositions, deque<COMState> &CoMStates,
+      RingBuffer<ZMPPosition> &ZMPPositions, RingBuffer<COMState> &CoMStates,
       deque<RelativeFootPosition> &RelativeFootPositions,
-      deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-      deque<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
       COMState &lStartingCOMState, Eigen::Vector3d &lStartingZMPPosition,
       FootAbsolutePosition &InitLeftFootAbsolutePosition,
       FootAbsolutePosition &InitRightFootAbsolutePosition);
@@ -194,9 +195,10 @@ public:
     The initial position of the ZMP given as a 3D vector.
   */
   std::size_t
-  InitOnLine(deque<ZMPPosition> &FinalZMPPositions, deque<COMState> &CoMStates,
-             deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-             deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+  InitOnLine(RingBuffer<ZMPPosition> &FinalZMPPositions,
+             RingBuffer<COMState> &CoMStates,
+             RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+             RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
              FootAbsolutePosition &InitLeftFootAbsolutePosition,
              FootAbsolutePosition &InitRightFootAbsolutePosition,
              deque<RelativeFootPosition> &RelativeFootPositions,
@@ -223,37 +225,41 @@ public:
 
   */
   void
-  OnLineAddFoot(RelativeFootPosition &NewRelativeFootPosition,
-                deque<ZMPPosition> &FinalZMPPositions,
-                deque<COMState> &CoMStates,
-                deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-                deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
-                bool EndSequence);
+  OnLineAddFoot(
+      RelativeFootPosition &NewRelativeFootPosition,
+      RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &CoMStates,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+      bool EndSequence);
 
   /* ! \brief Method to update the stacks on-line */
-  void OnLine(double time, deque<ZMPPosition> &FinalZMPPositions,
-              deque<COMState> &CoMStates,
-              deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-              deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
+  void OnLine(
+      double time, RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &CoMStates,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
 
   /* ! \brief Method to change on line the landing position of a foot.
      @return If the method failed it returns -1, 0 otherwise.
   */
   int OnLineFootChange(
       double time, FootAbsolutePosition &aFootPosition,
-      deque<ZMPPosition> &FinalZMPPositions, deque<COMState> &CoMStates,
-      deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-      deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+      RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &CoMStates,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
       StepStackHandler *aStepStackHandler = 0);
 
   /* ! \brief Method to change on line the landing position of several feet.
      @return If the method failed it returns -1, 0 otherwise.
   */
   int OnLineFootChanges(
-      double time, deque<FootAbsolutePosition> &FeetPosition,
-      deque<ZMPPosition> &FinalZMPPositions, deque<COMState> &CoMStates,
-      deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-      deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+      double time, RingBuffer<FootAbsolutePosition> &FeetPosition,
+      RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &CoMStates,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
       StepStackHandler *aStepStackHandler = 0);
 
   /*! \brief Method to stop walking.
@@ -265,10 +271,11 @@ public:
     absolute positions.
   */
   void
-  EndPhaseOfTheWalking(deque<ZMPPosition> &ZMPPositions,
-                       deque<COMState> &FinalCOMStates,
-                       deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-                       deque<FootAbsolutePosition> &RightFootAbsolutePositions);
+  EndPhaseOfTheWalking(
+      RingBuffer<ZMPPosition> &ZMPPositions,
+      RingBuffer<COMState> &FinalCOMStates,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions);
 
   /*! \brief Return the time at which it is optimal to regenerate
     a step in online mode.
@@ -294,6 +301,11 @@ public:
   /*! \brief Building the Z matrix to be inverted. */
   void BuildingTheZMatrix();
 
+  /*! \brief Return true if Z has no entry outside of
+    Z_LOWER_BANDWIDTH and Z_UPPER_BANDWIDTH: the banded decomposition
+    of ComputePolynomialWeights2() ignores these entries. */
+  bool ZIsBanded() const;
+
   /*! \brief Building the w vector.
     It is currently assume that all ZMP's speed will be
     set to zero, as well as the final COM's speed.
@@ -338,10 +350,13 @@ public:
   */
   bool InitializeBasicVariables();
 
-  /*! \brief Compute the polynomial weights. */
+  /*! \brief Compute the polynomial weights, decomposing Z again. */
   void ComputePolynomialWeights();
 
-  /*! \brief Compute the polynomial weights. */
+  /*! \brief Compute the polynomial weights by solving
+    \f$ {\bf Z} {\bf y} = {\bf w} \f$. The banded LU decomposition of
+    Z is computed after ResetTheResolutionOfThePolynomial(), and reused
+    for the following calls. */
   void ComputePolynomialWeights2();
 
   /*! \brief Compute a trajectory with the given parameters.
@@ -590,24 +605,26 @@ protected:
     \param FinalRightFootAbsolutePositions:
     The queue of Right Foot Absolute positions.
   */
-  void FillQueues(double StartingTime, double EndTime,
-                  deque<ZMPPosition> &FinalZMPPositions,
-                  deque<COMState> &FinalCoMPositions,
-                  deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-                  deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
+  void FillQueues(
+      double StartingTime, double EndTime,
+      RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &FinalCoMPositions,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
 
   void ComputeZMPz(double t, ZMPPosition &ZMPz, unsigned int IndexInterval);
 
   void ComputeCoMz(COMState &CoM, FootAbsolutePosition &LeftFoot,
                    FootAbsolutePosition &RightFoot);
   void ComputeCoMz(double t, unsigned int lIndexInterval, COMState &CoMz,
-                   deque<COMState> &FinalCoMPositions);
+                   RingBuffer<COMState> &FinalCoMPositions);
 
-  void FillQueues(double samplingPeriod, double StartingTime, double EndTime,
-                  deque<ZMPPosition> &FinalZMPPositions,
-                  deque<COMState> &FinalCoMPositions,
-                  deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-                  deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
+  void FillQueues(
+      double samplingPeriod, double StartingTime, double EndTime,
+      RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &FinalCoMPositions,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
 
   void ComputeOneElementOfTheQueue(
       unsigned int &lIndexInterval, unsigned int &lPrevIndexInterval, double t,
@@ -615,7 +632,14 @@ protected:
       FootAbsolutePosition &FinalLeftFootAbsolutePosition,
       FootAbsolutePosition &FinalRightFootAbsolutePosition);
 
-  /*! \brief LU decomposition of the Z matrix. */
+  /*! \brief Bandwidths of the Z matrix: the rows of ComputeZ1() reach
+    5 columns to the left of the diagonal and 4 to the right, the other
+    rows stay within these bounds. */
+  const static int Z_LOWER_BANDWIDTH = 5;
+  const static int Z_UPPER_BANDWIDTH = 4;
+
+  /*! \brief LU decomposition of the Z matrix, in the band storage
+    of LAPACK. */
   Eigen::MatrixXd m_AF;
 
   /*! \brief Pivots of the Z matrix LU decomposition. */
@@ -654,7 +678,7 @@ protected:
 
   /*! \brief Stores the absolute support foot positions
     currently in the buffer */
-  deque<FootAbsolutePosition> m_AbsoluteSupportFootPositions;
+  RingBuffer<FootAbsolutePosition> m_AbsoluteSupportFootPositions;
 
   /*! \brief Store the currently realized support foot position.
     \warning This field makes sense only direct ON-LINE mode.
@@ -694,16 +718,16 @@ protected:
       *m_FilterYaxisByPC;
   DynamicFilter *m_kajitaDynamicFilter;
   // deque sampled at m_SamplingPeriod
-  deque<FootAbsolutePosition> ctrlLF_;
-  deque<FootAbsolutePosition> ctrlRF_;
-  deque<COMState> ctrlCoM_;
-  deque<ZMPPosition> ctrlZMP_;
+  RingBuffer<FootAbsolutePosition> ctrlLF_;
+  RingBuffer<FootAbsolutePosition> ctrlRF_;
+  RingBuffer<COMState> ctrlCoM_;
+  RingBuffer<ZMPPosition> ctrlZMP_;
   // deque sampled at interpolation time
-  deque<COMState> intCoM_;
-  deque<FootAbsolutePosition> intLF_;
-  deque<FootAbsolutePosition> intRF_;
+  RingBuffer<COMState> intCoM_;
+  RingBuffer<FootAbsolutePosition> intLF_;
+  RingBuffer<FootAbsolutePosition> intRF_;
   // output of the filter
-  deque<COMState> outputDeltaCoM_;
+  RingBuffer<COMState> outputDeltaCoM_;
   // size of the Dynamic Filter preview
   double DFpreviewWindowSize_;
 
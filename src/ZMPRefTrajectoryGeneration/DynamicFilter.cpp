@@ -6,8 +6,15 @@ using namespace PatternGeneratorJRL;
 // using namespace metapod;
 
 DynamicFilter::DynamicFilter(SimplePluginManager *SPM, PinocchioRobot *aPR)
-    : SimplePlugin(SPM), stage0_(0), stage1_(1),
-      MODE_PC_(OptimalControllerSolver::MODE_WITH_INITIALPOS) {
+    : SimplePlugin(SPM), polyX_(1.0, 0.0), polyY_(1.0, 0.0), stage0_(0),
+      stage1_(1),
+      MODE_PC_(OptimalControllerSolver::MODE_WITH_INITIALPOS),
+      nbThreads_(1), robotPool_(0), jobId_(0), nbBusyWorkers_(0),
+      stopWorkers_(false), jobN_(0), jobCOMTraj_(0), jobLeftFootTraj_(0),
+      jobRightFootTraj_(0),
+      incremental_(false), incrementalTolerance_(1e-9), cacheValid_(false),
+      cacheN_(0), nbHits_(0), nbMisses_(0), latency_(0),
+      optimalControlIt_(0), debugIteration_(0) {
   controlPeriod_ = 0.0;
   interpolationPeriod_ = 0.0;
   controlWindowSize_ = 0.0;
@@ -24,19 +31,26 @@ DynamicFilter::DynamicFilter(SimplePluginManager *SPM, PinocchioRobot *aPR)
   comAndFootRealization_->ShiftFoot(true);
   comAndFootRealization_->setSamplingPeriod(interpolationPeriod_);
   comAndFootRealization_->Initialization();
+  mainWorkspace_.PR = PR_;
+  mainWorkspace_.comAndFootRealization = comAndFootRealization_;
 
   PC_ = new PreviewControl(SPM, MODE_PC_, false);
 
   deltaZMP_deq_.clear();
   ZMPMB_vec_.clear();
 
-  aCoMState_.resize(6);
-  aCoMSpeed_.resize(6);
-  aCoMAcc_.resize(6);
-  aLeftFootPosition_.resize(5);
-  aRightFootPosition_.resize(5);
-  deltax_.resize(3, 1);
-  deltay_.resize(3, 1);
+  mainWorkspace_.aCoMState.resize(6);
+  mainWorkspace_.aCoMSpeed.resize(6);
+  mainWorkspace_.aCoMAcc.resize(6);
+  mainWorkspace_.aLeftFootPosition.resize(5);
+  mainWorkspace_.aRightFootPosition.resize(5);
+  mainWorkspace_.aLeftFootSpeed.resize(5);
+  mainWorkspace_.aLeftFootAcc.resize(5);
+  mainWorkspace_.aRightFootSpeed.resize(5);
+  mainWorkspace_.aRightFootAcc.resize(5);
+  ResizeLegsBatch(mainWorkspace_);
+  deltax_.setZero();
+  deltay_.setZero();
 
   comAndFootRealization_->SetPreviousConfigurationStage0(
       PR_->currentRPYConfiguration());
@@ -56,20 +70,30 @@ DynamicFilter::DynamicFilter(SimplePluginManager *SPM, PinocchioRobot *aPR)
 
   walkingHeuristic_ = false;
   useDynamicFilter_ = false;
+  analyticalRates_ = false;
+  centroidalZMPMB_ = false;
 
   // Register method to handle
-  const unsigned int NbMethods = 1;
-  const char *lMethodNames[NbMethods] = {":useDynamicFilter"};
+  const unsigned int NbMethods = 5;
+  const char *lMethodNames[NbMethods] = {
+      ":useDynamicFilter", ":dynamicFilterThreads",
+      ":dynamicFilterAnalyticalRates", ":dynamicFilterCentroidalZMPMB",
+      ":dynamicFilterIncremental"};
   for (unsigned int i = 0; i < NbMethods; i++) {
     std::string aMethodName(lMethodNames[i]);
     if (!RegisterMethod(aMethodName)) {
       std::cerr << "Unable to register " << aMethodName << std::endl;
     }
   }
-  RESETDEBUG5("/tmp/dynamical_filter_dcom.dat");
+  RESETDEBUG4("/tmp/dynamical_filter_dcom.dat");
 }
 
 DynamicFilter::~DynamicFilter() {
+  stopWorkers();
+  if (robotPool_ != 0) {
+    delete robotPool_;
+    robotPool_ = 0;
+  }
   if (PC_ != 0) {
     delete PC_;
     PC_ = 0;
@@ -86,6 +110,50 @@ void DynamicFilter::CallMethod(string &Method, istringstream &strm) {
     strm >> useDynamicFilter;
     useDynamicFilter_ = useDynamicFilter == "true" ? true : false;
   }
+  if (Method == ":dynamicFilterThreads") {
+    unsigned int nbThreads = 1;
+    strm >> nbThreads;
+    setNbThreads(nbThreads);
+  }
+  if (Method == ":dynamicFilterAnalyticalRates") {
+    string analyticalRates;
+    strm >> analyticalRates;
+    analyticalRates_ = analyticalRates == "true" ? true : false;
+  }
+  if (Method == ":dynamicFilterCentroidalZMPMB") {
+    string centroidalZMPMB;
+    strm >> centroidalZMPMB;
+    centroidalZMPMB_ = centroidalZMPMB == "true" ? true : false;
+  }
+  if (Method == ":dynamicFilterIncremental") {
+    string incremental;
+    double tolerance;
+    strm >> incremental;
+    if (!(strm >> tolerance))
+      tolerance = incrementalTolerance_;
+    setIncremental(incremental == "true" ? true : false, tolerance);
+  }
+  // The previous results do not match the new options.
+  cacheValid_ = false;
+}
+
+void DynamicFilter::setNbThreads(unsigned int nbThreads) {
+  stopWorkers();
+  nbThreads_ =
+      (nbThreads == 0) ? std::thread::hardware_concurrency() : nbThreads;
+  if (nbThreads_ == 0)
+    nbThreads_ = 1;
+}
+
+void DynamicFilter::setIncremental(bool incremental, double tolerance) {
+  incremental_ = incremental;
+  incrementalTolerance_ = tolerance;
+  cacheValid_ = false;
+}
+
+void DynamicFilter::resetIncrementalCounters() {
+  nbHits_ = 0;
+  nbMisses_ = 0;
 }
 
 void DynamicFilter::setRobotUpperPart(const Eigen::VectorXd &configuration,
@@ -130,23 +198,33 @@ void DynamicFilter::init(double controlPeriod, double interpolationPeriod,
   ZMPMB_vec_.resize((int)round(previewWindowSize / interpolationPeriod_));
   int inc = (int)round(interpolationPeriod_ / controlPeriod_);
   zmpmb_i_.resize((ZMPMB_vec_.size() - 1) * inc + 1);
+  dZMPMB_vec_.assign(ZMPMB_vec_.size(), vector<double>(2, 0.0));
   deltaZMP_deq_.resize((int)round(previewWindowSize_ / controlPeriod_));
+  deltaZMPWindow_.resize((Eigen::Index)deltaZMP_deq_.size(), 2);
+  deltaCOM_.resize((std::size_t)round(controlWindowSize_ / controlPeriod_));
+  deltaCOM_.setZero();
 
   /// Set CoM/LeftFoot/RightFoot/deltax/deltay sizes
-  aCoMState_.resize(6);
-  aCoMSpeed_.resize(6);
-  aCoMAcc_.resize(6);
-  aLeftFootPosition_.resize(5);
-  aRightFootPosition_.resize(5);
-  deltax_.resize(3, 1);
-  deltay_.resize(3, 1);
+  mainWorkspace_.aCoMState.resize(6);
+  mainWorkspace_.aCoMSpeed.resize(6);
+  mainWorkspace_.aCoMAcc.resize(6);
+  mainWorkspace_.aLeftFootPosition.resize(5);
+  mainWorkspace_.aRightFootPosition.resize(5);
+  mainWorkspace_.aLeftFootSpeed.resize(5);
+  mainWorkspace_.aLeftFootAcc.resize(5);
+  mainWorkspace_.aRightFootSpeed.resize(5);
+  mainWorkspace_.aRightFootAcc.resize(5);
 
   /// Set CoM/LeftFoot/RightFoot/deltax/deltay to Zero
-  aCoMState_.setZero();
-  aCoMSpeed_.setZero();
-  aCoMAcc_.setZero();
-  aLeftFootPosition_.setZero();
-  aRightFootPosition_.setZero();
+  mainWorkspace_.aCoMState.setZero();
+  mainWorkspace_.aCoMSpeed.setZero();
+  mainWorkspace_.aCoMAcc.setZero();
+  mainWorkspace_.aLeftFootPosition.setZero();
+  mainWorkspace_.aRightFootPosition.setZero();
+  mainWorkspace_.aLeftFootSpeed.setZero();
+  mainWorkspace_.aLeftFootAcc.setZero();
+  mainWorkspace_.aRightFootSpeed.setZero();
+  mainWorkspace_.aRightFootAcc.setZero();
   deltax_.setZero();
   deltay_.setZero();
 
@@ -192,18 +270,123 @@ void DynamicFilter::init(double controlPeriod, double interpolationPeriod,
   comAndFootRealization_->leftArmIndexinVelocity(larmIdxv_);
   comAndFootRealization_->rightArmIndexinVelocity(rarmIdxv_);
   comAndFootRealization_->chestIndexinVelocity(chestIdxv_);
+
+  mainWorkspace_.configuration = ZMPMBConfiguration_;
+  mainWorkspace_.velocity = ZMPMBVelocity_;
+  mainWorkspace_.acceleration = ZMPMBAcceleration_;
+  cacheValid_ = false;
+  stopWorkers();
+  if (nbThreads_ > 1)
+    startWorkers();
   return;
 }
 
+void DynamicFilter::startWorkers() {
+  if (robotPool_ == 0)
+    robotPool_ = new PinocchioRobotPool(*PR_, nbThreads_ - 1);
+  workerWorkspaces_.resize(nbThreads_ - 1);
+  for (unsigned int k = 0; k < workerWorkspaces_.size(); k++) {
+    zmpmb_workspace_t &aWS = workerWorkspaces_[k];
+    aWS.PR = robotPool_->acquire();
+    if (aWS.PR == 0) {
+      std::cerr << "DynamicFilter: unable to clone the robot, "
+                << "the ZMP multibody is computed by one thread" << std::endl;
+      workerWorkspaces_.resize(k);
+      stopWorkers();
+      return;
+    }
+    // A robot released by a previous initialization keeps its last
+    // state, start from the one of the main robot.
+    aWS.PR->currentRPYConfiguration(PR_->currentRPYConfiguration());
+    aWS.PR->currentRPYVelocity(PR_->currentRPYVelocity());
+    aWS.PR->currentRPYAcceleration(PR_->currentRPYAcceleration());
+    aWS.comAndFootRealization = new ComAndFootRealizationByGeometry(
+        (PatternGeneratorInterfacePrivate *)getSimplePluginManager());
+    aWS.comAndFootRealization->setPinocchioRobot(aWS.PR);
+    aWS.comAndFootRealization->SetStepStackHandler(
+        comAndFootRealization_->GetStepStackHandler());
+    aWS.comAndFootRealization->setSamplingPeriod(interpolationPeriod_);
+    aWS.comAndFootRealization->Initialization();
+    aWS.comAndFootRealization->CopyParameters(*comAndFootRealization_);
+
+    aWS.aCoMState = mainWorkspace_.aCoMState;
+    aWS.aCoMSpeed = mainWorkspace_.aCoMSpeed;
+    aWS.aCoMAcc = mainWorkspace_.aCoMAcc;
+    aWS.aLeftFootPosition = mainWorkspace_.aLeftFootPosition;
+    aWS.aRightFootPosition = mainWorkspace_.aRightFootPosition;
+    aWS.aLeftFootSpeed = mainWorkspace_.aLeftFootSpeed;
+    aWS.aLeftFootAcc = mainWorkspace_.aLeftFootAcc;
+    aWS.aRightFootSpeed = mainWorkspace_.aRightFootSpeed;
+    aWS.aRightFootAcc = mainWorkspace_.aRightFootAcc;
+    aWS.configuration = ZMPMBConfiguration_;
+    aWS.velocity = ZMPMBVelocity_;
+    aWS.acceleration = ZMPMBAcceleration_;
+    ResizeLegsBatch(aWS);
+  }
+
+  // The id is read before the threads start: a job posted before a
+  // worker waits for the first time is not taken for an old one.
+  unsigned long lStartId;
+  {
+    std::lock_guard<std::mutex> lock(workersMutex_);
+    stopWorkers_ = false;
+    lStartId = jobId_;
+  }
+  workers_.reserve(workerWorkspaces_.size());
+  for (unsigned int k = 0; k < workerWorkspaces_.size(); k++)
+    workers_.push_back(
+        std::thread(&DynamicFilter::worker, this, k, lStartId));
+}
+
+void DynamicFilter::stopWorkers() {
+  {
+    std::lock_guard<std::mutex> lock(workersMutex_);
+    stopWorkers_ = true;
+  }
+  jobStarted_.notify_all();
+  for (unsigned int k = 0; k < workers_.size(); k++)
+    workers_[k].join();
+  workers_.clear();
+
+  for (unsigned int k = 0; k < workerWorkspaces_.size(); k++) {
+    delete workerWorkspaces_[k].comAndFootRealization;
+    robotPool_->release(workerWorkspaces_[k].PR);
+  }
+  workerWorkspaces_.clear();
+}
+
+void DynamicFilter::worker(unsigned int k, unsigned long lastJobId) {
+  std::unique_lock<std::mutex> lock(workersMutex_);
+  while (true) {
+    jobStarted_.wait(lock,
+                     [&] { return stopWorkers_ || (jobId_ != lastJobId); });
+    if (stopWorkers_)
+      return;
+    lastJobId = jobId_;
+
+    // Thread k handles the chunk k+1, the calling thread the first one.
+    unsigned int n = (unsigned int)workerWorkspaces_.size() + 1;
+    unsigned int first = (k + 1) * jobN_ / n;
+    unsigned int last = (k + 2) * jobN_ / n;
+    lock.unlock();
+    ComputeZMPMBChunk(workerWorkspaces_[k], first, last, *jobCOMTraj_,
+                      *jobLeftFootTraj_, *jobRightFootTraj_);
+    lock.lock();
+
+    if (--nbBusyWorkers_ == 0)
+      jobDone_.notify_all();
+  }
+}
+
 int DynamicFilter::OffLinefilter(
-    const deque<COMState> &inputCOMTraj_deq_,
-    const deque<ZMPPosition> &inputZMPTraj_deq_,
-    const deque<FootAbsolutePosition> &inputLeftFootTraj_deq_,
-    const deque<FootAbsolutePosition> &inputRightFootTraj_deq_,
+    const RingBuffer<COMState> &inputCOMTraj_deq_,
+    const RingBuffer<ZMPPosition> &inputZMPTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> &inputLeftFootTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> &inputRightFootTraj_deq_,
     const vector<Eigen::VectorXd> &UpperPart_q,
     const vector<Eigen::VectorXd> &UpperPart_dq,
     const vector<Eigen::VectorXd> &UpperPart_ddq,
-    deque<COMState> &outputDeltaCOMTraj_deq) {
+    RingBuffer<COMState> &outputDeltaCOMTraj_deq) {
   unsigned int N = (unsigned int)inputCOMTraj_deq_.size();
   deltaZMP_deq_.resize(N);
   if (useDynamicFilter_) {
@@ -231,22 +414,45 @@ int DynamicFilter::OffLinefilter(
 }
 
 int DynamicFilter::OnLinefilter(
-    const deque<COMState> &inputCOMTraj_deq_,
-    const deque<ZMPPosition> &inputZMPTraj_deq_,
-    const deque<FootAbsolutePosition> &inputLeftFootTraj_deq_,
-    const deque<FootAbsolutePosition> &inputRightFootTraj_deq_,
-    deque<COMState> &outputDeltaCOMTraj_deq_) {
+    const RingBuffer<COMState> &inputCOMTraj_deq_,
+    const RingBuffer<ZMPPosition> &inputZMPTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> &inputLeftFootTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> &inputRightFootTraj_deq_,
+    RingBuffer<COMState> &outputDeltaCOMTraj_deq_) {
+  assert(outputDeltaCOMTraj_deq_.size() == deltaCOM_.size());
+  int r = OnLinefilter(inputCOMTraj_deq_, inputZMPTraj_deq_,
+                       inputLeftFootTraj_deq_, inputRightFootTraj_deq_,
+                       deltaCOM_);
+  deltaCOM_.store(outputDeltaCOMTraj_deq_, 0, deltaCOM_.size(), COM_XY);
+  return r;
+}
+
+int DynamicFilter::OnLinefilter(
+    const RingBuffer<COMState> &inputCOMTraj_deq_,
+    const RingBuffer<ZMPPosition> &inputZMPTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> &inputLeftFootTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> &inputRightFootTraj_deq_,
+    COMStateBlock &outputDeltaCOM) {
   unsigned int N = (unsigned int)inputRightFootTraj_deq_.size();
   int inc = (int)round(interpolationPeriod_ / controlPeriod_);
   unsigned int N1 = (unsigned int)((ZMPMB_vec_.size() - 1) * inc + 1);
   if (useDynamicFilter_) {
-    for (unsigned int i = 0; i < N; ++i) {
-      ComputeZMPMB(interpolationPeriod_, inputCOMTraj_deq_[i],
-                   inputLeftFootTraj_deq_[i], inputRightFootTraj_deq_[i],
-                   ZMPMB_vec_[i], stage1_,
-                   // currentIteration
-                   i);
-    }
+    // The upper body heuristic carries a state from one sample to the
+    // next, it is only computed by one thread.
+    if (incremental_ && !walkingHeuristic_)
+      ComputeZMPMBIncremental(N, inputCOMTraj_deq_, inputLeftFootTraj_deq_,
+                              inputRightFootTraj_deq_);
+    else if (!workers_.empty() && !walkingHeuristic_)
+      ComputeZMPMBParallel(N, inputCOMTraj_deq_, inputLeftFootTraj_deq_,
+                           inputRightFootTraj_deq_);
+    else
+      for (unsigned int i = 0; i < N; ++i) {
+        ComputeZMPMB(interpolationPeriod_, inputCOMTraj_deq_[i],
+                     inputLeftFootTraj_deq_[i], inputRightFootTraj_deq_[i],
+                     ZMPMB_vec_[i], stage1_,
+                     // currentIteration
+                     i);
+      }
 
     ZMPMB_vec_[0][0] = inputZMPTraj_deq_[0].px;
     ZMPMB_vec_[0][1] = inputZMPTraj_deq_[0].py;
@@ -280,30 +486,34 @@ int DynamicFilter::OnLinefilter(
         zmpmb_i_[i * inc] = ZMPMB_vec_[i];
       }
 
-      vector<vector<double> > dZMPMB_vec(N, vector<double>(2, 0.0));
-      dZMPMB_vec[0][0] = (ZMPMB_vec_[1][0] - ZMPMB_vec_[0][0]) / inc;
-      dZMPMB_vec[0][1] = (ZMPMB_vec_[1][1] - ZMPMB_vec_[0][1]) / inc;
-      dZMPMB_vec[N - 1][0] =
+      // dZMPMB_vec_ is allocated in init().
+      if (dZMPMB_vec_.size() < N)
+        dZMPMB_vec_.resize(N, vector<double>(2, 0.0));
+      for (unsigned i = 0; i < N; ++i) {
+        dZMPMB_vec_[i][0] = 0.0;
+        dZMPMB_vec_[i][1] = 0.0;
+      }
+      dZMPMB_vec_[0][0] = (ZMPMB_vec_[1][0] - ZMPMB_vec_[0][0]) / inc;
+      dZMPMB_vec_[0][1] = (ZMPMB_vec_[1][1] - ZMPMB_vec_[0][1]) / inc;
+      dZMPMB_vec_[N - 1][0] =
           (ZMPMB_vec_[N - 1][0] - ZMPMB_vec_[N - 2][0]) / inc;
-      dZMPMB_vec[N - 1][1] =
+      dZMPMB_vec_[N - 1][1] =
           (ZMPMB_vec_[N - 1][1] - ZMPMB_vec_[N - 2][1]) / inc;
       for (unsigned i = 1; i < N - 2; ++i) {
-        dZMPMB_vec[i][0] =
+        dZMPMB_vec_[i][0] =
             (ZMPMB_vec_[i + 1][0] - ZMPMB_vec_[i - 1][0]) / (2 * inc);
-        dZMPMB_vec[i][1] =
+        dZMPMB_vec_[i][1] =
             (ZMPMB_vec_[i + 1][1] - ZMPMB_vec_[i - 1][1]) / (2 * inc);
       }
       for (unsigned i = 0; i < N - 1; ++i) {
-        Polynome5 polyX(1.0, 0.0);
-        Polynome5 polyY(1.0, 0.0);
-        polyX.SetParameters(inc, ZMPMB_vec_[i][0], dZMPMB_vec[i][0], 0.0,
-                            ZMPMB_vec_[i + 1][0], dZMPMB_vec[i + 1][0], 0.0);
-        polyY.SetParameters(inc, ZMPMB_vec_[i][1], dZMPMB_vec[i][1], 0.0,
-                            ZMPMB_vec_[i + 1][1], dZMPMB_vec[i + 1][1], 0.0);
+        polyX_.SetParameters(inc, ZMPMB_vec_[i][0], dZMPMB_vec_[i][0], 0.0,
+                             ZMPMB_vec_[i + 1][0], dZMPMB_vec_[i + 1][0], 0.0);
+        polyY_.SetParameters(inc, ZMPMB_vec_[i][1], dZMPMB_vec_[i][1], 0.0,
+                             ZMPMB_vec_[i + 1][1], dZMPMB_vec_[i + 1][1], 0.0);
 
         for (int j = 1; j < inc; ++j) {
-          zmpmb_i_[(i * inc) + j][0] = polyX.Compute(j);
-          zmpmb_i_[(i * inc) + j][1] = polyY.Compute(j);
+          zmpmb_i_[(i * inc) + j][0] = polyX_.Compute(j);
+          zmpmb_i_[(i * inc) + j][1] = polyY_.Compute(j);
           zmpmb_i_[(i * inc) + j][2] = 0.0;
         }
       }
@@ -321,7 +531,14 @@ int DynamicFilter::OnLinefilter(
     }
   }
 
-  OptimalControl(deltaZMP_deq_, outputDeltaCOMTraj_deq_);
+  // The correction is applied latency_ samples after the start of the
+  // preview: the error is previewed from there, and held at its end.
+  for (unsigned int i = 0; (i < latency_) && !deltaZMP_deq_.empty(); ++i) {
+    deltaZMP_deq_.pop_front();
+    deltaZMP_deq_.push_back(deltaZMP_deq_.back());
+  }
+
+  OptimalControl(deltaZMP_deq_, outputDeltaCOM);
 
   return 0;
 }
@@ -331,59 +548,115 @@ int DynamicFilter::zmpmb(Eigen::VectorXd &configuration,
                          Eigen::VectorXd &velocity,
                          Eigen::VectorXd &acceleration,
                          Eigen::Vector3d &zmpmb) {
-  PR_->computeInverseDynamics(configuration, velocity, acceleration);
-  PR_->zeroMomentumPoint(zmpmb);
+  ComputeZMPMB(PR_, configuration, velocity, acceleration, zmpmb);
   return 0;
 }
 
+void DynamicFilter::ComputeZMPMB(PinocchioRobot *aPR,
+                                 Eigen::VectorXd &configuration,
+                                 Eigen::VectorXd &velocity,
+                                 Eigen::VectorXd &acceleration,
+                                 Eigen::Vector3d &ZMPMB) {
+  if (centroidalZMPMB_) {
+    aPR->computeCentroidalDynamics(configuration, velocity, acceleration);
+    aPR->centroidalZeroMomentumPoint(ZMPMB);
+  } else {
+    aPR->computeInverseDynamics(configuration, velocity, acceleration);
+    aPR->zeroMomentumPoint(ZMPMB);
+  }
+}
+
 //##################################
 void DynamicFilter::InverseKinematics(
     const COMState &inputCoMState, const FootAbsolutePosition &inputLeftFoot,
     const FootAbsolutePosition &inputRightFoot, Eigen::VectorXd &configuration,
     Eigen::VectorXd &velocity, Eigen::VectorXd &acceleration,
     double samplingPeriod, int stage, int iteration) {
+  InverseKinematics(mainWorkspace_, inputCoMState, inputLeftFoot,
+                    inputRightFoot, configuration, velocity, acceleration,
+                    samplingPeriod, stage, iteration);
+}
 
+void DynamicFilter::SetPostureInputs(
+    zmpmb_workspace_t &aWS, const COMState &inputCoMState,
+    const FootAbsolutePosition &inputLeftFoot,
+    const FootAbsolutePosition &inputRightFoot) {
   // lower body !!!!! the angular quantities are set in degree !!!!!!
-  aCoMState_(0) = inputCoMState.x[0];
-  aCoMSpeed_(0) = inputCoMState.x[1];
-  aCoMState_(1) = inputCoMState.y[0];
-  aCoMSpeed_(1) = inputCoMState.y[1];
-  aCoMState_(2) = inputCoMState.z[0];
-  aCoMSpeed_(2) = inputCoMState.z[1];
-  aCoMState_(3) = inputCoMState.roll[0];
-  aCoMSpeed_(3) = inputCoMState.roll[1];
-  aCoMState_(4) = inputCoMState.pitch[0];
-  aCoMSpeed_(4) = inputCoMState.pitch[1];
-  aCoMState_(5) = inputCoMState.yaw[0];
-  aCoMSpeed_(5) = inputCoMState.yaw[1];
-
-  aCoMAcc_(0) = inputCoMState.x[2];
-  aLeftFootPosition_(0) = inputLeftFoot.x;
-  aCoMAcc_(1) = inputCoMState.y[2];
-  aLeftFootPosition_(1) = inputLeftFoot.y;
-  aCoMAcc_(2) = inputCoMState.z[2];
-  aLeftFootPosition_(2) = inputLeftFoot.z;
-  aCoMAcc_(3) = inputCoMState.roll[2];
-  aLeftFootPosition_(3) = inputLeftFoot.theta;
-  aCoMAcc_(4) = inputCoMState.pitch[2];
-  aLeftFootPosition_(4) = inputLeftFoot.omega;
-  aCoMAcc_(5) = inputCoMState.yaw[2];
-
-  aRightFootPosition_(0) = inputRightFoot.x;
-  aRightFootPosition_(1) = inputRightFoot.y;
-  aRightFootPosition_(2) = inputRightFoot.z;
-  aRightFootPosition_(3) = inputRightFoot.theta;
-  aRightFootPosition_(4) = inputRightFoot.omega;
+  aWS.aCoMState(0) = inputCoMState.x[0];
+  aWS.aCoMSpeed(0) = inputCoMState.x[1];
+  aWS.aCoMState(1) = inputCoMState.y[0];
+  aWS.aCoMSpeed(1) = inputCoMState.y[1];
+  aWS.aCoMState(2) = inputCoMState.z[0];
+  aWS.aCoMSpeed(2) = inputCoMState.z[1];
+  aWS.aCoMState(3) = inputCoMState.roll[0];
+  aWS.aCoMSpeed(3) = inputCoMState.roll[1];
+  aWS.aCoMState(4) = inputCoMState.pitch[0];
+  aWS.aCoMSpeed(4) = inputCoMState.pitch[1];
+  aWS.aCoMState(5) = inputCoMState.yaw[0];
+  aWS.aCoMSpeed(5) = inputCoMState.yaw[1];
+
+  aWS.aCoMAcc(0) = inputCoMState.x[2];
+  aWS.aLeftFootPosition(0) = inputLeftFoot.x;
+  aWS.aCoMAcc(1) = inputCoMState.y[2];
+  aWS.aLeftFootPosition(1) = inputLeftFoot.y;
+  aWS.aCoMAcc(2) = inputCoMState.z[2];
+  aWS.aLeftFootPosition(2) = inputLeftFoot.z;
+  aWS.aCoMAcc(3) = inputCoMState.roll[2];
+  aWS.aLeftFootPosition(3) = inputLeftFoot.theta;
+  aWS.aCoMAcc(4) = inputCoMState.pitch[2];
+  aWS.aLeftFootPosition(4) = inputLeftFoot.omega;
+  aWS.aCoMAcc(5) = inputCoMState.yaw[2];
+
+  aWS.aRightFootPosition(0) = inputRightFoot.x;
+  aWS.aRightFootPosition(1) = inputRightFoot.y;
+  aWS.aRightFootPosition(2) = inputRightFoot.z;
+  aWS.aRightFootPosition(3) = inputRightFoot.theta;
+  aWS.aRightFootPosition(4) = inputRightFoot.omega;
+}
+
+void DynamicFilter::ResizeLegsBatch(zmpmb_workspace_t &aWS) {
+  // Two legs per sample, the chunks never exceed the preview window.
+  Eigen::Index n = 2 * (Eigen::Index)ZMPMB_vec_.size();
+  aWS.legs.resize(n);
+  aWS.legsJoints.resize(n, 6);
+  aWS.legsFeasible.resize(n);
+}
+
+void DynamicFilter::InverseKinematics(
+    zmpmb_workspace_t &aWS, const COMState &inputCoMState,
+    const FootAbsolutePosition &inputLeftFoot,
+    const FootAbsolutePosition &inputRightFoot, Eigen::VectorXd &configuration,
+    Eigen::VectorXd &velocity, Eigen::VectorXd &acceleration,
+    double samplingPeriod, int stage, int iteration) {
+
+  SetPostureInputs(aWS, inputCoMState, inputLeftFoot, inputRightFoot);
 
   /*
-    std::cout << "aCoMState_ :" << aCoMState_ << std::endl
-    << " aCoMSpeed_ :" << aCoMSpeed_ << std::endl
-    << " aCoMAcc_ :" << aCoMAcc_ << std::endl;
+    std::cout << "aWS.aCoMState :" << aWS.aCoMState << std::endl
+    << " aWS.aCoMSpeed :" << aWS.aCoMSpeed << std::endl
+    << " aWS.aCoMAcc :" << aWS.aCoMAcc << std::endl;
   */
-  comAndFootRealization_->setSamplingPeriod(samplingPeriod);
-  comAndFootRealization_->ComputePostureForGivenCoMAndFeetPosture(
-      aCoMState_, aCoMSpeed_, aCoMAcc_, aLeftFootPosition_, aRightFootPosition_,
-      configuration, velocity, acceleration, iteration, stage);
+  aWS.comAndFootRealization->setSamplingPeriod(samplingPeriod);
+  if (analyticalRates_) {
+    aWS.aLeftFootSpeed << inputLeftFoot.dx, inputLeftFoot.dy, inputLeftFoot.dz,
+        inputLeftFoot.dtheta, inputLeftFoot.domega;
+    aWS.aLeftFootAcc << inputLeftFoot.ddx, inputLeftFoot.ddy,
+        inputLeftFoot.ddz, inputLeftFoot.ddtheta, inputLeftFoot.ddomega;
+    aWS.aRightFootSpeed << inputRightFoot.dx, inputRightFoot.dy,
+        inputRightFoot.dz, inputRightFoot.dtheta, inputRightFoot.domega;
+    aWS.aRightFootAcc << inputRightFoot.ddx, inputRightFoot.ddy,
+        inputRightFoot.ddz, inputRightFoot.ddtheta, inputRightFoot.ddomega;
+    aWS.comAndFootRealization->ComputePostureForGivenCoMAndFeetPosture(
+        aWS.aCoMState, aWS.aCoMSpeed, aWS.aCoMAcc, aWS.aLeftFootPosition,
+        aWS.aLeftFootSpeed, aWS.aLeftFootAcc, aWS.aRightFootPosition,
+        aWS.aRightFootSpeed, aWS.aRightFootAcc, configuration, velocity,
+        acceleration, stage);
+  } else {
+    aWS.comAndFootRealization->ComputePostureForGivenCoMAndFeetPosture(
+        aWS.aCoMState, aWS.aCoMSpeed, aWS.aCoMAcc, aWS.aLeftFootPosition,
+        aWS.aRightFootPosition, configuration, velocity, acceleration,
+        iteration, stage);
+  }
 
   // upper body
   if (walkingHeuristic_) {
@@ -438,60 +711,232 @@ void DynamicFilter::ComputeZMPMB(double samplingPeriod,
     //      ODEBUG3("ZMPMBConfiguration_:"<<ZMPMBConfiguration_);
     //      ODEBUG3("ZMPMBVelocity_:"<<ZMPMBVelocity_);
     //      ODEBUG3("ZMPMBAcceleration_:"<<ZMPMBAcceleration_);
-    PR_->computeInverseDynamics(ZMPMBConfiguration_, ZMPMBVelocity_,
-                                ZMPMBAcceleration_);
-
-    PR_->zeroMomentumPoint(ZMPMB);
+    ComputeZMPMB(PR_, ZMPMBConfiguration_, ZMPMBVelocity_, ZMPMBAcceleration_,
+                 ZMPMB);
   }
 
   return;
 }
 
-int DynamicFilter::OptimalControl(deque<ZMPPosition> &inputdeltaZMP_deq,
-                                  deque<COMState> &outputDeltaCOMTraj_deq_) {
+void DynamicFilter::ComputeZMPMBChunk(
+    zmpmb_workspace_t &aWS, unsigned int first, unsigned int last,
+    const RingBuffer<COMState> &inputCOMTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> &inputLeftFootTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> &inputRightFootTraj_deq_) {
+  // The velocity and the acceleration are finite differences
+  // over the two previous postures, unless they are derived
+  // from the ones of the CoM and of the feet.
+  unsigned int i = analyticalRates_ ? first : ((first > 2) ? first - 2 : 0);
+
+  // Solve the legs of all the samples at once, the postures below
+  // take their joints from the batch.
+  unsigned int iFirst = i;
+  Eigen::Index n = 2 * (Eigen::Index)(last - iFirst);
+  bool lBatched = (n <= aWS.legs.size());
+  if (lBatched) {
+    for (; i < last; ++i) {
+      SetPostureInputs(aWS, inputCOMTraj_deq_[i], inputLeftFootTraj_deq_[i],
+                       inputRightFootTraj_deq_[i]);
+      aWS.comAndFootRealization->LegsPoses(
+          aWS.aCoMState, aWS.aLeftFootPosition, aWS.aRightFootPosition,
+          aWS.legs, 2 * (i - iFirst));
+    }
+    lBatched = aWS.PR->ComputeLegsInverseKinematics(
+        aWS.legs, 0, n, aWS.legsJoints, aWS.legsFeasible);
+    i = iFirst;
+  }
+
+  for (; i < last; ++i) {
+    if (lBatched)
+      aWS.comAndFootRealization->UseLegsJoints(&aWS.legsJoints,
+                                               2 * (i - iFirst));
+    InverseKinematics(aWS, inputCOMTraj_deq_[i], inputLeftFootTraj_deq_[i],
+                      inputRightFootTraj_deq_[i], aWS.configuration,
+                      aWS.velocity, aWS.acceleration, interpolationPeriod_,
+                      stage1_, i);
+    if ((i >= first) && (i > 0)) {
+      ComputeZMPMB(aWS.PR, aWS.configuration, aWS.velocity, aWS.acceleration,
+                   ZMPMB_vec_[i]);
+    }
+  }
+  aWS.comAndFootRealization->UseLegsJoints(0, 0);
+}
+
+void DynamicFilter::ComputeZMPMBParallel(
+    unsigned int N, const RingBuffer<COMState> &inputCOMTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> &inputLeftFootTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> &inputRightFootTraj_deq_) {
+  // The posture parameters may have been changed since init().
+  for (unsigned int k = 0; k < workerWorkspaces_.size(); k++)
+    workerWorkspaces_[k].comAndFootRealization->CopyParameters(
+        *comAndFootRealization_);
+
+  {
+    std::lock_guard<std::mutex> lock(workersMutex_);
+    jobN_ = N;
+    jobCOMTraj_ = &inputCOMTraj_deq_;
+    jobLeftFootTraj_ = &inputLeftFootTraj_deq_;
+    jobRightFootTraj_ = &inputRightFootTraj_deq_;
+    nbBusyWorkers_ = (unsigned int)workers_.size();
+    jobId_++;
+  }
+  jobStarted_.notify_all();
+
+  unsigned int n = (unsigned int)workerWorkspaces_.size() + 1;
+  ComputeZMPMBChunk(mainWorkspace_, 0, N / n, inputCOMTraj_deq_,
+                    inputLeftFootTraj_deq_, inputRightFootTraj_deq_);
+
+  std::unique_lock<std::mutex> lock(workersMutex_);
+  jobDone_.wait(lock, [this] { return nbBusyWorkers_ == 0; });
+}
+
+namespace {
+bool sameCOMState(const COMState &a, const COMState &b, double tolerance) {
+  for (int j = 0; j < 3; j++)
+    if ((fabs(a.x[j] - b.x[j]) > tolerance) ||
+        (fabs(a.y[j] - b.y[j]) > tolerance) ||
+        (fabs(a.z[j] - b.z[j]) > tolerance) ||
+        (fabs(a.roll[j] - b.roll[j]) > tolerance) ||
+        (fabs(a.pitch[j] - b.pitch[j]) > tolerance) ||
+        (fabs(a.yaw[j] - b.yaw[j]) > tolerance))
+      return false;
+  return true;
+}
+
+bool sameFootPosition(const FootAbsolutePosition &a,
+                      const FootAbsolutePosition &b, double tolerance) {
+  const double la[15] = {a.x,   a.y,   a.z,   a.theta,   a.omega,
+                         a.dx,  a.dy,  a.dz,  a.dtheta,  a.domega,
+                         a.ddx, a.ddy, a.ddz, a.ddtheta, a.ddomega};
+  const double lb[15] = {b.x,   b.y,   b.z,   b.theta,   b.omega,
+                         b.dx,  b.dy,  b.dz,  b.dtheta,  b.domega,
+                         b.ddx, b.ddy, b.ddz, b.ddtheta, b.ddomega};
+  for (int j = 0; j < 15; j++)
+    if (fabs(la[j] - lb[j]) > tolerance)
+      return false;
+  return true;
+}
+
+bool sameVector(const Eigen::VectorXd &a, const Eigen::VectorXd &b,
+                double tolerance) {
+  return (a.size() == b.size()) &&
+         ((a.size() == 0) || ((a - b).cwiseAbs().maxCoeff() <= tolerance));
+}
+} // namespace
+
+void DynamicFilter::ComputeZMPMBIncremental(
+    unsigned int N, const RingBuffer<COMState> &inputCOMTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> &inputLeftFootTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> &inputRightFootTraj_deq_) {
+  // The previous call started one control window earlier.
+  unsigned int shift =
+      (unsigned int)round(controlWindowSize_ / interpolationPeriod_);
+  bool reuse =
+      cacheValid_ && (cacheN_ == N) && (shift > 0) &&
+      sameVector(upperPartConfiguration_, cachedUpperPartConfiguration_,
+                 incrementalTolerance_) &&
+      sameVector(upperPartVelocity_, cachedUpperPartVelocity_,
+                 incrementalTolerance_) &&
+      sameVector(upperPartAcceleration_, cachedUpperPartAcceleration_,
+                 incrementalTolerance_);
+
+  if (!reuse && !workers_.empty()) {
+    ComputeZMPMBParallel(N, inputCOMTraj_deq_, inputLeftFootTraj_deq_,
+                         inputRightFootTraj_deq_);
+    if (N > 0)
+      nbMisses_ += N - 1;
+  } else {
+    // With finite differences, the rates of a sample also depend on
+    // the two previous ones.
+    unsigned int nbPrevious = analyticalRates_ ? 0 : 2;
+    unsigned int nbMatching = 0;
+    // First sample of the current run of samples to compute, N if none.
+    unsigned int first = N;
+    for (unsigned int i = 0; i < N; ++i) {
+      unsigned int j = i + shift;
+      bool matching =
+          reuse && (j < N) &&
+          sameCOMState(inputCOMTraj_deq_[i], cachedCOMTraj_[j],
+                       incrementalTolerance_) &&
+          sameFootPosition(inputLeftFootTraj_deq_[i], cachedLeftFootTraj_[j],
+                           incrementalTolerance_) &&
+          sameFootPosition(inputRightFootTraj_deq_[i],
+                           cachedRightFootTraj_[j], incrementalTolerance_);
+      nbMatching = matching ? nbMatching + 1 : 0;
+
+      if ((i > nbPrevious) && (nbMatching > nbPrevious)) {
+        if (first < i)
+          ComputeZMPMBChunk(mainWorkspace_, first, i, inputCOMTraj_deq_,
+                            inputLeftFootTraj_deq_, inputRightFootTraj_deq_);
+        first = N;
+        ZMPMB_vec_[i] = cachedZMPMB_[j];
+        nbHits_++;
+      } else {
+        if (first == N)
+          first = i;
+        // The first sample is replaced by the reference ZMP.
+        if (i > 0)
+          nbMisses_++;
+      }
+    }
+    if (first < N)
+      ComputeZMPMBChunk(mainWorkspace_, first, N, inputCOMTraj_deq_,
+                        inputLeftFootTraj_deq_, inputRightFootTraj_deq_);
+  }
+
+  cachedCOMTraj_ = inputCOMTraj_deq_;
+  cachedLeftFootTraj_ = inputLeftFootTraj_deq_;
+  cachedRightFootTraj_ = inputRightFootTraj_deq_;
+  cachedZMPMB_ = ZMPMB_vec_;
+  cachedUpperPartConfiguration_ = upperPartConfiguration_;
+  cachedUpperPartVelocity_ = upperPartVelocity_;
+  cachedUpperPartAcceleration_ = upperPartAcceleration_;
+  cacheN_ = N;
+  cacheValid_ = true;
+}
+
+int DynamicFilter::OptimalControl(
+    RingBuffer<ZMPPosition> &inputdeltaZMP_deq,
+    RingBuffer<COMState> &outputDeltaCOMTraj_deq_) {
+  assert(outputDeltaCOMTraj_deq_.size() == deltaCOM_.size());
+  int r = OptimalControl(inputdeltaZMP_deq, deltaCOM_);
+  deltaCOM_.store(outputDeltaCOMTraj_deq_, 0, deltaCOM_.size(), COM_XY);
+  return r;
+}
+
+int DynamicFilter::OptimalControl(RingBuffer<ZMPPosition> &inputdeltaZMP_deq,
+                                  COMStateBlock &outputDeltaCOM) {
   assert(PC_->IsCoherent());
   std::size_t Nctrl = (int)round(controlWindowSize_ / controlPeriod_);
 
-  assert(outputDeltaCOMTraj_deq_.size() == Nctrl);
+  assert(outputDeltaCOM.size() >= Nctrl);
   double deltaZMPx = 0.0;
   double deltaZMPy = 0.0;
+  // The windows of the iterations overlap: load the queue once in
+  // contiguous storage, each iteration reads it from row i.
+  std::size_t NbOfRows = inputdeltaZMP_deq.size();
+  PreviewControl::LoadZMPWindow(inputdeltaZMP_deq, 0, NbOfRows,
+                                deltaZMPWindow_);
   // computation of the preview control along the "deltaZMP_deq_"
-  //  for(unsigned i=0;i<3;++i)
-  //  {
-  //    deltax_(i,0)=0.0;
-  //    deltay_(i,0)=0.0;
-  //  }
-  static unsigned int localIt = 0;
-
   for (std::size_t i = 0; i < Nctrl; ++i) {
     PC_->OneIterationOfPreview(deltax_, deltay_, sxzmp_[0], syzmp_[0],
-                               inputdeltaZMP_deq, i, deltaZMPx, deltaZMPy,
-                               false);
-    ODEBUG5(localIt++ << " (" << i << ") " << inputdeltaZMP_deq[i].px << " "
-                      << inputdeltaZMP_deq[i].py << " " << deltax_(0, 0) << " "
-                      << deltay_(0, 0),
+                               deltaZMPWindow_, NbOfRows, i, deltaZMPx,
+                               deltaZMPy, false);
+    ODEBUG4(optimalControlIt_++ << " (" << i << ") "
+                                << inputdeltaZMP_deq[i].px << " "
+                                << inputdeltaZMP_deq[i].py << " "
+                                << deltax_(0, 0) << " " << deltay_(0, 0),
             "/tmp/dynamical_filter_dcom.dat");
 
-    for (int j = 0; j < 3; ++j) {
-      outputDeltaCOMTraj_deq_[i].x[j] = deltax_(j, 0);
-      outputDeltaCOMTraj_deq_[i].y[j] = deltay_(j, 0);
-    }
+    outputDeltaCOM.x.row((Eigen::Index)i) = deltax_.col(0).transpose();
+    outputDeltaCOM.y.row((Eigen::Index)i) = deltay_.col(0).transpose();
   }
   // test to verify if the Kajita PC diverged
-  for (std::size_t i = 0; i < Nctrl; ++i) {
-    for (int j = 0; j < 3; ++j) {
-      if ((outputDeltaCOMTraj_deq_[i].x[j] ==
-           outputDeltaCOMTraj_deq_[i].x[j]) ||
-          (outputDeltaCOMTraj_deq_[i].y[j] ==
-           outputDeltaCOMTraj_deq_[i].y[j])) {
-      } else {
-        cout << "kajita2003 preview control diverged "
-             << outputDeltaCOMTraj_deq_[i].x[j] << " "
-             << outputDeltaCOMTraj_deq_[i].y[j] << " " << deltaZMPx << " "
-             << deltaZMPy << "\n";
-        return -1;
-      }
-    }
+  if (!outputDeltaCOM.x.topRows((Eigen::Index)Nctrl).allFinite() ||
+      !outputDeltaCOM.y.topRows((Eigen::Index)Nctrl).allFinite()) {
+    cout << "kajita2003 preview control diverged " << deltaZMPx << " "
+         << deltaZMPy << "\n";
+    return -1;
   }
   return 0;
 }
@@ -674,15 +1119,15 @@ int DynamicFilter::OptimalControl(deque<ZMPPosition> &inputdeltaZMP_deq,
 //}
 
 void DynamicFilter::Debug(
-    const deque<COMState> &ctrlCoMState,
-    const deque<FootAbsolutePosition> &ctrlLeftFoot,
-    const deque<FootAbsolutePosition> &ctrlRightFoot,
-    const deque<COMState> &inputCOMTraj_deq_,
-    const deque<ZMPPosition> inputZMPTraj_deq_,
-    const deque<FootAbsolutePosition> &inputLeftFootTraj_deq_,
-    const deque<FootAbsolutePosition> &inputRightFootTraj_deq_,
-    const deque<COMState> &outputDeltaCOMTraj_deq_) {
-  deque<COMState> CoM_tmp = ctrlCoMState;
+    const RingBuffer<COMState> &ctrlCoMState,
+    const RingBuffer<FootAbsolutePosition> &ctrlLeftFoot,
+    const RingBuffer<FootAbsolutePosition> &ctrlRightFoot,
+    const RingBuffer<COMState> &inputCOMTraj_deq_,
+    const RingBuffer<ZMPPosition> inputZMPTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> &inputLeftFootTraj_deq_,
+    const RingBuffer<FootAbsolutePosition> &inputRightFootTraj_deq_,
+    const RingBuffer<COMState> &outputDeltaCOMTraj_deq_) {
+  RingBuffer<COMState> CoM_tmp = ctrlCoMState;
   int Nctrl = (int)round(controlWindowSize_ / controlPeriod_);
 
   for (int i = 0; i < Nctrl; ++i) {
@@ -722,11 +1167,10 @@ void DynamicFilter::Debug(
   int inc = (int)round(interpolationPeriod_ / controlPeriod_);
   ofstream aof;
   string aFileName;
-  static int iteration_zmp = 0;
   ostringstream oss(std::ostringstream::ate);
   oss.str("/tmp/zmpmb_herdt.txt");
   aFileName = oss.str();
-  if (iteration_zmp == 0) {
+  if (debugIteration_ == 0) {
     aof.open(aFileName.c_str(), ofstream::out);
     aof.close();
   }
@@ -736,7 +1180,7 @@ void DynamicFilter::Debug(
   aof.setf(ios::scientific, ios::floatfield);
   int NbI = (int)round(controlWindowSize_ / interpolationPeriod_);
   for (int i = 0; i < NbI; ++i) {
-    aof << (iteration_zmp + i) * interpolationPeriod_ << " "; // 1
+    aof << (debugIteration_ + i) * interpolationPeriod_ << " "; // 1
 
     aof << inputZMPTraj_deq_[i * inc].px << " "; // 1
     aof << inputZMPTraj_deq_[i * inc].py << " "; // 2
@@ -824,7 +1268,7 @@ void DynamicFilter::Debug(
   aof.close();
 
   aFileName = "/tmp/zmpmb_corr_herdt.txt";
-  if (iteration_zmp == 0) {
+  if (debugIteration_ == 0) {
     aof.open(aFileName.c_str(), ofstream::out);
     aof.close();
   }
@@ -857,7 +1301,7 @@ void DynamicFilter::Debug(
   aof.close();
 
   oss.str("/tmp/buffer_");
-  oss << setfill('0') << setw(3) << iteration_zmp << ".txt";
+  oss << setfill('0') << setw(3) << debugIteration_ << ".txt";
   aFileName = oss.str();
   aof.open(aFileName.c_str(), ofstream::out);
   aof.close();
@@ -927,6 +1371,6 @@ void DynamicFilter::Debug(
     aof << endl;
   }
   aof.close();
-  iteration_zmp++;
+  debugIteration_++;
   return;
 }
@@ -29,8 +29,15 @@
 #ifndef DYNAMICFILTER_HH
 #define DYNAMICFILTER_HH
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include "Clock.hh"
+#include <Mathematics/PolynomeFoot.hh>
 #include <MotionGeneration/ComAndFootRealizationByGeometry.hh>
+#include <RingBuffer.hh>
+#include <TrajectoryBlock.hh>
 
 namespace PatternGeneratorJRL {
 
@@ -40,20 +47,31 @@ public: // Public methods
   DynamicFilter(SimplePluginManager *SPM, PinocchioRobot *aPR);
   ~DynamicFilter();
   /// \brief
-  int OffLinefilter(const deque<COMState> &inputCOMTraj_deq_,
-                    const deque<ZMPPosition> &inputZMPTraj_deq_,
-                    const deque<FootAbsolutePosition> &inputLeftFootTraj_deq_,
-                    const deque<FootAbsolutePosition> &inputRightFootTraj_deq_,
-                    const vector<Eigen::VectorXd> &UpperPart_q,
-                    const vector<Eigen::VectorXd> &UpperPart_dq,
-                    const vector<Eigen::VectorXd> &UpperPart_ddq,
-                    deque<COMState> &outputDeltaCOMTraj_deq_);
-
-  int OnLinefilter(const deque<COMState> &inputCOMTraj_deq_,
-                   const deque<ZMPPosition> &inputZMPTraj_deq_,
-                   const deque<FootAbsolutePosition> &inputLeftFootTraj_deq_,
-                   const deque<FootAbsolutePosition> &inputRightFootTraj_deq_,
-                   deque<COMState> &outputDeltaCOMTraj_deq_);
+  int OffLinefilter(
+      const RingBuffer<COMState> &inputCOMTraj_deq_,
+      const RingBuffer<ZMPPosition> &inputZMPTraj_deq_,
+      const RingBuffer<FootAbsolutePosition> &inputLeftFootTraj_deq_,
+      const RingBuffer<FootAbsolutePosition> &inputRightFootTraj_deq_,
+      const vector<Eigen::VectorXd> &UpperPart_q,
+      const vector<Eigen::VectorXd> &UpperPart_dq,
+      const vector<Eigen::VectorXd> &UpperPart_ddq,
+      RingBuffer<COMState> &outputDeltaCOMTraj_deq_);
+
+  int OnLinefilter(
+      const RingBuffer<COMState> &inputCOMTraj_deq_,
+      const RingBuffer<ZMPPosition> &inputZMPTraj_deq_,
+      const RingBuffer<FootAbsolutePosition> &inputLeftFootTraj_deq_,
+      const RingBuffer<FootAbsolutePosition> &inputRightFootTraj_deq_,
+      RingBuffer<COMState> &outputDeltaCOMTraj_deq_);
+
+  /// \brief Same as above, the correction of the CoM is written along
+  /// x and y in the first samples of a block allocated by the caller.
+  int OnLinefilter(
+      const RingBuffer<COMState> &inputCOMTraj_deq_,
+      const RingBuffer<ZMPPosition> &inputZMPTraj_deq_,
+      const RingBuffer<FootAbsolutePosition> &inputLeftFootTraj_deq_,
+      const RingBuffer<FootAbsolutePosition> &inputRightFootTraj_deq_,
+      COMStateBlock &outputDeltaCOM);
 
   void init(double controlPeriod, double interpolationPeriod,
             double controlWindowSize, double previewWindowSize,
@@ -77,9 +95,34 @@ public: // Public methods
 
   void stage0INstage1();
 
+  /// \brief Number of threads computing the ZMP multibody along the
+  /// preview window, including the calling one. The threads are
+  /// started by the next call to init().
+  void setNbThreads(unsigned int nbThreads);
+  inline unsigned int getNbThreads() const { return nbThreads_; }
+
+  /// \brief Reuse the ZMP multibody computed by the previous call to
+  /// OnLinefilter for the samples whose CoM, feet and upper body moved
+  /// by less than tolerance, once shifted by the control window.
+  void setIncremental(bool incremental, double tolerance = 1e-9);
+  inline bool getIncremental() const { return incremental_; }
+  /// \brief Number of samples whose ZMP multibody was reused (hits)
+  /// or computed (misses) since the last reset.
+  inline unsigned long getIncrementalHits() const { return nbHits_; }
+  inline unsigned long getIncrementalMisses() const { return nbMisses_; }
+  void resetIncrementalCounters();
+
+  /// \brief Number of control samples between the start of the preview
+  /// given to OnLinefilter and the first sample the correction is
+  /// applied to, when the filter runs behind the trajectories.
+  inline void setLatency(unsigned int nbSamples) { latency_ = nbSamples; }
+  inline unsigned int getLatency() const { return latency_; }
+
   /// \brief Preview control on the ZMPMBs computed
-  int OptimalControl(deque<ZMPPosition> &inputdeltaZMP_deq,
-                     deque<COMState> &outputDeltaCOMTraj_deq_);
+  int OptimalControl(RingBuffer<ZMPPosition> &inputdeltaZMP_deq,
+                     RingBuffer<COMState> &outputDeltaCOMTraj_deq_);
+  int OptimalControl(RingBuffer<ZMPPosition> &inputdeltaZMP_deq,
+                     COMStateBlock &outputDeltaCOM);
 
   /// \brief compute the zmpmb from articulated pos vel and acc
   int zmpmb(Eigen::VectorXd &configuration, Eigen::VectorXd &velocity,
@@ -89,6 +132,61 @@ public: // Public methods
 
 private: // Private methods
          // void computeWaist(const FootAbsolutePosition & inputLeftFoot) ;
+
+  struct zmpmb_workspace_t;
+
+  /// \brief Copy the CoM and feet of a sample in the buffers of aWS,
+  /// the angles in degrees.
+  void SetPostureInputs(zmpmb_workspace_t &aWS, const COMState &inputCoMState,
+                        const FootAbsolutePosition &inputLeftFoot,
+                        const FootAbsolutePosition &inputRightFoot);
+
+  /// \brief Allocate the batch of legs of aWS for the longest chunk.
+  void ResizeLegsBatch(zmpmb_workspace_t &aWS);
+
+  void InverseKinematics(zmpmb_workspace_t &aWS, const COMState &inputCoMState,
+                         const FootAbsolutePosition &inputLeftFoot,
+                         const FootAbsolutePosition &inputRightFoot,
+                         Eigen::VectorXd &configuration,
+                         Eigen::VectorXd &velocity,
+                         Eigen::VectorXd &acceleration, double samplingPeriod,
+                         int stage, int iteration);
+
+  /// \brief Compute the ZMP multibody of the samples [first,last[
+  /// in ZMPMB_vec_, after replaying the posture of the two previous
+  /// samples to seed the finite differences. The legs of all these
+  /// samples are solved at once.
+  void ComputeZMPMBChunk(
+      zmpmb_workspace_t &aWS, unsigned int first, unsigned int last,
+      const RingBuffer<COMState> &inputCOMTraj_deq_,
+      const RingBuffer<FootAbsolutePosition> &inputLeftFootTraj_deq_,
+      const RingBuffer<FootAbsolutePosition> &inputRightFootTraj_deq_);
+
+  /// \brief Split the N first samples between the threads.
+  void ComputeZMPMBParallel(
+      unsigned int N, const RingBuffer<COMState> &inputCOMTraj_deq_,
+      const RingBuffer<FootAbsolutePosition> &inputLeftFootTraj_deq_,
+      const RingBuffer<FootAbsolutePosition> &inputRightFootTraj_deq_);
+
+  /// \brief ZMP multibody of aPR in the given state, computed
+  /// as set by centroidalZMPMB_.
+  void ComputeZMPMB(PinocchioRobot *aPR, Eigen::VectorXd &configuration,
+                    Eigen::VectorXd &velocity, Eigen::VectorXd &acceleration,
+                    Eigen::Vector3d &ZMPMB);
+
+  /// \brief Compute the ZMP multibody of the N first samples, only on
+  /// the ones which differ from the previous call, and keep the inputs
+  /// and the results for the next one.
+  void ComputeZMPMBIncremental(
+      unsigned int N, const RingBuffer<COMState> &inputCOMTraj_deq_,
+      const RingBuffer<FootAbsolutePosition> &inputLeftFootTraj_deq_,
+      const RingBuffer<FootAbsolutePosition> &inputRightFootTraj_deq_);
+
+  void startWorkers();
+  void stopWorkers();
+  /// \brief Loop of the thread k, which handles the jobs posted
+  /// after lastJobId.
+  void worker(unsigned int k, unsigned long lastJobId);
   // -------------------------------------------------------------------
 
 public: // The accessors
@@ -142,12 +240,29 @@ private: // Private members
   /// \brief Store a reference to the object to solve posture resolution.
   ComAndFootRealizationByGeometry *comAndFootRealization_;
 
-  /// \brief Buffers for the Inverse Kinematics
-  Eigen::VectorXd aCoMState_;
-  Eigen::VectorXd aCoMSpeed_;
-  Eigen::VectorXd aCoMAcc_;
-  Eigen::VectorXd aLeftFootPosition_;
-  Eigen::VectorXd aRightFootPosition_;
+  /// \brief Robot, posture resolution and buffers for the Inverse
+  /// Kinematics, one set per thread computing the ZMP multibody.
+  struct zmpmb_workspace_t {
+    PinocchioRobot *PR;
+    ComAndFootRealizationByGeometry *comAndFootRealization;
+    Eigen::VectorXd aCoMState;
+    Eigen::VectorXd aCoMSpeed;
+    Eigen::VectorXd aCoMAcc;
+    Eigen::VectorXd aLeftFootPosition;
+    Eigen::VectorXd aRightFootPosition;
+    Eigen::VectorXd aLeftFootSpeed, aLeftFootAcc;
+    Eigen::VectorXd aRightFootSpeed, aRightFootAcc;
+    Eigen::VectorXd configuration;
+    Eigen::VectorXd velocity;
+    Eigen::VectorXd acceleration;
+    /// \brief Legs of the samples of a chunk, solved at once.
+    PRLegsBatch legs;
+    Eigen::Array<double, Eigen::Dynamic, 6> legsJoints;
+    Eigen::Array<bool, Eigen::Dynamic, 1> legsFeasible;
+  };
+  /// \brief Buffers of the calling thread, on PR_ and
+  /// comAndFootRealization_.
+  zmpmb_workspace_t mainWorkspace_;
 
   /// \brief used to compute the ZMPMB from only
   /// com and feet position from outside of the class
@@ -186,6 +301,13 @@ private: // Private members
 
   bool walkingHeuristic_;
   bool useDynamicFilter_;
+  /// \brief Joint velocities and accelerations derived from the ones
+  /// of the CoM and of the feet through the leg Jacobians, instead of
+  /// finite differences.
+  bool analyticalRates_;
+  /// \brief ZMP multibody from the rate of the centroidal momentum
+  /// instead of the inverse dynamics.
+  bool centroidalZMPMB_;
 
   /// Class that compute the dynamic and kinematic of the robot
   PinocchioRobot *PR_;
@@ -198,7 +320,11 @@ private: // Private members
   /// sampled at control sampling period
   deque<Eigen::Vector3d> zmpmb_i_;
   /// sampled at control sampling period
-  std::deque<ZMPPosition> deltaZMP_deq_;
+  RingBuffer<ZMPPosition> deltaZMP_deq_;
+  /// \brief Derivative of the ZMP multibody and polynomials
+  /// interpolating it at the control sampling period, allocated once
+  vector<vector<double> > dZMPMB_vec_;
+  Polynome5 polyX_, polyY_;
 
   /// \brief Optimal Control variables
   /// --------------------------------
@@ -210,8 +336,14 @@ private: // Private members
   double CoMHeight_;
 
   /// \brief State of the Preview control.
-  Eigen::MatrixXd deltax_;
-  Eigen::MatrixXd deltay_;
+  CartTable::state_t deltax_;
+  CartTable::state_t deltay_;
+  /// \brief Correction of the CoM over the control window, kept for
+  /// the methods filling a queue of COMState.
+  COMStateBlock deltaCOM_;
+  /// \brief Delta ZMP loaded once for all the iterations of the
+  /// preview control over the control window.
+  PreviewControl::ZMPWindow deltaZMPWindow_;
 
   /// \brief time measurement
   Clock clock_;
@@ -222,18 +354,68 @@ private: // Private members
 
   const unsigned int MODE_PC_;
 
+  /// \brief Parallel computation of the ZMP multibody
+  /// --------------------------------
+  /// \brief Number of threads, including the calling one.
+  unsigned int nbThreads_;
+  /// \brief Clones of the robot, kept from one initialization to the
+  /// next one.
+  PinocchioRobotPool *robotPool_;
+  /// \brief Workspaces of the other threads, each one uses a clone
+  /// of the robot and owns its own posture resolution.
+  std::vector<zmpmb_workspace_t> workerWorkspaces_;
+  std::vector<std::thread> workers_;
+  std::mutex workersMutex_;
+  std::condition_variable jobStarted_, jobDone_;
+  /// \brief Incremented each time a job is posted.
+  unsigned long jobId_;
+  /// \brief Number of threads still working on the current job.
+  unsigned int nbBusyWorkers_;
+  bool stopWorkers_;
+  /// \brief Current job.
+  unsigned int jobN_;
+  const RingBuffer<COMState> *jobCOMTraj_;
+  const RingBuffer<FootAbsolutePosition> *jobLeftFootTraj_;
+  const RingBuffer<FootAbsolutePosition> *jobRightFootTraj_;
+
+  /// \brief Incremental computation of the ZMP multibody
+  /// --------------------------------
+  bool incremental_;
+  /// \brief Largest difference on the inputs of a sample for which
+  /// its ZMP multibody is reused, in the units of the inputs.
+  double incrementalTolerance_;
+  /// \brief Inputs and ZMP multibody of the previous call, valid
+  /// until the next init() or option change.
+  bool cacheValid_;
+  unsigned int cacheN_;
+  RingBuffer<COMState> cachedCOMTraj_;
+  RingBuffer<FootAbsolutePosition> cachedLeftFootTraj_;
+  RingBuffer<FootAbsolutePosition> cachedRightFootTraj_;
+  deque<Eigen::Vector3d> cachedZMPMB_;
+  Eigen::VectorXd cachedUpperPartConfiguration_;
+  Eigen::VectorXd cachedUpperPartVelocity_;
+  Eigen::VectorXd cachedUpperPartAcceleration_;
+  unsigned long nbHits_, nbMisses_;
+
+  /// \brief Delay of the correction, in control samples.
+  unsigned int latency_;
+
+  /// \brief Iteration counters of the debug traces, kept per instance
+  unsigned int optimalControlIt_;
+  int debugIteration_;
+
 public: // debug functions
   // to use the vector of eigen used by metapod
   // EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
-  void Debug(const deque<COMState> &ctrlCoMState,
-             const deque<FootAbsolutePosition> &ctrlLeftFoot,
-             const deque<FootAbsolutePosition> &ctrlRightFoot,
-             const deque<COMState> &inputCOMTraj_deq_,
-             const deque<ZMPPosition> inputZMPTraj_deq_,
-             const deque<FootAbsolutePosition> &inputLeftFootTraj_deq_,
-             const deque<FootAbsolutePosition> &inputRightFootTraj_deq_,
-             const deque<COMState> &outputDeltaCOMTraj_deq_);
+  void Debug(const RingBuffer<COMState> &ctrlCoMState,
+             const RingBuffer<FootAbsolutePosition> &ctrlLeftFoot,
+             const RingBuffer<FootAbsolutePosition> &ctrlRightFoot,
+             const RingBuffer<COMState> &inputCOMTraj_deq_,
+             const RingBuffer<ZMPPosition> inputZMPTraj_deq_,
+             const RingBuffer<FootAbsolutePosition> &inputLeftFootTraj_deq_,
+             const RingBuffer<FootAbsolutePosition> &inputRightFootTraj_deq_,
+             const RingBuffer<COMState> &outputDeltaCOMTraj_deq_);
 };
 
 } // namespace PatternGeneratorJRL
@@ -88,15 +88,15 @@ OrientationsPreview::~OrientationsPreview() {}
 
 void OrientationsPreview::preview_orientations(
     double Time, const reference_t &Ref, double StepDuration,
-    const std::deque<FootAbsolutePosition> &LeftFootPositions_deq,
-    const std::deque<FootAbsolutePosition> &RightFootPositions_deq,
+    const RingBuffer<FootAbsolutePosition> &LeftFootPositions_deq,
+    const RingBuffer<FootAbsolutePosition> &RightFootPositions_deq,
     solution_t &Solution) {
 
-  const deque<support_state_t> &PrwSupportStates_deq =
+  const RingBuffer<support_state_t> &PrwSupportStates_deq =
       Solution.SupportStates_deq;
-  std::deque<double> &PreviewedSupportAngles_deq =
+  RingBuffer<double> &PreviewedSupportAngles_deq =
       Solution.SupportOrientations_deq;
-  std::deque<double> &PreviewedTrunkOrientations_deq =
+  RingBuffer<double> &PreviewedTrunkOrientations_deq =
       Solution.TrunkOrientations_deq;
 
   support_state_t CurrentSupport = PrwSupportStates_deq.front();
@@ -119,7 +119,7 @@ void OrientationsPreview::preview_orientations(
   signRotVelTrunk_ = (TrunkStateT_.yaw[1] < 0.0) ? -1.0 : 1.0;
 
   // compute the number of iteration before landing on the first previewed step
-  std::deque<support_state_t>::const_iterator SPTraj_it =
+  RingBuffer<support_state_t>::const_iterator SPTraj_it =
       Solution.SupportStates_deq.begin();
   int ItBeforeLanding = 0;
   while (SPTraj_it != Solution.SupportStates_deq.end()) {
@@ -280,7 +280,7 @@ void OrientationsPreview::preview_orientations(
                                              TrunkStateT_.yaw[1] * T_);
   }
 
-  std::deque<support_state_t>::iterator prwSS_it =
+  RingBuffer<support_state_t>::iterator prwSS_it =
       Solution.SupportStates_deq.begin();
   double supportAngle = prwSS_it->Yaw;
   prwSS_it++; // Point at the first previewed instant
@@ -401,8 +401,8 @@ void OrientationsPreview::verify_velocity_hip_joint(
 
 void OrientationsPreview::interpolate_trunk_orientation(
     double Time, int CurrentIndex, double NewSamplingPeriod,
-    const deque<support_state_t> &PrwSupportStates_deq,
-    deque<COMState> &FinalCOMTraj_deq) {
+    const RingBuffer<support_state_t> &PrwSupportStates_deq,
+    RingBuffer<COMState> &FinalCOMTraj_deq) {
 
   support_state_t CurrentSupport = PrwSupportStates_deq.front();
 
@@ -439,7 +439,7 @@ void OrientationsPreview::interpolate_trunk_orientation(
 }
 
 void OrientationsPreview::one_iteration(
-    double Time, const deque<support_state_t> &PrwSupportStates_deq) {
+    double Time, const RingBuffer<support_state_t> &PrwSupportStates_deq) {
   support_state_t CurrentSupport = PrwSupportStates_deq.front();
 
   if (CurrentSupport.Phase == SS &&
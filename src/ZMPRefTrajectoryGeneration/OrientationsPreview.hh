@@ -34,6 +34,7 @@
 #include <deque>
 
 #include <Mathematics/PolynomeFoot.hh>
+#include <RingBuffer.hh>
 #include <jrl/walkgen/pgtypes.hh>
 #include <jrl/walkgen/pinocchiorobot.hh>
 #include <privatepgtypes.hh>
@@ -72,8 +73,8 @@ public:
   /// \param[out] Solution Trunk and Foot orientations
   void preview_orientations(
       double Time, const reference_t &Ref, double StepDuration,
-      const std::deque<FootAbsolutePosition> &LeftFootPositions_deq,
-      const std::deque<FootAbsolutePosition> &RightFootPositions_deq,
+      const RingBuffer<FootAbsolutePosition> &LeftFootPositions_deq,
+      const RingBuffer<FootAbsolutePosition> &RightFootPositions_deq,
       solution_t &Solution);
 
   /// \brief Interpolate previewed orientation of the trunk
@@ -85,8 +86,8 @@ public:
   /// \param[out] FinalCOMTraj_deq
   void interpolate_trunk_orientation(
       double Time, int CurrentIndex, double NewSamplingPeriod,
-      const std::deque<support_state_t> &PrwSupportStates_deq,
-      std::deque<COMState> &FinalCOMTraj_deq);
+      const RingBuffer<support_state_t> &PrwSupportStates_deq,
+      RingBuffer<COMState> &FinalCOMTraj_deq);
 
   /// \brief Compute the current state for the preview of the orientation
   ///
@@ -96,7 +97,7 @@ public:
   /// \param[in] PrwSupportStates_deq
   /// \param[out] FinalCOMTraj_deq
   void one_iteration(double Time,
-                     const std::deque<support_state_t> &PrwSupportStates_deq);
+                     const RingBuffer<support_state_t> &PrwSupportStates_deq);
 
   /// \name Accessors
   /// \{
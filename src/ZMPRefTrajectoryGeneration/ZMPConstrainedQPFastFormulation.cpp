@@ -76,6 +76,7 @@ ZMPConstrainedQPFastFormulation::ZMPConstrainedQPFastFormulation(
   //  m_QP_T = 0.02;
   m_QP_T = 0.1;
   m_QP_N = 16;
+  m_QPLocalTime = -m_QP_T;
 
   m_SamplingPeriod = 0.005;
 
@@ -814,14 +815,14 @@ int ZMPConstrainedQPFastFormulation::BuildConstraintMatrices(
   }
 
   ODEBUG6("Index Constraint :" << IndexConstraint, Buffer);
-  static double localtime = -m_QP_T;
-  localtime += m_QP_T;
+  m_QPLocalTime += m_QP_T;
 
-  ODEBUG("IndexConstraint:" << IndexConstraint << " localTime :" << localtime);
+  ODEBUG("IndexConstraint:" << IndexConstraint
+                             << " localTime :" << m_QPLocalTime);
 
-  //  if (localtime>=1.96)
+  //  if (m_QPLocalTime>=1.96)
   if (0) {
-    ODEBUG("localtime: " << localtime);
+    ODEBUG("localtime: " << m_QPLocalTime);
     ofstream aof;
 
     char Buffer[1024];
@@ -965,9 +966,9 @@ int ZMPConstrainedQPFastFormulation::DumpProblem(double *Q, double *D,
   return 0;
 }
 int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(
-    deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &RightFootAbsolutePositions,
-    deque<ZMPPosition> &ZMPRefPositions, deque<COMState> &COMStates,
+    RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
+    RingBuffer<ZMPPosition> &ZMPRefPositions, RingBuffer<COMState> &COMStates,
     double ConstraintOnX, double ConstraintOnY, double T, unsigned int N) {
 
   double *DPx = 0, *DPu = 0;
@@ -1273,10 +1274,10 @@ int ZMPConstrainedQPFastFormulation::BuildZMPTrajectoryFromFootTrajectory(
 }
 
 void ZMPConstrainedQPFastFormulation::GetZMPDiscretization(
-    deque<ZMPPosition> &ZMPPositions, deque<COMState> &COMStates,
+    RingBuffer<ZMPPosition> &ZMPPositions, RingBuffer<COMState> &COMStates,
     deque<RelativeFootPosition> &RelativeFootPositions,
-    deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
+    RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
     COMState &lStartingCOMState, Eigen::Vector3d &lStartingZMPPosition,
     FootAbsolutePosition &InitLeftFootAbsolutePosition,
     FootAbsolutePosition &InitRightFootAbsolutePosition) {
@@ -1326,10 +1327,10 @@ void ZMPConstrainedQPFastFormulation::CallMethod(std::string &Method,
 }
 
 std::size_t ZMPConstrainedQPFastFormulation::InitOnLine(
-    deque<ZMPPosition> &,          // FinalZMPPositions,
-    deque<COMState> &,             // FinalCOMStates,
-    deque<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
+    RingBuffer<ZMPPosition> &,          // FinalZMPPositions,
+    RingBuffer<COMState> &,             // FinalCOMStates,
+    RingBuffer<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
     FootAbsolutePosition &,        // InitLeftFootAbsolutePosition,
     FootAbsolutePosition &,        // InitRightFootAbsolutePosition,
     deque<RelativeFootPosition> &, // RelativeFootPositions,
@@ -1342,10 +1343,10 @@ std::size_t ZMPConstrainedQPFastFormulation::InitOnLine(
 
 void ZMPConstrainedQPFastFormulation::OnLineAddFoot(
     RelativeFootPosition &,        // NewRelativeFootPosition,
-    deque<ZMPPosition> &,          // FinalZMPPositions,
-    deque<COMState> &,             // FinalCOMStates,
-    deque<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
+    RingBuffer<ZMPPosition> &,          // FinalZMPPositions,
+    RingBuffer<COMState> &,             // FinalCOMStates,
+    RingBuffer<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
     bool)                          // EndSequence)
 {
   cout << "To be implemented" << endl;
@@ -1353,10 +1354,10 @@ void ZMPConstrainedQPFastFormulation::OnLineAddFoot(
 
 void ZMPConstrainedQPFastFormulation::OnLine(
     double,                        // time,
-    deque<ZMPPosition> &,          // FinalZMPPositions,
-    deque<COMState> &,             // FinalCOMStates,
-    deque<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &) // FinalRightFootAbsolutePositions)
+    RingBuffer<ZMPPosition> &,          // FinalZMPPositions,
+    RingBuffer<COMState> &,             // FinalCOMStates,
+    RingBuffer<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &) // FinalRightFootAbsolutePositions)
 {
   cout << "To be implemented" << endl;
 }
@@ -1364,10 +1365,10 @@ void ZMPConstrainedQPFastFormulation::OnLine(
 int ZMPConstrainedQPFastFormulation::OnLineFootChange(
     double,                        // time,
     FootAbsolutePosition &,        // aFootAbsolutePosition,
-    deque<ZMPPosition> &,          // FinalZMPPositions,
-    deque<COMState> &,             // CoMPositions,
-    deque<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
+    RingBuffer<ZMPPosition> &,          // FinalZMPPositions,
+    RingBuffer<COMState> &,             // CoMPositions,
+    RingBuffer<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
     StepStackHandler *)            // aStepStackHandler)
 {
   cout << "To be implemented" << endl;
@@ -1375,10 +1376,10 @@ int ZMPConstrainedQPFastFormulation::OnLineFootChange(
 }
 
 void ZMPConstrainedQPFastFormulation::EndPhaseOfTheWalking(
-    deque<ZMPPosition> &,          // ZMPPositions,
-    deque<COMState> &,             // FinalCOMStates,
-    deque<FootAbsolutePosition> &, // LeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &) // RightFootAbsolutePositions)
+    RingBuffer<ZMPPosition> &,          // ZMPPositions,
+    RingBuffer<COMState> &,             // FinalCOMStates,
+    RingBuffer<FootAbsolutePosition> &, // LeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &) // RightFootAbsolutePositions)
 {}
 
 int ZMPConstrainedQPFastFormulation::ReturnOptimalTimeToRegenerateAStep() {
@@ -32,6 +32,7 @@
 #include <Mathematics/OptCholesky.hh>
 #include <Mathematics/PLDPSolver.hh>
 #include <PreviewControl/LinearizedInvertedPendulum2D.hh>
+#include <RingBuffer.hh>
 #include <ZMPRefTrajectoryGeneration/ZMPRefTrajectoryGeneration.hh>
 
 namespace PatternGeneratorJRL {
@@ -91,10 +92,10 @@ public:
 
   */
   void GetZMPDiscretization(
-      deque<ZMPPosition> &ZMPPositions, deque<COMState> &CoMStates,
+      RingBuffer<ZMPPosition> &ZMPPositions, RingBuffer<COMState> &CoMStates,
       deque<RelativeFootPosition> &RelativeFootPositions,
-      deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-      deque<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
       COMState &lStartingCOMState, Eigen::Vector3d &lStartingZMPPosition,
       FootAbsolutePosition &InitLeftFootAbsolutePosition,
       FootAbsolutePosition &InitRightFootAbsolutePosition);
@@ -102,9 +103,9 @@ public:
   /*! This method is a new way of computing the ZMP trajectory from
     foot trajectory. */
   int BuildZMPTrajectoryFromFootTrajectory(
-      deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-      deque<FootAbsolutePosition> &RightFootAbsolutePositions,
-      deque<ZMPPosition> &ZMPRefPositions, deque<COMState> &COMStates,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
+      RingBuffer<ZMPPosition> &ZMPRefPositions, RingBuffer<COMState> &COMStates,
       double ConstraintOnX, double ConstraintOnY, double T, unsigned int N);
 
   /*! \name Methods to build the optimization problem
@@ -176,9 +177,10 @@ public:
     the queue of ZMP, and foot positions.
   */
   std::size_t
-  InitOnLine(deque<ZMPPosition> &FinalZMPPositions, deque<COMState> &CoMStates,
-             deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-             deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+  InitOnLine(RingBuffer<ZMPPosition> &FinalZMPPositions,
+             RingBuffer<COMState> &CoMStates,
+             RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+             RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
              FootAbsolutePosition &InitLeftFootAbsolutePosition,
              FootAbsolutePosition &InitRightFootAbsolutePosition,
              deque<RelativeFootPosition> &RelativeFootPositions,
@@ -188,27 +190,30 @@ public:
   /* ! Methods to update the stack on-line by inserting
      a new foot position. */
   void
-  OnLineAddFoot(RelativeFootPosition &NewRelativeFootPosition,
-                deque<ZMPPosition> &FinalZMPPositions,
-                deque<COMState> &CoMStates,
-                deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-                deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
-                bool EndSequence);
+  OnLineAddFoot(
+      RelativeFootPosition &NewRelativeFootPosition,
+      RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &CoMStates,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+      bool EndSequence);
 
   /* ! \brief Method to update the stacks on-line */
-  void OnLine(double time, deque<ZMPPosition> &FinalZMPPositions,
-              deque<COMState> &CoMStates,
-              deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-              deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
+  void OnLine(
+      double time, RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &CoMStates,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
 
   /* ! \brief Method to change on line the landing position of a foot.
      @return If the method failed it returns -1, 0 otherwise.
   */
   int OnLineFootChange(
       double time, FootAbsolutePosition &aFootAbsolutePosition,
-      deque<ZMPPosition> &FinalZMPPositions, deque<COMState> &CoMStates,
-      deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-      deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+      RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &CoMStates,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
       StepStackHandler *aStepStackHandler = 0);
 
   /*! \brief Method to stop walking.
@@ -220,10 +225,11 @@ public:
     The queue of right foot absolute positions.
   */
   void
-  EndPhaseOfTheWalking(deque<ZMPPosition> &ZMPPositions,
-                       deque<COMState> &FinalCOMStates,
-                       deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-                       deque<FootAbsolutePosition> &RightFootAbsolutePositions);
+  EndPhaseOfTheWalking(
+      RingBuffer<ZMPPosition> &ZMPPositions,
+      RingBuffer<COMState> &FinalCOMStates,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions);
 
   int ValidationConstraints(
       double *&DPx, double *&DPu, int NbOfConstraints,
@@ -281,6 +287,9 @@ private:
   /*! Sampling of the QP. */
   double m_QP_T;
 
+  /*! Time of the last QP built, for debugging. */
+  double m_QPLocalTime;
+
   /*! Preview window */
   unsigned int m_QP_N;
 
@@ -125,10 +125,11 @@ ZMPDiscretization::~ZMPDiscretization() {
 }
 
 void ZMPDiscretization::GetZMPDiscretization(
-    deque<ZMPPosition> &FinalZMPPositions, deque<COMState> &FinalCOMStates,
+    RingBuffer<ZMPPosition> &FinalZMPPositions,
+    RingBuffer<COMState> &FinalCOMStates,
     deque<RelativeFootPosition> &RelativeFootPositions,
-    deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
     double, // Xmax,
     COMState &lStartingCOMState, Eigen::Vector3d &lStartingZMPPosition,
     FootAbsolutePosition &InitLeftFootAbsolutePosition,
@@ -146,7 +147,8 @@ void ZMPDiscretization::GetZMPDiscretization(
 }
 
 void ZMPDiscretization::DumpFootAbsolutePosition(
-    string aFileName, deque<FootAbsolutePosition> &aFootAbsolutePositions) {
+    string aFileName,
+    RingBuffer<FootAbsolutePosition> &aFootAbsolutePositions) {
   ofstream aof;
   aof.open(aFileName.c_str(), ofstream::out);
   if (aof.is_open()) {
@@ -173,8 +175,9 @@ void ZMPDiscretization::ResetADataFile(string &DataFile) {
   }
 }
 void ZMPDiscretization::DumpDataFiles(
-    string ZMPFileName, string FootFileName, deque<ZMPPosition> &ZMPPositions,
-    deque<FootAbsolutePosition> &SupportFootAbsolutePositions) {
+    string ZMPFileName, string FootFileName,
+    RingBuffer<ZMPPosition> &ZMPPositions,
+    RingBuffer<FootAbsolutePosition> &SupportFootAbsolutePositions) {
   ofstream aof;
   aof.open(ZMPFileName.c_str(), ofstream::out);
   if (aof.is_open()) {
@@ -219,8 +222,8 @@ void ZMPDiscretization::InitializeFilter() {
     m_ZMPFilterWindow[i] /= sum;
 }
 
-void ZMPDiscretization::FilterZMPRef(deque<ZMPPosition> &ZMPPositionsX,
-                                     deque<ZMPPosition> &ZMPPositionsY) {
+void ZMPDiscretization::FilterZMPRef(RingBuffer<ZMPPosition> &ZMPPositionsX,
+                                     RingBuffer<ZMPPosition> &ZMPPositionsY) {
   int n = 0;
   double T = 0.050; // Arbritraty fixed from Kajita's San matlab files.
   deque<double> window;
@@ -263,9 +266,10 @@ void ZMPDiscretization::SetZMPShift(vector<double> &ZMPShift) {
 
 /* Initialiazation of the on-line stacks. */
 std::size_t ZMPDiscretization::InitOnLine(
-    deque<ZMPPosition> &FinalZMPPositions, deque<COMState> &FinalCoMStates,
-    deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+    RingBuffer<ZMPPosition> &FinalZMPPositions,
+    RingBuffer<COMState> &FinalCoMStates,
+    RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
     FootAbsolutePosition &InitLeftFootAbsolutePosition,
     FootAbsolutePosition &InitRightFootAbsolutePosition,
     deque<RelativeFootPosition> &RelativeFootPositions,
@@ -340,7 +344,7 @@ std::size_t ZMPDiscretization::InitOnLine(
   }
 
   ODEBUG(AddArraySize);
-  deque<ZMPPosition> ZMPPositions;
+  RingBuffer<ZMPPosition> ZMPPositions;
   ZMPPositions.resize(AddArraySize);
   FinalCoMStates.resize(AddArraySize);
   LeftFootAbsolutePositions.resize(AddArraySize);
@@ -506,10 +510,10 @@ void ZMPDiscretization::UpdateCurrentSupportFootPosition(
 
 void ZMPDiscretization::OnLine(
     double,                        // time,
-    deque<ZMPPosition> &,          // FinalZMPPositions,
-    deque<COMState> &,             // FinalCOMStates,
-    deque<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &) // FinalRightFootAbsolutePositions)
+    RingBuffer<ZMPPosition> &,          // FinalZMPPositions,
+    RingBuffer<COMState> &,             // FinalCOMStates,
+    RingBuffer<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &) // FinalRightFootAbsolutePositions)
 {
   /* Does nothing... */
 }
@@ -519,13 +523,14 @@ void ZMPDiscretization::OnLine(
    state of the relative steps stack. */
 void ZMPDiscretization::OnLineAddFoot(
     RelativeFootPosition &NewRelativeFootPosition,
-    deque<ZMPPosition> &FinalZMPPositions, deque<COMState> &FinalCOMStates,
-    deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+    RingBuffer<ZMPPosition> &FinalZMPPositions,
+    RingBuffer<COMState> &FinalCOMStates,
+    RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
     bool EndSequence) {
-  deque<ZMPPosition> ZMPPositions;
-  deque<FootAbsolutePosition> LeftFootAbsolutePositions;
-  deque<FootAbsolutePosition> RightFootAbsolutePositions;
+  RingBuffer<ZMPPosition> ZMPPositions;
+  RingBuffer<FootAbsolutePosition> LeftFootAbsolutePositions;
+  RingBuffer<FootAbsolutePosition> RightFootAbsolutePositions;
   FootAbsolutePosition CurrentLeftFootAbsPos, CurrentRightFootAbsPos;
   double CurrentAbsZMPTheta = 0;
 
@@ -954,8 +959,9 @@ void ZMPDiscretization::OnLineAddFoot(
   }
 }
 
-void ZMPDiscretization::DumpReferences(deque<ZMPPosition> &FinalZMPPositions,
-                                       deque<ZMPPosition> &ZMPPositions) {
+void ZMPDiscretization::DumpReferences(
+    RingBuffer<ZMPPosition> &FinalZMPPositions,
+    RingBuffer<ZMPPosition> &ZMPPositions) {
 
   ofstream dbg_aof("DebugZMPRefPos.dat", ofstream::app);
   for (unsigned int i = 0; i < ZMPPositions.size(); i++) {
@@ -971,9 +977,9 @@ void ZMPDiscretization::DumpReferences(deque<ZMPPosition> &FinalZMPPositions,
   dbg_aof.close();
 }
 
-void ZMPDiscretization::FilterOutValues(deque<ZMPPosition> &ZMPPositions,
-                                        deque<ZMPPosition> &FinalZMPPositions,
-                                        bool InitStep) {
+void ZMPDiscretization::FilterOutValues(
+    RingBuffer<ZMPPosition> &ZMPPositions,
+    RingBuffer<ZMPPosition> &FinalZMPPositions, bool InitStep) {
   unsigned int lshift = 2;
   // Filter out the ZMP values.
   for (unsigned int i = 0; i < ZMPPositions.size(); i++) {
@@ -1030,10 +1036,10 @@ void ZMPDiscretization::FilterOutValues(deque<ZMPPosition> &ZMPPositions,
 int ZMPDiscretization::OnLineFootChange(
     double,                        // time,
     FootAbsolutePosition &,        // aFootAbsolutePosition,
-    deque<ZMPPosition> &,          // FinalZMPPositions,
-    deque<COMState> &,             // CoMStates,
-    deque<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
+    RingBuffer<ZMPPosition> &,          // FinalZMPPositions,
+    RingBuffer<COMState> &,             // CoMStates,
+    RingBuffer<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
     StepStackHandler *)            // aStepStackHandler)
 {
   return -1;
@@ -1046,12 +1052,13 @@ int ZMPDiscretization::ReturnOptimalTimeToRegenerateAStep() {
 }
 
 void ZMPDiscretization::EndPhaseOfTheWalking(
-    deque<ZMPPosition> &FinalZMPPositions, deque<COMState> &FinalCOMStates,
-    deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions)
+    RingBuffer<ZMPPosition> &FinalZMPPositions,
+    RingBuffer<COMState> &FinalCOMStates,
+    RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions)
 
 {
-  deque<ZMPPosition> ZMPPositions;
+  RingBuffer<ZMPPosition> ZMPPositions;
   FootAbsolutePosition LeftFootAbsolutePosition;
   FootAbsolutePosition RightFootAbsolutePosition;
 
@@ -50,6 +50,7 @@ using namespace ::std;
 #include <Mathematics/ConvexHull.hh>
 #include <Mathematics/PolynomeFoot.hh>
 #include <PreviewControl/PreviewControl.hh>
+#include <RingBuffer.hh>
 #include <ZMPRefTrajectoryGeneration/ZMPRefTrajectoryGeneration.hh>
 #include <jrl/walkgen/pgtypes.hh>
 
@@ -140,34 +141,35 @@ public:
 
   */
   void GetZMPDiscretization(
-      deque<ZMPPosition> &ZMPPositions, deque<COMState> &CoMStates,
+      RingBuffer<ZMPPosition> &ZMPPositions, RingBuffer<COMState> &CoMStates,
       deque<RelativeFootPosition> &RelativeFootPositions,
-      deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-      deque<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
       COMState &lStartingCOMState, Eigen::Vector3d &lStartingZMPPosition,
       FootAbsolutePosition &InitLeftFootAbsolutePosition,
       FootAbsolutePosition &InitRightFootAbsolutePosition);
 
   /*! Dump data files. */
   void DumpDataFiles(string ZMPFileName, string FootFileName,
-                     deque<ZMPPosition> &ZMPPositions,
-                     deque<FootAbsolutePosition> &FootAbsolutePositions);
+                     RingBuffer<ZMPPosition> &ZMPPositions,
+                     RingBuffer<FootAbsolutePosition> &FootAbsolutePositions);
 
   void
-  DumpFootAbsolutePosition(string aFileName,
-                           deque<FootAbsolutePosition> &aFootAbsolutePositions);
+  DumpFootAbsolutePosition(
+      string aFileName,
+      RingBuffer<FootAbsolutePosition> &aFootAbsolutePositions);
 
   /** Update the value of the foot configuration according to the
       current situation. */
   void UpdateFootPosition(
-      deque<FootAbsolutePosition> &SupportFootAbsolutePositions,
-      deque<FootAbsolutePosition> &NoneSupportFootAbsolutePositions, int index,
-      int k, int indexinitial, double ModulationSupportTime, int StepType,
-      int LeftOrRight);
+      RingBuffer<FootAbsolutePosition> &SupportFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &NoneSupportFootAbsolutePositions,
+      int index, int k, int indexinitial, double ModulationSupportTime,
+      int StepType, int LeftOrRight);
 
   /*! IIR filtering of ZMP Position X put in ZMP Position Y. */
-  void FilterZMPRef(deque<ZMPPosition> &ZMPPositionsX,
-                    deque<ZMPPosition> &ZMPPositionsY);
+  void FilterZMPRef(RingBuffer<ZMPPosition> &ZMPPositionsX,
+                    RingBuffer<ZMPPosition> &ZMPPositionsY);
 
   /*! ZMP shift parameters to shift ZMP position during Single support
     with respect to the normal ankle position */
@@ -185,9 +187,10 @@ public:
     the queue of ZMP, and foot positions.
   */
   std::size_t
-  InitOnLine(deque<ZMPPosition> &FinalZMPPositions, deque<COMState> &CoMStates,
-             deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-             deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+  InitOnLine(RingBuffer<ZMPPosition> &FinalZMPPositions,
+             RingBuffer<COMState> &CoMStates,
+             RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+             RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
              FootAbsolutePosition &InitLeftFootAbsolutePosition,
              FootAbsolutePosition &InitRightFootAbsolutePosition,
              deque<RelativeFootPosition> &RelativeFootPositions,
@@ -195,29 +198,32 @@ public:
              Eigen::Vector3d &lStartingZMPPosition);
 
   /*! \brief  Methods to update the stacks on-line. */
-  void OnLine(double time, deque<ZMPPosition> &FinalZMPPositions,
-              deque<COMState> &CoMStates,
-              deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-              deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
+  void OnLine(
+      double time, RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &CoMStates,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
 
   /*! \brief  Methods to update the stack on-line by inserting a
     new foot position. */
   void
-  OnLineAddFoot(RelativeFootPosition &NewRelativeFootPosition,
-                deque<ZMPPosition> &FinalZMPPositions,
-                deque<COMState> &CoMStates,
-                deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-                deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
-                bool EndSequence);
+  OnLineAddFoot(
+      RelativeFootPosition &NewRelativeFootPosition,
+      RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &CoMStates,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+      bool EndSequence);
 
   /* ! \brief Method to change on line the landing position of a foot.
      @return If the method failed it returns -1, 0 otherwise.
   */
   int OnLineFootChange(
       double time, FootAbsolutePosition &aFootAbsolutePosition,
-      deque<ZMPPosition> &FinalZMPPositions, deque<COMState> &CoMStates,
-      deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-      deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+      RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &CoMStates,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
       StepStackHandler *aStepStackHandler = 0);
 
   /*! \brief Return the time at which it is optimal to regenerate
@@ -231,14 +237,16 @@ public:
 
   /// End phase of the walking.
   void
-  EndPhaseOfTheWalking(deque<ZMPPosition> &ZMPPositions,
-                       deque<COMState> &FinalCOMStates,
-                       deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-                       deque<FootAbsolutePosition> &RightFootAbsolutePositions);
+  EndPhaseOfTheWalking(
+      RingBuffer<ZMPPosition> &ZMPPositions,
+      RingBuffer<COMState> &FinalCOMStates,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions);
 
   /*! Filter out the ZMP values and put them at the back FinalZMPPositions. */
-  void FilterOutValues(deque<ZMPPosition> &ZMPPositions,
-                       deque<ZMPPosition> &FinalZMPPositions, bool InitPhase);
+  void FilterOutValues(RingBuffer<ZMPPosition> &ZMPPositions,
+                       RingBuffer<ZMPPosition> &FinalZMPPositions,
+                       bool InitPhase);
 
   /*! Set the ZMP neutral position in the global coordinates system */
   void setZMPNeutralPosition(const double aZMPNeutralPosition[2]) {
@@ -260,8 +268,8 @@ private:
   void ResetADataFile(string &aDataFile);
 
   /*! \brief Dump references */
-  void DumpReferences(deque<ZMPPosition> &FinalZMPPositions,
-                      deque<ZMPPosition> &ZMPPositions);
+  void DumpReferences(RingBuffer<ZMPPosition> &FinalZMPPositions,
+                      RingBuffer<ZMPPosition> &ZMPPositions);
 
   /* ! ModulationSupportCoefficient coeeficient to wait a
      little before foot is of the ground */
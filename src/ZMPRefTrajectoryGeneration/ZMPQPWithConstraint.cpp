@@ -196,8 +196,8 @@ int ZMPQPWithConstraint::ComputeLinearSystem(vector<CH_Point> aVecOfPoints,
 }
 
 int ZMPQPWithConstraint::BuildLinearConstraintInequalities(
-    deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
     deque<LinearConstraintInequality_t *> &QueueOfLConstraintInequalities,
     double ConstraintOnX, double ConstraintOnY) {
   // Find the convex hull for each of the position,
@@ -574,9 +574,9 @@ int ZMPQPWithConstraint::BuildMatricesPxPu(
 }
 
 int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(
-    deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &RightFootAbsolutePositions,
-    deque<ZMPPosition> &ZMPRefPositions, deque<COMState> &COMStates,
+    RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
+    RingBuffer<ZMPPosition> &ZMPRefPositions, RingBuffer<COMState> &COMStates,
     double ConstraintOnX, double ConstraintOnY, double T, unsigned int N) {
   //  double T=0.02;
   // double T=0.02;
@@ -1200,10 +1200,10 @@ int ZMPQPWithConstraint::BuildZMPTrajectoryFromFootTrajectory(
 }
 
 void ZMPQPWithConstraint::GetZMPDiscretization(
-    deque<ZMPPosition> &ZMPPositions, deque<COMState> &COMStates,
+    RingBuffer<ZMPPosition> &ZMPPositions, RingBuffer<COMState> &COMStates,
     deque<RelativeFootPosition> &RelativeFootPositions,
-    deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
+    RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
     COMState &lStartingCOMState, Eigen::Vector3d &lStartingZMPPosition,
     FootAbsolutePosition &InitLeftFootAbsolutePosition,
     FootAbsolutePosition &InitRightFootAbsolutePosition) {
@@ -1252,10 +1252,10 @@ void ZMPQPWithConstraint::CallMethod(std::string &Method,
 }
 
 std::size_t ZMPQPWithConstraint::InitOnLine(
-    deque<ZMPPosition> &,          // FinalZMPPositions,
-    deque<COMState> &,             // FinalCOMStates,
-    deque<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
+    RingBuffer<ZMPPosition> &,          // FinalZMPPositions,
+    RingBuffer<COMState> &,             // FinalCOMStates,
+    RingBuffer<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
     FootAbsolutePosition &,        // InitLeftFootAbsolutePosition,
     FootAbsolutePosition &,        // InitRightFootAbsolutePosition,
     deque<RelativeFootPosition> &, // RelativeFootPositions,
@@ -1268,10 +1268,10 @@ std::size_t ZMPQPWithConstraint::InitOnLine(
 
 void ZMPQPWithConstraint::OnLineAddFoot(
     RelativeFootPosition &,        // NewRelativeFootPosition,
-    deque<ZMPPosition> &,          // FinalZMPPositions,
-    deque<COMState> &,             // FinalCOMStates,
-    deque<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
+    RingBuffer<ZMPPosition> &,          // FinalZMPPositions,
+    RingBuffer<COMState> &,             // FinalCOMStates,
+    RingBuffer<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
     bool)                          // EndSequence)
 {
   cout << "To be implemented" << endl;
@@ -1279,10 +1279,10 @@ void ZMPQPWithConstraint::OnLineAddFoot(
 
 void ZMPQPWithConstraint::OnLine(
     double,                        // time,
-    deque<ZMPPosition> &,          // FinalZMPPositions,
-    deque<COMState> &,             // FinalCOMStates,
-    deque<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &) // FinalRightFootAbsolutePositions)
+    RingBuffer<ZMPPosition> &,          // FinalZMPPositions,
+    RingBuffer<COMState> &,             // FinalCOMStates,
+    RingBuffer<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &) // FinalRightFootAbsolutePositions)
 {
   cout << "To be implemented" << endl;
 }
@@ -1290,10 +1290,10 @@ void ZMPQPWithConstraint::OnLine(
 int ZMPQPWithConstraint::OnLineFootChange(
     double,                        // time,
     FootAbsolutePosition &,        // aFootAbsolutePosition,
-    deque<ZMPPosition> &,          // FinalZMPPositions,
-    deque<COMState> &,             // CoMStates,
-    deque<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
+    RingBuffer<ZMPPosition> &,          // FinalZMPPositions,
+    RingBuffer<COMState> &,             // CoMStates,
+    RingBuffer<FootAbsolutePosition> &, // FinalLeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &, // FinalRightFootAbsolutePositions,
     StepStackHandler *)            // aStepStackHandler)
 {
   cout << "To be implemented" << endl;
@@ -1301,10 +1301,10 @@ int ZMPQPWithConstraint::OnLineFootChange(
 }
 
 void ZMPQPWithConstraint::EndPhaseOfTheWalking(
-    deque<ZMPPosition> &,          // ZMPPositions,
-    deque<COMState> &,             // FinalCOMStates,
-    deque<FootAbsolutePosition> &, // LeftFootAbsolutePositions,
-    deque<FootAbsolutePosition> &) // RightFootAbsolutePositions)
+    RingBuffer<ZMPPosition> &,          // ZMPPositions,
+    RingBuffer<COMState> &,             // FinalCOMStates,
+    RingBuffer<FootAbsolutePosition> &, // LeftFootAbsolutePositions,
+    RingBuffer<FootAbsolutePosition> &) // RightFootAbsolutePositions)
 {}
 
 int ZMPQPWithConstraint::ReturnOptimalTimeToRegenerateAStep() {
@@ -30,6 +30,7 @@
 #define _ZMPQP_WITH_CONSTRAINT_H_
 
 #include <Mathematics/ConvexHull.hh>
+#include <RingBuffer.hh>
 #include <ZMPRefTrajectoryGeneration/ZMPRefTrajectoryGeneration.hh>
 
 namespace PatternGeneratorJRL {
@@ -48,8 +49,8 @@ public:
     on the foot trajectories given as an input.
     The result is a set Linear Constraint Inequalities. */
   int BuildLinearConstraintInequalities(
-      deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-      deque<FootAbsolutePosition> &RightFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
       deque<LinearConstraintInequality_t *> &QueueOfLConstraintInequalities,
       double ConstraintOnX, double ConstraintOnY);
 
@@ -98,10 +99,10 @@ public:
 
   */
   void GetZMPDiscretization(
-      deque<ZMPPosition> &ZMPPositions, deque<COMState> &CoMStates,
+      RingBuffer<ZMPPosition> &ZMPPositions, RingBuffer<COMState> &CoMStates,
       deque<RelativeFootPosition> &RelativeFootPositions,
-      deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-      deque<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
       COMState &lStartingCOMState, Eigen::Vector3d &lStartingZMPPosition,
       FootAbsolutePosition &InitLeftFootAbsolutePosition,
       FootAbsolutePosition &InitRightFootAbsolutePosition);
@@ -109,9 +110,9 @@ public:
   /*! This method is a new way of computing the ZMP trajectory from
     foot trajectory. */
   int BuildZMPTrajectoryFromFootTrajectory(
-      deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-      deque<FootAbsolutePosition> &RightFootAbsolutePositions,
-      deque<ZMPPosition> &ZMPRefPositions, deque<COMState> &COMStates,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions,
+      RingBuffer<ZMPPosition> &ZMPRefPositions, RingBuffer<COMState> &COMStates,
       double ConstraintOnX, double ConstraintOnY, double T, unsigned int N);
 
   /*! Build the necessary matrices for the QP problem under linear inequality
@@ -126,7 +127,7 @@ public:
                           Eigen::MatrixXd &A, Eigen::MatrixXd &B);
 
   /*! This method get the COM buffer computed by the QP in off-line mode. */
-  void GetComBuffer(deque<COMState> &aCOMBuffer);
+  void GetComBuffer(RingBuffer<COMState> &aCOMBuffer);
 
   /*! Call method to handle the plugins. */
   void CallMethod(std::string &Method, std::istringstream &strm);
@@ -146,9 +147,10 @@ public:
     the queue of ZMP, and foot positions.
   */
   std::size_t
-  InitOnLine(deque<ZMPPosition> &FinalZMPPositions, deque<COMState> &CoMStates,
-             deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-             deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+  InitOnLine(RingBuffer<ZMPPosition> &FinalZMPPositions,
+             RingBuffer<COMState> &CoMStates,
+             RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+             RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
              FootAbsolutePosition &InitLeftFootAbsolutePosition,
              FootAbsolutePosition &InitRightFootAbsolutePosition,
              deque<RelativeFootPosition> &RelativeFootPositions,
@@ -158,27 +160,30 @@ public:
   /* ! Methods to update the stack on-line by inserting
      a new foot position. */
   void
-  OnLineAddFoot(RelativeFootPosition &NewRelativeFootPosition,
-                deque<ZMPPosition> &FinalZMPPositions,
-                deque<COMState> &CoMStates,
-                deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-                deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
-                bool EndSequence);
+  OnLineAddFoot(
+      RelativeFootPosition &NewRelativeFootPosition,
+      RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &CoMStates,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+      bool EndSequence);
 
   /* ! \brief Method to update the stacks on-line */
-  void OnLine(double time, deque<ZMPPosition> &FinalZMPPositions,
-              deque<COMState> &CoMStates,
-              deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-              deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
+  void OnLine(
+      double time, RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &CoMStates,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions);
 
   /* ! \brief Method to change on line the landing position of a foot.
      @return If the method failed it returns -1, 0 otherwise.
   */
   int OnLineFootChange(
       double time, FootAbsolutePosition &aFootAbsolutePosition,
-      deque<ZMPPosition> &FinalZMPPositions, deque<COMState> &CoMStates,
-      deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-      deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+      RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &CoMStates,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
       StepStackHandler *aStepStackHandler = 0);
 
   /*! \brief Method to stop walking.
@@ -190,10 +195,11 @@ public:
     The queue of right foot absolute positions.
   */
   void
-  EndPhaseOfTheWalking(deque<ZMPPosition> &ZMPPositions,
-                       deque<COMState> &FinalCOMStates,
-                       deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-                       deque<FootAbsolutePosition> &RightFootAbsolutePositions);
+  EndPhaseOfTheWalking(
+      RingBuffer<ZMPPosition> &ZMPPositions,
+      RingBuffer<COMState> &FinalCOMStates,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions);
 
   /*! \brief Return the time at which it is optimal to regenerate a step in
     online mode.
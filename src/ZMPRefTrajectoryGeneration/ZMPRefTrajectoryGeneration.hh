@@ -33,6 +33,7 @@
 #include <string>
 //#define FULL_POLYNOME
 
+#include <RingBuffer.hh>
 #include <SimplePlugin.hh>
 #include <jrl/walkgen/pgtypes.hh>
 
@@ -209,10 +210,10 @@ public:
 
   */
   virtual void GetZMPDiscretization(
-      std::deque<ZMPPosition> &ZMPPositions, std::deque<COMState> &COMStates,
+      RingBuffer<ZMPPosition> &ZMPPositions, RingBuffer<COMState> &COMStates,
       std::deque<RelativeFootPosition> &RelativeFootPositions,
-      std::deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-      std::deque<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
       COMState &lStartingCOMState, Eigen::Vector3d &lStartingZMPPosition,
       FootAbsolutePosition &InitLeftFootAbsolutePosition,
       FootAbsolutePosition &InitRightFootAbsolutePosition) = 0;
@@ -246,9 +247,9 @@ public:
     ZMP given as a 3D vector.
   */
   virtual std::size_t InitOnLine(
-      std::deque<ZMPPosition> &ZMPPositions, std::deque<COMState> &COMStates,
-      std::deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-      std::deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+      RingBuffer<ZMPPosition> &ZMPPositions, RingBuffer<COMState> &COMStates,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
       FootAbsolutePosition &InitLeftFootAbsolutePosition,
       FootAbsolutePosition &InitRightFootAbsolutePosition,
       std::deque<RelativeFootPosition> &RelativeFootPositions,
@@ -272,10 +273,10 @@ public:
   */
   virtual void OnLineAddFoot(
       RelativeFootPosition &NewRelativeFootPosition,
-      std::deque<ZMPPosition> &FinalZMPPositions,
-      std::deque<COMState> &COMStates,
-      std::deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-      std::deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+      RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &COMStates,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
       bool EndSequence) = 0;
 
   /* ! \brief Method to change to update on line the queues necessary
@@ -294,10 +295,10 @@ public:
      @return If the method failed it returns -1, 0 otherwise.
   */
   virtual void
-  OnLine(double time, std::deque<ZMPPosition> &FinalZMPPositions,
-         std::deque<COMState> &COMStates,
-         std::deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-         std::deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions) = 0;
+  OnLine(double time, RingBuffer<ZMPPosition> &FinalZMPPositions,
+         RingBuffer<COMState> &COMStates,
+         RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+         RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions) = 0;
 
   /*! \brief Method to stop walking.
     @param[out] ZMPPositions: The queue of ZMP reference positions.
@@ -308,10 +309,10 @@ public:
     foot absolute positions.
   */
   virtual void EndPhaseOfTheWalking(
-      std::deque<ZMPPosition> &ZMPPositions,
-      std::deque<COMState> &FinalCOMStates,
-      std::deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-      std::deque<FootAbsolutePosition> &RightFootAbsolutePositions) = 0;
+      RingBuffer<ZMPPosition> &ZMPPositions,
+      RingBuffer<COMState> &FinalCOMStates,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions) = 0;
 
   /* ! \brief Method to change on line the landing position of a foot.
      @param[in] time : Current time.
@@ -328,10 +329,10 @@ public:
   */
   virtual int OnLineFootChange(
       double time, FootAbsolutePosition &aFootAbsolutePosition,
-      std::deque<ZMPPosition> &FinalZMPPositions,
-      std::deque<COMState> &COMStates,
-      std::deque<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
-      std::deque<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
+      RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &COMStates,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootAbsolutePositions,
       StepStackHandler *aStepStackHandler) = 0;
 
   /*! \brief Return the time at which it is optimal to regenerate
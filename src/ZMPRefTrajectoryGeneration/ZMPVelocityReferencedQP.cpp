@@ -72,11 +72,18 @@ ZMPVelocityReferencedQP::ZMPVelocityReferencedQP(SimplePluginManager *SPM,
     : ZMPRefTrajectoryGeneration(SPM), Robot_(0), SupportFSM_(0), OrientPrw_(0),
       OrientPrw_DF_(0), VRQPGenerator_(0), IntermedData_(0), RFI_(0),
       Problem_(), Solution_(), OFTG_DF_(0), OFTG_control_(0),
-      dynamicFilter_(0) {
+      dynamicFilter_(0), QPSolver_(QLD), AsyncQP_(false), AsyncFront_(0),
+      AsyncBack_(1), AsyncReady_(-1), AsyncPending_(false),
+      AsyncDeadlineMisses_(0), AsyncUpdates_(0), AsyncJobPosted_(false),
+      AsyncStop_(false),
+      PipelinedFilter_(false),
+      FilterInputs_(1), FilterOutputs_(1), FilterInFlight_(0),
+      FilterLateUpdates_(0), FilterStop_(false) {
   // Save the reference to HDR
   PR_ = aPR;
 
   Running_ = false;
+  RunningPreview_ = false;
   TimeBuffer_ = 0.04;
   QP_T_ = 0.1;
   QP_N_ = 16;
@@ -93,6 +100,9 @@ ZMPVelocityReferencedQP::ZMPVelocityReferencedQP(SimplePluginManager *SPM,
   StepHeight_ = 0.05;
   CoMHeight_ = 0.814;
   PerturbationOccured_ = false;
+  PerturbationAcceleration_.setZero(6);
+  NewPerturbationOccured_ = false;
+  NewPerturbationAcceleration_.setZero(6);
   UpperTimeLimitToUpdate_ = 0.0;
   RobotMass_ = PR_->mass();
   Solution_.useWarmStart = false;
@@ -191,10 +201,11 @@ ZMPVelocityReferencedQP::ZMPVelocityReferencedQP(SimplePluginManager *SPM,
   dynamicFilter_ = new DynamicFilter(SPM, PR_);
 
   // Register method to handle
-  const unsigned int NbMethods = 4;
-  const char *lMethodNames[NbMethods] = {":previewcontroltime",
-                                         ":numberstepsbeforestop", ":stoppg",
-                                         ":setfeetconstraint"};
+  const unsigned int NbMethods = 9;
+  const char *lMethodNames[NbMethods] = {
+      ":previewcontroltime", ":numberstepsbeforestop", ":stoppg",
+      ":setfeetconstraint",  ":asyncQP",               ":qpsolver",
+      ":qpmaxiterations",    ":pipelinedFilter",       ":asyncdeadlinemisses"};
   RESETDEBUG4("PgDebug2.txt");
   ODEBUG4("Before registering methods for ZMPVelocityReferencedQP",
           "PgDebug2.txt");
@@ -221,11 +232,26 @@ ZMPVelocityReferencedQP::ZMPVelocityReferencedQP(SimplePluginManager *SPM,
 
   ZMPTraj_deq_ctrl_.resize(QP_N_ * NbSampleControl_ + 10);
   COMTraj_deq_ctrl_.resize(QP_N_ * NbSampleControl_ + 10);
-  deltaCOMTraj_deq_.resize(NbSampleControl_);
+  deltaCOMTraj_.resize(NbSampleControl_);
+  deltaCOMTraj_.setZero();
+
+  // The buffers of the dynamic filter are swapped with the ones of the
+  // asynchronous slots, they need the same size.
+  for (unsigned int i = 0; i < 2; i++) {
+    AsyncSlots_[i].FilterZMPTraj_deq.resize(ZMPTraj_deq_ctrl_.size());
+    AsyncSlots_[i].FilterCOMTraj_deq.resize(COMTraj_deq_.size());
+    AsyncSlots_[i].FilterLeftFootTraj_deq.resize(LeftFootTraj_deq_.size());
+    AsyncSlots_[i].FilterRightFootTraj_deq.resize(RightFootTraj_deq_.size());
+    AsyncSlots_[i].PerturbationOccured = false;
+    AsyncSlots_[i].PerturbationAcceleration.setZero(6);
+  }
 }
 
 ZMPVelocityReferencedQP::~ZMPVelocityReferencedQP() {
 
+  StopAsyncWorker();
+  StopFilterWorker();
+
   if (VRQPGenerator_ != 0) {
     delete VRQPGenerator_;
     VRQPGenerator_ = 0;
@@ -268,23 +294,26 @@ ZMPVelocityReferencedQP::~ZMPVelocityReferencedQP() {
 }
 
 void ZMPVelocityReferencedQP::setCoMPerturbationForce(istringstream &strm) {
-
-  PerturbationAcceleration_.resize(6);
-
-  strm >> PerturbationAcceleration_(2);
-  strm >> PerturbationAcceleration_(5);
-  PerturbationAcceleration_(2) = PerturbationAcceleration_(2) / RobotMass_;
-  PerturbationAcceleration_(5) = PerturbationAcceleration_(5) / RobotMass_;
-  PerturbationOccured_ = true;
+  double x = 0.0, y = 0.0;
+  strm >> x;
+  strm >> y;
+  setCoMPerturbationForce(x, y);
 }
 
+// As the velocity reference, the perturbation is only read by the QP when
+// it is handed over at the next update: in asynchronous mode the worker
+// thread never sees the members written here.
 void ZMPVelocityReferencedQP::setCoMPerturbationForce(double x, double y) {
+  NewPerturbationAcceleration_(2) = x / RobotMass_;
+  NewPerturbationAcceleration_(5) = y / RobotMass_;
+  NewPerturbationOccured_ = true;
+}
 
-  PerturbationAcceleration_.resize(6);
-
-  PerturbationAcceleration_(2) = x / RobotMass_;
-  PerturbationAcceleration_(5) = y / RobotMass_;
-  PerturbationOccured_ = true;
+void ZMPVelocityReferencedQP::TakePerturbation(bool &Occured,
+                                               Eigen::VectorXd &Acceleration) {
+  Occured = NewPerturbationOccured_;
+  Acceleration = NewPerturbationAcceleration_;
+  NewPerturbationOccured_ = false;
 }
 
 //--------------------------------------
@@ -296,6 +325,8 @@ void ZMPVelocityReferencedQP::CallMethod(std::string &Method,
   //#ifdef DEBUG
   //  std::cout << __PRETTY_FUNCTION__ << " Method:" << Method << std::endl;
   //#endif
+  // The worker thread owns the preview while a job is running.
+  WaitAsyncIdle();
   if (Method == ":previewcontroltime") {
     strm >> m_PreviewControlTime;
   }
@@ -313,18 +344,59 @@ void ZMPVelocityReferencedQP::CallMethod(std::string &Method,
   if (Method == ":setfeetconstraint") {
     RFI_->CallMethod(Method, strm);
   }
+  if (Method == ":asyncQP") {
+    string asyncQP;
+    strm >> asyncQP;
+    AsyncQP_ = asyncQP == "true" ? true : false;
+  }
+  if (Method == ":asyncdeadlinemisses") {
+    std::cout << "Asynchronous QP deadline misses: " << AsyncDeadlineMisses_
+              << " over " << AsyncUpdates_ << " updates" << std::endl;
+  }
+  if (Method == ":pipelinedFilter") {
+    string pipelinedFilter;
+    strm >> pipelinedFilter;
+    // The filter thread owns the dynamic filter while a packet is in
+    // flight.
+    DrainFilter();
+    PipelinedFilter_ = pipelinedFilter == "true" ? true : false;
+    dynamicFilter_->setLatency(PipelinedFilter_ ? NbSampleControl_ : 0);
+  }
+  if (Method == ":qpsolver") {
+    string qpsolver;
+    strm >> qpsolver;
+    if (qpsolver == "qld")
+      QPSolver_ = QLD;
+    else if (qpsolver == "dualactiveset")
+      QPSolver_ = DUAL_ACTIVE_SET;
+    else
+      std::cerr << "Unknown QP solver " << qpsolver << std::endl;
+  }
+  if (Method == ":qpmaxiterations") {
+    unsigned int MaxIterations = 0;
+    strm >> MaxIterations;
+    Problem_.MaxIterations(MaxIterations);
+  }
   ZMPRefTrajectoryGeneration::CallMethod(Method, strm);
 }
 
 std::size_t ZMPVelocityReferencedQP::InitOnLine(
-    deque<ZMPPosition> &FinalZMPTraj_deq,
-    deque<COMState> &FinalCoMPositions_deq,
-    deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-    deque<FootAbsolutePosition> &FinalRightFootTraj_deq,
+    RingBuffer<ZMPPosition> &FinalZMPTraj_deq,
+    RingBuffer<COMState> &FinalCoMPositions_deq,
+    RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+    RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq,
     FootAbsolutePosition &InitLeftFootAbsolutePosition,
     FootAbsolutePosition &InitRightFootAbsolutePosition,
     deque<RelativeFootPosition> &, // RelativeFootPositions,
     COMState &lStartingCOMState, Eigen::Vector3d &lStartingZMPPosition) {
+  // Drop the result of a previous walk.
+  if (AsyncPending_) {
+    TakeAsyncResult();
+  }
+  AsyncDeadlineMisses_ = 0;
+  AsyncUpdates_ = 0;
+  DrainFilter();
+  FilterLateUpdates_ = 0;
   UpperTimeLimitToUpdate_ = 0.0;
 
   FootAbsolutePosition CurrentLeftFootAbsPos, CurrentRightFootAbsPos;
@@ -348,6 +420,16 @@ std::size_t ZMPVelocityReferencedQP::InitOnLine(
     AddArraySize = (int)ldAddArraySize;
   }
 
+  // Room for the whole preview, OnLine then only moves the indices of
+  // the queues.
+  std::size_t lCapacity = AddArraySize + (QP_N_ + 1) * NbSampleControl_;
+  FinalZMPTraj_deq.reserve(lCapacity);
+  FinalCoMPositions_deq.reserve(lCapacity);
+  FinalLeftFootTraj_deq.reserve(lCapacity);
+  FinalRightFootTraj_deq.reserve(lCapacity);
+  LeftFootTraj_deq_ctrl_.reserve(lCapacity);
+  RightFootTraj_deq_ctrl_.reserve(lCapacity);
+
   FinalZMPTraj_deq.resize(AddArraySize);
   FinalCoMPositions_deq.resize(AddArraySize);
   FinalLeftFootTraj_deq.resize(AddArraySize);
@@ -432,6 +514,10 @@ std::size_t ZMPVelocityReferencedQP::InitOnLine(
   InitStateOrientPrw_ = OrientPrw_->CurrentTrunkState();
   FinalCurrentStateOrientPrw_ = OrientPrw_->CurrentTrunkState();
 
+  // At most one step per sampling period of the preview, plus the current
+  // support and the extrapolated step.
+  FootPrw_vec.assign(QP_N_ + 2, vector<double>(2, 0.0));
+
   dynamicFilter_->getComAndFootRealization()->ShiftFoot(true);
   dynamicFilter_->init(m_SamplingPeriod, InterpolationPeriod_, QP_T_,
                        previewDuration_ + QP_T_, previewDuration_,
@@ -440,10 +526,10 @@ std::size_t ZMPVelocityReferencedQP::InitOnLine(
 }
 
 void ZMPVelocityReferencedQP::OnLine(
-    double time, deque<ZMPPosition> &FinalZMPTraj_deq,
-    deque<COMState> &FinalCOMTraj_deq,
-    deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-    deque<FootAbsolutePosition> &FinalRightFootTraj_deq)
+    double time, RingBuffer<ZMPPosition> &FinalZMPTraj_deq,
+    RingBuffer<COMState> &FinalCOMTraj_deq,
+    RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+    RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq)
 
 {
   // If on-line mode not activated we go out.
@@ -460,110 +546,46 @@ void ZMPVelocityReferencedQP::OnLine(
   // ----------------------------
   if (time + 0.00001 > UpperTimeLimitToUpdate_) {
 
-    // UPDATE INTERNAL DATA:
-    // ---------------------
-    Problem_.reset_variant();
-    Solution_.reset();
-    VRQPGenerator_->CurrentTime(time);
-    VelRef_ = NewVelRef_;
-    SupportFSM_->update_vel_reference(VelRef_, IntermedData_->SupportState());
-    IntermedData_->Reference(VelRef_);
-    IntermedData_->CoM(LIPM_());
-
-    // PREVIEW SUPPORT STATES FOR THE WHOLE PREVIEW WINDOW:
-    // ----------------------------------------------------
-    VRQPGenerator_->preview_support_states(
-        time, SupportFSM_, FinalLeftFootTraj_deq, FinalRightFootTraj_deq,
-        Solution_.SupportStates_deq);
-
-    // COMPUTE ORIENTATIONS OF FEET FOR WHOLE PREVIEW PERIOD:
-    // ------------------------------------------------------
-    InitStateOrientPrw_ = OrientPrw_->CurrentTrunkState();
-    OrientPrw_->preview_orientations(time, VelRef_, SupportFSM_->StepPeriod(),
-                                     FinalLeftFootTraj_deq,
-                                     FinalRightFootTraj_deq, Solution_);
-
-    // UPDATE THE DYNAMICS:
-    // --------------------
-    Robot_->update(Solution_.SupportStates_deq, FinalLeftFootTraj_deq,
-                   FinalRightFootTraj_deq);
-
-    // COMPUTE REFERENCE IN THE GLOBAL FRAME:
-    // --------------------------------------
-    VRQPGenerator_->compute_global_reference(Solution_);
-
-    // BUILD VARIANT PART OF THE OBJECTIVE:
-    // ------------------------------------
-    VRQPGenerator_->update_problem(Problem_, Solution_.SupportStates_deq);
-
-    // BUILD CONSTRAINTS:
-    // ------------------
-    VRQPGenerator_->build_constraints(Problem_, Solution_);
-
-    // SOLVE PROBLEM:
-    // --------------
-    Problem_.solve(QLD, Solution_, NONE);
-    if (Solution_.Fail > 0) {
-      Problem_.dump(time);
-    }
-    VRQPGenerator_->LastFootSol(Solution_);
-    // OrientPrw_->
-
-    // INITIALIZE INTERPOLATION:
-    // ------------------------
-    CurrentIndex_ = (unsigned int)FinalCOMTraj_deq.size();
-    for (unsigned int i = 0; i < CurrentIndex_; ++i) {
-      ZMPTraj_deq_ctrl_[i] = FinalZMPTraj_deq[i];
-      COMTraj_deq_ctrl_[i] = FinalCOMTraj_deq[i];
-    }
-    LeftFootTraj_deq_ctrl_ = FinalLeftFootTraj_deq;
-    RightFootTraj_deq_ctrl_ = FinalRightFootTraj_deq;
-
-    solution_ = Solution_;
-    InterpretSolutionVector();
-
-    // INTERPOLATION
-    FinalZMPTraj_deq.resize(NbSampleControl_ + CurrentIndex_);
-    FinalCOMTraj_deq.resize(NbSampleControl_ + CurrentIndex_);
-    ControlInterpolation(FinalCOMTraj_deq, FinalZMPTraj_deq,
-                         FinalLeftFootTraj_deq, FinalRightFootTraj_deq, time);
-
-    DynamicFilterInterpolation(time);
-
-    unsigned int IndexMax =
-        (int)round((previewDuration_ + QP_T_) / InterpolationPeriod_);
-    ZMPTraj_deq_.resize(IndexMax);
-    COMTraj_deq_.resize(IndexMax);
-    LeftFootTraj_deq_.resize(IndexMax);
-    RightFootTraj_deq_.resize(IndexMax);
-    int inc = (int)round(InterpolationPeriod_ / m_SamplingPeriod);
-    for (unsigned int i = 0, j = 0; j < IndexMax; i = i + inc, ++j) {
-      ZMPTraj_deq_[j] = ZMPTraj_deq_ctrl_[i];
-      COMTraj_deq_[j] = COMTraj_deq_ctrl_[i];
-      COMTraj_deq_[j].roll[0] = 180 / M_PI * COMTraj_deq_ctrl_[i].roll[0];
-      COMTraj_deq_[j].pitch[0] = 180 / M_PI * COMTraj_deq_ctrl_[i].pitch[0];
-      COMTraj_deq_[j].yaw[0] = 180 / M_PI * COMTraj_deq_ctrl_[i].yaw[0];
-      LeftFootTraj_deq_[j] = LeftFootTraj_deq_ctrl_[i];
-      RightFootTraj_deq_[j] = RightFootTraj_deq_ctrl_[i];
-    }
-
-    dynamicFilter_->OnLinefilter(COMTraj_deq_, ZMPTraj_deq_ctrl_,
-                                 LeftFootTraj_deq_, RightFootTraj_deq_,
-                                 deltaCOMTraj_deq_);
-    //#define DEBUG
-#ifdef DEBUG
-    dynamicFilter_->Debug(COMTraj_deq_ctrl_, LeftFootTraj_deq_ctrl_,
-                          RightFootTraj_deq_ctrl_, COMTraj_deq_,
-                          ZMPTraj_deq_ctrl_, LeftFootTraj_deq_,
-                          RightFootTraj_deq_, deltaCOMTraj_deq_);
-#endif
-
-    // Correct the CoM.
-    for (unsigned int i = 0; i < NbSampleControl_; ++i) {
-      for (int j = 0; j < 3; j++) {
-        FinalCOMTraj_deq[i].x[j] += deltaCOMTraj_deq_[i].x[j];
-        FinalCOMTraj_deq[i].y[j] += deltaCOMTraj_deq_[i].y[j];
+    bool FilterFromSlot = false;
+    if (AsyncPending_) {
+      // The worker thread computed this period from the queues predicted
+      // at the previous update.
+      AsyncUpdates_++;
+      AsyncFront_ = TakeAsyncResult();
+      async_slot_t &aSlot = AsyncSlots_[AsyncFront_];
+      if (FinalCOMTraj_deq.size() == aSlot.PredictedSize &&
+          FinalLeftFootTraj_deq.size() == aSlot.PredictedSize) {
+        FinalZMPTraj_deq.swap(aSlot.ZMPTraj_deq);
+        FinalCOMTraj_deq.swap(aSlot.COMTraj_deq);
+        FinalLeftFootTraj_deq.swap(aSlot.LeftFootTraj_deq);
+        FinalRightFootTraj_deq.swap(aSlot.RightFootTraj_deq);
+      } else {
+        // The queues were modified outside of the pattern generator:
+        // only append the new period.
+        ODEBUG("Trajectory queues changed since the asynchronous job "
+               "was posted");
+        std::size_t lNew = aSlot.COMTraj_deq.size() - aSlot.PredictedSize;
+        FinalZMPTraj_deq.insert(FinalZMPTraj_deq.end(),
+                                aSlot.ZMPTraj_deq.end() - lNew,
+                                aSlot.ZMPTraj_deq.end());
+        FinalCOMTraj_deq.insert(FinalCOMTraj_deq.end(),
+                                aSlot.COMTraj_deq.end() - lNew,
+                                aSlot.COMTraj_deq.end());
+        FinalLeftFootTraj_deq.insert(FinalLeftFootTraj_deq.end(),
+                                     aSlot.LeftFootTraj_deq.end() - lNew,
+                                     aSlot.LeftFootTraj_deq.end());
+        FinalRightFootTraj_deq.insert(FinalRightFootTraj_deq.end(),
+                                      aSlot.RightFootTraj_deq.end() - lNew,
+                                      aSlot.RightFootTraj_deq.end());
       }
+      Running_ = aSlot.Running;
+      FilterFromSlot = true;
+    } else {
+      VelRef_ = NewVelRef_;
+      TakePerturbation(PerturbationOccured_, PerturbationAcceleration_);
+      SolveAndInterpolate(time, FinalZMPTraj_deq, FinalCOMTraj_deq,
+                          FinalLeftFootTraj_deq, FinalRightFootTraj_deq);
+      Running_ = RunningPreview_;
     }
 
     // Specify that we are in the ending phase.
@@ -580,6 +602,39 @@ void ZMPVelocityReferencedQP::OnLine(
       }
       UpperTimeLimitToUpdate_ = UpperTimeLimitToUpdate_ + QP_T_;
     }
+
+    // PREPARE THE NEXT PERIOD ON THE WORKER THREAD:
+    // ---------------------------------------------
+    if (AsyncQP_ && m_OnLineMode) {
+      if (!FilterFromSlot) {
+        // The worker thread is about to overwrite the filter buffers.
+        SwapFilterBuffers(AsyncSlots_[AsyncFront_]);
+        FilterFromSlot = true;
+      }
+      PostAsyncJob(time + QP_T_, FinalZMPTraj_deq, FinalCOMTraj_deq,
+                   FinalLeftFootTraj_deq, FinalRightFootTraj_deq);
+    }
+
+    // APPLY THE DYNAMIC FILTER:
+    // -------------------------
+    if (FilterFromSlot) {
+      async_slot_t &aSlot = AsyncSlots_[AsyncFront_];
+      FilterCoM(FinalCOMTraj_deq, aSlot.FilterCOMTraj_deq,
+                aSlot.FilterZMPTraj_deq, aSlot.FilterLeftFootTraj_deq,
+                aSlot.FilterRightFootTraj_deq);
+    } else {
+      FilterCoM(FinalCOMTraj_deq, COMTraj_deq_, ZMPTraj_deq_ctrl_,
+                LeftFootTraj_deq_, RightFootTraj_deq_);
+      //#define DEBUG
+#ifdef DEBUG
+      RingBuffer<COMState> deltaCOMTraj_deq(deltaCOMTraj_.size());
+      deltaCOMTraj_.store(deltaCOMTraj_deq, 0, deltaCOMTraj_.size(), COM_XY);
+      dynamicFilter_->Debug(COMTraj_deq_ctrl_, LeftFootTraj_deq_ctrl_,
+                            RightFootTraj_deq_ctrl_, COMTraj_deq_,
+                            ZMPTraj_deq_ctrl_, LeftFootTraj_deq_,
+                            RightFootTraj_deq_, deltaCOMTraj_deq);
+#endif
+    }
   }
   //-----------------------------------
   //
@@ -587,11 +642,316 @@ void ZMPVelocityReferencedQP::OnLine(
   //----------"Real-time" loop---------
 }
 
+void ZMPVelocityReferencedQP::SolveAndInterpolate(
+    double time, RingBuffer<ZMPPosition> &FinalZMPTraj_deq,
+    RingBuffer<COMState> &FinalCOMTraj_deq,
+    RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+    RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq) {
+  // UPDATE INTERNAL DATA:
+  // ---------------------
+  Problem_.reset_variant();
+  // The multipliers of the last cycle hot start the dual active-set solver.
+  if (QPSolver_ == DUAL_ACTIVE_SET)
+    LastConstrLagr_vec_.swap(Solution_.ConstrLagr_vec);
+  Solution_.reset();
+  VRQPGenerator_->CurrentTime(time);
+  SupportFSM_->update_vel_reference(VelRef_, IntermedData_->SupportState());
+  IntermedData_->Reference(VelRef_);
+  IntermedData_->CoM(LIPM_());
+
+  // PREVIEW SUPPORT STATES FOR THE WHOLE PREVIEW WINDOW:
+  // ----------------------------------------------------
+  VRQPGenerator_->preview_support_states(
+      time, SupportFSM_, FinalLeftFootTraj_deq, FinalRightFootTraj_deq,
+      Solution_.SupportStates_deq);
+
+  // COMPUTE ORIENTATIONS OF FEET FOR WHOLE PREVIEW PERIOD:
+  // ------------------------------------------------------
+  InitStateOrientPrw_ = OrientPrw_->CurrentTrunkState();
+  OrientPrw_->preview_orientations(time, VelRef_, SupportFSM_->StepPeriod(),
+                                   FinalLeftFootTraj_deq,
+                                   FinalRightFootTraj_deq, Solution_);
+
+  // UPDATE THE DYNAMICS:
+  // --------------------
+  Robot_->update(Solution_.SupportStates_deq, FinalLeftFootTraj_deq,
+                 FinalRightFootTraj_deq);
+
+  // COMPUTE REFERENCE IN THE GLOBAL FRAME:
+  // --------------------------------------
+  VRQPGenerator_->compute_global_reference(Solution_);
+
+  // BUILD VARIANT PART OF THE OBJECTIVE:
+  // ------------------------------------
+  VRQPGenerator_->update_problem(Problem_, Solution_.SupportStates_deq);
+
+  // BUILD CONSTRAINTS:
+  // ------------------
+  VRQPGenerator_->build_constraints(Problem_, Solution_);
+  if (QPSolver_ == DUAL_ACTIVE_SET)
+    VRQPGenerator_->shift_constraint_multipliers(LastConstrLagr_vec_,
+                                                 Solution_);
+
+  // SOLVE PROBLEM:
+  // --------------
+  Problem_.solve(QPSolver_, Solution_, NONE);
+  if (Solution_.Fail > 0) {
+    Problem_.dump(time);
+  }
+  VRQPGenerator_->LastFootSol(Solution_);
+  // OrientPrw_->
+
+  // INITIALIZE INTERPOLATION:
+  // ------------------------
+  CurrentIndex_ = (unsigned int)FinalCOMTraj_deq.size();
+  for (unsigned int i = 0; i < CurrentIndex_; ++i) {
+    ZMPTraj_deq_ctrl_[i] = FinalZMPTraj_deq[i];
+    COMTraj_deq_ctrl_[i] = FinalCOMTraj_deq[i];
+  }
+  LeftFootTraj_deq_ctrl_ = FinalLeftFootTraj_deq;
+  RightFootTraj_deq_ctrl_ = FinalRightFootTraj_deq;
+
+  solution_.assign(Solution_);
+  InterpretSolutionVector();
+
+  // INTERPOLATION
+  FinalZMPTraj_deq.resize(NbSampleControl_ + CurrentIndex_);
+  FinalCOMTraj_deq.resize(NbSampleControl_ + CurrentIndex_);
+  ControlInterpolation(FinalCOMTraj_deq, FinalZMPTraj_deq,
+                       FinalLeftFootTraj_deq, FinalRightFootTraj_deq, time);
+
+  DynamicFilterInterpolation(time);
+
+  unsigned int IndexMax =
+      (int)round((previewDuration_ + QP_T_) / InterpolationPeriod_);
+  ZMPTraj_deq_.resize(IndexMax);
+  COMTraj_deq_.resize(IndexMax);
+  LeftFootTraj_deq_.resize(IndexMax);
+  RightFootTraj_deq_.resize(IndexMax);
+  int inc = (int)round(InterpolationPeriod_ / m_SamplingPeriod);
+  for (unsigned int i = 0, j = 0; j < IndexMax; i = i + inc, ++j) {
+    ZMPTraj_deq_[j] = ZMPTraj_deq_ctrl_[i];
+    COMTraj_deq_[j] = COMTraj_deq_ctrl_[i];
+    COMTraj_deq_[j].roll[0] = 180 / M_PI * COMTraj_deq_ctrl_[i].roll[0];
+    COMTraj_deq_[j].pitch[0] = 180 / M_PI * COMTraj_deq_ctrl_[i].pitch[0];
+    COMTraj_deq_[j].yaw[0] = 180 / M_PI * COMTraj_deq_ctrl_[i].yaw[0];
+    LeftFootTraj_deq_[j] = LeftFootTraj_deq_ctrl_[i];
+    RightFootTraj_deq_[j] = RightFootTraj_deq_ctrl_[i];
+  }
+}
+
+void ZMPVelocityReferencedQP::FilterCoM(
+    RingBuffer<COMState> &FinalCOMTraj_deq, RingBuffer<COMState> &COMTraj_deq,
+    RingBuffer<ZMPPosition> &ZMPTraj_deq_ctrl,
+    RingBuffer<FootAbsolutePosition> &LeftFootTraj_deq,
+    RingBuffer<FootAbsolutePosition> &RightFootTraj_deq) {
+  if (PipelinedFilter_) {
+    PipelinedFilterCoM(FinalCOMTraj_deq, COMTraj_deq, ZMPTraj_deq_ctrl,
+                       LeftFootTraj_deq, RightFootTraj_deq);
+    return;
+  }
+  dynamicFilter_->OnLinefilter(COMTraj_deq, ZMPTraj_deq_ctrl, LeftFootTraj_deq,
+                               RightFootTraj_deq, deltaCOMTraj_);
+
+  // Correct the CoM.
+  deltaCOMTraj_.addTo(FinalCOMTraj_deq, 0, NbSampleControl_, COM_XY);
+}
+
+void ZMPVelocityReferencedQP::PipelinedFilterCoM(
+    RingBuffer<COMState> &FinalCOMTraj_deq,
+    const RingBuffer<COMState> &COMTraj_deq,
+    const RingBuffer<ZMPPosition> &ZMPTraj_deq_ctrl,
+    const RingBuffer<FootAbsolutePosition> &LeftFootTraj_deq,
+    const RingBuffer<FootAbsolutePosition> &RightFootTraj_deq) {
+  if (!FilterThread_.joinable()) {
+    FilterStop_ = false;
+    FilterThread_ = std::thread(&ZMPVelocityReferencedQP::FilterWorker, this);
+  }
+
+  // Correct the CoM with the result of the previous period.
+  if (FilterInFlight_ > 0) {
+    COMStateBlock *lDeltaCOM = FilterOutputs_.front();
+    if (lDeltaCOM == 0) {
+      FilterLateUpdates_++;
+      std::unique_lock<std::mutex> lock(FilterMutex_);
+      while ((lDeltaCOM = FilterOutputs_.front()) == 0)
+        FilterCond_.wait(lock);
+    }
+    lDeltaCOM->addTo(FinalCOMTraj_deq, 0, NbSampleControl_, COM_XY);
+    FilterOutputs_.pop();
+    FilterInFlight_--;
+  }
+
+  // The storage of the packets is reused from one period to the next.
+  filter_packet_t *lPacket = FilterInputs_.back();
+  assert(lPacket != 0);
+  lPacket->ZMPTraj_deq = ZMPTraj_deq_ctrl;
+  lPacket->COMTraj_deq = COMTraj_deq;
+  lPacket->LeftFootTraj_deq = LeftFootTraj_deq;
+  lPacket->RightFootTraj_deq = RightFootTraj_deq;
+  FilterInputs_.push();
+  FilterInFlight_++;
+  // The filter thread tests the queue with the lock held.
+  {
+    std::lock_guard<std::mutex> lock(FilterMutex_);
+  }
+  FilterCond_.notify_all();
+}
+
+void ZMPVelocityReferencedQP::FilterWorker() {
+  std::unique_lock<std::mutex> lock(FilterMutex_);
+  while (true) {
+    filter_packet_t *lPacket = 0;
+    while (!FilterStop_ && (lPacket = FilterInputs_.front()) == 0)
+      FilterCond_.wait(lock);
+    if (FilterStop_)
+      return;
+    lock.unlock();
+
+    // At most one packet is in flight, the output queue has room.
+    COMStateBlock *lDeltaCOM = FilterOutputs_.back();
+    assert(lDeltaCOM != 0);
+    if (lDeltaCOM->size() != deltaCOMTraj_.size())
+      lDeltaCOM->resize(deltaCOMTraj_.size());
+    dynamicFilter_->OnLinefilter(lPacket->COMTraj_deq, lPacket->ZMPTraj_deq,
+                                 lPacket->LeftFootTraj_deq,
+                                 lPacket->RightFootTraj_deq, *lDeltaCOM);
+    FilterInputs_.pop();
+    FilterOutputs_.push();
+
+    lock.lock();
+    FilterCond_.notify_all();
+  }
+}
+
+void ZMPVelocityReferencedQP::DrainFilter() {
+  if (FilterInFlight_ == 0)
+    return;
+  std::unique_lock<std::mutex> lock(FilterMutex_);
+  while (FilterInFlight_ > 0) {
+    while (FilterOutputs_.front() == 0)
+      FilterCond_.wait(lock);
+    FilterOutputs_.pop();
+    FilterInFlight_--;
+  }
+}
+
+void ZMPVelocityReferencedQP::StopFilterWorker() {
+  if (!FilterThread_.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(FilterMutex_);
+    FilterStop_ = true;
+  }
+  FilterCond_.notify_all();
+  FilterThread_.join();
+  FilterInputs_.clear();
+  FilterOutputs_.clear();
+  FilterInFlight_ = 0;
+}
+
+void ZMPVelocityReferencedQP::SwapFilterBuffers(async_slot_t &aSlot) {
+  ZMPTraj_deq_ctrl_.swap(aSlot.FilterZMPTraj_deq);
+  COMTraj_deq_.swap(aSlot.FilterCOMTraj_deq);
+  LeftFootTraj_deq_.swap(aSlot.FilterLeftFootTraj_deq);
+  RightFootTraj_deq_.swap(aSlot.FilterRightFootTraj_deq);
+}
+
+void ZMPVelocityReferencedQP::PostAsyncJob(
+    double time, const RingBuffer<ZMPPosition> &FinalZMPTraj_deq,
+    const RingBuffer<COMState> &FinalCOMTraj_deq,
+    const RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+    const RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq) {
+  if (!AsyncThread_.joinable()) {
+    AsyncThread_ = std::thread(&ZMPVelocityReferencedQP::AsyncWorker, this);
+  }
+
+  // Queues as they will be when the next update occurs.
+  unsigned int lConsumed = NbSampleControl_;
+  if (lConsumed > FinalCOMTraj_deq.size())
+    lConsumed = (unsigned int)FinalCOMTraj_deq.size();
+  AsyncBack_ = 1 - AsyncFront_;
+  async_slot_t &aSlot = AsyncSlots_[AsyncBack_];
+  aSlot.Time = time;
+  aSlot.PredictedSize = FinalCOMTraj_deq.size() - lConsumed;
+  aSlot.ZMPTraj_deq.assign(FinalZMPTraj_deq.begin() + lConsumed,
+                           FinalZMPTraj_deq.end());
+  aSlot.COMTraj_deq.assign(FinalCOMTraj_deq.begin() + lConsumed,
+                           FinalCOMTraj_deq.end());
+  aSlot.LeftFootTraj_deq.assign(FinalLeftFootTraj_deq.begin() + lConsumed,
+                                FinalLeftFootTraj_deq.end());
+  aSlot.RightFootTraj_deq.assign(FinalRightFootTraj_deq.begin() + lConsumed,
+                                 FinalRightFootTraj_deq.end());
+  AsyncVelRef_ = NewVelRef_;
+  TakePerturbation(aSlot.PerturbationOccured, aSlot.PerturbationAcceleration);
+
+  {
+    std::lock_guard<std::mutex> lock(AsyncMutex_);
+    AsyncJobPosted_ = true;
+  }
+  AsyncCond_.notify_all();
+  AsyncPending_ = true;
+}
+
+void ZMPVelocityReferencedQP::AsyncWorker() {
+  std::unique_lock<std::mutex> lock(AsyncMutex_);
+  while (true) {
+    while (!AsyncJobPosted_ && !AsyncStop_)
+      AsyncCond_.wait(lock);
+    if (AsyncStop_)
+      return;
+    AsyncJobPosted_ = false;
+    lock.unlock();
+
+    async_slot_t &aSlot = AsyncSlots_[AsyncBack_];
+    VelRef_ = AsyncVelRef_;
+    PerturbationOccured_ = aSlot.PerturbationOccured;
+    PerturbationAcceleration_ = aSlot.PerturbationAcceleration;
+    SolveAndInterpolate(aSlot.Time, aSlot.ZMPTraj_deq, aSlot.COMTraj_deq,
+                        aSlot.LeftFootTraj_deq, aSlot.RightFootTraj_deq);
+    SwapFilterBuffers(aSlot);
+    aSlot.Solution.assign(Solution_);
+    aSlot.Running = RunningPreview_;
+
+    lock.lock();
+    AsyncReady_.store(AsyncBack_, std::memory_order_release);
+    AsyncCond_.notify_all();
+  }
+}
+
+int ZMPVelocityReferencedQP::TakeAsyncResult() {
+  WaitAsyncIdle();
+  int lReady = AsyncReady_.load(std::memory_order_acquire);
+  AsyncReady_.store(-1, std::memory_order_relaxed);
+  AsyncPending_ = false;
+  return lReady;
+}
+
+void ZMPVelocityReferencedQP::WaitAsyncIdle() {
+  if (!AsyncPending_ || AsyncReady_.load(std::memory_order_acquire) >= 0)
+    return;
+  AsyncDeadlineMisses_++;
+  std::unique_lock<std::mutex> lock(AsyncMutex_);
+  while (AsyncReady_.load(std::memory_order_acquire) < 0)
+    AsyncCond_.wait(lock);
+}
+
+void ZMPVelocityReferencedQP::StopAsyncWorker() {
+  if (!AsyncThread_.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(AsyncMutex_);
+    AsyncStop_ = true;
+  }
+  AsyncCond_.notify_all();
+  AsyncThread_.join();
+}
+
 void ZMPVelocityReferencedQP::ControlInterpolation(
-    std::deque<COMState> &FinalCOMTraj_deq,                   // OUTPUT
-    std::deque<ZMPPosition> &FinalZMPTraj_deq,                // OUTPUT
-    std::deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,  // OUTPUT
-    std::deque<FootAbsolutePosition> &FinalRightFootTraj_deq, // OUTPUT
+    RingBuffer<COMState> &FinalCOMTraj_deq,                   // OUTPUT
+    RingBuffer<ZMPPosition> &FinalZMPTraj_deq,                // OUTPUT
+    RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,  // OUTPUT
+    RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq, // OUTPUT
     double time)                                              // INPUT
 {
   InitStateLIPM_ = LIPM_.GetState();
@@ -659,10 +1019,10 @@ void ZMPVelocityReferencedQP::DynamicFilterInterpolation(double time) {
 }
 
 void ZMPVelocityReferencedQP::CoMZMPInterpolation(
-    std::deque<ZMPPosition> &ZMPPositions,                     // OUTPUT
-    std::deque<COMState> &COMTraj_deq,                         // OUTPUT
-    const std::deque<FootAbsolutePosition> &LeftFootTraj_deq,  // INPUT
-    const std::deque<FootAbsolutePosition> &RightFootTraj_deq, // INPUT
+    RingBuffer<ZMPPosition> &ZMPPositions,                     // OUTPUT
+    RingBuffer<COMState> &COMTraj_deq,                         // OUTPUT
+    const RingBuffer<FootAbsolutePosition> &LeftFootTraj_deq,  // INPUT
+    const RingBuffer<FootAbsolutePosition> &RightFootTraj_deq, // INPUT
     const solution_t *aSolutionReference,                      // INPUT
     LinearizedInvertedPendulum2D *LIPM,                        // INPUT/OUTPUT
     const unsigned numberOfSample,                             // INPUT
@@ -677,7 +1037,7 @@ void ZMPVelocityReferencedQP::CoMZMPInterpolation(
     double jy = (LeftFootTraj_deq[i - 1].y + RightFootTraj_deq[i - 1].y) / 2 -
                 COMTraj_deq[i - 1].y[0];
     if (fabs(jx) < 1e-3 && fabs(jy) < 1e-3) {
-      Running_ = false;
+      RunningPreview_ = false;
     }
     const double tf = 0.75;
     jx = 6 / (tf * tf * tf) *
@@ -691,7 +1051,7 @@ void ZMPVelocityReferencedQP::CoMZMPInterpolation(
                         jy);
     LIPM->OneIteration(jx, jy);
   } else {
-    Running_ = true;
+    RunningPreview_ = true;
     LIPM->Interpolation(
         COMTraj_deq, ZMPPositions,
         currentIndex + IterationNumber * numberOfSample,
@@ -711,12 +1071,15 @@ void ZMPVelocityReferencedQP::InterpretSolutionVector() {
     Vx = 0.2;
   if (Vy > 0.2 /*ms*/)
     Vy = 0.2;
-  std::deque<support_state_t> &SupportStates = solution_.SupportStates_deq;
+  RingBuffer<support_state_t> &SupportStates = solution_.SupportStates_deq;
   support_state_t &LastSupport = solution_.SupportStates_deq.back();
   support_state_t &FirstSupport = solution_.SupportStates_deq[1];
   support_state_t &CurrentSupport = solution_.SupportStates_deq.front();
   int nbSteps = LastSupport.StepNumber;
-  FootPrw_vec.resize(nbSteps + 2, vector<double>(2, 0.0));
+  // FootPrw_vec is allocated in InitOnLine.
+  int size_vec_sol = nbSteps + 2;
+  if ((int)FootPrw_vec.size() < size_vec_sol)
+    FootPrw_vec.resize(size_vec_sol, vector<double>(2, 0.0));
 
   // complete the previewed feet position
   FootPrw_vec[0][0] = FirstSupport.X;
@@ -728,8 +1091,6 @@ void ZMPVelocityReferencedQP::InterpretSolutionVector() {
 
   // compute an additional previewed foot position
   {
-    int size_vec_sol = (int)FootPrw_vec.size();
-
     if (nbSteps > 0) {
       // center of the feet of the last preview double support phase :
       double middleX = (FootPrw_vec[size_vec_sol - 2][0] +
@@ -782,32 +1143,33 @@ void ZMPVelocityReferencedQP::PrepareSolution() {
 
 // TODO: New parent class needed
 void ZMPVelocityReferencedQP::GetZMPDiscretization(
-    deque<ZMPPosition> &, deque<COMState> &, deque<RelativeFootPosition> &,
-    deque<FootAbsolutePosition> &, deque<FootAbsolutePosition> &, double,
-    COMState &, Eigen::Vector3d &, FootAbsolutePosition &,
-    FootAbsolutePosition &) {
+    RingBuffer<ZMPPosition> &, RingBuffer<COMState> &,
+    deque<RelativeFootPosition> &, RingBuffer<FootAbsolutePosition> &,
+    RingBuffer<FootAbsolutePosition> &, double, COMState &, Eigen::Vector3d &,
+    FootAbsolutePosition &, FootAbsolutePosition &) {
   cout << "To be removed" << endl;
 }
 
-void ZMPVelocityReferencedQP::OnLineAddFoot(
-    RelativeFootPosition &, deque<ZMPPosition> &, deque<COMState> &,
-    deque<FootAbsolutePosition> &, deque<FootAbsolutePosition> &, bool) {
+void ZMPVelocityReferencedQP::OnLineAddFoot(RelativeFootPosition &,
+                                            RingBuffer<ZMPPosition> &,
+                                            RingBuffer<COMState> &,
+                                            RingBuffer<FootAbsolutePosition> &,
+                                            RingBuffer<FootAbsolutePosition> &,
+                                            bool) {
   cout << "To be removed" << endl;
 }
 
-int ZMPVelocityReferencedQP::OnLineFootChange(double, FootAbsolutePosition &,
-                                              deque<ZMPPosition> &,
-                                              deque<COMState> &,
-                                              deque<FootAbsolutePosition> &,
-                                              deque<FootAbsolutePosition> &,
-                                              StepStackHandler *) {
+int ZMPVelocityReferencedQP::OnLineFootChange(
+    double, FootAbsolutePosition &, RingBuffer<ZMPPosition> &,
+    RingBuffer<COMState> &, RingBuffer<FootAbsolutePosition> &,
+    RingBuffer<FootAbsolutePosition> &, StepStackHandler *) {
   cout << "To be removed" << endl;
   return -1;
 }
 
 void ZMPVelocityReferencedQP::EndPhaseOfTheWalking(
-    deque<ZMPPosition> &, deque<COMState> &, deque<FootAbsolutePosition> &,
-    deque<FootAbsolutePosition> &) {
+    RingBuffer<ZMPPosition> &, RingBuffer<COMState> &,
+    RingBuffer<FootAbsolutePosition> &, RingBuffer<FootAbsolutePosition> &) {
   cout << "To be removed" << endl;
 }
 
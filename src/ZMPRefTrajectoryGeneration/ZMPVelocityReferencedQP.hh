@@ -30,12 +30,19 @@
 #ifndef _ZMPVELOCITYREFERENCEDQP_WITH_CONSTRAINT_H_
 #define _ZMPVELOCITYREFERENCEDQP_WITH_CONSTRAINT_H_
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include <Mathematics/intermediate-qp-matrices.hh>
 #include <Mathematics/relative-feet-inequalities.hh>
 #include <PreviewControl/LinearizedInvertedPendulum2D.hh>
 #include <PreviewControl/PreviewControl.hh>
 #include <PreviewControl/SupportFSM.hh>
 #include <PreviewControl/rigid-body-system.hh>
+#include <RingBuffer.hh>
+#include <SPSCQueue.hh>
 #include <ZMPRefTrajectoryGeneration/DynamicFilter.hh>
 #include <ZMPRefTrajectoryGeneration/OrientationsPreview.hh>
 #include <ZMPRefTrajectoryGeneration/ZMPRefTrajectoryGeneration.hh>
@@ -59,6 +66,18 @@ public:
   ~ZMPVelocityReferencedQP();
 
   /// \brief Handle plugins (SimplePlugin interface)
+  ///
+  /// ":asyncQP true|false" switches the asynchronous solve of the QP:
+  /// the QP of the next period is built, solved and interpolated on a
+  /// worker thread while the current one is being played, and the control
+  /// thread only swaps the finished trajectories in.
+  /// The velocity reference is then sampled one QP period earlier.
+  ///
+  /// ":pipelinedFilter true|false" runs the dynamic filter on its own
+  /// thread, one QP period behind: the correction computed from the
+  /// preview of one period is applied at the next one, and the filter
+  /// previews the ZMP error from there. The options of the dynamic
+  /// filter should not be changed while walking in this mode.
   void CallMethod(std::string &Method, std::istringstream &strm);
 
   /*! \name Call method to handle on-line generation of ZMP
@@ -76,21 +95,21 @@ public:
     Returns the number of steps which has been completely put inside
     the queue of ZMP, and foot positions.
   */
-  std::size_t InitOnLine(deque<ZMPPosition> &FinalZMPPositions,
-                         deque<COMState> &FinalCoMPositions_deq,
-                         deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-                         deque<FootAbsolutePosition> &FinalRightFootTraj_deq,
-                         FootAbsolutePosition &InitLeftFootAbsolutePosition,
-                         FootAbsolutePosition &InitRightFootAbsolutePosition,
-                         deque<RelativeFootPosition> &RelativeFootPositions,
-                         COMState &lStartingCOMState,
-                         Eigen::Vector3d &lStartingZMPPosition);
+  std::size_t InitOnLine(
+      RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &FinalCoMPositions_deq,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq,
+      FootAbsolutePosition &InitLeftFootAbsolutePosition,
+      FootAbsolutePosition &InitRightFootAbsolutePosition,
+      deque<RelativeFootPosition> &RelativeFootPositions,
+      COMState &lStartingCOMState, Eigen::Vector3d &lStartingZMPPosition);
 
   /// \brief Update the stacks on-line
-  void OnLine(double time, deque<ZMPPosition> &FinalZMPPositions,
-              deque<COMState> &FinalCOMTraj_deq,
-              deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-              deque<FootAbsolutePosition> &FinalRightFootTraj_deq);
+  void OnLine(double time, RingBuffer<ZMPPosition> &FinalZMPPositions,
+              RingBuffer<COMState> &FinalCOMTraj_deq,
+              RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+              RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq);
 
   /// \name Accessors and mutators
   /// \{
@@ -115,7 +134,24 @@ public:
   void setCoMPerturbationForce(double x, double y);
   void setCoMPerturbationForce(istringstream &strm);
 
-  solution_t &Solution() { return Solution_; }
+  /// \brief Last solution applied to the trajectories.
+  solution_t &Solution() {
+    if (AsyncPending_) {
+      WaitAsyncIdle();
+      return AsyncSlots_[AsyncFront_].Solution;
+    }
+    return Solution_;
+  }
+
+  /// \brief Number of times the control thread had to wait for the worker
+  /// thread in asynchronous mode, since the start of the walk.
+  inline unsigned long AsyncDeadlineMisses() const {
+    return AsyncDeadlineMisses_;
+  }
+
+  /// \brief Number of updates for which the control thread had to wait for
+  /// the dynamic filter in pipelined mode.
+  inline unsigned long FilterLateUpdates() const { return FilterLateUpdates_; }
 
   inline const int &QP_N(void) const { return QP_N_; }
 
@@ -149,6 +185,10 @@ private:
   /// \brief PG running
   bool Running_;
 
+  /// \brief PG running as seen by the last interpolation of the preview,
+  /// copied into Running_ when the trajectories are applied.
+  bool RunningPreview_;
+
   /// \brief Time at which the online mode will stop
   double TimeToStopOnLineMode_;
 
@@ -161,6 +201,11 @@ private:
   /// \brief Additional term on the acceleration of the CoM
   Eigen::VectorXd PerturbationAcceleration_;
 
+  /// \brief Perturbation set since the last update, handed over to the
+  /// QP with the velocity reference.
+  bool NewPerturbationOccured_;
+  Eigen::VectorXd NewPerturbationAcceleration_;
+
   /// \brief Sampling period considered in the QP
   double QP_T_;
 
@@ -205,6 +250,9 @@ private:
   /// \brief Previewed Solution
   solution_t Solution_;
 
+  /// \brief Constraint multipliers of the last cycle
+  Eigen::VectorXd LastConstrLagr_vec_;
+
   /// \brief Copy of the QP_ solution
   solution_t solution_;
 
@@ -212,17 +260,17 @@ private:
   PinocchioRobot *PR_;
 
   /// \brief Buffers for the Kajita's dynamic filter
-  deque<COMState> deltaCOMTraj_deq_;
+  COMStateBlock deltaCOMTraj_;
 
-  deque<ZMPPosition> ZMPTraj_deq_;
-  deque<COMState> COMTraj_deq_;
-  deque<FootAbsolutePosition> LeftFootTraj_deq_;
-  deque<FootAbsolutePosition> RightFootTraj_deq_;
+  RingBuffer<ZMPPosition> ZMPTraj_deq_;
+  RingBuffer<COMState> COMTraj_deq_;
+  RingBuffer<FootAbsolutePosition> LeftFootTraj_deq_;
+  RingBuffer<FootAbsolutePosition> RightFootTraj_deq_;
 
-  deque<ZMPPosition> ZMPTraj_deq_ctrl_;
-  deque<COMState> COMTraj_deq_ctrl_;
-  deque<FootAbsolutePosition> LeftFootTraj_deq_ctrl_;
-  deque<FootAbsolutePosition> RightFootTraj_deq_ctrl_;
+  RingBuffer<ZMPPosition> ZMPTraj_deq_ctrl_;
+  RingBuffer<COMState> COMTraj_deq_ctrl_;
+  RingBuffer<FootAbsolutePosition> LeftFootTraj_deq_ctrl_;
+  RingBuffer<FootAbsolutePosition> RightFootTraj_deq_ctrl_;
 
   /// \brief used to predict the next step using the current solution
   /// allow the computation of the complete preview
@@ -271,45 +319,194 @@ private:
 
   DynamicFilter *dynamicFilter_;
 
+  /// \brief Solver of the QP
+  solver_e QPSolver_;
+
+  /// \name Asynchronous solve of the QP
+  /// \{
+  /// \brief Result of one QP period computed by the worker thread.
+  struct async_slot_t {
+    /// \brief Time at which the result has to be applied
+    double Time;
+    /// \brief Value of Running_ after the interpolation
+    bool Running;
+    /// \brief Size of the queues before the interpolation
+    std::size_t PredictedSize;
+    solution_t Solution;
+    /// \brief Perturbation sampled when the job was posted
+    bool PerturbationOccured;
+    Eigen::VectorXd PerturbationAcceleration;
+    /// \brief Predicted trajectory queues extended by one QP period
+    RingBuffer<ZMPPosition> ZMPTraj_deq;
+    RingBuffer<COMState> COMTraj_deq;
+    RingBuffer<FootAbsolutePosition> LeftFootTraj_deq;
+    RingBuffer<FootAbsolutePosition> RightFootTraj_deq;
+    /// \brief Inputs of the dynamic filter
+    RingBuffer<ZMPPosition> FilterZMPTraj_deq;
+    RingBuffer<COMState> FilterCOMTraj_deq;
+    RingBuffer<FootAbsolutePosition> FilterLeftFootTraj_deq;
+    RingBuffer<FootAbsolutePosition> FilterRightFootTraj_deq;
+  };
+
+  /// \brief Asynchronous mode switch
+  bool AsyncQP_;
+  /// \brief Double buffer of results
+  async_slot_t AsyncSlots_[2];
+  /// \brief Slot read by the control thread
+  int AsyncFront_;
+  /// \brief Slot written by the worker thread
+  int AsyncBack_;
+  /// \brief Index of the published slot, -1 while the worker is busy
+  std::atomic<int> AsyncReady_;
+  /// \brief A job has been posted and its result not consumed yet
+  bool AsyncPending_;
+  /// \brief Velocity reference sampled when the job was posted
+  reference_t AsyncVelRef_;
+  /// \brief Updates and calls for which the result was not ready in time
+  unsigned long AsyncDeadlineMisses_;
+  /// \brief Updates in asynchronous mode since the start of the walk
+  unsigned long AsyncUpdates_;
+
+  std::thread AsyncThread_;
+  std::mutex AsyncMutex_;
+  std::condition_variable AsyncCond_;
+  /// \brief Guarded by AsyncMutex_
+  bool AsyncJobPosted_;
+  bool AsyncStop_;
+
+  /// \brief Loop of the worker thread
+  void AsyncWorker();
+
+  /// \brief Ask the worker thread to compute the QP period starting at time
+  /// from the queues predicted at that time.
+  void PostAsyncJob(
+      double time, const RingBuffer<ZMPPosition> &FinalZMPTraj_deq,
+      const RingBuffer<COMState> &FinalCOMTraj_deq,
+      const RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+      const RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq);
+
+  /// \brief Get the slot of the pending job, waiting for it if needed.
+  int TakeAsyncResult();
+
+  /// \brief Wait until the worker thread does not touch the preview anymore.
+  /// Having to wait counts as a deadline miss.
+  void WaitAsyncIdle();
+
+  /// \brief Take the perturbation set since the last update.
+  void TakePerturbation(bool &Occured, Eigen::VectorXd &Acceleration);
+
+  /// \brief Stop and join the worker thread.
+  void StopAsyncWorker();
+
+  /// \brief Exchange the buffers of the dynamic filter with the ones of
+  /// a slot.
+  void SwapFilterBuffers(async_slot_t &aSlot);
+  /// \}
+
+  /// \name Pipelined dynamic filter
+  /// \{
+  /// \brief Inputs of the dynamic filter for one QP period.
+  struct filter_packet_t {
+    RingBuffer<ZMPPosition> ZMPTraj_deq;
+    RingBuffer<COMState> COMTraj_deq;
+    RingBuffer<FootAbsolutePosition> LeftFootTraj_deq;
+    RingBuffer<FootAbsolutePosition> RightFootTraj_deq;
+  };
+
+  /// \brief Pipelined mode switch
+  bool PipelinedFilter_;
+  /// \brief Packets sent by the control thread to the filter thread
+  SPSCQueue<filter_packet_t> FilterInputs_;
+  /// \brief Corrections of the CoM sent back by the filter thread
+  SPSCQueue<COMStateBlock> FilterOutputs_;
+  /// \brief Packets posted and whose correction was not applied yet
+  unsigned int FilterInFlight_;
+  /// \brief Updates for which the correction was not ready in time
+  unsigned long FilterLateUpdates_;
+
+  std::thread FilterThread_;
+  std::mutex FilterMutex_;
+  std::condition_variable FilterCond_;
+  /// \brief Guarded by FilterMutex_
+  bool FilterStop_;
+
+  /// \brief Loop of the filter thread
+  void FilterWorker();
+
+  /// \brief Apply the correction of the previous period to the first QP
+  /// period of FinalCOMTraj_deq, and send the inputs of this one to the
+  /// filter thread.
+  void PipelinedFilterCoM(
+      RingBuffer<COMState> &FinalCOMTraj_deq,
+      const RingBuffer<COMState> &COMTraj_deq,
+      const RingBuffer<ZMPPosition> &ZMPTraj_deq_ctrl,
+      const RingBuffer<FootAbsolutePosition> &LeftFootTraj_deq,
+      const RingBuffer<FootAbsolutePosition> &RightFootTraj_deq);
+
+  /// \brief Wait for the packets in flight and drop their corrections.
+  void DrainFilter();
+
+  /// \brief Stop and join the filter thread.
+  void StopFilterWorker();
+  /// \}
+
+  /// \brief Build, solve and interpolate the QP of the period starting at
+  /// time. The trajectory queues are extended by one QP period and the
+  /// buffers of the dynamic filter are filled.
+  void SolveAndInterpolate(
+      double time, RingBuffer<ZMPPosition> &FinalZMPTraj_deq,
+      RingBuffer<COMState> &FinalCOMTraj_deq,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq);
+
+  /// \brief Run the dynamic filter on the whole preview and correct the CoM
+  /// of the first QP period.
+  void FilterCoM(RingBuffer<COMState> &FinalCOMTraj_deq,
+                 RingBuffer<COMState> &COMTraj_deq,
+                 RingBuffer<ZMPPosition> &ZMPTraj_deq_ctrl,
+                 RingBuffer<FootAbsolutePosition> &LeftFootTraj_deq,
+                 RingBuffer<FootAbsolutePosition> &RightFootTraj_deq);
+
 public:
   void GetZMPDiscretization(
-      std::deque<ZMPPosition> &ZMPPositions, std::deque<COMState> &COMStates,
+      RingBuffer<ZMPPosition> &ZMPPositions, RingBuffer<COMState> &COMStates,
       std::deque<RelativeFootPosition> &RelativeFootPositions,
-      std::deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-      std::deque<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
       COMState &lStartingCOMState, Eigen::Vector3d &lStartingZMPPosition,
       FootAbsolutePosition &InitLeftFootAbsolutePosition,
       FootAbsolutePosition &InitRightFootAbsolutePosition);
 
   void OnLineAddFoot(RelativeFootPosition &NewRelativeFootPosition,
-                     std::deque<ZMPPosition> &FinalZMPPositions,
-                     std::deque<COMState> &COMStates,
-                     std::deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-                     std::deque<FootAbsolutePosition> &FinalRightFootTraj_deq,
+                     RingBuffer<ZMPPosition> &FinalZMPPositions,
+                     RingBuffer<COMState> &COMStates,
+                     RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+                     RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq,
                      bool EndSequence);
 
   int OnLineFootChange(double time, FootAbsolutePosition &aFootAbsolutePosition,
-                       deque<ZMPPosition> &FinalZMPPositions,
-                       deque<COMState> &CoMPositions,
-                       deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-                       deque<FootAbsolutePosition> &FinalRightFootTraj_deq,
+                       RingBuffer<ZMPPosition> &FinalZMPPositions,
+                       RingBuffer<COMState> &CoMPositions,
+                       RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+                       RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq,
                        StepStackHandler *aStepStackHandler);
 
   void
-  EndPhaseOfTheWalking(deque<ZMPPosition> &ZMPPositions,
-                       deque<COMState> &FinalCOMTraj_deq,
-                       deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-                       deque<FootAbsolutePosition> &RightFootAbsolutePositions);
+  EndPhaseOfTheWalking(
+      RingBuffer<ZMPPosition> &ZMPPositions,
+      RingBuffer<COMState> &FinalCOMTraj_deq,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions);
 
   int ReturnOptimalTimeToRegenerateAStep();
 
   /// \brief Interpolation form the com jerk the position of the com and the
   /// zmp corresponding to the kart table model
   void CoMZMPInterpolation(
-      std::deque<ZMPPosition> &ZMPPositions,                     // OUTPUT
-      std::deque<COMState> &COMTraj_deq,                         // OUTPUT
-      const std::deque<FootAbsolutePosition> &LeftFootTraj_deq,  // INPUT
-      const std::deque<FootAbsolutePosition> &RightFootTraj_deq, // INPUT
+      RingBuffer<ZMPPosition> &ZMPPositions,                     // OUTPUT
+      RingBuffer<COMState> &COMTraj_deq,                         // OUTPUT
+      const RingBuffer<FootAbsolutePosition> &LeftFootTraj_deq,  // INPUT
+      const RingBuffer<FootAbsolutePosition> &RightFootTraj_deq, // INPUT
       const solution_t *Solution,                                // INPUT
       LinearizedInvertedPendulum2D *LIPM,                        // INPUT/OUTPUT
       const unsigned numberOfSample,                             // INPUT
@@ -319,10 +516,10 @@ public:
   /// \brief Interpolate just enough data to pilot the robot (period of
   ///    interpolation = QP_T_)
   void ControlInterpolation(
-      std::deque<COMState> &FinalCOMTraj_deq,                   // OUTPUT
-      std::deque<ZMPPosition> &FinalZMPTraj_deq,                // OUTPUT
-      std::deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,  // OUTPUT
-      std::deque<FootAbsolutePosition> &FinalRightFootTraj_deq, // OUTPUT
+      RingBuffer<COMState> &FinalCOMTraj_deq,                   // OUTPUT
+      RingBuffer<ZMPPosition> &FinalZMPTraj_deq,                // OUTPUT
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,  // OUTPUT
+      RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq, // OUTPUT
       double time);                                             // INPUT
 
   /// \brief Interpolation everything on the whole preview
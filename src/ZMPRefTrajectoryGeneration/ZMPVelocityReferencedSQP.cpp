@@ -106,11 +106,11 @@ ZMPVelocityReferencedSQP::ZMPVelocityReferencedSQP(SimplePluginManager *SPM,
   dynamicFilter_ = new DynamicFilter(SPM, PR_);
 
   // Register method to handle
-  const unsigned int NbMethods = 8;
+  const unsigned int NbMethods = 9;
   string aMethodName[NbMethods] = {
       ":previewcontroltime", ":numberstepsbeforestop", ":stoppg",
       ":setfeetconstraint",  ":addoneobstacle",        ":updateoneobstacle",
-      ":deleteallobstacles", ":perturbationforce"};
+      ":deleteallobstacles", ":perturbationforce",     ":reusehessianfactor"};
 
   for (unsigned int i = 0; i < NbMethods; i++) {
     if (!RegisterMethod(aMethodName[i])) {
@@ -136,8 +136,9 @@ ZMPVelocityReferencedSQP::ZMPVelocityReferencedSQP(SimplePluginManager *SPM,
   RightFootTraj_deq_ctrl_.resize(previewSize_ * NbSampleControl_ +
                                  CurrentIndexUpperBound_);
 
-  deltaCOMTraj_deq_.resize(
-      (int)round(outputPreviewDuration_ / m_SamplingPeriod));
+  deltaCOMTraj_.resize(
+      (std::size_t)round(outputPreviewDuration_ / m_SamplingPeriod));
+  deltaCOMTraj_.setZero();
 
   JerkX_.clear();
   JerkY_.clear();
@@ -225,6 +226,13 @@ void ZMPVelocityReferencedSQP::CallMethod(std::string &Method,
   if (Method == ":perturbationforce") {
     setCoMPerturbationForce(strm);
   }
+  if (Method == ":reusehessianfactor") {
+    string reuse;
+    double tolerance = 0.0;
+    strm >> reuse;
+    strm >> tolerance;
+    NMPCgenerator_->reuseHessianFactor(reuse == "true", tolerance);
+  }
 
   ZMPRefTrajectoryGeneration::CallMethod(Method, strm);
 
@@ -238,10 +246,10 @@ void ZMPVelocityReferencedSQP::CallMethod(std::string &Method,
 }
 
 std::size_t ZMPVelocityReferencedSQP::InitOnLine(
-    deque<ZMPPosition> &FinalZMPTraj_deq,
-    deque<COMState> &FinalCoMPositions_deq,
-    deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-    deque<FootAbsolutePosition> &FinalRightFootTraj_deq,
+    RingBuffer<ZMPPosition> &FinalZMPTraj_deq,
+    RingBuffer<COMState> &FinalCoMPositions_deq,
+    RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+    RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq,
     FootAbsolutePosition &InitLeftFootAbsolutePosition,
     FootAbsolutePosition &InitRightFootAbsolutePosition,
     deque<RelativeFootPosition> &, // RelativeFootPositions,
@@ -366,8 +374,9 @@ std::size_t ZMPVelocityReferencedSQP::InitOnLine(
   RightFootTraj_deq_ctrl_.resize(previewSize_ * NbSampleControl_ +
                                  CurrentIndexUpperBound_);
 
-  deltaCOMTraj_deq_.resize(
-      (int)round(outputPreviewDuration_ / m_SamplingPeriod));
+  deltaCOMTraj_.resize(
+      (std::size_t)round(outputPreviewDuration_ / m_SamplingPeriod));
+  deltaCOMTraj_.setZero();
 
   JerkX_.clear();
   JerkY_.clear();
@@ -420,10 +429,10 @@ std::size_t ZMPVelocityReferencedSQP::InitOnLine(
 }
 
 void ZMPVelocityReferencedSQP::OnLine(
-    double time, deque<ZMPPosition> &FinalZMPTraj_deq,
-    deque<COMState> &FinalCOMTraj_deq,
-    deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-    deque<FootAbsolutePosition> &FinalRightFootTraj_deq) {
+    double time, RingBuffer<ZMPPosition> &FinalZMPTraj_deq,
+    RingBuffer<COMState> &FinalCOMTraj_deq,
+    RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+    RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq) {
   // If on-line mode not activated we go out.
   if (!m_OnLineMode) {
     return;
@@ -515,25 +524,17 @@ void ZMPVelocityReferencedSQP::OnLine(
 
     dynamicFilter_->OnLinefilter(COMTraj_deq_, ZMPTraj_deq_ctrl_,
                                  LeftFootTraj_deq_, RightFootTraj_deq_,
-                                 deltaCOMTraj_deq_);
+                                 deltaCOMTraj_);
 #ifdef DEBUG
+    RingBuffer<COMState> deltaCOMTraj_deq(deltaCOMTraj_.size());
+    deltaCOMTraj_.store(deltaCOMTraj_deq, 0, deltaCOMTraj_.size(), COM_XY);
     dynamicFilter_->Debug(COMTraj_deq_ctrl_, LeftFootTraj_deq_ctrl_,
                           RightFootTraj_deq_ctrl_, COMTraj_deq_,
                           ZMPTraj_deq_ctrl_, LeftFootTraj_deq_,
-                          RightFootTraj_deq_, deltaCOMTraj_deq_);
+                          RightFootTraj_deq_, deltaCOMTraj_deq);
 #endif
     // Correct the CoM.
-    for (unsigned int i = 0; i < deltaCOMTraj_deq_.size(); ++i) {
-      for (int j = 0; j < 3; j++) {
-        FinalCOMTraj_deq[i].x[j] += deltaCOMTraj_deq_[i].x[j];
-        FinalCOMTraj_deq[i].y[j] += deltaCOMTraj_deq_[i].y[j];
-        //        FinalZMPTraj_deq[i].px = FinalCOMTraj_deq[i].x[0] -
-        //            CoMHeight_ / 9.81 * FinalCOMTraj_deq[i].x[2];
-        //        FinalZMPTraj_deq[i].py = FinalCOMTraj_deq[i].y[0] -
-        //            CoMHeight_ / 9.81 * FinalCOMTraj_deq[i].y[2];
-        //        FinalZMPTraj_deq[i].pz = 0.0 ;
-      }
-    }
+    deltaCOMTraj_.addTo(FinalCOMTraj_deq, 0, deltaCOMTraj_.size(), COM_XY);
 
     // Specify that we are in the ending phase.
     if (time <= m_SamplingPeriod) {
@@ -701,32 +702,33 @@ void ZMPVelocityReferencedSQP::CoMZMPInterpolation(
 
 // TODO: New parent class needed
 void ZMPVelocityReferencedSQP::GetZMPDiscretization(
-    deque<ZMPPosition> &, deque<COMState> &, deque<RelativeFootPosition> &,
-    deque<FootAbsolutePosition> &, deque<FootAbsolutePosition> &, double,
-    COMState &, Eigen::Vector3d &, FootAbsolutePosition &,
-    FootAbsolutePosition &) {
+    RingBuffer<ZMPPosition> &, RingBuffer<COMState> &,
+    deque<RelativeFootPosition> &, RingBuffer<FootAbsolutePosition> &,
+    RingBuffer<FootAbsolutePosition> &, double, COMState &, Eigen::Vector3d &,
+    FootAbsolutePosition &, FootAbsolutePosition &) {
   cout << "To be removed" << endl;
 }
 
-void ZMPVelocityReferencedSQP::OnLineAddFoot(
-    RelativeFootPosition &, deque<ZMPPosition> &, deque<COMState> &,
-    deque<FootAbsolutePosition> &, deque<FootAbsolutePosition> &, bool) {
+void ZMPVelocityReferencedSQP::OnLineAddFoot(RelativeFootPosition &,
+                                             RingBuffer<ZMPPosition> &,
+                                             RingBuffer<COMState> &,
+                                             RingBuffer<FootAbsolutePosition> &,
+                                             RingBuffer<FootAbsolutePosition> &,
+                                             bool) {
   cout << "To be removed" << endl;
 }
 
-int ZMPVelocityReferencedSQP::OnLineFootChange(double, FootAbsolutePosition &,
-                                               deque<ZMPPosition> &,
-                                               deque<COMState> &,
-                                               deque<FootAbsolutePosition> &,
-                                               deque<FootAbsolutePosition> &,
-                                               StepStackHandler *) {
+int ZMPVelocityReferencedSQP::OnLineFootChange(
+    double, FootAbsolutePosition &, RingBuffer<ZMPPosition> &,
+    RingBuffer<COMState> &, RingBuffer<FootAbsolutePosition> &,
+    RingBuffer<FootAbsolutePosition> &, StepStackHandler *) {
   cout << "To be removed" << endl;
   return -1;
 }
 
 void ZMPVelocityReferencedSQP::EndPhaseOfTheWalking(
-    deque<ZMPPosition> &, deque<COMState> &, deque<FootAbsolutePosition> &,
-    deque<FootAbsolutePosition> &) {
+    RingBuffer<ZMPPosition> &, RingBuffer<COMState> &,
+    RingBuffer<FootAbsolutePosition> &, RingBuffer<FootAbsolutePosition> &) {
   cout << "To be removed" << endl;
 }
 
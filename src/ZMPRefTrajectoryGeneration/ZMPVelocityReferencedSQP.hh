@@ -30,6 +30,7 @@
 
 #include <PreviewControl/LinearizedInvertedPendulum2D.hh>
 #include <PreviewControl/rigid-body-system.hh>
+#include <RingBuffer.hh>
 #include <ZMPRefTrajectoryGeneration/DynamicFilter.hh>
 #include <ZMPRefTrajectoryGeneration/ZMPRefTrajectoryGeneration.hh>
 #include <ZMPRefTrajectoryGeneration/nmpc_generator.hh>
@@ -67,15 +68,15 @@ public:
     Returns the number of steps which has been completely put inside
     the queue of ZMP, and foot positions.
   */
-  std::size_t InitOnLine(deque<ZMPPosition> &FinalZMPPositions,
-                         deque<COMState> &FinalCoMPositions_deq,
-                         deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-                         deque<FootAbsolutePosition> &FinalRightFootTraj_deq,
-                         FootAbsolutePosition &InitLeftFootAbsolutePosition,
-                         FootAbsolutePosition &InitRightFootAbsolutePosition,
-                         deque<RelativeFootPosition> &RelativeFootPositions,
-                         COMState &lStartingCOMState,
-                         Eigen::Vector3d &lStartingZMPPosition);
+  std::size_t InitOnLine(
+      RingBuffer<ZMPPosition> &FinalZMPPositions,
+      RingBuffer<COMState> &FinalCoMPositions_deq,
+      RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+      RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq,
+      FootAbsolutePosition &InitLeftFootAbsolutePosition,
+      FootAbsolutePosition &InitRightFootAbsolutePosition,
+      deque<RelativeFootPosition> &RelativeFootPositions,
+      COMState &lStartingCOMState, Eigen::Vector3d &lStartingZMPPosition);
 
   int UpdateCurrentPos(ZMPPosition initZMP, COMState initCOM,
                        FootAbsolutePosition initLeftFoot,
@@ -112,10 +113,10 @@ public:
   }
 
   /// \brief Update the stacks on-line
-  void OnLine(double time, deque<ZMPPosition> &FinalZMPPositions,
-              deque<COMState> &FinalCOMTraj_deq,
-              deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-              deque<FootAbsolutePosition> &FinalRightFootTraj_deq);
+  void OnLine(double time, RingBuffer<ZMPPosition> &FinalZMPPositions,
+              RingBuffer<COMState> &FinalCOMTraj_deq,
+              RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+              RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq);
 
   /// \name Accessors and mutators
   /// \{
@@ -216,17 +217,17 @@ private:
   double RobotMass_;
 
   /// \brief Buffers for the Kajita's dynamic filter
-  std::deque<COMState> deltaCOMTraj_deq_;
+  COMStateBlock deltaCOMTraj_;
   // subsampled trajectory m_interpolationPeriod
-  std::deque<ZMPPosition> ZMPTraj_deq_;
-  std::deque<COMState> COMTraj_deq_;
-  std::deque<FootAbsolutePosition> LeftFootTraj_deq_;
-  std::deque<FootAbsolutePosition> RightFootTraj_deq_;
+  RingBuffer<ZMPPosition> ZMPTraj_deq_;
+  RingBuffer<COMState> COMTraj_deq_;
+  RingBuffer<FootAbsolutePosition> LeftFootTraj_deq_;
+  RingBuffer<FootAbsolutePosition> RightFootTraj_deq_;
   // full trajectory (m_samplingPeriod)
-  std::deque<ZMPPosition> ZMPTraj_deq_ctrl_;
-  std::deque<COMState> COMTraj_deq_ctrl_;
-  std::deque<FootAbsolutePosition> LeftFootTraj_deq_ctrl_;
-  std::deque<FootAbsolutePosition> RightFootTraj_deq_ctrl_;
+  RingBuffer<ZMPPosition> ZMPTraj_deq_ctrl_;
+  RingBuffer<COMState> COMTraj_deq_ctrl_;
+  RingBuffer<FootAbsolutePosition> LeftFootTraj_deq_ctrl_;
+  RingBuffer<FootAbsolutePosition> RightFootTraj_deq_ctrl_;
   // usefull deque to handle the solution of the nmpc
   std::vector<double> JerkX_;
   std::vector<double> JerkY_;
@@ -277,33 +278,34 @@ private:
 
 public:
   void GetZMPDiscretization(
-      std::deque<ZMPPosition> &ZMPPositions, std::deque<COMState> &COMStates,
+      RingBuffer<ZMPPosition> &ZMPPositions, RingBuffer<COMState> &COMStates,
       std::deque<RelativeFootPosition> &RelativeFootPositions,
-      std::deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-      std::deque<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions, double Xmax,
       COMState &lStartingCOMState, Eigen::Vector3d &lStartingZMPPosition,
       FootAbsolutePosition &InitLeftFootAbsolutePosition,
       FootAbsolutePosition &InitRightFootAbsolutePosition);
 
   void OnLineAddFoot(RelativeFootPosition &NewRelativeFootPosition,
-                     std::deque<ZMPPosition> &FinalZMPPositions,
-                     std::deque<COMState> &COMStates,
-                     std::deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-                     std::deque<FootAbsolutePosition> &FinalRightFootTraj_deq,
+                     RingBuffer<ZMPPosition> &FinalZMPPositions,
+                     RingBuffer<COMState> &COMStates,
+                     RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+                     RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq,
                      bool EndSequence);
 
   int OnLineFootChange(double time, FootAbsolutePosition &aFootAbsolutePosition,
-                       deque<ZMPPosition> &FinalZMPPositions,
-                       deque<COMState> &CoMPositions,
-                       deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-                       deque<FootAbsolutePosition> &FinalRightFootTraj_deq,
+                       RingBuffer<ZMPPosition> &FinalZMPPositions,
+                       RingBuffer<COMState> &CoMPositions,
+                       RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+                       RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq,
                        StepStackHandler *aStepStackHandler);
 
   void
-  EndPhaseOfTheWalking(deque<ZMPPosition> &ZMPPositions,
-                       deque<COMState> &FinalCOMTraj_deq,
-                       deque<FootAbsolutePosition> &LeftFootAbsolutePositions,
-                       deque<FootAbsolutePosition> &RightFootAbsolutePositions);
+  EndPhaseOfTheWalking(
+      RingBuffer<ZMPPosition> &ZMPPositions,
+      RingBuffer<COMState> &FinalCOMTraj_deq,
+      RingBuffer<FootAbsolutePosition> &LeftFootAbsolutePositions,
+      RingBuffer<FootAbsolutePosition> &RightFootAbsolutePositions);
 
   int ReturnOptimalTimeToRegenerateAStep();
 
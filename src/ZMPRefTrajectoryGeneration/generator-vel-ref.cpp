@@ -36,8 +36,12 @@ GeneratorVelRef::GeneratorVelRef(SimplePluginManager *lSPM, IntermedQPMat *Data,
                                  RigidBodySystem *Robot,
                                  RelativeFeetInequalities *RFI)
     : MPCTrajectoryGeneration(lSPM), IntermedData_(Data), Robot_(Robot),
-      RFI_(RFI), LastFootSolX_(0.0), LastFootSolY_(0.0), MM_(1, 1), MV_(1),
-      MV2_(1) {}
+      RFI_(RFI), LastFootSolX_(0.0), LastFootSolY_(0.0), Phase_(0),
+      MM_(1, 1), MV_(1), MV2_(1) {
+  ConstraintRows_.NbEq = ConstraintRows_.NbSteps = 0;
+  ConstraintRows_.NbCoP = ConstraintRows_.NbFeet = 0;
+  LastConstraintRows_ = ConstraintRows_;
+}
 
 GeneratorVelRef::~GeneratorVelRef() {}
 
@@ -52,13 +56,17 @@ void GeneratorVelRef::Ponderation(double weight, objective_e type) {
   IntermedQPMat::objective_variant_t &Objective =
       IntermedData_->Objective(type);
   Objective.weight = weight;
+
+  // The cached phases contain weighted terms.
+  PhaseCache_.clear();
+  Phase_ = 0;
 }
 
 void GeneratorVelRef::preview_support_states(
     double time, const SupportFSM *FSM,
-    const deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-    const deque<FootAbsolutePosition> &FinalRightFootTraj_deq,
-    deque<support_state_t> &SupportStates_deq) {
+    const RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+    const RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq,
+    RingBuffer<support_state_t> &SupportStates_deq) {
 
   const FootAbsolutePosition *FAP = NULL;
 
@@ -113,17 +121,44 @@ void GeneratorVelRef::preview_support_states(
 }
 
 void GeneratorVelRef::generate_selection_matrices(
-    const std::deque<support_state_t> &SupportStates_deq) {
+    const RingBuffer<support_state_t> &SupportStates_deq) {
 
   IntermedQPMat::state_variant_t &State = IntermedData_->State();
   const unsigned &NbPrwSteps = SupportStates_deq.back().StepNumber;
 
+  // The selection matrices only depend on the step numbers
+  // of the previewed samples, which repeat during a walk.
+  RingBuffer<support_state_t>::const_iterator SS_it;
+  SS_it = SupportStates_deq.begin(); // points at the cur. sup. st.
+  ++SS_it;
+  PhaseKey_.resize(N_);
+  for (unsigned i = 0; i < N_; i++, ++SS_it)
+    PhaseKey_[i] = SS_it->StepNumber;
+  if (Robot_->multiBody()) {
+    // The CoP dynamics are rebuilt at each cycle with the feet,
+    // the phases can not be reused.
+    PhaseCache_.clear();
+    compute_support_phase(MultiBodyPhase_);
+    Phase_ = &MultiBodyPhase_;
+  } else {
+    phase_cache_t::iterator Phase_it = PhaseCache_.find(PhaseKey_);
+    if (Phase_it == PhaseCache_.end()) {
+      // Bound the memory when the walk does not settle.
+      if (PhaseCache_.size() >= 256)
+        PhaseCache_.clear();
+      Phase_it =
+          PhaseCache_.insert(std::make_pair(PhaseKey_, support_phase_t()))
+              .first;
+      compute_support_phase(Phase_it->second);
+    }
+    Phase_ = &Phase_it->second;
+  }
+  State.V = Phase_->V;
+  State.VT = Phase_->VT;
+  State.Vshift = Phase_->Vshift;
+
   State.VcX.setZero();
   State.VcY.setZero();
-  State.V.resize(N_, NbPrwSteps);
-  State.V.setZero();
-  State.VT.resize(NbPrwSteps, N_);
-  State.VT.setZero();
   State.Vc_fX.resize(NbPrwSteps);
   State.Vc_fX.setZero();
   State.Vc_fY.resize(NbPrwSteps);
@@ -131,13 +166,10 @@ void GeneratorVelRef::generate_selection_matrices(
   State.V_f.resize(NbPrwSteps, NbPrwSteps);
   State.V_f.setZero();
 
-  std::deque<support_state_t>::const_iterator SS_it;
   SS_it = SupportStates_deq.begin(); // points at the cur. sup. st.
   ++SS_it;
   for (unsigned i = 0; i < N_; i++) {
     if (SS_it->StepNumber > 0) {
-      State.V(i, SS_it->StepNumber - 1) = State.VT(SS_it->StepNumber - 1, i) =
-          1.0;
       if (SS_it->StepNumber == 1 && SS_it->StateChanged && SS_it->Phase == SS) {
         --SS_it;
         State.Vc_fX(0) = SS_it->X;
@@ -158,20 +190,35 @@ void GeneratorVelRef::generate_selection_matrices(
 
   State.VcshiftX.setZero();
   State.VcshiftY.setZero();
-  State.Vshift.resize(N_, NbPrwSteps);
-  State.Vshift.setZero();
   SS_it = SupportStates_deq.begin();
   State.VcshiftX(0) = SS_it->X;
   State.VcshiftY(0) = SS_it->Y;
   for (unsigned i = 0; i < (N_ - 1); ++i) {
-    for (unsigned j = 0; j < NbPrwSteps; ++j) {
-      State.Vshift(i + 1, j) = State.V(i, j);
-    }
     State.VcshiftX(i + 1) = State.VcX(i);
     State.VcshiftY(i + 1) = State.VcY(i);
   }
 }
 
+void GeneratorVelRef::compute_support_phase(support_phase_t &Phase) {
+
+  const unsigned NbPrwSteps = PhaseKey_.back();
+
+  Phase.V.setZero(N_, NbPrwSteps);
+  for (unsigned i = 0; i < N_; i++)
+    if (PhaseKey_[i] > 0)
+      Phase.V(i, PhaseKey_[i] - 1) = 1.0;
+  Phase.VT = Phase.V.transpose();
+  Phase.Vshift.setZero(N_, NbPrwSteps);
+  Phase.Vshift.bottomRows(N_ - 1) = Phase.V.topRows(N_ - 1);
+
+  // CoP centering terms
+  const double weight = IntermedData_->Objective(COP_CENTERING).weight;
+  const linear_dynamics_t &CoPDynamics = Robot_->DynamicsCoPJerk();
+  compute_term(Phase.UTV, -weight, CoPDynamics.UT, Phase.V);
+  compute_term(Phase.VTV, weight, Phase.VT, Phase.V);
+  compute_term(Phase.VTS, -weight, Phase.VT, CoPDynamics.S);
+}
+
 void GeneratorVelRef::compute_global_reference(const solution_t &Solution) {
 
   reference_t &Ref = IntermedData_->Reference();
@@ -234,9 +281,10 @@ void GeneratorVelRef::initialize_matrices(linear_inequality_t &Inequalities) {
 
 void GeneratorVelRef::build_inequalities_cop(
     linear_inequality_t &Inequalities,
-    const std::deque<support_state_t> &SupportStates_deq) const {
+    const RingBuffer<support_state_t> &SupportStates_deq) const {
 
-  deque<support_state_t>::const_iterator prwSS_it = SupportStates_deq.begin();
+  RingBuffer<support_state_t>::const_iterator prwSS_it =
+      SupportStates_deq.begin();
 
   const unsigned nbEdges = 4;
   const unsigned nbIneq = 4;
@@ -277,7 +325,7 @@ void GeneratorVelRef::build_inequalities_cop(
 
 void GeneratorVelRef::build_inequalities_feet(
     linear_inequality_t &Inequalities,
-    const std::deque<support_state_t> &SupportStates_deq) const {
+    const RingBuffer<support_state_t> &SupportStates_deq) const {
 
   // Arrays for the generated set of inequalities
   const unsigned nbEdges = 5;
@@ -287,7 +335,8 @@ void GeneratorVelRef::build_inequalities_feet(
   unsigned nbSteps = SupportStates_deq.back().StepNumber;
   Inequalities.resize(nbEdges * nbSteps, nbSteps, false);
 
-  deque<support_state_t>::const_iterator prwSS_it = SupportStates_deq.begin();
+  RingBuffer<support_state_t>::const_iterator prwSS_it =
+      SupportStates_deq.begin();
   prwSS_it++; // Point at the first previewed instant
   Inequalities.D.X_mat.reserve(N_ * nbEdges);
   Inequalities.D.Y_mat.reserve(N_ * nbEdges);
@@ -330,9 +379,10 @@ void GeneratorVelRef::build_inequalities_feet(
 
 void GeneratorVelRef::build_inequalities_com(
     linear_inequality_t &Inequalities,
-    const std::deque<support_state_t> &SupportStates_deq) const {
+    const RingBuffer<support_state_t> &SupportStates_deq) const {
 
-  deque<support_state_t>::const_iterator prwSS_it = SupportStates_deq.begin();
+  RingBuffer<support_state_t>::const_iterator prwSS_it =
+      SupportStates_deq.begin();
 
   const unsigned nbEdges = 0;
   const unsigned nbIneq = 10;
@@ -365,34 +415,40 @@ void GeneratorVelRef::build_constraints_cop(const linear_inequality_t &IneqCoP,
                                             QPProblem &Pb) {
 
   unsigned int NbConstraints = Pb.NbConstraints();
+  unsigned int NbIneq = (unsigned int)IneqCoP.D.X_mat.rows();
 
+  // The terms are written directly inside the problem.
   // -D*U
-  compute_term(MM_, -1.0, IneqCoP.D.X_mat, Robot_->DynamicsCoPJerk().U);
-  Pb.add_term_to(MATRIX_DU, MM_, NbConstraints, 0);
-  compute_term(MM_, -1.0, IneqCoP.D.Y_mat, Robot_->DynamicsCoPJerk().U);
-  Pb.add_term_to(MATRIX_DU, MM_, NbConstraints, N_);
+  const Eigen::MatrixXd &U = Robot_->DynamicsCoPJerk().U;
+  Pb.matrix_view(MATRIX_DU, NbConstraints, 0, NbIneq, (unsigned int)U.cols())
+      .noalias() -= IneqCoP.D.X_mat * U;
+  Pb.matrix_view(MATRIX_DU, NbConstraints, N_, NbIneq, (unsigned int)U.cols())
+      .noalias() -= IneqCoP.D.Y_mat * U;
 
   // +D*V
-  compute_term(MM_, 1.0, IneqCoP.D.X_mat, IntermedData_->State().V);
+  const Eigen::MatrixXd &V = IntermedData_->State().V;
   // +  Robot_->LeftFoot().Dynamics(COP).U +
   // Robot_->RightFoot().Dynamics(COP).U        );
-  Pb.add_term_to(MATRIX_DU, MM_, NbConstraints, 2 * N_);
+  Pb.matrix_view(MATRIX_DU, NbConstraints, 2 * N_, NbIneq,
+                 (unsigned int)V.cols())
+      .noalias() += IneqCoP.D.X_mat * V;
 
   //  cout << "IntermedData_->State().V  = "
   // << IntermedData_->State().V  << endl ;
-  compute_term(MM_, 1.0, IneqCoP.D.Y_mat, IntermedData_->State().V);
   // +  Robot_->LeftFoot().Dynamics(COP).U +
   // Robot_->RightFoot().Dynamics(COP).U        );
-  Pb.add_term_to(MATRIX_DU, MM_, NbConstraints, 2 * N_ + NbStepsPreviewed);
+  Pb.matrix_view(MATRIX_DU, NbConstraints, 2 * N_ + NbStepsPreviewed, NbIneq,
+                 (unsigned int)V.cols())
+      .noalias() += IneqCoP.D.Y_mat * V;
 
   // constant part
+  QPProblem::vector_view_t DS = Pb.vector_view(VECTOR_DS, NbConstraints, NbIneq);
   // +dc
-  Pb.add_term_to(VECTOR_DS, IneqCoP.Dc_vec, NbConstraints);
+  DS += IneqCoP.Dc_vec;
 
   // -D*S_z*x
-  compute_term(MV_, -1.0, IneqCoP.D.X_mat, Robot_->DynamicsCoPJerk().S,
-               IntermedData_->State().CoM.x);
-  Pb.add_term_to(VECTOR_DS, MV_, NbConstraints);
+  MV2_.noalias() = Robot_->DynamicsCoPJerk().S * IntermedData_->State().CoM.x;
+  DS.noalias() -= IneqCoP.D.X_mat * MV2_;
   /*
    * Usefull for multibody dynamics
    *
@@ -405,9 +461,8 @@ void GeneratorVelRef::build_constraints_cop(const linear_inequality_t &IneqCoP,
    Pb.add_term_to( VECTOR_DS, MV_,
    NbConstraints                                                  );
   */
-  compute_term(MV_, -1.0, IneqCoP.D.Y_mat, Robot_->DynamicsCoPJerk().S,
-               IntermedData_->State().CoM.y);
-  Pb.add_term_to(VECTOR_DS, MV_, NbConstraints);
+  MV2_.noalias() = Robot_->DynamicsCoPJerk().S * IntermedData_->State().CoM.y;
+  DS.noalias() -= IneqCoP.D.Y_mat * MV2_;
   /*
    * Usefull for multibody dynamics
    *
@@ -422,10 +477,8 @@ void GeneratorVelRef::build_constraints_cop(const linear_inequality_t &IneqCoP,
   */
 
   // +D*Vc*FP
-  compute_term(MV_, 1.0, IneqCoP.D.X_mat, IntermedData_->State().VcX);
-  Pb.add_term_to(VECTOR_DS, MV_, NbConstraints);
-  compute_term(MV_, 1.0, IneqCoP.D.Y_mat, IntermedData_->State().VcY);
-  Pb.add_term_to(VECTOR_DS, MV_, NbConstraints);
+  DS.noalias() += IneqCoP.D.X_mat * IntermedData_->State().VcX;
+  DS.noalias() += IneqCoP.D.Y_mat * IntermedData_->State().VcY;
 }
 
 void GeneratorVelRef::build_constraints_feet(
@@ -433,23 +486,24 @@ void GeneratorVelRef::build_constraints_feet(
     const IntermedQPMat::state_variant_t &State, int NbStepsPreviewed,
     QPProblem &Pb) {
   unsigned int NbConstraints = Pb.NbConstraints();
+  unsigned int NbIneq = (unsigned int)IneqFeet.D.X_mat.rows();
+  unsigned int NbCols = (unsigned int)State.V_f.cols();
 
   // -D*V_f
-  compute_term(MM_, -1.0, IneqFeet.D.X_mat, State.V_f);
-  Pb.add_term_to(MATRIX_DU, MM_, NbConstraints, 2 * N_);
+  Pb.matrix_view(MATRIX_DU, NbConstraints, 2 * N_, NbIneq, NbCols).noalias() -=
+      IneqFeet.D.X_mat * State.V_f;
 
-  compute_term(MM_, -1.0, IneqFeet.D.Y_mat, State.V_f);
-  Pb.add_term_to(MATRIX_DU, MM_, NbConstraints, 2 * N_ + NbStepsPreviewed);
+  Pb.matrix_view(MATRIX_DU, NbConstraints, 2 * N_ + NbStepsPreviewed, NbIneq,
+                 NbCols)
+      .noalias() -= IneqFeet.D.Y_mat * State.V_f;
 
+  QPProblem::vector_view_t DS = Pb.vector_view(VECTOR_DS, NbConstraints, NbIneq);
   // +dc
-  Pb.add_term_to(VECTOR_DS, IneqFeet.Dc_vec, NbConstraints);
+  DS += IneqFeet.Dc_vec;
 
   // D*Vc_f*FPc
-  compute_term(MV_, 1.0, IneqFeet.D.X_mat, State.Vc_fX);
-  Pb.add_term_to(VECTOR_DS, MV_, NbConstraints);
-
-  compute_term(MV_, 1.0, IneqFeet.D.Y_mat, State.Vc_fY);
-  Pb.add_term_to(VECTOR_DS, MV_, NbConstraints);
+  DS.noalias() += IneqFeet.D.X_mat * State.Vc_fX;
+  DS.noalias() += IneqFeet.D.Y_mat * State.Vc_fY;
 }
 
 void GeneratorVelRef::build_constraints_com(
@@ -461,33 +515,37 @@ void GeneratorVelRef::build_constraints_com(
   const com_t &CoM = IntermedData_->State().CoM;
 
   unsigned nbConstraints = Pb.NbConstraints();
+  unsigned int NbIneq = (unsigned int)IneqCoM.D.X_mat.rows();
 
   // D*(S*c+U*ddd-(Vc*pc+V*p))+Dc > 0:
   // ---------------------------------
   // +Dx*U
-  compute_term(MM_, 1.0, IneqCoM.D.X_mat, CoMDyn.U);
-  Pb.add_term_to(MATRIX_DU, MM_, nbConstraints, 0);
+  Pb.matrix_view(MATRIX_DU, nbConstraints, 0, NbIneq,
+                 (unsigned int)CoMDyn.U.cols())
+      .noalias() += IneqCoM.D.X_mat * CoMDyn.U;
   // +Dy*U
-  compute_term(MM_, 1.0, IneqCoM.D.Y_mat, CoMDyn.U);
-  Pb.add_term_to(MATRIX_DU, MM_, nbConstraints, N_);
+  Pb.matrix_view(MATRIX_DU, nbConstraints, N_, NbIneq,
+                 (unsigned int)CoMDyn.U.cols())
+      .noalias() += IneqCoM.D.Y_mat * CoMDyn.U;
 
   // -Dx*Vshift
-  compute_term(MM_, -1.0, IneqCoM.D.X_mat, State.Vshift);
-  Pb.add_term_to(MATRIX_DU, MM_, nbConstraints, 2 * N_); // X
+  Pb.matrix_view(MATRIX_DU, nbConstraints, 2 * N_, NbIneq,
+                 (unsigned int)State.Vshift.cols())
+      .noalias() -= IneqCoM.D.X_mat * State.Vshift; // X
   // -Dy*Vshift
-  compute_term(MM_, -1.0, IneqCoM.D.Y_mat, State.Vshift);
-  Pb.add_term_to(MATRIX_DU, MM_, nbConstraints, 2 * N_); // X
+  Pb.matrix_view(MATRIX_DU, nbConstraints, 2 * N_, NbIneq,
+                 (unsigned int)State.Vshift.cols())
+      .noalias() -= IneqCoM.D.Y_mat * State.Vshift; // X
 
+  QPProblem::vector_view_t DS = Pb.vector_view(VECTOR_DS, nbConstraints, NbIneq);
   // +Dx*(S*cx-Vc*pcx)
-  compute_term(MV_, 1.0, IneqCoM.D.X_mat, CoMDyn.S, CoM.x);
-  Pb.add_term_to(VECTOR_DS, MV_, nbConstraints);
-  compute_term(MV_, -CurrentSupport.X, IneqCoM.D.X_mat, State.VcshiftX);
-  Pb.add_term_to(VECTOR_DS, MV_, nbConstraints);
+  MV2_.noalias() = CoMDyn.S * CoM.x;
+  DS.noalias() += IneqCoM.D.X_mat * MV2_;
+  DS.noalias() -= CurrentSupport.X * (IneqCoM.D.X_mat * State.VcshiftX);
   // +Dy*(S*cy-Vc*pcy)
-  compute_term(MV_, 1.0, IneqCoM.D.Y_mat, CoMDyn.S, CoM.y);
-  Pb.add_term_to(VECTOR_DS, MV_, nbConstraints);
-  compute_term(MV_, -CurrentSupport.Y, IneqCoM.D.Y_mat, State.VcshiftY);
-  Pb.add_term_to(VECTOR_DS, MV_, nbConstraints);
+  MV2_.noalias() = CoMDyn.S * CoM.y;
+  DS.noalias() += IneqCoM.D.Y_mat * MV2_;
+  DS.noalias() -= CurrentSupport.Y * (IneqCoM.D.Y_mat * State.VcshiftY);
   // +Dz*cz
   MM_ = IneqCoM.D.Z_mat * Robot_->CoMHeight();
   Pb.add_term_to(VECTOR_DS, MM_, nbConstraints, 0);
@@ -496,7 +554,7 @@ void GeneratorVelRef::build_constraints_com(
 }
 
 void GeneratorVelRef::build_eq_constraints_feet(
-    const std::deque<support_state_t> &SupportStates_deq,
+    const RingBuffer<support_state_t> &SupportStates_deq,
     unsigned int NbStepsPreviewed, QPProblem &Pb) {
 
   if (SupportStates_deq.front().StateChanged)
@@ -508,7 +566,7 @@ void GeneratorVelRef::build_eq_constraints_feet(
   Eigen::VectorXd EqualityVector;
   EqualityMatrix.resize(2, 2 * NbStepsPreviewed);
   EqualityMatrix.setZero();
-  EqualityVector.resize(2, false);
+  EqualityVector.resize(2);
   EqualityVector.setZero();
   Pb.NbEqConstraints(2 * NbStepsPreviewed);
   for (unsigned int i = 0; i < NbStepsPreviewed; i++) {
@@ -526,7 +584,7 @@ void GeneratorVelRef::build_eq_constraints_feet(
 
 void GeneratorVelRef::build_eq_constraints_limitPosFeet(
     const solution_t &Solution, QPProblem &Pb) {
-  std::deque<support_state_t>::const_iterator SPTraj_it =
+  RingBuffer<support_state_t>::const_iterator SPTraj_it =
       Solution.SupportStates_deq.begin();
   int ItBeforeLanding = 0;
   while (SPTraj_it != Solution.SupportStates_deq.end()) {
@@ -549,7 +607,7 @@ void GeneratorVelRef::build_eq_constraints_limitPosFeet(
 
     EqualityMatrix.resize(2, 2 * N_ + 2 * NbStepsPreviewed);
     EqualityMatrix.setZero();
-    EqualityVector.resize(2, false);
+    EqualityVector.resize(2);
     EqualityVector.setZero();
 
     EqualityMatrix(0, 2 * N_) = 1.0;
@@ -576,6 +634,9 @@ void GeneratorVelRef::build_constraints(QPProblem &Pb, solution_t &Solution) {
   // build_eq_constraints_feet( Solution.SupportStates_deq, nbStepsPreviewed,
   // Pb );
   build_eq_constraints_limitPosFeet(Solution, Pb);
+  LastConstraintRows_ = ConstraintRows_;
+  ConstraintRows_.NbEq = Pb.NbConstraints();
+  ConstraintRows_.NbSteps = nbStepsPreviewed;
 
   // Polygonal constraints:
   // ----------------------
@@ -583,12 +644,14 @@ void GeneratorVelRef::build_constraints(QPProblem &Pb, solution_t &Solution) {
   linear_inequality_t &IneqCoP = IntermedData_->Inequalities(INEQ_COP);
   build_inequalities_cop(IneqCoP, Solution.SupportStates_deq);
   build_constraints_cop(IneqCoP, nbStepsPreviewed, Pb);
+  ConstraintRows_.NbCoP = (unsigned)IneqCoP.D.X_mat.rows();
 
   // Foot constraints
   linear_inequality_t &IneqFeet = IntermedData_->Inequalities(INEQ_FEET);
   build_inequalities_feet(IneqFeet, Solution.SupportStates_deq);
   build_constraints_feet(IneqFeet, IntermedData_->State(), nbStepsPreviewed,
                          Pb);
+  ConstraintRows_.NbFeet = (unsigned)IneqFeet.D.X_mat.rows();
 
   // Polyhedric constraints:
   // -----------------------
@@ -604,6 +667,48 @@ void GeneratorVelRef::build_constraints(QPProblem &Pb, solution_t &Solution) {
   }
 }
 
+void GeneratorVelRef::shift_constraint_multipliers(
+    const Eigen::VectorXd &LastConstrLagr, solution_t &Solution) const {
+
+  // Rows of the constraints of a sample (CoP) and of a step (feet),
+  // as built by build_constraints.
+  unsigned nbCoPEdges = ConstraintRows_.NbCoP / N_;
+  unsigned nbFeetEdges = 0;
+  if (ConstraintRows_.NbSteps > 0)
+    nbFeetEdges = ConstraintRows_.NbFeet / ConstraintRows_.NbSteps;
+  else if (LastConstraintRows_.NbSteps > 0)
+    nbFeetEdges = LastConstraintRows_.NbFeet / LastConstraintRows_.NbSteps;
+
+  // The first row of the problem is empty, the equalities come next.
+  unsigned FirstCoP = 1 + ConstraintRows_.NbEq;
+  unsigned FirstFeet = FirstCoP + ConstraintRows_.NbCoP;
+  unsigned LastFirstCoP = 1 + LastConstraintRows_.NbEq;
+  unsigned LastFirstFeet = LastFirstCoP + LastConstraintRows_.NbCoP;
+
+  Solution.ConstrLagr_vec.setZero(FirstFeet + ConstraintRows_.NbFeet);
+  if (LastConstrLagr.size() != LastFirstFeet + LastConstraintRows_.NbFeet)
+    return;
+  // The multipliers are only moved between rows of the same size.
+  if ((LastConstraintRows_.NbCoP != ConstraintRows_.NbCoP) ||
+      (LastConstraintRows_.NbFeet != nbFeetEdges * LastConstraintRows_.NbSteps))
+    return;
+
+  // The previewed samples move by one, the first one leaves the window.
+  Solution.ConstrLagr_vec.segment(FirstCoP, nbCoPEdges * (N_ - 1)) =
+      LastConstrLagr.segment(LastFirstCoP + nbCoPEdges, nbCoPEdges * (N_ - 1));
+
+  // The previewed steps are numbered again once the first one has landed.
+  unsigned Landed = Solution.SupportStates_deq.front().StateChanged ? 1 : 0;
+  for (unsigned Step = Landed; Step < LastConstraintRows_.NbSteps; Step++) {
+    if (Step - Landed >= ConstraintRows_.NbSteps)
+      break;
+    Solution.ConstrLagr_vec.segment(
+        FirstFeet + nbFeetEdges * (Step - Landed), nbFeetEdges) =
+        LastConstrLagr.segment(LastFirstFeet + nbFeetEdges * Step,
+                               nbFeetEdges);
+  }
+}
+
 void GeneratorVelRef::build_invariant_part(QPProblem &Pb) {
 
   const RigidBody &CoM = Robot_->CoM();
@@ -632,10 +737,14 @@ void GeneratorVelRef::build_invariant_part(QPProblem &Pb) {
                Robot_->DynamicsCoPJerk().U);
   Pb.add_term_to(MATRIX_Q, MM_, 0, 0);
   Pb.add_term_to(MATRIX_Q, MM_, N_, N_);
+
+  // The cached phases depend on the CoP dynamics.
+  PhaseCache_.clear();
+  Phase_ = 0;
 }
 
 void GeneratorVelRef::update_problem(
-    QPProblem &Pb, const std::deque<support_state_t> &SupportStates_deq) {
+    QPProblem &Pb, const RingBuffer<support_state_t> &SupportStates_deq) {
 
   Pb.clear(VECTOR_D);
 
@@ -660,33 +769,40 @@ void GeneratorVelRef::update_problem(
   Pb.add_term_to(VECTOR_D, MV_, N_);
 
   // COP - centering terms
+  // The products by the selection matrices come from the phase cache.
+  if (Robot_->multiBody()) {
+    // RigidBodySystem::update has recomputed the CoP dynamics since the
+    // selection matrices were generated.
+    compute_support_phase(MultiBodyPhase_);
+  }
   const IntermedQPMat::objective_variant_t &COPCent =
       IntermedData_->Objective(COP_CENTERING);
-  const linear_dynamics_t &CoPDynamics = Robot_->DynamicsCoPJerk();
   //  const linear_dynamics_t & LFCoP = Robot_->LeftFoot().Dynamics(COP);
   //  const linear_dynamics_t & RFCoP = Robot_->RightFoot().Dynamics(COP);
   // Hessian
   // -a*U'*V
-  compute_term(MM_, -COPCent.weight, CoPDynamics.UT, State.V);
-  Pb.add_term_to(MATRIX_Q, MM_, 0, 2 * N_);
-  Pb.add_term_to(MATRIX_Q, MM_, N_, 2 * N_ + nbStepsPreviewed);
+  Pb.matrix_view(MATRIX_Q, 0, 2 * N_, N_, nbStepsPreviewed) += Phase_->UTV;
+  Pb.matrix_view(MATRIX_Q, N_, 2 * N_ + nbStepsPreviewed, N_,
+                 nbStepsPreviewed) += Phase_->UTV;
 
   // -a*V*U
-  compute_term(MM_, -COPCent.weight, State.VT, CoPDynamics.U);
-  Pb.add_term_to(MATRIX_Q, MM_, 2 * N_, 0);
-  Pb.add_term_to(MATRIX_Q, MM_, 2 * N_ + nbStepsPreviewed, N_);
+  Pb.matrix_view(MATRIX_Q, 2 * N_, 0, nbStepsPreviewed, N_) +=
+      Phase_->UTV.transpose();
+  Pb.matrix_view(MATRIX_Q, 2 * N_ + nbStepsPreviewed, N_, nbStepsPreviewed,
+                 N_) += Phase_->UTV.transpose();
   //+a*V'*V
-  compute_term(MM_, COPCent.weight, State.VT, State.V);
-  Pb.add_term_to(MATRIX_Q, MM_, 2 * N_, 2 * N_);
-  Pb.add_term_to(MATRIX_Q, MM_, 2 * N_ + nbStepsPreviewed,
-                 2 * N_ + nbStepsPreviewed);
+  Pb.matrix_view(MATRIX_Q, 2 * N_, 2 * N_, nbStepsPreviewed,
+                 nbStepsPreviewed) += Phase_->VTV;
+  Pb.matrix_view(MATRIX_Q, 2 * N_ + nbStepsPreviewed,
+                 2 * N_ + nbStepsPreviewed, nbStepsPreviewed,
+                 nbStepsPreviewed) += Phase_->VTV;
 
   // Linear part
   // -a*V'*S*x
-  compute_term(MV_, -COPCent.weight, State.VT, CoPDynamics.S, State.CoM.x);
-  Pb.add_term_to(VECTOR_D, MV_, 2 * N_);
-  compute_term(MV_, -COPCent.weight, State.VT, CoPDynamics.S, State.CoM.y);
-  Pb.add_term_to(VECTOR_D, MV_, 2 * N_ + nbStepsPreviewed);
+  Pb.vector_view(VECTOR_D, 2 * N_, nbStepsPreviewed).noalias() +=
+      Phase_->VTS * State.CoM.x;
+  Pb.vector_view(VECTOR_D, 2 * N_ + nbStepsPreviewed, nbStepsPreviewed)
+      .noalias() += Phase_->VTS * State.CoM.y;
   // +a*V'*Vc*x
   compute_term(MV_, COPCent.weight, State.VT, State.VcX);
   Pb.add_term_to(VECTOR_D, MV_, 2 * N_);
@@ -714,7 +830,7 @@ void GeneratorVelRef::compute_warm_start(solution_t &Solution) {
 
   // Compute initial ZMP and foot positions:
   // ---------------------------------------
-  deque<support_state_t>::iterator prwSS_it =
+  RingBuffer<support_state_t>::iterator prwSS_it =
       Solution.SupportStates_deq.begin();
   prwSS_it++; // Point at the first previewed support state
   unsigned int j = 0;
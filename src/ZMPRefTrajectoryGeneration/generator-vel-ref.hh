@@ -39,8 +39,11 @@
 #include <ZMPRefTrajectoryGeneration/qp-problem.hh>
 #include <jrl/walkgen/pinocchiorobot.hh>
 
+#include <RingBuffer.hh>
 #include <cmath>
+#include <map>
 #include <privatepgtypes.hh>
+#include <vector>
 
 namespace PatternGeneratorJRL {
 
@@ -67,9 +70,9 @@ public:
   /// \param[out] SupportStates_deq
   void preview_support_states(
       double Time, const SupportFSM *FSM,
-      const deque<FootAbsolutePosition> &FinalLeftFootTraj_deq,
-      const deque<FootAbsolutePosition> &FinalRightFootTraj_deq,
-      deque<support_state_t> &SupportStates_deq);
+      const RingBuffer<FootAbsolutePosition> &FinalLeftFootTraj_deq,
+      const RingBuffer<FootAbsolutePosition> &FinalRightFootTraj_deq,
+      RingBuffer<support_state_t> &SupportStates_deq);
 
   /// \brief Set the global reference from the local one and the
   /// orientation of the trunk frame
@@ -98,7 +101,17 @@ public:
   /// \param[in] Pb
   /// \param[in] SupportStates_deq
   void update_problem(QPProblem &Pb,
-                      const std::deque<support_state_t> &SupportStates_deq);
+                      const RingBuffer<support_state_t> &SupportStates_deq);
+
+  /// \brief Move the constraint multipliers of the last cycle onto the
+  /// constraints built by build_constraints, one sample later
+  ///
+  /// The multipliers of constraints which no longer exist are dropped.
+  ///
+  /// \param[in] LastConstrLagr Constraint multipliers of the last cycle
+  /// \param[out] Solution Its multipliers hot start the solver
+  void shift_constraint_multipliers(const Eigen::VectorXd &LastConstrLagr,
+                                    solution_t &Solution) const;
 
   /// \brief Compute the initial solution vector for warm start
   ///
@@ -140,7 +153,7 @@ public:
   /// \param[in] SupportStates_deq
   void build_inequalities_feet(
       linear_inequality_t &Inequalities,
-      const std::deque<support_state_t> &SupportStates_deq) const;
+      const RingBuffer<support_state_t> &SupportStates_deq) const;
 
   //
   // Protected methods
@@ -150,7 +163,7 @@ protected:
   ///
   /// \param[in] SupportStates_deq
   void generate_selection_matrices(
-      const std::deque<support_state_t> &SupportStates_deq);
+      const RingBuffer<support_state_t> &SupportStates_deq);
 
   /// \brief Generate a queue of inequalities with respect to the centers of
   /// the feet
@@ -159,7 +172,7 @@ protected:
   /// \param[in] SupportStates_deq
   void build_inequalities_cop(
       linear_inequality_t &Inequalities,
-      const std::deque<support_state_t> &SupportStates_deq) const;
+      const RingBuffer<support_state_t> &SupportStates_deq) const;
 
   /// \brief Generate a queue of inequality constraints on
   /// the feet positions with respect to previous foot positions
@@ -168,7 +181,7 @@ protected:
   /// \param[in] SupportStates_deq
   void build_inequalities_com(
       linear_inequality_t &Inequalities,
-      const std::deque<support_state_t> &SupportStates_deq) const;
+      const RingBuffer<support_state_t> &SupportStates_deq) const;
 
   /// \brief Compute CoP constraints corresponding to the set of inequalities
   ///
@@ -203,7 +216,7 @@ protected:
   /// \param[in] NbStepsPreviewed
   /// \param[out] Pb
   void build_eq_constraints_feet(
-      const std::deque<support_state_t> &SupportStates_deq,
+      const RingBuffer<support_state_t> &SupportStates_deq,
       unsigned int NbStepsPreviewed, QPProblem &Pb);
 
   /// \brief Compute feet equality constraints to restrain the previewed foot
@@ -246,10 +259,67 @@ protected:
   RelativeFeetInequalities *RFI_;
   double LastFootSolX_;
   double LastFootSolY_;
+  //
+  // Private types
+  //
+private:
+  /// \brief Matrices which only depend on the sequence of previewed steps
+  struct support_phase_t {
+    /// \brief Selection matrices
+    Eigen::MatrixXd V, VT, Vshift;
+    /// \brief CoP centering terms of the Hessian -a*U'*V and a*V'*V
+    Eigen::MatrixXd UTV, VTV;
+    /// \brief CoP centering term of the gradient -a*V'*S
+    Eigen::MatrixXd VTS;
+  };
+
+  /// \brief Number of rows of each kind of constraints
+  struct constraint_rows_t {
+    /// \brief Equality constraints on the next foot
+    unsigned NbEq;
+    /// \brief Previewed steps, each one with its foot constraints
+    unsigned NbSteps;
+    /// \brief CoP constraints, the same number for each previewed sample
+    unsigned NbCoP;
+    /// \brief Foot constraints, the same number for each previewed step
+    unsigned NbFeet;
+  };
+
+  /// \brief The key is the step number of each previewed sample.
+  /// It encodes the phase offset inside the current step and the number
+  /// of previewed steps.
+  typedef std::map<std::vector<unsigned>, support_phase_t> phase_cache_t;
+
+  //
+  // Private methods
+  //
+private:
+  /// \brief Compute the matrices of the support phase PhaseKey_
+  ///
+  /// \param[out] Phase
+  void compute_support_phase(support_phase_t &Phase);
+
   //
   // Private members
   //
 private:
+  /// \name Support phases met so far
+  /// \{
+  phase_cache_t PhaseCache_;
+  /// \brief Key of the current sequence
+  std::vector<unsigned> PhaseKey_;
+  /// \brief Matrices of the current sequence
+  const support_phase_t *Phase_;
+  /// \brief Matrices of the current sequence when the feet are part
+  /// of the CoP dynamics, never cached
+  support_phase_t MultiBodyPhase_;
+  /// \}
+
+  /// \name Constraints of the current and of the last cycle
+  /// \{
+  constraint_rows_t ConstraintRows_, LastConstraintRows_;
+  /// \}
+
   /// \name Temporary vectors
   /// \{
   Eigen::MatrixXd MM_;
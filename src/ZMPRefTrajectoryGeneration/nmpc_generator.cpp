@@ -25,7 +25,9 @@
 /*! \file nmpc_generator.cpp
   \brief implement an SQP method to generate online stable walking motion */
 
+#ifndef EIGEN_RUNTIME_NO_MALLOC
 #define EIGEN_RUNTIME_NO_MALLOC
+#endif
 #include <Eigen/Dense>
 
 #include <Debug.hh>
@@ -125,13 +127,16 @@ NMPCgenerator::NMPCgenerator(SimplePluginManager *aSPM, PinocchioRobot *aPR) {
   RFI_ = new RelativeFeetInequalities(SPM_, PR_);
 
   QP_ = NULL;
-  QuadProg_H_.resize(1, 1);
   QuadProg_J_eq_.resize(1, 1);
   QuadProg_J_ineq_.resize(1, 1);
-  QuadProg_g_.resize(1);
   QuadProg_bJ_eq_.resize(1);
   QuadProg_lbJ_ineq_.resize(1);
   deltaU_.resize(1);
+  QuadProg_nceq_ = 0;
+  QuadProg_ncineq_ = 0;
+  reuseHessianFactor_ = false;
+  isHessianFactorValid_ = false;
+  hessianFactorTolerance_ = 0.0;
 
   isQPinitialized_ = false;
   useItBeforeLanding_ = false;
@@ -271,6 +276,7 @@ void NMPCgenerator::initNMPCgenerator(bool useLineSearch,
   SecurityMarginX_ = 0.095;
   SecurityMarginY_ = 0.055;
   maxSolverIteration_ = 1;
+  iterationSolverFile_ = 0;
   oneMoreStep_ = false;
 
   setLocalVelocityReference(local_vel_ref);
@@ -314,16 +320,15 @@ void NMPCgenerator::initNMPCgenerator(bool useLineSearch,
   // we assume 0 equality constraint at the beginning
   // call QP_->problem((int)nv_,(int)nceq_,(int)ncineq_) before using it
   QP_ = new Eigen::QuadProgDense((int)nv_, (int)nceq_, (int)ncineq_);
-  QuadProg_H_.resize(nv_, nv_);
-  QuadProg_g_.resize(nv_);
+  QuadProg_nceq_ = nceq_;
+  QuadProg_ncineq_ = ncineq_;
+  isHessianFactorValid_ = false;
   QuadProg_J_eq_.resize(nceq_, nv_);
   QuadProg_bJ_eq_.resize(nceq_);
   QuadProg_J_ineq_.resize(ncineq_, nv_);
   QuadProg_lbJ_ineq_.resize(ncineq_);
   deltaU_.resize(nv_);
 
-  QuadProg_H_.fill(0.0);
-  QuadProg_g_.fill(0.0);
   QuadProg_J_eq_.fill(0.0);
   QuadProg_bJ_eq_.fill(0.0);
   QuadProg_J_ineq_.fill(0.0);
@@ -721,7 +726,8 @@ void NMPCgenerator::updateInitialConditionDependentMatrices() {
 void NMPCgenerator::solve() {
   if (currentSupport_.Phase == DS && currentSupport_.NbStepsLeft == 0)
     return;
-  Eigen::internal::set_is_malloc_allowed(false);
+  // Restored on exit, the caller may forbid the allocations as well.
+  bool lMallocAllowed = Eigen::internal::set_is_malloc_allowed(false);
   /* Process and solve problem, s.t. pattern generator data is consistent */
   unsigned iter = 0;
   oneMoreStep_ = true;
@@ -743,14 +749,13 @@ void NMPCgenerator::solve() {
 
     ++iter;
   }
+  Eigen::internal::set_is_malloc_allowed(lMallocAllowed);
 #ifdef DEBUG
-  static unsigned iteration_solver_file = 0;
-  if (iteration_solver_file == 0) {
+  if (iterationSolverFile_ == 0) {
     ofstream os;
     os.open("iteration_solver.dat", ios::out);
-    ++iteration_solver_file;
+    ++iterationSolverFile_;
   }
-  Eigen::internal::set_is_malloc_allowed(true);
   ofstream os("iteration_solver.dat", ios::app);
   os << time_ << " " << iter - 1 << " " << normDeltaU << endl;
 #endif // DEBUG
@@ -762,42 +767,53 @@ void NMPCgenerator::solve() {
 void NMPCgenerator::preprocess_solution() {
   updateConstraint();
   updateCostFunction();
-  QP_->problem((int)nv_, (int)nceq_, (int)ncineq_);
-  QuadProg_H_.resize(nv_, nv_);
-  QuadProg_g_.resize(nv_);
-  QuadProg_J_eq_.resize(nceq_, nv_);
-  QuadProg_bJ_eq_.resize(nceq_);
-  QuadProg_J_ineq_.resize(ncineq_, nv_);
-  QuadProg_lbJ_ineq_.resize(ncineq_);
+  // The solver is only resized when the number of constraints changes,
+  // H and g are given to it without copy.
+  if (nceq_ != QuadProg_nceq_ || ncineq_ != QuadProg_ncineq_) {
+    QP_->problem((int)nv_, (int)nceq_, (int)ncineq_);
+    QuadProg_nceq_ = nceq_;
+    QuadProg_ncineq_ = ncineq_;
+  }
+  QuadProg_J_eq_ = qp_J_.topRows(nceq_);
+  QuadProg_bJ_eq_ = qp_ubJ_.head(nceq_);
+  QuadProg_J_ineq_ = qp_J_.middleRows(nceq_, ncineq_);
+  QuadProg_lbJ_ineq_ = qp_ubJ_.segment(nceq_, ncineq_);
   deltaU_.resize(nv_);
   deltaU_thresh_.resize(nv_);
 
-  for (unsigned i = 0; i < nv_; ++i) {
-    for (unsigned j = 0; j < nv_; ++j) {
-      QuadProg_H_(i, j) = qp_H_(i, j);
-    }
-    QuadProg_g_(i) = qp_g_(i);
-  }
-  for (unsigned i = 0; i < nceq_; ++i) {
-    for (unsigned j = 0; j < nv_; ++j) {
-      QuadProg_J_eq_(i, j) = qp_J_(i, j);
-    }
-    QuadProg_bJ_eq_(i) = qp_ubJ_(i);
-  }
+  if (reuseHessianFactor_)
+    updateHessianFactor();
+  return;
+}
 
-  for (unsigned i = 0; i < ncineq_; ++i) {
-    for (unsigned j = 0; j < nv_; ++j) {
-      QuadProg_J_ineq_(i, j) = qp_J_(i + nceq_, j);
-    }
-    QuadProg_lbJ_ineq_(i) = qp_ubJ_(i + nceq_);
+void NMPCgenerator::updateHessianFactor() {
+  // Within a control cycle the Hessian only depends on the support
+  // states, the factorization of the previous iteration is kept.
+  if (isHessianFactorValid_ &&
+      (qp_H_ - QuadProg_factoredH_).cwiseAbs().maxCoeff() <=
+          hessianFactorTolerance_)
+    return;
+
+  QuadProg_llt_.compute(qp_H_);
+  if (QuadProg_llt_.info() != Eigen::Success) {
+    // QuadProg factorizes H itself and reports the failure.
+    isHessianFactorValid_ = false;
+    return;
   }
-  return;
+  QuadProg_invR_.setIdentity(nv_, nv_);
+  QuadProg_llt_.matrixU().solveInPlace(QuadProg_invR_);
+  QuadProg_factoredH_ = qp_H_;
+  isHessianFactorValid_ = true;
 }
 
 void NMPCgenerator::solve_qp() {
   // primal SQP solution
-  QP_->solve(QuadProg_H_, QuadProg_g_, QuadProg_J_eq_, QuadProg_bJ_eq_,
-             QuadProg_J_ineq_, QuadProg_lbJ_ineq_, false);
+  if (reuseHessianFactor_ && isHessianFactorValid_)
+    QP_->solve(QuadProg_invR_, qp_g_, QuadProg_J_eq_, QuadProg_bJ_eq_,
+               QuadProg_J_ineq_, QuadProg_lbJ_ineq_, true);
+  else
+    QP_->solve(qp_H_, qp_g_, QuadProg_J_eq_, QuadProg_bJ_eq_,
+               QuadProg_J_ineq_, QuadProg_lbJ_ineq_, false);
   //  if(QP_->fail()==0)
   //    cerr << "qp solveur succeded" << endl ;
   if (QP_->fail() == 1) {
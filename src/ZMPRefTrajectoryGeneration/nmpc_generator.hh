@@ -28,6 +28,7 @@
 #ifndef NMPC_GENERATOR_H
 #define NMPC_GENERATOR_H
 
+#include <Eigen/Cholesky>
 #include <Mathematics/relative-feet-inequalities.hh>
 #include <cmath>
 #include <eigen-quadprog/QuadProg.h>
@@ -58,6 +59,7 @@ private:
   // Solve the Problem :
   //////////////////////
   void preprocess_solution();
+  void updateHessianFactor();
   void solve_qp();
   void postprocess_solution();
 
@@ -186,6 +188,14 @@ public:
   inline double T_step() { return T_step_; }
   inline void T_step(double T_step) { T_step_ = T_step; }
 
+  // Keep the factorization of the Hessian between two QP solves
+  // while it changes by less than tolerance (max norm).
+  inline void reuseHessianFactor(bool reuse, double tolerance) {
+    reuseHessianFactor_ = reuse;
+    hessianFactorTolerance_ = tolerance;
+    isHessianFactorValid_ = false;
+  }
+
   std::deque<RelativeFootPosition> &relativeSupportDeque() {
     return desiredNextSupportFootRelativePosition;
   }
@@ -325,6 +335,7 @@ private:
   unsigned maxLineSearchIteration_;
   bool oneMoreStep_;
   unsigned maxSolverIteration_;
+  unsigned iterationSolverFile_; // debug trace counter
 
   // Gauss-Newton Hessian
   unsigned nceq_;
@@ -435,8 +446,16 @@ private:
   bool isQPinitialized_;
   bool isQPlandinginitialized_;
   Eigen::QuadProgDense *QP_;
-  Eigen::MatrixXd QuadProg_H_, QuadProg_J_eq_, QuadProg_J_ineq_;
-  Eigen::VectorXd QuadProg_g_, QuadProg_bJ_eq_, QuadProg_lbJ_ineq_, deltaU_;
+  Eigen::MatrixXd QuadProg_J_eq_, QuadProg_J_ineq_;
+  Eigen::VectorXd QuadProg_bJ_eq_, QuadProg_lbJ_ineq_, deltaU_;
+  // number of constraints QP_ is sized for
+  unsigned QuadProg_nceq_, QuadProg_ncineq_;
+  // factorization of the Hessian given to QP_: R^-1 with H = R^T R,
+  // and the Hessian it was computed from
+  bool reuseHessianFactor_, isHessianFactorValid_;
+  double hessianFactorTolerance_;
+  Eigen::LLT<Eigen::MatrixXd> QuadProg_llt_;
+  Eigen::MatrixXd QuadProg_invR_, QuadProg_factoredH_;
   Eigen::VectorXd deltaU_thresh_;
 
   /// Exit on error.
@@ -30,6 +30,7 @@
 #include <Windows.h>
 #endif /* WIN32 */
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <iostream>
@@ -82,13 +83,21 @@ QPProblem::QPProblem()
 
 QPProblem::~QPProblem() { release_memory(); }
 
-void QPProblem::release_memory() {}
+void QPProblem::release_memory() {
+  if (istate_ != 0x0) {
+    delete[] istate_;
+    delete[] kx_;
+    delete[] b_;
+    delete[] clamda_;
+    istate_ = 0x0;
+  }
+}
 
 void QPProblem::resize_all() {
   bool ok = false;
 
   if ((NbConstraints_ > 0) && (NbVariables_ > 0)) {
-    DU_.resize(2 * NbConstraints_, 2 * NbVariables_, true);
+    DU_.resize(2 * (NbConstraints_ + 1), 2 * NbVariables_, true);
     ok = true;
   }
 
@@ -194,9 +203,8 @@ int QPProblem::reset_variant() {
     }
   }
 
-  Q_dense_.fill(0.0);
-  DU_.fill(0.0);
-  DU_dense_.fill(0.0);
+  // Only the rows of the last problem have been written.
+  DU_.fill(NbConstraints_ + 1, NbVariables_, 0.0);
   D_.fill(0.0);
   DS_.fill(0.0);
   NbConstraints_ = 0;
@@ -211,32 +219,67 @@ void QPProblem::solve(solver_e Solver, solution_t &Result,
 
   m_ = NbConstraints_ + 1;
   me_ = NbEqConstraints_;
-  mmax_ = m_ + 1;
   n_ = NbVariables_;
-  nmax_ = n_;
   mnn_ = m_ + 2 * n_;
 
+  // The solver works directly on the storage:
+  // the leading dimensions are the allocated ones.
+  if ((DU_.NbRows_ < (unsigned int)m_ + 1) ||
+      (DU_.NbCols_ < (unsigned int)n_))
+    DU_.resize(2 * m_, 2 * n_, true);
+  if (DS_.NbRows_ < (unsigned int)m_ + 1)
+    DS_.resize(2 * m_, 1, true);
+  mmax_ = DU_.NbRows_;
+  nmax_ = Q_.NbRows_;
+
   iout_ = 0;
   iprint_ = 1;
-  lwar_ = 2 * (3 * NbVariables_ * NbVariables_ / 2 + 10 * NbVariables_ +
-               2 * (NbConstraints_ + 1) + 20000);
+  lwar_ = 3 * nmax_ * nmax_ / 2 + 10 * nmax_ + 2 * mmax_ + 20000;
+  if ((unsigned int)lwar_ > war_.NbRows_)
+    war_.resize(lwar_, 1, false);
   liwar_ = 2 * NbVariables_ + 1000;
   eps_ = 1e-8;
 
   iwar_.Array_[0] = 1;
 
-  Q_.stick_together(Q_dense_, n_, n_);
-  DU_.stick_together(DU_dense_, mmax_, n_);
+  // The non zero multipliers of the previous solution give the
+  // initial active set of the dual active-set solver.
+  if (Solver == DUAL_ACTIVE_SET) {
+    ActiveSet_.clear();
+    int NbConstrLagr = std::min((int)Result.ConstrLagr_vec.size(), m_);
+    for (int i = 0; i < NbConstrLagr; i++)
+      if (Result.ConstrLagr_vec(i) != 0.0)
+        ActiveSet_.push_back(i);
+    if ((int)Result.LBoundsLagr_vec.size() == n_)
+      for (int i = 0; i < n_; i++) {
+        if (Result.LBoundsLagr_vec(i) != 0.0)
+          ActiveSet_.push_back(m_ + i);
+        if (Result.UBoundsLagr_vec(i) != 0.0)
+          ActiveSet_.push_back(m_ + n_ + i);
+      }
+  }
 
   Result.resize(n_, m_);
 
   switch (Solver) {
-  case QLD:
-
-    ql0001_(&m_, &me_, &mmax_, &n_, &nmax_, &mnn_, Q_dense_.Array_, D_.Array_,
-            DU_dense_.Array_, DS_.Array_, XL_.Array_, XU_.Array_, X_.Array_,
+  case QLD: {
+    // QLD regularizes the element (nmax,nmax) of the Hessian when it is
+    // null. It falls inside the padding: regularize the last variable
+    // instead, as when the Hessian is passed with nmax == n.
+    double &LastDiagonal = Q_.Array_[(n_ - 1) + (n_ - 1) * nmax_];
+    bool Regularized = (nmax_ > n_) && (LastDiagonal == 0.0);
+    if (Regularized)
+      LastDiagonal = eps_;
+
+    ql0001_(&m_, &me_, &mmax_, &n_, &nmax_, &mnn_, Q_.Array_, D_.Array_,
+            DU_.Array_, DS_.Array_, XL_.Array_, XU_.Array_, X_.Array_,
             U_.Array_, &iout_, &ifail_, &iprint_, war_.Array_, &lwar_,
             iwar_.Array_, &liwar_, &eps_);
+    // The regularization only holds for this call.
+    if (Regularized)
+      LastDiagonal = 0.0;
+    if (nmax_ > n_)
+      Q_.Array_[(nmax_ - 1) + (nmax_ - 1) * nmax_] = 0.0;
 
     for (int i = 0; i < n_; i++) {
       Result.Solution_vec(i) = X_.Array_[i];
@@ -259,11 +302,39 @@ void QPProblem::solve(solver_e Solver, solution_t &Result,
       }
       std::cout << "nb iterations : " << nb_itt_approx << std::endl;
     }
+  } break;
+  case DUAL_ACTIVE_SET: {
+    DualActiveSet::const_matrix_view_t Q(Q_.Array_, n_, n_,
+                                         Eigen::OuterStride<>(nmax_));
+    DualActiveSet::const_matrix_view_t DU(DU_.Array_, m_, n_,
+                                          Eigen::OuterStride<>(mmax_));
+    DualActiveSet::const_vector_view_t D(D_.Array_, n_), DS(DS_.Array_, m_),
+        XL(XL_.Array_, n_), XU(XU_.Array_, n_);
+
+    DualActiveSet_.NbInvariantVariables(
+        std::min(nbInvariantRows_, nbInvariantCols_));
+    Result.Fail =
+        DualActiveSet_.solve(Q, D, DU, DS, XL, XU, me_, ActiveSet_);
+    Result.Print = 0;
 
-    break;
+    const Eigen::VectorXd &Lagr = DualActiveSet_.Lagr();
+    Result.Solution_vec = DualActiveSet_.Solution();
+    Result.ConstrLagr_vec = Lagr.head(m_);
+    Result.LBoundsLagr_vec = Lagr.segment(m_, n_);
+    Result.UBoundsLagr_vec = Lagr.tail(n_);
+
+    if (tests == ITT || tests == ALL) {
+      std::cout << "nb iterations : " << DualActiveSet_.NbIterations()
+                << std::endl;
+    }
+  } break;
   case LSSOL:
 #ifdef LSSOL_FOUND
 
+    // LSSOL may factorize the Hessian in place: give it a copy.
+    Q_.stick_together(Q_dense_, n_, n_);
+    DU_.stick_together(DU_dense_, m_ + 1, n_);
+
     sendOption("Print Level = 0");
 
     sendOption("Problem Type = QP2");
@@ -322,7 +393,8 @@ void QPProblem::solve(solver_e Solver, solution_t &Result,
                 << "Nb unrespected constraints : " << nb_ctr << std::endl;
     }
 
-    lssol_(&n_, &n_, &m_, &mmax_, &n_, DU_dense_.Array_, bl, bu, D_.Array_,
+    int mdense = m_ + 1;
+    lssol_(&n_, &n_, &m_, &mdense, &n_, DU_dense_.Array_, bl, bu, D_.Array_,
            istate_, kx_, X_.Array_, Q_dense_.Array_, b_, &inform_, &iter_,
            &obj_, clamda_, iwar_.Array_, &liwar_, war_.Array_, &lwar_);
 
@@ -351,8 +423,9 @@ void QPProblem::solve(solver_e Solver, solution_t &Result,
   }
 }
 
-void QPProblem::add_term_to(qp_element_e Type, const Eigen::MatrixXd &Mat,
-                            unsigned int row, unsigned int col) {
+double *QPProblem::reserve(qp_element_e Type, unsigned int row,
+                           unsigned int col, unsigned int NbRows,
+                           unsigned int NbCols, unsigned int &LeadingDim) {
 
   array_s<double> *Array_p = 0;
 
@@ -360,124 +433,92 @@ void QPProblem::add_term_to(qp_element_e Type, const Eigen::MatrixXd &Mat,
   case MATRIX_Q:
     Array_p = &Q_;
     NbVariables_ =
-        (unsigned int)((col + Mat.cols() > NbVariables_) ? col + Mat.cols()
-                                                         : NbVariables_);
+        (col + NbCols > NbVariables_) ? col + NbCols : NbVariables_;
     break;
 
   case MATRIX_DU:
     Array_p = &DU_;
     NbConstraints_ =
-        (unsigned int)((row + Mat.rows() > NbConstraints_) ? row + Mat.rows()
-                                                           : NbConstraints_);
+        (row + NbRows > NbConstraints_) ? row + NbRows : NbConstraints_;
     NbVariables_ =
-        (unsigned int)((col + Mat.cols() > NbVariables_) ? col + Mat.cols()
-                                                         : NbVariables_);
-    row++; // The first rows of DU,DS are empty
-    break;
-
-  case VECTOR_D:
-    break;
-  case VECTOR_XL:
-    break;
-  case VECTOR_XU:
-    break;
-  case VECTOR_DS:
-    Array_p = &DS_;
-    NbConstraints_ =
-        (unsigned int)((row + Mat.rows() > NbConstraints_) ? row + Mat.rows()
-                                                           : NbConstraints_);
+        (col + NbCols > NbVariables_) ? col + NbCols : NbVariables_;
     row++; // The first rows of DU,DS are empty
     break;
-  }
-
-  if (NbVariables_ > Array_p->NbCols_)
-    resize_all();
-
-  if ((NbConstraints_ > DU_.NbRows_) && (NbConstraints_ > 0)) {
-    if (NbVariables_ > 0)
-      DU_.resize(2 * NbConstraints_, 2 * NbVariables_, true);
-  }
-
-  if ((NbConstraints_ > DS_.NbRows_) && (NbConstraints_ > 0))
-    DS_.resize(2 * NbConstraints_, 1, true);
-
-  if (U_.NbRows_ < NbConstraints_ + 2 * NbVariables_)
-    U_.resize(NbConstraints_ + 2 * NbVariables_, 1, true);
 
-  unsigned warsize = 3 * NbVariables_ * NbVariables_ / 2 + 10 * NbVariables_ +
-                     2 * (NbConstraints_ + 1) + 20000;
-  if (warsize > war_.NbRows_)
-    war_.resize(warsize, 1, true);
-
-  double *p = Array_p->Array_;
-  double *p_it = &p[row + (col)*Array_p->NbRows_];
-  for (unsigned j = 0; j < Mat.cols(); j++) {
-    p_it = &p[row + (col + j) * Array_p->NbRows_];
-    for (unsigned i = 0; i < Mat.rows(); i++) {
-      *p_it += Mat(i, j);
-      ++p_it;
-    }
-  }
-}
-
-void QPProblem::add_term_to(qp_element_e Type, const Eigen::VectorXd &Vec,
-                            unsigned row, unsigned col) {
-
-  array_s<double> *Array_p = 0;
-
-  switch (Type) {
   case VECTOR_D:
     Array_p = &D_;
     NbVariables_ =
-        (unsigned int)((row + Vec.size() > NbVariables_) ? row + Vec.size()
-                                                         : NbVariables_);
+        (row + NbRows > NbVariables_) ? row + NbRows : NbVariables_;
     break;
 
   case VECTOR_XL:
     Array_p = &XL_;
     NbVariables_ =
-        (unsigned int)((row + Vec.size() > NbVariables_) ? row + Vec.size()
-                                                         : NbVariables_);
+        (row + NbRows > NbVariables_) ? row + NbRows : NbVariables_;
     break;
 
   case VECTOR_XU:
     Array_p = &XU_;
     NbVariables_ =
-        (unsigned int)((row + Vec.size() > NbVariables_) ? row + Vec.size()
-                                                         : NbVariables_);
+        (row + NbRows > NbVariables_) ? row + NbRows : NbVariables_;
     break;
 
   case VECTOR_DS:
     Array_p = &DS_;
     NbConstraints_ =
-        (unsigned int)((row + Vec.size() > NbConstraints_) ? row + Vec.size()
-                                                           : NbConstraints_);
+        (row + NbRows > NbConstraints_) ? row + NbRows : NbConstraints_;
     row++; // The first rows of DU,DS are empty
     break;
-
-  case MATRIX_DU:
-    Array_p = &DU_;
-    NbConstraints_ = (row + 1 > NbConstraints_) ? row + 1 : NbConstraints_;
-    break;
-  case MATRIX_Q:
-    break;
   }
 
-  if ((NbVariables_ > D_.NbRows_) && (NbVariables_ > 0))
+  // Enlarge the storage, with some margin to avoid repeated reallocations.
+  if ((NbVariables_ > Q_.NbCols_) || (NbVariables_ > D_.NbRows_))
     resize_all();
 
-  double *p_it = &Array_p->Array_[row + col * Array_p->NbRows_];
-  if (Type == MATRIX_DU) {
-    for (unsigned i = 0; i < Vec.size(); i++) {
-      *p_it += Vec(i);
-      ++p_it;
-    }
-  } else {
-    for (unsigned i = 0; i < Vec.size(); i++) {
-      *p_it += Vec(i);
-      ++p_it;
-    }
-  }
+  if (((NbConstraints_ + 2 > DU_.NbRows_) || (NbVariables_ > DU_.NbCols_)) &&
+      (NbConstraints_ > 0) && (NbVariables_ > 0))
+    DU_.resize(2 * (NbConstraints_ + 1), 2 * NbVariables_, true);
+
+  if ((NbConstraints_ + 2 > DS_.NbRows_) && (NbConstraints_ > 0))
+    DS_.resize(2 * (NbConstraints_ + 1), 1, true);
+
+  if (U_.NbRows_ < NbConstraints_ + 1 + 2 * NbVariables_)
+    U_.resize(2 * (NbConstraints_ + 1 + 2 * NbVariables_), 1, true);
+
+  LeadingDim = Array_p->NbRows_;
+  return &Array_p->Array_[row + col * LeadingDim];
+}
+
+QPProblem::matrix_view_t QPProblem::matrix_view(qp_element_e Type,
+                                                unsigned int Row,
+                                                unsigned int Col,
+                                                unsigned int NbRows,
+                                                unsigned int NbCols) {
+  unsigned int LeadingDim = 0;
+  double *p = reserve(Type, Row, Col, NbRows, NbCols, LeadingDim);
+  return matrix_view_t(p, NbRows, NbCols, Eigen::OuterStride<>(LeadingDim));
+}
+
+QPProblem::vector_view_t QPProblem::vector_view(qp_element_e Type,
+                                                unsigned int Row,
+                                                unsigned int NbRows) {
+  unsigned int LeadingDim = 0;
+  double *p = reserve(Type, Row, 0, NbRows, 1, LeadingDim);
+  return vector_view_t(p, NbRows);
+}
+
+void QPProblem::add_term_to(qp_element_e Type, const Eigen::MatrixXd &Mat,
+                            unsigned int row, unsigned int col) {
+  matrix_view(Type, row, col, (unsigned int)Mat.rows(),
+              (unsigned int)Mat.cols()) += Mat;
+}
+
+void QPProblem::add_term_to(qp_element_e Type, const Eigen::VectorXd &Vec,
+                            unsigned row, unsigned col) {
+  if ((Type == MATRIX_Q) || (Type == MATRIX_DU))
+    matrix_view(Type, row, col, (unsigned int)Vec.size(), 1) += Vec;
+  else
+    vector_view(Type, row, (unsigned int)Vec.size()) += Vec;
 }
 
 void QPProblem::dump_solver_parameters(std::ostream &aos) {
@@ -496,20 +537,22 @@ void QPProblem::dump_solver_parameters(std::ostream &aos) {
 
 void QPProblem::dump(qp_element_e Type, std::ostream &aos) {
 
-  unsigned int NbRows = 0, NbCols = 0;
+  unsigned int NbRows = 0, NbCols = 0, LeadingDim = 0;
   double *Array = 0;
   std::string Name;
   switch (Type) {
   case MATRIX_Q:
-    NbRows = NbCols = Q_dense_.NbCols_;
-    Array = Q_dense_.Array_;
+    NbRows = NbCols = NbVariables_;
+    LeadingDim = Q_.NbRows_;
+    Array = Q_.Array_;
     Name = "Q";
     break;
 
   case MATRIX_DU:
-    NbRows = DU_dense_.NbRows_;
-    NbCols = DU_dense_.NbCols_;
-    Array = DU_dense_.Array_;
+    NbRows = NbConstraints_ + 1;
+    NbCols = NbVariables_;
+    LeadingDim = DU_.NbRows_;
+    Array = DU_.Array_;
     Name = "DU";
     break;
 
@@ -541,11 +584,15 @@ void QPProblem::dump(qp_element_e Type, std::ostream &aos) {
     Name = "DS";
     break;
   }
+  if (LeadingDim < NbRows)
+    LeadingDim = NbRows;
+  if (Array == 0)
+    NbRows = NbCols = 0;
   aos << Name << "[" << NbRows << "," << NbCols << "]" << std::endl;
 
   for (unsigned int i = 0; i < NbRows; i++) {
     for (unsigned int j = 0; j < NbCols; j++)
-      aos << std::scientific << Array[i + j * NbRows] << " ";
+      aos << std::scientific << Array[i + j * LeadingDim] << " ";
     aos << std::endl;
   }
   aos << std::endl;
@@ -27,6 +27,7 @@
 #ifndef _QP_PROBLEM_H_
 #define _QP_PROBLEM_H_
 
+#include <Mathematics/dual-active-set.hh>
 #include <Mathematics/intermediate-qp-matrices.hh>
 #include <Mathematics/qld.hh>
 #include <PreviewControl/rigid-body-system.hh>
@@ -73,6 +74,35 @@ public:
   void add_term_to(qp_element_e Type, const Eigen::VectorXd &Vec, unsigned Row,
                    unsigned Col = 0);
 
+  /// \name Views on the storage of the problem
+  /// The views point directly to the arrays passed to the solver.
+  /// The problem is enlarged as with add_term_to, and a view stays valid
+  /// until the problem is enlarged again.
+  /// \{
+  typedef Eigen::Map<Eigen::MatrixXd, Eigen::Unaligned, Eigen::OuterStride<> >
+      matrix_view_t;
+  typedef Eigen::Map<Eigen::VectorXd> vector_view_t;
+
+  /// \brief Block of a matrix of the problem
+  ///
+  /// \param[in] Type Target matrix type
+  /// \param[in] Row First row inside the target
+  /// \param[in] Col First column inside the target
+  /// \param[in] NbRows Number of rows of the block
+  /// \param[in] NbCols Number of columns of the block
+  matrix_view_t matrix_view(qp_element_e Type, unsigned int Row,
+                            unsigned int Col, unsigned int NbRows,
+                            unsigned int NbCols);
+
+  /// \brief Segment of a vector of the problem
+  ///
+  /// \param[in] Type Target vector type
+  /// \param[in] Row First row inside the target
+  /// \param[in] NbRows Size of the segment
+  vector_view_t vector_view(qp_element_e Type, unsigned int Row,
+                            unsigned int NbRows);
+  /// \}
+
   /// \brief Dump current problem on disk.
   void dump(const char *Filename);
   void dump(double Time);
@@ -128,6 +158,14 @@ public:
     nbInvariantCols_ = nbInvariantCols;
   };
   inline unsigned int nbInvariantCols() { return nbInvariantCols_; };
+
+  /// \brief Iteration limit of the dual active-set solver, 0 for none
+  inline void MaxIterations(unsigned int MaxIterations) {
+    DualActiveSet_.MaxIterations(MaxIterations);
+  };
+  inline unsigned int MaxIterations() {
+    return DualActiveSet_.MaxIterations();
+  };
   /// \}
 
   /// \brief Print_ array
@@ -144,6 +182,19 @@ private:
   ///
   void resize_all();
 
+  /// \brief Enlarge the problem such that a block fits inside the target.
+  ///
+  /// \param[in] Type Target type
+  /// \param[in] Row First row inside the target
+  /// \param[in] Col First column inside the target
+  /// \param[in] NbRows Number of rows of the block
+  /// \param[in] NbCols Number of columns of the block
+  /// \param[out] LeadingDim Leading dimension of the target
+  /// \return Address of the first element of the block
+  double *reserve(qp_element_e Type, unsigned int Row, unsigned int Col,
+                  unsigned int NbRows, unsigned int NbCols,
+                  unsigned int &LeadingDim);
+
   /// \name Dumping functions
   /// \{
   /// \brief Print_ on disk the parameters that are passed to the solver
@@ -158,6 +209,9 @@ private:
   //
 private:
   /// \brief Handle matrices/vectors in array form
+  ///
+  /// The arrays are column major with a leading dimension NbRows_,
+  /// the solvers work directly on them.
   template <typename type> struct array_s {
     type *Array_;
 
@@ -171,6 +225,16 @@ private:
       std::fill_n(Array, Size, Value);
     }
 
+    /// \brief Set a block of the array to a value
+    void fill(unsigned int NbRows, unsigned int NbCols, type Value) {
+      if (NbRows > NbRows_)
+        NbRows = NbRows_;
+      if (NbCols > NbCols_)
+        NbCols = NbCols_;
+      for (unsigned int j = 0; j < NbCols; j++)
+        std::fill_n(Array_ + j * NbRows_, NbRows, Value);
+    }
+
     /// \brief Make a contiguous array
     ///
     /// \param[in] FinalArray New array
@@ -215,19 +279,30 @@ private:
       try {
         bool Reallocate = false;
         type *NewArray = 0;
-        if (NbRows * NbCols > SizeMem_) {
+        // Preserving the values of a reshaped array needs a new one
+        // since the leading dimension changes.
+        if ((NbRows * NbCols > SizeMem_) ||
+            ((Preserve) && (Array_ != 0) && (NbRows != NbRows_))) {
           NewArray = new type[NbRows * NbCols];
           SizeMem_ = NbRows * NbCols;
           Reallocate = true;
         } else
           NewArray = Array_;
 
-        fill(NewArray, NbRows * NbCols, (type)0);
         if ((Preserve) && (Array_ != 0)) {
-          for (unsigned int j = 0; j < NbCols_; j++)
-            for (unsigned int i = 0; i < NbRows_; i++)
-              NewArray[i + NbRows * j] = Array_[i + NbRows_ * j];
-        }
+          unsigned int NbRowsKept = (NbRows < NbRows_) ? NbRows : NbRows_;
+          unsigned int NbColsKept = (NbCols < NbCols_) ? NbCols : NbCols_;
+          if (Reallocate) {
+            fill(NewArray, NbRows * NbCols, (type)0);
+            for (unsigned int j = 0; j < NbColsKept; j++)
+              for (unsigned int i = 0; i < NbRowsKept; i++)
+                NewArray[i + NbRows * j] = Array_[i + NbRows_ * j];
+          } else if (NbCols > NbColsKept) {
+            fill(NewArray + NbRows * NbColsKept,
+                 NbRows * (NbCols - NbColsKept), (type)0);
+          }
+        } else
+          fill(NewArray, NbRows * NbCols, (type)0);
 
         if ((Array_ != 0) && Reallocate) {
           delete[] Array_;
@@ -275,6 +350,13 @@ private:
   double eps_;
   /// \}
 
+  /// \name Dual active-set solver
+  /// \{
+  DualActiveSet DualActiveSet_;
+  /// \brief Initial active set taken from the previous solution
+  std::vector<int> ActiveSet_;
+  /// \}
+
   ///  \brief Robot
   RigidBodySystem *Robot_;
 
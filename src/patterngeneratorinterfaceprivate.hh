@@ -53,6 +53,7 @@
 
 #include <FootTrajectoryGeneration/LeftAndRightFootTrajectoryGenerationMultiple.hh>
 
+#include <RingBuffer.hh>
 #include <StepStackHandler.hh>
 
 #include <SimplePlugin.hh>
@@ -379,10 +380,19 @@ public:
     objects which registered the method. */
   int ParseCmd(std::istringstream &strm);
 
+  /*! \brief Replay on this object the commands parsed by aPGI before
+    its first step of control, and copy its ZMP initial point.
+    Commands parsed while handling another command are not replayed. */
+  void ReplayConfiguration(const PatternGeneratorInterfacePrivate &aPGI);
+
   /*! \brief This method register a method to a specific object which
     derivates from SimplePlugin class. */
   bool RegisterMethod(string &MethodName, SimplePlugin *aSP);
 
+  /*! \brief Objects which registered the method MethodName. */
+  void getPlugins(const std::string &MethodName,
+                  std::vector<SimplePlugin *> &Plugins) const;
+
   /*! @} */
 
   /*! \brief Returns the ZMP, CoM, left foot absolute position, and
@@ -495,6 +505,18 @@ private:
 
   /*@} */
 
+  /*! \name Commands recorded to clone this object.
+    @{ */
+  /*! Top-level commands parsed before the first step of control. */
+  std::vector<std::string> m_ConfigurationCommands;
+
+  /*! Depth of the nested calls to ParseCmd. */
+  unsigned int m_ParseCmdDepth;
+
+  /*! True until the first step of control. */
+  bool m_RecordCommands;
+  /*! @} */
+
   /*! The Preview Control object. */
   PreviewControl *m_PC;
 
@@ -620,6 +642,11 @@ private:
 
   bool m_feedBackControl;
 
+  /*! \brief Real-time mode: the buffers are allocated when the on-line
+    walking starts, and one step of the control loop is checked by an
+    AllocationCheck. */
+  bool m_RealTime;
+
   /*! \name To handle a new step.
     @{
   */
@@ -714,16 +741,16 @@ private:
   */
 
   /*! Buffer of ZMP positions */
-  deque<ZMPPosition> m_ZMPPositions;
+  RingBuffer<ZMPPosition> m_ZMPPositions;
 
   /*! Buffer of Absolute foot position (World frame) */
-  deque<FootAbsolutePosition> m_FootAbsolutePositions;
+  RingBuffer<FootAbsolutePosition> m_FootAbsolutePositions;
 
   /*! Buffer of absolute foot position. */
-  deque<FootAbsolutePosition> m_LeftFootPositions, m_RightFootPositions;
+  RingBuffer<FootAbsolutePosition> m_LeftFootPositions, m_RightFootPositions;
 
   /*! Buffer for the COM position. */
-  deque<COMState> m_COMBuffer;
+  RingBuffer<COMState> m_COMBuffer;
 
   /*! @} */
 
@@ -241,13 +241,32 @@ void solution_t::reset() {
   Fail = 0;
   Print = 0;
 
-  Solution_vec.resize(0, false);
+  Solution_vec.resize(0);
   SupportOrientations_deq.resize(0);
   TrunkOrientations_deq.resize(0);
   SupportStates_deq.resize(0);
-  ConstrLagr_vec.resize(0, false);
-  LBoundsLagr_vec.resize(0, false);
-  UBoundsLagr_vec.resize(0, false);
+  ConstrLagr_vec.resize(0);
+  LBoundsLagr_vec.resize(0);
+  UBoundsLagr_vec.resize(0);
+}
+
+void solution_t::assign(const solution_t &Solution) {
+  NbVariables = Solution.NbVariables;
+  NbConstraints = Solution.NbConstraints;
+  Fail = Solution.Fail;
+  Print = Solution.Print;
+  useWarmStart = Solution.useWarmStart;
+
+  // Eigen and RingBuffer only reallocate when the storage is too small.
+  Solution_vec = Solution.Solution_vec;
+  initialSolution = Solution.initialSolution;
+  ConstrLagr_vec = Solution.ConstrLagr_vec;
+  LBoundsLagr_vec = Solution.LBoundsLagr_vec;
+  UBoundsLagr_vec = Solution.UBoundsLagr_vec;
+
+  SupportOrientations_deq = Solution.SupportOrientations_deq;
+  TrunkOrientations_deq = Solution.TrunkOrientations_deq;
+  SupportStates_deq = Solution.SupportStates_deq;
 }
 
 void solution_t::resize(unsigned int SizeSolution,
@@ -255,10 +274,10 @@ void solution_t::resize(unsigned int SizeSolution,
   NbVariables = SizeSolution;
   NbConstraints = SizeConstraints;
 
-  Solution_vec.resize(SizeSolution, false);
-  ConstrLagr_vec.resize(SizeConstraints, false);
-  LBoundsLagr_vec.resize(SizeSolution, false);
-  UBoundsLagr_vec.resize(SizeSolution, false);
+  Solution_vec.resize(SizeSolution);
+  ConstrLagr_vec.resize(SizeConstraints);
+  LBoundsLagr_vec.resize(SizeSolution);
+  UBoundsLagr_vec.resize(SizeSolution);
 }
 
 void solution_t::dump(const char *FileName) {
@@ -37,6 +37,8 @@
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
 
+#include <RingBuffer.hh>
+
 namespace PatternGeneratorJRL {
 
 //
@@ -86,7 +88,7 @@ enum qp_element_e {
   VECTOR_XU
 };
 
-enum solver_e { QLD, LSSOL };
+enum solver_e { QLD, LSSOL, DUAL_ACTIVE_SET };
 
 enum tests_e { NONE, ALL, ITT, CTR };
 
@@ -323,11 +325,11 @@ struct solution_t {
   /// \brief QP initial solution vector
   Eigen::VectorXd initialSolution;
   /// \brief Previewed support orientations
-  std::deque<double> SupportOrientations_deq;
+  RingBuffer<double> SupportOrientations_deq;
   /// \brief Previewed trunk orientations (only yaw as for now)
-  std::deque<double> TrunkOrientations_deq;
+  RingBuffer<double> TrunkOrientations_deq;
   /// \brief Previewed support states
-  std::deque<support_state_t> SupportStates_deq;
+  RingBuffer<support_state_t> SupportStates_deq;
   /// \}
 
   /// \name{
@@ -346,6 +348,10 @@ struct solution_t {
   /// \brief Resize solution containers
   void resize(unsigned int NbVariables, unsigned int NbConstraints);
 
+  /// \brief Copy Solution in place, reusing the storage of the
+  /// containers
+  void assign(const solution_t &Solution);
+
   /// \brief Dump solution
   /// \param Filename
   void dump(const char *Filename);
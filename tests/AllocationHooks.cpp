@@ -0,0 +1,140 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file AllocationHooks.cpp
+  \brief Replace the global operator new and delete of a test program,
+  so that AllocationCheck counts its allocations.
+*/
+#include <cstdlib>
+#include <new>
+
+#include <AllocationCheck.hh>
+
+using PatternGeneratorJRL::AllocationCheck;
+
+namespace {
+void *CountedAllocation(std::size_t size) {
+  AllocationCheck::countAllocation();
+  if (size == 0)
+    size = 1;
+  void *p;
+  while ((p = std::malloc(size)) == 0) {
+    std::new_handler aHandler = std::set_new_handler(0);
+    std::set_new_handler(aHandler);
+    if (aHandler == 0)
+      throw std::bad_alloc();
+    aHandler();
+  }
+  return p;
+}
+
+void *CountedAllocation(std::size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return CountedAllocation(size);
+  } catch (...) {
+    return 0;
+  }
+}
+
+#ifdef __cpp_aligned_new
+void *CountedAllocation(std::size_t size, std::align_val_t alignment) {
+  AllocationCheck::countAllocation();
+  std::size_t lAlignment = static_cast<std::size_t>(alignment);
+  if (lAlignment < sizeof(void *))
+    lAlignment = sizeof(void *);
+  if (size == 0)
+    size = 1;
+  void *p;
+  while (posix_memalign(&p, lAlignment, size) != 0) {
+    std::new_handler aHandler = std::set_new_handler(0);
+    std::set_new_handler(aHandler);
+    if (aHandler == 0)
+      throw std::bad_alloc();
+    aHandler();
+  }
+  return p;
+}
+
+void *CountedAllocation(std::size_t size, std::align_val_t alignment,
+                        const std::nothrow_t &) noexcept {
+  try {
+    return CountedAllocation(size, alignment);
+  } catch (...) {
+    return 0;
+  }
+}
+#endif
+} // namespace
+
+void *operator new(std::size_t size) { return CountedAllocation(size); }
+void *operator new[](std::size_t size) { return CountedAllocation(size); }
+void *operator new(std::size_t size, const std::nothrow_t &t) noexcept {
+  return CountedAllocation(size, t);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &t) noexcept {
+  return CountedAllocation(size, t);
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+  std::free(p);
+}
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+  std::free(p);
+}
+
+#ifdef __cpp_sized_deallocation
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+#endif
+
+#ifdef __cpp_aligned_new
+void *operator new(std::size_t size, std::align_val_t a) {
+  return CountedAllocation(size, a);
+}
+void *operator new[](std::size_t size, std::align_val_t a) {
+  return CountedAllocation(size, a);
+}
+void *operator new(std::size_t size, std::align_val_t a,
+                   const std::nothrow_t &t) noexcept {
+  return CountedAllocation(size, a, t);
+}
+void *operator new[](std::size_t size, std::align_val_t a,
+                     const std::nothrow_t &t) noexcept {
+  return CountedAllocation(size, a, t);
+}
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t,
+                     const std::nothrow_t &) noexcept {
+  std::free(p);
+}
+void operator delete[](void *p, std::align_val_t,
+                       const std::nothrow_t &) noexcept {
+  std::free(p);
+}
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+#endif
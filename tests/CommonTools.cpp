@@ -33,11 +33,14 @@
 #include <Windows.h>
 #endif /*WIN32*/
 
+#include <algorithm>
 #include <fstream>
 #include <sstream>
+#include <vector>
 
 #include "CommonTools.hh"
 #include "Debug.hh"
+#include "patterngeneratorinterfaceprivate.hh"
 
 #include <jrl/walkgen/patterngeneratorinterface.hh>
 
@@ -112,6 +115,109 @@ void CommonInitialization(PatternGeneratorInterface &aPGI) {
          << InitRightFootAbsPos.omega << " " << InitRightFootAbsPos.omega2);
 }
 
+/*! \brief Objects of type T which registered the method MethodName
+  in aPGI. */
+template <class T>
+static void findPlugins(PatternGeneratorInterface &aPGI,
+                        const std::string &MethodName,
+                        std::vector<T *> &Plugins) {
+  Plugins.clear();
+  PatternGeneratorInterfacePrivate *aPGIP =
+      dynamic_cast<PatternGeneratorInterfacePrivate *>(&aPGI);
+  if (aPGIP == 0)
+    return;
+  std::vector<SimplePlugin *> lPlugins;
+  aPGIP->getPlugins(MethodName, lPlugins);
+  for (std::size_t i = 0; i < lPlugins.size(); i++) {
+    T *aPlugin = dynamic_cast<T *>(lPlugins[i]);
+    if (aPlugin != 0)
+      Plugins.push_back(aPlugin);
+  }
+}
+
+/*! \brief The multibody ZMP used by the second stage, audited against
+  the inverse dynamics, stays within a centimeter of it. */
+static bool checkMultiBodyZMPAccuracy(PatternGeneratorInterface &aPGI,
+                                      std::ostream &os) {
+  std::vector<ZMPPreviewControlWithMultiBodyZMP *> lPlugins;
+  findPlugins(aPGI, ":multibodyzmpaccuracy", lPlugins);
+  unsigned long int lNbSamples = 0;
+  double lMaxError = 0.0;
+  for (std::size_t i = 0; i < lPlugins.size(); i++) {
+    double lMax, lRMS;
+    lNbSamples += lPlugins[i]->GetMultiBodyZMPAccuracyLoss(lMax, lRMS);
+    lMaxError = std::max(lMaxError, lMax);
+  }
+  os << "Multibody ZMP accuracy loss: max " << lMaxError << " over "
+     << lNbSamples << " samples" << endl;
+  return (lNbSamples > 0) && (lMaxError < 1e-2);
+}
+
+/*! \brief The incremental dynamic filter reused some samples. */
+static bool checkIncrementalHits(PatternGeneratorInterface &aPGI,
+                                 std::ostream &os) {
+  std::vector<DynamicFilter *> lPlugins;
+  findPlugins(aPGI, ":dynamicFilterIncremental", lPlugins);
+  unsigned long lNbHits = 0, lNbMisses = 0;
+  for (std::size_t i = 0; i < lPlugins.size(); i++) {
+    lNbHits += lPlugins[i]->getIncrementalHits();
+    lNbMisses += lPlugins[i]->getIncrementalMisses();
+  }
+  os << "Incremental dynamic filter: " << lNbHits << " hits, " << lNbMisses
+     << " misses" << endl;
+  return lNbHits > 0;
+}
+
+/*! \brief Options checked against the default behaviour. */
+static const OptionVariant OptionVariants[] = {
+    // Both solvers find the minimum of the same strictly convex QP.
+    {"DualActiveSet", 0, ":qpsolver dualactiveset", 0, 1e-6},
+    // The asynchronous QP samples the velocity reference one QP period
+    // (20 iterations) earlier, and computes the same trajectories.
+    {"AsyncQP", 0, ":asyncQP true", 20, 1e-6},
+    // With a tolerance of 0 the factor is only reused while the Hessian
+    // does not change.
+    {"ReuseHessianFactor", 0, ":reusehessianfactor true 0.0", 0, 1e-6},
+    // The threads compute the same postures as the serial loop.
+    {"DynamicFilterThreads", ":useDynamicFilter true",
+     ":dynamicFilterThreads 4", 0, 1e-6},
+    // The analytical rates are exact derivatives of the leg inverse
+    // kinematics (checked by TestLegJointRates), the reference uses
+    // backward differences over one period: the corrections of the CoM
+    // differ slightly.
+    {"DynamicFilterAnalyticalRates", ":useDynamicFilter true",
+     ":dynamicFilterAnalyticalRates true", 0, 1e-2},
+    // A sample is only reused when its inputs moved by less than 1e-9,
+    // and some samples must be reused.
+    {"DynamicFilterIncremental", ":useDynamicFilter true",
+     ":dynamicFilterIncremental true 1e-9", 0, 1e-6, checkIncrementalHits},
+    // The correction of the CoM is computed from the preview of the
+    // previous QP period, and applied one period late.
+    {"PipelinedFilter", ":useDynamicFilter true", ":pipelinedFilter true", 0,
+     1e-2},
+    // Between two evaluations, the second stage previews the multibody
+    // ZMP extrapolated, then interpolated linearly: its correction of the
+    // CoM differs by less than a millimeter.
+    {"MultiBodyZMPEvaluation", 0, ":multibodyzmpevaluation 4 rnea", 0, 1e-3},
+    // The centroidal dynamics give the multibody ZMP of the inverse
+    // dynamics, which the audit computes at each iteration to bound the
+    // error of the interpolation.
+    {"MultiBodyZMPCentroidalAudit", 0,
+     ":multibodyzmpevaluation 4 centroidal audit", 0, 1e-3,
+     checkMultiBodyZMPAccuracy}};
+
+const OptionVariant *findOptionVariant(const std::string &aTestName) {
+  std::size_t lNbVariants = sizeof(OptionVariants) / sizeof(OptionVariant);
+  for (std::size_t i = 0; i < lNbVariants; i++) {
+    std::string lSuffix(OptionVariants[i].Suffix);
+    if ((aTestName.size() > lSuffix.size()) &&
+        (aTestName.compare(aTestName.size() - lSuffix.size(), lSuffix.size(),
+                           lSuffix) == 0))
+      return &OptionVariants[i];
+  }
+  return 0;
+}
+
 void getOptions(int argc, char *argv[], string &urdfFullPath,
                 string &srdfFullPath,
                 unsigned int &) // TestProfil)
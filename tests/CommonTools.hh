@@ -52,6 +52,30 @@ void getOptions(int argc, char *argv[], std::string &urdfFullPath,
 
 void CommonInitialization(PatternGeneratorJRL::PatternGeneratorInterface &aPGI);
 
+/*! \brief Option of an algorithm checked against its default
+  behaviour. */
+struct OptionVariant {
+  /*! \brief Suffix of the names of the tests checking the option. */
+  const char *Suffix;
+  /*! \brief Command parsed with and without the option, or 0. */
+  const char *Setup;
+  /*! \brief Command setting the option. */
+  const char *Option;
+  /*! \brief Number of iterations by which the run without the option
+    delays the events of the profile. */
+  unsigned int EventDelay;
+  /*! \brief Largest difference allowed on each field of the
+    debug file. */
+  double Tolerance;
+  /*! \brief Check of the pattern generator after the run with the
+    option, or 0. */
+  bool (*Check)(PatternGeneratorInterface &aPGI, std::ostream &os);
+};
+
+/*! \brief Return the option checked by the test aTestName,
+  or 0 if the test does not check an option. */
+const OptionVariant *findOptionVariant(const std::string &aTestName);
+
 /*! \brief Structure to handle information related
   to one step of each algorithm m_*/
 class OneStep {
@@ -58,6 +58,7 @@ public:
 protected:
   void startOnLineWalking(PatternGeneratorInterface &aPGI) {
     CommonInitialization(aPGI);
+    parseCommands(aPGI);
 
     {
       istringstream strm2(":SetAlgoForZmpTrajectory Herdt");
@@ -88,6 +89,7 @@ protected:
 
   void startEmergencyStop(PatternGeneratorInterface &aPGI) {
     CommonInitialization(aPGI);
+    parseCommands(aPGI);
 
     {
       istringstream strm2(":SetAlgoForZmpTrajectory Herdt");
@@ -227,7 +229,7 @@ protected:
 
     // Test when triggering event.
     for (unsigned int i = 0; i < localNbOfEvents; i++) {
-      if (m_OneStep.NbOfIt == events[i].time) {
+      if (m_OneStep.m_NbOfIt == events[i].time + m_EventDelay) {
         ODEBUG3("********* GENERATE EVENT OLW ***********");
         (this->*(events[i].Handler))(*m_PGI);
       }
@@ -245,7 +247,7 @@ protected:
 
     // Test when triggering event.
     for (unsigned int i = 0; i < localNbOfEventsEMS; i++) {
-      if (m_OneStep.NbOfIt == events[i].time) {
+      if (m_OneStep.m_NbOfIt == events[i].time + m_EventDelay) {
         ODEBUG3("********* GENERATE EVENT EMS ***********");
         (this->*(events[i].Handler))(*m_PGI);
       }
@@ -288,6 +290,24 @@ int PerformTests(int argc, char *argv[]) {
     exit(-1);
   }
 
+  // Tests named after an option compare it with the default behaviour.
+  const OptionVariant *aVariant = findOptionVariant(TestName);
+  if (aVariant != 0) {
+    try {
+      if (!runOptionVariant<TestHerdt2010>(argc, argv, TestName,
+                                           TestProfiles[indexProfile],
+                                           *aVariant, std::cout)) {
+        cout << "Failed test " << aVariant->Suffix << endl;
+        return -1;
+      } else
+        cout << "Passed test " << aVariant->Suffix << endl;
+    } catch (const char *astr) {
+      cerr << "Failed on following error " << astr << std::endl;
+      return -1;
+    }
+    return 0;
+  }
+
   TestHerdt2010 aTH2010(argc, argv, TestName, TestProfiles[indexProfile]);
   aTH2010.init();
   try {
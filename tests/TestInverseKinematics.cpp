@@ -109,8 +109,8 @@ public:
                                    rfFoot[i], zmpmb[i], stage0, i);
     }
 
-    deque<ZMPPosition> inputdeltaZMP_deq(comPos.size());
-    deque<COMState> outputDeltaCOMTraj_deq;
+    RingBuffer<ZMPPosition> inputdeltaZMP_deq(comPos.size());
+    RingBuffer<COMState> outputDeltaCOMTraj_deq;
     for (unsigned int i = 0; i < comPos.size(); ++i) {
       inputdeltaZMP_deq[i].px = zmp[i].px - zmpmb[i][0];
       inputdeltaZMP_deq[i].py = zmp[i].py - zmpmb[i][1];
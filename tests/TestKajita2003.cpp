@@ -116,6 +116,7 @@ protected:
 
   void TurningOnTheCircle(PatternGeneratorInterface &aPGI) {
     CommonInitialization(aPGI);
+    parseCommands(aPGI);
 
     {
       istringstream strm2(":supportfoot 1");
@@ -140,6 +141,7 @@ protected:
 
   void StraightWalking(PatternGeneratorInterface &aPGI) {
     CommonInitialization(aPGI);
+    parseCommands(aPGI);
     {
       istringstream strm2(":SetAlgoForZmpTrajectory Kajita");
       aPGI.ParseCmd(strm2);
@@ -167,6 +169,7 @@ protected:
 
   void WalkingOnSpot(PatternGeneratorInterface &aPGI) {
     CommonInitialization(aPGI);
+    parseCommands(aPGI);
     {
       istringstream strm2(":SetAlgoForZmpTrajectory Kajita");
       aPGI.ParseCmd(strm2);
@@ -209,6 +212,7 @@ protected:
 
   void PbFlorentSeq1(PatternGeneratorInterface &aPGI) {
     CommonInitialization(aPGI);
+    parseCommands(aPGI);
     {
       istringstream strm2(":SetAlgoForZmpTrajectory Kajita");
       aPGI.ParseCmd(strm2);
@@ -238,6 +242,7 @@ protected:
 
   void PbFlorentSeq2(PatternGeneratorInterface &aPGI) {
     CommonInitialization(aPGI);
+    parseCommands(aPGI);
     {
       istringstream strm2(":SetAlgoForZmpTrajectory Kajita");
       aPGI.ParseCmd(strm2);
@@ -369,6 +374,23 @@ int PerformTests(int argc, char *argv[]) {
   } else {
     ODEBUG("Index detected: " << indexProfile);
   }
+  const OptionVariant *aVariant = findOptionVariant(TestName);
+  if (aVariant != 0) {
+    try {
+      if (!runOptionVariant<TestKajita2003>(argc, argv, TestName,
+                                            TestProfiles[indexProfile],
+                                            *aVariant, std::cout)) {
+        cout << "Failed test " << aVariant->Suffix << endl;
+        return -1;
+      } else
+        cout << "Passed test " << aVariant->Suffix << endl;
+    } catch (const char *astr) {
+      cerr << "Failed on following error " << astr << std::endl;
+      return -1;
+    }
+    return 0;
+  }
+
   TestKajita2003 aTK2003(argc, argv, TestName, TestProfiles[indexProfile]);
   aTK2003.init();
   try {
@@ -47,12 +47,12 @@ private:
   MAL_VECTOR(InitialAcceleration, double);
   MAL_S3_VECTOR(lStartingCOMState, double);
 
-  deque<COMState> delta_com;
+  RingBuffer<COMState> delta_com;
 
   vector<FootAbsolutePosition> lfFoot;
   vector<FootAbsolutePosition> rfFoot;
 
-  deque<ZMPPosition> delta_zmp;
+  RingBuffer<ZMPPosition> delta_zmp;
 
 public:
   TestInverseKinematics(int argc, char *argv[], string &aString)
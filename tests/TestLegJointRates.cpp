@@ -0,0 +1,147 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestLegJointRates.cpp
+  \brief Check that the joint rates of the legs computed from their
+  Jacobians are the central differences of the inverse kinematics,
+  along a motion of the CoM and of the feet.
+*/
+
+#include <cmath>
+#include <iostream>
+
+#include "TestObject.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+using namespace PatternGeneratorJRL::TestSuite;
+
+class TestLegJointRates : public TestObject {
+public:
+  TestLegJointRates(int argc, char *argv[], string &aString)
+      : TestObject(argc, argv, aString) {}
+
+  bool doTest(ostream &os) {
+    Eigen::Matrix<double, 6, 1> lWaist;
+    Eigen::Vector3d lCoM;
+    FootAbsolutePosition lLeftFoot, lRightFoot;
+    m_ComAndFootRealization->InitializationCoM(m_HalfSitting, lCoM, lWaist,
+                                               lLeftFoot, lRightFoot);
+    m_CoM0 << lCoM, 0.0, 0.0, 0.0;
+    m_LeftFoot0 << lLeftFoot.x, lLeftFoot.y, lLeftFoot.z, lLeftFoot.theta,
+        lLeftFoot.omega;
+    m_RightFoot0 << lRightFoot.x, lRightFoot.y, lRightFoot.z,
+        lRightFoot.theta, lRightFoot.omega;
+
+    std::vector<int> lLegs, lRightLeg;
+    m_ComAndFootRealization->leftLegIndexinVelocity(lLegs);
+    m_ComAndFootRealization->rightLegIndexinVelocity(lRightLeg);
+    lLegs.insert(lLegs.end(), lRightLeg.begin(), lRightLeg.end());
+
+    Eigen::Index n = m_PR->numberVelDof();
+    Eigen::VectorXd q(n), v(n), a(n), qm(n), qp(n), lUnused(n);
+    const double h = 1e-3;
+    bool ok = true;
+    for (unsigned int k = 0; k < 50; k++) {
+      double t = 0.02 * k;
+      posture(t, q, v, a);
+      posture(t - h, qm, lUnused, lUnused);
+      posture(t + h, qp, lUnused, lUnused);
+
+      double lVelocityError = 0.0, lAccelerationError = 0.0;
+      for (std::size_t i = 0; i < lLegs.size(); i++) {
+        int j = lLegs[i];
+        lVelocityError =
+            max(lVelocityError, fabs(v[j] - (qp[j] - qm[j]) / (2.0 * h)));
+        lAccelerationError =
+            max(lAccelerationError,
+                fabs(a[j] - (qp[j] - 2.0 * q[j] + qm[j]) / (h * h)));
+      }
+      if ((lVelocityError > 1e-5) || (lAccelerationError > 1e-3)) {
+        os << "t=" << t << ": velocity error " << lVelocityError
+           << " acceleration error " << lAccelerationError << endl;
+        ok = false;
+      }
+    }
+    return ok;
+  }
+
+protected:
+  /*! Posture and joint rates at time t of a motion around the
+    initial posture, which moves all the coordinates used by the
+    inverse kinematics. The angles are in degrees. */
+  void posture(double t, Eigen::VectorXd &q, Eigen::VectorXd &v,
+               Eigen::VectorXd &a) {
+    Eigen::VectorXd lCoM(6), ldCoM(6), lddCoM(6);
+    Eigen::VectorXd lLeft(5), ldLeft(5), lddLeft(5);
+    Eigen::VectorXd lRight(5), ldRight(5), lddRight(5);
+    Eigen::Matrix<double, 6, 1> lCoMAmplitude, lCoMPulsation;
+    lCoMAmplitude << 0.03, 0.04, 0.01, 0.0, 3.0, 10.0;
+    lCoMPulsation << 3.0, 5.0, 7.0, 0.0, 4.0, 2.0;
+    Eigen::Matrix<double, 5, 1> lFootAmplitude, lFootPulsation;
+    lFootAmplitude << 0.04, 0.01, 0.02, 8.0, 5.0;
+    lFootPulsation << 4.0, 6.0, 5.0, 3.0, 7.0;
+    sine(t, m_CoM0, lCoMAmplitude, lCoMPulsation, lCoM, ldCoM, lddCoM);
+    sine(t, m_LeftFoot0, lFootAmplitude, lFootPulsation, lLeft, ldLeft,
+         lddLeft);
+    sine(t + 0.5, m_RightFoot0, lFootAmplitude, lFootPulsation, lRight,
+         ldRight, lddRight);
+
+    q = m_PR->currentRPYConfiguration();
+    v.setZero();
+    a.setZero();
+    m_ComAndFootRealization->ComputePostureForGivenCoMAndFeetPosture(
+        lCoM, ldCoM, lddCoM, lLeft, ldLeft, lddLeft, lRight, ldRight,
+        lddRight, q, v, a, 0);
+  }
+
+  /*! x0 + A (1 - cos(w t)) and its derivatives. */
+  static void sine(double t, const Eigen::VectorXd &x0,
+                   const Eigen::VectorXd &A, const Eigen::VectorXd &w,
+                   Eigen::VectorXd &x, Eigen::VectorXd &dx,
+                   Eigen::VectorXd &ddx) {
+    for (Eigen::Index i = 0; i < x0.size(); i++) {
+      x[i] = x0[i] + A[i] * (1.0 - cos(w[i] * t));
+      dx[i] = A[i] * w[i] * sin(w[i] * t);
+      ddx[i] = A[i] * w[i] * w[i] * cos(w[i] * t);
+    }
+  }
+
+  void chooseTestProfile() {}
+  void generateEvent() {}
+
+  Eigen::VectorXd m_CoM0 = Eigen::VectorXd(6);
+  Eigen::VectorXd m_LeftFoot0 = Eigen::VectorXd(5);
+  Eigen::VectorXd m_RightFoot0 = Eigen::VectorXd(5);
+};
+
+int main(int argc, char *argv[]) {
+  string TestName("TestLegJointRates");
+  TestLegJointRates aTest(argc, argv, TestName);
+  if (!aTest.init())
+    return 1;
+  if (!aTest.doTest(cout)) {
+    cerr << "Leg joint rates: fail" << endl;
+    return 1;
+  }
+  cout << "Leg joint rates: ok" << endl;
+  return 0;
+}
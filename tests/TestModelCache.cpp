@@ -0,0 +1,163 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestModelCache.cpp
+  \brief Check that a robot saved in the model cache and reloaded has
+  the same dimensions, frames, limbs and inverse kinematics as the
+  robot parsed from its description, and that a corrupted cache is
+  rejected.
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "TestObject.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+using namespace PatternGeneratorJRL::TestSuite;
+
+class TestModelCache : public TestObject {
+public:
+  TestModelCache(int argc, char *argv[], string &aString)
+      : TestObject(argc, argv, aString) {}
+
+  bool doTest(ostream &os) {
+    string lPrefix("/tmp/TestModelCache");
+    vector<string> lFiles;
+    lFiles.push_back(m_URDFPath);
+    lFiles.push_back(m_SRDFPath);
+    std::uint64_t lKey = PinocchioRobot::cacheKey(lFiles);
+    if (!m_PR->saveCache(lPrefix, lKey)) {
+      os << "saveCache: unable to write " << lPrefix << endl;
+      return false;
+    }
+    bool ok = compare(lPrefix, lKey, os);
+
+    if (PinocchioRobot::loadModelFromCache(lPrefix, lKey + 1, m_Model)) {
+      os << "loadModelFromCache: cache loaded with another key" << endl;
+      ok = false;
+    }
+
+    // Change the last byte of the model.
+    {
+      fstream aof((lPrefix + ".model").c_str(),
+                  ios::in | ios::out | ios::binary);
+      aof.seekg(-1, ios::end);
+      char lByte = (char)aof.get();
+      aof.seekp(-1, ios::end);
+      aof.put((char)(lByte ^ 0x5a));
+    }
+    pinocchio::Model lModel;
+    if (PinocchioRobot::loadModelFromCache(lPrefix, lKey, lModel)) {
+      os << "loadModelFromCache: corrupted model loaded" << endl;
+      ok = false;
+    }
+
+    remove((lPrefix + ".model").c_str());
+    remove((lPrefix + ".meta").c_str());
+    return ok;
+  }
+
+protected:
+  /*! Reload the cache and compare it with m_PR. */
+  bool compare(const string &aPrefix, std::uint64_t aKey, ostream &os) {
+    if (!PinocchioRobot::loadModelFromCache(aPrefix, aKey, m_Model)) {
+      os << "loadModelFromCache: unable to read " << aPrefix << endl;
+      return false;
+    }
+    pinocchio::Data lData(m_Model);
+    PinocchioRobot lPR;
+    if (!lPR.initializeFromCache(aPrefix, aKey, &m_Model, &lData)) {
+      os << "initializeFromCache: unable to read " << aPrefix << endl;
+      return false;
+    }
+
+    bool ok = true;
+    if ((m_Model.nq != m_robotModel.nq) || (m_Model.nv != m_robotModel.nv) ||
+        (m_Model.nframes != m_robotModel.nframes)) {
+      os << "nq, nv or number of frames differ" << endl;
+      ok = false;
+    }
+    for (std::size_t i = 0; ok && (i < m_robotModel.frames.size()); i++) {
+      const string &aName = m_robotModel.frames[i].name;
+      if (!m_Model.existFrame(aName) || (m_Model.getFrameId(aName) != i)) {
+        os << "frame " << aName << " has another index" << endl;
+        ok = false;
+      }
+    }
+    if ((lPR.waist() != m_PR->waist()) || (lPR.chest() != m_PR->chest()) ||
+        (lPR.leftFoot()->associatedAnkle !=
+         m_PR->leftFoot()->associatedAnkle) ||
+        (lPR.rightFoot()->associatedAnkle !=
+         m_PR->rightFoot()->associatedAnkle)) {
+      os << "limbs differ" << endl;
+      ok = false;
+    }
+    if (!ok)
+      return false;
+
+    // Inverse kinematics of the legs in the initial posture, with the
+    // ankles lowered by 2cm.
+    m_PR->computeForwardKinematics();
+    pinocchio::Data *lPRData = m_PR->Data();
+    Eigen::Matrix4d lWaistPose =
+        lPRData->oMi[m_PR->waist()].toHomogeneousMatrix();
+    pinocchio::JointIndex lAnkles[2] = {m_PR->leftFoot()->associatedAnkle,
+                                        m_PR->rightFoot()->associatedAnkle};
+    for (unsigned int k = 0; k < 2; k++) {
+      Eigen::Matrix4d lAnklePose =
+          lPRData->oMi[lAnkles[k]].toHomogeneousMatrix();
+      lAnklePose(2, 3) -= 0.02;
+      Eigen::VectorXd lq(6), lCachedq(6);
+      m_PR->ComputeSpecializedInverseKinematics(
+          m_PR->waist(), lAnkles[k], lWaistPose, lAnklePose, lq);
+      lPR.ComputeSpecializedInverseKinematics(lPR.waist(), lAnkles[k],
+                                              lWaistPose, lAnklePose,
+                                              lCachedq);
+      if ((lq - lCachedq).cwiseAbs().maxCoeff() > 1e-12) {
+        os << "inverse kinematics of leg " << k << " differ" << endl;
+        ok = false;
+      }
+    }
+    return ok;
+  }
+
+  void chooseTestProfile() {}
+  void generateEvent() {}
+
+  /*! Model read from the cache. */
+  pinocchio::Model m_Model;
+};
+
+int main(int argc, char *argv[]) {
+  string TestName("TestModelCache");
+  TestModelCache aTest(argc, argv, TestName);
+  if (!aTest.init())
+    return 1;
+  if (!aTest.doTest(cout)) {
+    cerr << "Model cache: fail" << endl;
+    return 1;
+  }
+  cout << "Model cache: ok" << endl;
+  return 0;
+}
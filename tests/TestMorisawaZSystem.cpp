@@ -0,0 +1,115 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestMorisawaZSystem.cpp
+  \brief Check that Z of AnalyticalMorisawaCompact stays within its
+  bandwidths, and that the banded solve of the Z system agrees with a
+  dense LU decomposition.
+*/
+
+#include <cmath>
+#include <iostream>
+
+#include "TestObject.hh"
+#include <ZMPRefTrajectoryGeneration/AnalyticalMorisawaCompact.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+using namespace PatternGeneratorJRL::TestSuite;
+
+/*! Access to the Z system of AnalyticalMorisawaCompact. */
+class ZSystem : public AnalyticalMorisawaCompact {
+public:
+  ZSystem(SimplePluginManager *lSPM, PinocchioRobot *aPR)
+      : AnalyticalMorisawaCompact(lSPM, aPR) {}
+
+  /*! Build Z for NbOfIntervals intervals, with varying durations
+    and heights of the CoM. */
+  void build(int NbOfIntervals) {
+    m_NumberOfIntervals = NbOfIntervals;
+    m_DeltaTj.resize(NbOfIntervals);
+    m_Omegaj.resize(NbOfIntervals);
+    m_PolynomialDegrees.resize(NbOfIntervals);
+    for (int i = 0; i < NbOfIntervals; i++) {
+      m_DeltaTj[i] = 0.1 + 0.7 * ((i * 37) % 11) / 11.0;
+      m_Omegaj[i] = sqrt(9.81 / (0.8 + 0.01 * (i % 3)));
+      m_PolynomialDegrees[i] = ((i == 0) || (i == NbOfIntervals - 1)) ? 4 : 3;
+    }
+    BuildingTheZMatrix();
+    ResetTheResolutionOfThePolynomial();
+  }
+
+  /*! Solve Z y = w with the banded decomposition, and return the
+    relative difference with the dense solution. */
+  double compare(const Eigen::VectorXd &w) {
+    m_w = w;
+    ComputePolynomialWeights2();
+    Eigen::VectorXd lDense = m_Z.partialPivLu().solve(w);
+    return (m_y - lDense).norm() / lDense.norm();
+  }
+};
+
+class TestMorisawaZSystem : public TestObject {
+public:
+  TestMorisawaZSystem(int argc, char *argv[], string &aString)
+      : TestObject(argc, argv, aString) {}
+
+  bool doTest(ostream &os) {
+    ZSystem aZSystem(m_SPM, m_PR);
+    bool ok = true;
+    for (int lNbOfIntervals = 2; lNbOfIntervals <= 40; lNbOfIntervals++) {
+      aZSystem.build(lNbOfIntervals);
+      if (!aZSystem.ZIsBanded()) {
+        os << lNbOfIntervals << " intervals: Z is not banded" << endl;
+        ok = false;
+        continue;
+      }
+      Eigen::Index n = 2 * lNbOfIntervals + 6;
+      // The second solve reuses the decomposition of the first one.
+      double lError =
+          max(aZSystem.compare(Eigen::VectorXd::LinSpaced(n, -1.0, 2.0)),
+              aZSystem.compare(Eigen::VectorXd::Random(n)));
+      if (lError > 1e-8) {
+        os << lNbOfIntervals << " intervals: relative error " << lError
+           << endl;
+        ok = false;
+      }
+    }
+    return ok;
+  }
+
+protected:
+  void chooseTestProfile() {}
+  void generateEvent() {}
+};
+
+int main(int argc, char *argv[]) {
+  string TestName("TestMorisawaZSystem");
+  TestMorisawaZSystem aTest(argc, argv, TestName);
+  if (!aTest.init())
+    return 1;
+  if (!aTest.doTest(cout)) {
+    cerr << "Z system: fail" << endl;
+    return 1;
+  }
+  cout << "Z system: ok" << endl;
+  return 0;
+}
@@ -473,6 +473,9 @@ protected:
       m_DebugPR->zeroMomentumPoint(zmpmb);
       m_err_zmp_x.push_back(zmpmb[0] - m_OneStep.m_ZMPTarget(0));
       m_err_zmp_y.push_back(zmpmb[1] - m_OneStep.m_ZMPTarget(1));
+      compareZMPMBEngines(currentConfiguration, m_CurrentVelocity,
+                          m_CurrentAcceleration);
+      compareLegsInverseKinematics();
 
       ++iteration;
 
@@ -532,6 +535,7 @@ protected:
 
   void startHRP2OnLineWalking(PatternGeneratorInterface &aPGI) {
     CommonInitialization(aPGI);
+    parseCommands(aPGI);
 
     {
       istringstream strm2(":SetAlgoForZmpTrajectory Naveau");
@@ -584,6 +588,7 @@ protected:
 
   void startTalosOnLineWalking(PatternGeneratorInterface &aPGI) {
     CommonInitialization(aPGI);
+    parseCommands(aPGI);
 
     {
       istringstream strm2(":setDSFeetDistance 0.162");
@@ -711,6 +716,24 @@ int PerformTests(int argc, char *argv[]) {
     ODEBUG("Index detected: " << indexProfile);
   }
 
+  // Tests named after an option compare it with the default behaviour.
+  const OptionVariant *aVariant = findOptionVariant(TestName);
+  if (aVariant != 0) {
+    try {
+      if (!runOptionVariant<TestNaveau2015>(argc, argv, TestName,
+                                            TestProfiles[indexProfile],
+                                            *aVariant, std::cout)) {
+        cout << "Failed test " << aVariant->Suffix << endl;
+        return -1;
+      } else
+        cout << "Passed test " << aVariant->Suffix << endl;
+    } catch (const char *astr) {
+      cerr << "Failed on following error " << astr << std::endl;
+      return -1;
+    }
+    return 0;
+  }
+
   TestNaveau2015 aTN2015(argc, argv, TestName, TestProfiles[indexProfile]);
   if (!aTN2015.init()) {
     cout << "pb on init" << endl;
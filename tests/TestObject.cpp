@@ -25,6 +25,7 @@
  * Olivier Stasse
  */
 // System include for files
+#include <cstdlib>
 #include <fstream>
 // System include for floating point errors
 #include <fenv.h>
@@ -71,6 +72,19 @@ TestObject::TestObject(int argc, char *argv[], string &aTestName,
   m_DebugZMP2 = false;
   m_TestProfile = 0;
 
+  m_NbZMPMBSamples = 0;
+  m_RNEAZMPMBTime = 0.0;
+  m_CentroidalZMPMBTime = 0.0;
+  m_MaxZMPMBDistance = 0.0;
+  m_PinoZMPMBTime = 0.0;
+  m_MaxPinoZMPMBDistance = 0.0;
+  m_NbLegsIKSamples = 0;
+  m_MaxLegsIKDifference = 0.0;
+
+  m_ReferenceFile = m_TestName + "TestFGPI.datref";
+  m_Tolerance = 1e-6;
+  m_EventDelay = 0;
+
   /*! Extract options and fill in members. */
   getOptions(argc, argv, m_URDFPath, m_SRDFPath, m_TestProfile);
 
@@ -276,12 +290,15 @@ void TestObject::CreateAndInitializeHumanoidRobot(std::string &URDFFile,
                                                   std::string &SRDFFile,
                                                   PinocchioRobot *&aPR,
                                                   PinocchioRobot *&aDebugPR) {
-  // Creating the humanoid robot via the URDF.
-  //      try{
-  pinocchio::urdf::buildModel(URDFFile, pinocchio::JointModelFreeFlyer(),
-                              m_robotModel);
-  m_robotData = new pinocchio::Data(m_robotModel);
-  m_DebugRobotData = new pinocchio::Data(m_robotModel);
+  // The parsed model is cached in the files given by
+  // JRL_WALKGEN_MODEL_CACHE, if this variable is set.
+  const char *lCache = getenv("JRL_WALKGEN_MODEL_CACHE");
+  std::vector<std::string> lFiles;
+  lFiles.push_back(URDFFile);
+  lFiles.push_back(SRDFFile);
+  std::uint64_t lKey = PinocchioRobot::cacheKey(lFiles);
+  bool lCached = (lCache != 0) &&
+                 PinocchioRobot::loadModelFromCache(lCache, lKey, m_robotModel);
 
   if ((aPR == 0) || (aDebugPR == 0)) {
     if (aPR != 0)
@@ -293,15 +310,44 @@ void TestObject::CreateAndInitializeHumanoidRobot(std::string &URDFFile,
     aDebugPR = new PinocchioRobot();
   }
 
-  // initialize the model and data of the humanoid robot
-  aPR->initializeRobotModelAndData(&m_robotModel, m_robotData);
-  aDebugPR->initializeRobotModelAndData(&m_robotModel, m_DebugRobotData);
+  if (lCached) {
+    m_robotData = new pinocchio::Data(m_robotModel);
+    m_DebugRobotData = new pinocchio::Data(m_robotModel);
+    lCached =
+        aPR->initializeFromCache(lCache, lKey, &m_robotModel, m_robotData) &&
+        aDebugPR->initializeFromCache(lCache, lKey, &m_robotModel,
+                                      m_DebugRobotData);
+    if (!lCached) {
+      // Parse the robot description instead.
+      std::cerr << "Unable to use the model cache " << lCache << std::endl;
+      delete m_robotData;
+      delete m_DebugRobotData;
+      delete aPR;
+      delete aDebugPR;
+      aPR = new PinocchioRobot();
+      aDebugPR = new PinocchioRobot();
+      m_robotModel = pinocchio::Model();
+    }
+  }
+
+  if (!lCached) {
+    // Creating the humanoid robot via the URDF.
+    pinocchio::urdf::buildModel(URDFFile, pinocchio::JointModelFreeFlyer(),
+                                m_robotModel);
+    m_robotData = new pinocchio::Data(m_robotModel);
+    m_DebugRobotData = new pinocchio::Data(m_robotModel);
+    aPR->initializeRobotModelAndData(&m_robotModel, m_robotData);
+    aDebugPR->initializeRobotModelAndData(&m_robotModel, m_DebugRobotData);
+  }
 
   m_conf.resize(m_robotModel.nq);
   // Parsing the SRDF file to initialize
   // the starting configuration and the robot specifities
   InitializeRobotWithSRDF(*aPR, SRDFFile);
   InitializeRobotWithSRDF(*aDebugPR, SRDFFile);
+
+  if ((lCache != 0) && !lCached)
+    aPR->saveCache(lCache, lKey);
 }
 
 void TestObject::InitializeRobotWithSRDF(PinocchioRobot &aPR,
@@ -461,6 +507,99 @@ void TestObject::fillInDebugFiles() {
     m_OneStep.fillInDebugFile();
 }
 
+void TestObject::compareZMPMBEngines(Eigen::VectorXd &conf,
+                                     Eigen::VectorXd &vel,
+                                     Eigen::VectorXd &acc) {
+  Eigen::Vector3d zmpmbRNEA, zmpmbCentroidal;
+  struct timeval begin, end;
+
+  gettimeofday(&begin, 0);
+  m_DebugPR->computeInverseDynamics(conf, vel, acc);
+  m_DebugPR->zeroMomentumPoint(zmpmbRNEA);
+  gettimeofday(&end, 0);
+  m_RNEAZMPMBTime += (double)(end.tv_sec - begin.tv_sec) * 1e6 +
+                     (double)(end.tv_usec - begin.tv_usec);
+
+  gettimeofday(&begin, 0);
+  m_DebugPR->computeCentroidalDynamics(conf, vel, acc);
+  m_DebugPR->centroidalZeroMomentumPoint(zmpmbCentroidal);
+  gettimeofday(&end, 0);
+  m_CentroidalZMPMBTime += (double)(end.tv_sec - begin.tv_sec) * 1e6 +
+                           (double)(end.tv_usec - begin.tv_usec);
+
+  double lDistance = (zmpmbRNEA - zmpmbCentroidal).norm();
+  if (lDistance > m_MaxZMPMBDistance)
+    m_MaxZMPMBDistance = lDistance;
+
+  // The RPY versions take the joints from the last configuration
+  // given to the robot, the converted state uses the same ones.
+  Eigen::Vector3d zmpmbPino;
+  m_DebugPR->RPYToPinocchioConfiguration(conf, m_PinoConfiguration);
+  Eigen::Index lNbJoints = m_PinoConfiguration.size() -
+                           (Eigen::Index)m_DebugPR->getFreeFlyerSize();
+  m_PinoConfiguration.tail(lNbJoints) =
+      m_DebugPR->currentPinoConfiguration().tail(lNbJoints);
+  gettimeofday(&begin, 0);
+  m_DebugPR->computeInverseDynamicsFromPinocchio(m_PinoConfiguration, vel,
+                                                 acc);
+  m_DebugPR->zeroMomentumPoint(zmpmbPino);
+  gettimeofday(&end, 0);
+  m_PinoZMPMBTime += (double)(end.tv_sec - begin.tv_sec) * 1e6 +
+                     (double)(end.tv_usec - begin.tv_usec);
+
+  lDistance = (zmpmbRNEA - zmpmbPino).norm();
+  if (lDistance > m_MaxPinoZMPMBDistance)
+    m_MaxPinoZMPMBDistance = lDistance;
+  m_NbZMPMBSamples++;
+}
+
+void TestObject::compareLegsInverseKinematics() {
+  pinocchio::Data *lData = m_DebugPR->Data();
+  pinocchio::JointIndex lWaist = m_DebugPR->waist();
+  pinocchio::JointIndex lAnkles[2] = {m_DebugPR->leftFoot()->associatedAnkle,
+                                      m_DebugPR->rightFoot()->associatedAnkle};
+
+  Eigen::Matrix4d lWaistPose = lData->oMi[lWaist].toHomogeneousMatrix();
+  Eigen::Matrix4d lAnklePoses[2];
+  PRLegsBatch lLegs;
+  lLegs.resize(2);
+  for (unsigned int k = 0; k < 2; k++) {
+    lAnklePoses[k] = lData->oMi[lAnkles[k]].toHomogeneousMatrix();
+    lLegs.set(k, (k == 0) ? 1 : -1, lWaistPose, lAnklePoses[k]);
+  }
+
+  Eigen::Array<double, Eigen::Dynamic, 6> lBatchq;
+  Eigen::Array<bool, Eigen::Dynamic, 1> lFeasible;
+  if (!m_DebugPR->ComputeLegsInverseKinematics(lLegs, lBatchq, lFeasible))
+    return;
+
+  Eigen::VectorXd lq(6);
+  for (unsigned int k = 0; k < 2; k++) {
+    m_DebugPR->ComputeSpecializedInverseKinematics(
+        lWaist, lAnkles[k], lWaistPose, lAnklePoses[k], lq);
+    double lDifference =
+        (lq.array().transpose() - lBatchq.row(k)).abs().maxCoeff();
+    if (lDifference > m_MaxLegsIKDifference)
+      m_MaxLegsIKDifference = lDifference;
+    m_NbLegsIKSamples++;
+  }
+}
+
+void TestObject::displayZMPMBEnginesComparison(std::ostream &os) {
+  os << "ZMP multibody on " << m_NbZMPMBSamples << " samples:" << endl;
+  os << "inverse dynamics: " << m_RNEAZMPMBTime / (double)m_NbZMPMBSamples
+     << " us per sample" << endl;
+  os << "centroidal dynamics: "
+     << m_CentroidalZMPMBTime / (double)m_NbZMPMBSamples << " us per sample"
+     << endl;
+  os << "maximal distance between both: " << m_MaxZMPMBDistance << " m"
+     << endl;
+  os << "inverse dynamics from the pinocchio state: "
+     << m_PinoZMPMBTime / (double)m_NbZMPMBSamples << " us per sample, "
+     << "maximal distance to the RPY version: " << m_MaxPinoZMPMBDistance
+     << " m" << endl;
+}
+
 void TestObject::fillInDebugFilesFull() {
   if (m_DebugFGPIFull) {
     analyticalInverseKinematics(m_CurrentConfiguration, m_CurrentVelocity,
@@ -502,8 +641,31 @@ void TestObject::fillInDebugFilesFull() {
   }
 }
 
+void TestObject::addCommand(const std::string &aCommand) {
+  m_Commands.push_back(aCommand);
+}
+
+void TestObject::setReferenceFile(const std::string &aFileName,
+                                  double aTolerance) {
+  m_ReferenceFile = aFileName;
+  m_Tolerance = aTolerance;
+}
+
+void TestObject::setEventDelay(unsigned int aNbIterations) {
+  m_EventDelay = aNbIterations;
+}
+
+void TestObject::parseCommands(PatternGeneratorInterface &aPGI) {
+  for (std::size_t i = 0; i < m_Commands.size(); i++) {
+    istringstream strm(m_Commands[i]);
+    aPGI.ParseCmd(strm);
+  }
+}
+
 bool TestObject::compareDebugFiles() {
   bool SameFile = false;
+  if (m_DebugFGPI && m_ReferenceFile.empty())
+    return true;
   if (m_DebugFGPI) {
     SameFile = true;
     ifstream alif;
@@ -521,8 +683,7 @@ bool TestObject::compareDebugFiles() {
     }
 
     ifstream arif;
-    aFileName = m_TestName;
-    aFileName += "TestFGPI.datref";
+    aFileName = m_ReferenceFile;
     arif.open(aFileName.c_str(), ifstream::in);
     ODEBUG("ReportRef:" << aFileName);
 
@@ -573,7 +734,7 @@ bool TestObject::compareDebugFiles() {
         break;
 
       for (unsigned int i = 0; i < NB_OF_FIELDS; i++) {
-        if (fabs(LocalInput[i] - ReferenceInput[i]) >= 1e-6) {
+        if (fabs(LocalInput[i] - ReferenceInput[i]) >= m_Tolerance) {
           finalreport = false;
           ostringstream oss;
           oss << "l: " << nblines << " col:" << i
@@ -678,9 +839,18 @@ bool TestObject::doTest(ostream &os) {
   lProfileOutput += "TimeProfile.dat";
   m_clock.writeBuffer(lProfileOutput);
   m_clock.displayStatistics(os, m_OneStep);
+  if (m_NbZMPMBSamples > 0)
+    displayZMPMBEnginesComparison(os);
+  bool lLegsIK = true;
+  if (m_NbLegsIKSamples > 0) {
+    os << "legs inverse kinematics on " << m_NbLegsIKSamples
+       << " legs, maximal difference between the batched and the single "
+       << "leg versions: " << m_MaxLegsIKDifference << " rad" << endl;
+    lLegsIK = (m_MaxLegsIKDifference < 1e-9);
+  }
 
   // Compare debugging files
-  return compareDebugFiles();
+  return compareDebugFiles() && lLegsIK;
 }
 
 void TestObject::setDirectorySeqplay(std::string &aDirectory) {
@@ -40,6 +40,7 @@
 #include "CommonTools.hh"
 #include <ostream>
 #include <string>
+#include <vector>
 
 #include "DumpReferencesObjects.hh"
 #include "MotionGeneration/ComAndFootRealizationByGeometry.hh"
@@ -73,6 +74,20 @@ public:
   /*! \brief Set directory for OpenHRP seqplay */
   void setDirectorySeqplay(std::string &aDirectory);
 
+  /*! \brief Add a command parsed after the common initialization
+    of the test profile. */
+  void addCommand(const std::string &aCommand);
+
+  /*! \brief Compare the debug file with aFileName up to aTolerance.
+    No comparison is done if aFileName is empty. */
+  void setReferenceFile(const std::string &aFileName, double aTolerance);
+
+  /*! \brief Delay the events of the test profile by aNbIterations. */
+  void setEventDelay(unsigned int aNbIterations);
+
+  /*! \brief Pattern generator of the test. */
+  PatternGeneratorInterface &getPatternGeneratorInterface() { return *m_PGI; }
+
 protected:
   /*! \brief Choose which test to perform. */
   virtual void chooseTestProfile() = 0;
@@ -80,6 +95,15 @@ protected:
   /*! \brief Generate events. */
   virtual void generateEvent() = 0;
 
+  /*! \brief Parse the commands given by addCommand. */
+  void parseCommands(PatternGeneratorInterface &aPGI);
+
+  /*! \brief Commands given by addCommand. */
+  std::vector<std::string> m_Commands;
+
+  /*! \brief Delay of the events of the test profile, in iterations. */
+  unsigned int m_EventDelay;
+
   /*! \brief Profile of the test to perform. */
   unsigned int m_TestProfile;
 
@@ -200,11 +224,51 @@ protected:
   virtual void fillInDebugFiles();
   virtual void fillInDebugFilesFull();
 
+  /*! \brief Compute the ZMP multibody of m_DebugPR in the given state
+    from the inverse dynamics and from the centroidal dynamics,
+    and accumulate the timings and the distance between both.
+    The inverse dynamics is also computed from the state converted
+    once to the pinocchio format. */
+  void compareZMPMBEngines(Eigen::VectorXd &conf, Eigen::VectorXd &vel,
+                           Eigen::VectorXd &acc);
+
+  /*! \brief Display the statistics of compareZMPMBEngines. */
+  void displayZMPMBEnginesComparison(std::ostream &os);
+
+  /*! \brief Statistics of compareZMPMBEngines, times in microseconds.
+    @{ */
+  unsigned long int m_NbZMPMBSamples;
+  double m_RNEAZMPMBTime;
+  double m_CentroidalZMPMBTime;
+  double m_MaxZMPMBDistance;
+  double m_PinoZMPMBTime;
+  double m_MaxPinoZMPMBDistance;
+  Eigen::VectorXd m_PinoConfiguration;
+  /*! @} */
+
+  /*! \brief Solve the inverse kinematics of both legs of m_DebugPR,
+    from the waist and ankles placements of its last kinematics,
+    with the batched and the single leg versions, and accumulate the
+    largest difference between both. doTest() fails if it exceeds
+    1e-9 rad. */
+  void compareLegsInverseKinematics();
+
+  /*! \brief Statistics of compareLegsInverseKinematics, in radians.
+    @{ */
+  unsigned long int m_NbLegsIKSamples;
+  double m_MaxLegsIKDifference;
+  /*! @} */
+
   DumpReferencesObjects m_DumpReferencesObjects;
 
   /*! \brief Compare debug files with references. */
   bool compareDebugFiles();
 
+  /*! \brief Reference of the debug file, and largest difference
+    allowed with it. */
+  std::string m_ReferenceFile;
+  double m_Tolerance;
+
   /*! \brief Set map from URDF joint index to OpenHRP index */
   void setFromURDFToOpenHRP(std::vector<unsigned int> &vfromURDFToOpenHRP);
 
@@ -361,6 +425,40 @@ public:
     aPGI.ParseCmd(strm2);
   }
 }; /* end of TestObject class */
+
+/*! \brief Run the test TestName twice: once with the setup of aVariant
+  only, and once with its option too. The debug file of the second run
+  is compared with the one of the first run, and the check of aVariant
+  is done on the second one. */
+template <class Test>
+bool runOptionVariant(int argc, char *argv[], const std::string &TestName,
+                      int TestProfile, const OptionVariant &aVariant,
+                      std::ostream &os) {
+  std::string lReferenceName = TestName + "Reference";
+  {
+    Test aReference(argc, argv, lReferenceName, TestProfile);
+    if (aVariant.Setup != 0)
+      aReference.addCommand(aVariant.Setup);
+    aReference.setReferenceFile("", 0.0);
+    aReference.setEventDelay(aVariant.EventDelay);
+    aReference.init();
+    if (!aReference.doTest(os))
+      return false;
+  }
+
+  std::string lName = TestName;
+  Test aTest(argc, argv, lName, TestProfile);
+  if (aVariant.Setup != 0)
+    aTest.addCommand(aVariant.Setup);
+  aTest.addCommand(aVariant.Option);
+  aTest.setReferenceFile(lReferenceName + "TestFGPI.dat", aVariant.Tolerance);
+  aTest.init();
+  if (!aTest.doTest(os))
+    return false;
+  if (aVariant.Check != 0)
+    return aVariant.Check(aTest.getPatternGeneratorInterface(), os);
+  return true;
+}
 } // namespace TestSuite
 } // namespace PatternGeneratorJRL
 #endif /* _TEST_OBJECT_PATTERN_GENERATOR_UTESTING_H_*/
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestPhaseCache.cpp
+  \brief Check that the objective built by GeneratorVelRef from its cache
+  of support phases is the one built from scratch.
+*/
+
+#include <iostream>
+
+#include "TestObject.hh"
+#include <ZMPRefTrajectoryGeneration/generator-vel-ref.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+using namespace PatternGeneratorJRL::TestSuite;
+
+/*! Access to the selection matrices of GeneratorVelRef. */
+class PhaseCacheGenerator : public GeneratorVelRef {
+public:
+  PhaseCacheGenerator(SimplePluginManager *lSPM, RigidBodySystem *Robot,
+                      RelativeFeetInequalities *RFI, unsigned N, double T)
+      : GeneratorVelRef(lSPM, &m_Data, Robot, RFI) {
+    NbPrwSamplings(N);
+    SamplingPeriodPreview(T);
+    SamplingPeriodControl(0.005);
+    ComHeight(0.814);
+    initialize_matrices();
+    Ponderation(1.0, INSTANT_VELOCITY);
+    Ponderation(0.000001, COP_CENTERING);
+    Ponderation(0.00001, JERK_MIN);
+    m_Data.State().Ref.Global.X_vec.setConstant(N, 0.2);
+    m_Data.State().Ref.Global.Y_vec.setConstant(N, 0.05);
+  }
+
+  /*! Build the variant part of the objective in Pb. When Fresh is true,
+    the cached phases are dropped before. */
+  void build(QPProblem &Pb,
+             const RingBuffer<support_state_t> &SupportStates_deq,
+             const com_t &CoM, bool Fresh) {
+    if (Fresh)
+      Ponderation(m_Data.Objective(COP_CENTERING).weight, COP_CENTERING);
+    m_Data.CoM(CoM);
+    generate_selection_matrices(SupportStates_deq);
+    Pb.reset();
+    update_problem(Pb, SupportStates_deq);
+  }
+
+  const Eigen::MatrixXd &V() const { return m_Data.State().V; }
+
+private:
+  IntermedQPMat m_Data;
+};
+
+class TestPhaseCache : public TestObject {
+public:
+  TestPhaseCache(int argc, char *argv[], string &aString)
+      : TestObject(argc, argv, aString) {}
+
+  bool doTest(ostream &os) {
+    const unsigned N = 16;
+    const double T = 0.1;
+
+    SupportFSM aFSM;
+    aFSM.StepPeriod(0.8);
+    RigidBodySystem aRobot(m_SPM, m_PR, &aFSM);
+    aRobot.Mass(m_PR->mass());
+    aRobot.NbSamplingsPreviewed(N);
+    aRobot.SamplingPeriodSim(T);
+    aRobot.SamplingPeriodAct(0.005);
+    aRobot.CoMHeight(0.814);
+    aRobot.multiBody(false);
+    aRobot.initialize();
+
+    RelativeFeetInequalities aRFI(m_SPM, m_PR);
+    PhaseCacheGenerator aCached(m_SPM, &aRobot, &aRFI, N, T);
+    PhaseCacheGenerator aFresh(m_SPM, &aRobot, &aRFI, N, T);
+
+    QPProblem CachedPb, FreshPb;
+    bool ok = true;
+    // A step lasts 8 samples: from the 9th cycle on, the phases of
+    // aCached are found in its cache.
+    for (unsigned Cycle = 0; Cycle < 32; Cycle++) {
+      unsigned Offset = Cycle % 8;
+      RingBuffer<support_state_t> SupportStates_deq(N + 1);
+      SupportStates_deq[0].X = 0.01 * Cycle;
+      SupportStates_deq[0].Y = ((Cycle / 8) % 2) ? 0.095 : -0.095;
+      for (unsigned i = 1; i <= N; i++) {
+        support_state_t &Support = SupportStates_deq[i];
+        Support.Phase = SS;
+        Support.StepNumber = (i + Offset) / 8;
+        Support.StateChanged = ((i + Offset) % 8 == 0);
+        Support.X = (Support.StepNumber == 0) ? SupportStates_deq[0].X : 0.0;
+        Support.Y = (Support.StepNumber == 0) ? SupportStates_deq[0].Y : 0.0;
+      }
+      com_t CoM;
+      CoM.x << 0.01 * Cycle, 0.1, 0.0;
+      CoM.y << 0.02 * Offset, -0.05, 0.1;
+
+      aCached.build(CachedPb, SupportStates_deq, CoM, false);
+      aFresh.build(FreshPb, SupportStates_deq, CoM, true);
+
+      unsigned n = FreshPb.NbVariables();
+      double Error = 1.0;
+      if ((CachedPb.NbVariables() == n) &&
+          (aCached.V().cols() == aFresh.V().cols())) {
+        Error = (aCached.V() - aFresh.V()).norm();
+        Error += (CachedPb.matrix_view(MATRIX_Q, 0, 0, n, n) -
+                  FreshPb.matrix_view(MATRIX_Q, 0, 0, n, n))
+                     .norm();
+        Error += (CachedPb.vector_view(VECTOR_D, 0, n) -
+                  FreshPb.vector_view(VECTOR_D, 0, n))
+                     .norm();
+      }
+      if (Error > 1e-12) {
+        os << "Cycle " << Cycle << ": cached and fresh objectives differ by "
+           << Error << endl;
+        ok = false;
+      }
+    }
+    return ok;
+  }
+
+protected:
+  void chooseTestProfile() {}
+  void generateEvent() {}
+};
+
+int main(int argc, char *argv[]) {
+  string TestName("TestPhaseCache");
+  TestPhaseCache aTest(argc, argv, TestName);
+  if (!aTest.init())
+    return 1;
+  if (!aTest.doTest(cout)) {
+    cerr << "Phase cache: fail" << endl;
+    return 1;
+  }
+  cout << "Phase cache: ok" << endl;
+  return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestPinocchioRobotPool.cpp
+  \brief Acquire and release the robots of a pool from several threads
+  at once. Check that a robot is never given to two threads, that the
+  clones compute the ZMP of the prototype, and that the pool does not
+  clone more robots than there are threads.
+*/
+
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "TestObject.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+using namespace PatternGeneratorJRL::TestSuite;
+
+class TestPinocchioRobotPool : public TestObject {
+public:
+  TestPinocchioRobotPool(int argc, char *argv[], string &aString)
+      : TestObject(argc, argv, aString), m_NbErrors(0) {}
+
+  bool doTest(ostream &os) {
+    const unsigned int NbThreads = 8;
+    Eigen::Index nv = m_PR->numberVelDof();
+    m_q.resize(nv);
+    m_v.resize(nv);
+    m_a.resize(nv);
+    for (Eigen::Index i = 0; i < nv; i++) {
+      m_v[i] = sin(0.37 * (double)(i + 1));
+      m_a[i] = cos(0.53 * (double)(i + 1));
+      m_q[i] = 0.0;
+    }
+    m_q[2] = 1.0;
+    m_q.tail(nv - 6) = m_HalfSitting;
+    m_PR->computeInverseDynamics(m_q, m_v, m_a);
+    m_PR->zeroMomentumPoint(m_ZMP);
+
+    PinocchioRobotPool aPool(*m_PR, 2);
+    m_Pool = &aPool;
+    vector<thread> lThreads;
+    for (unsigned int k = 0; k < NbThreads; k++)
+      lThreads.push_back(thread(&TestPinocchioRobotPool::cycle, this, 100));
+    for (unsigned int k = 0; k < NbThreads; k++)
+      lThreads[k].join();
+
+    bool ok = (m_NbErrors == 0);
+    if (!ok)
+      os << m_NbErrors << " errors in the acquisition cycles" << endl;
+    size_t lSize = aPool.size();
+    if ((lSize < 2) || (lSize > NbThreads)) {
+      os << lSize << " robots cloned for " << NbThreads << " threads" << endl;
+      ok = false;
+    }
+
+    // Every robot is free again, and the pool gives distinct ones.
+    set<PinocchioRobot *> lRobots;
+    for (size_t k = 0; k < lSize; k++)
+      lRobots.insert(aPool.acquire());
+    if ((lRobots.size() != lSize) || (aPool.size() != lSize) ||
+        (lRobots.count(0) != 0)) {
+      os << "the released robots are not all free and distinct" << endl;
+      ok = false;
+    }
+    for (set<PinocchioRobot *>::iterator it = lRobots.begin();
+         it != lRobots.end(); it++)
+      aPool.release(*it);
+    return ok;
+  }
+
+protected:
+  /*! Acquire a robot, compute its ZMP and release it,
+    NbCycles times. */
+  void cycle(unsigned int NbCycles) {
+    Eigen::VectorXd q(m_q), v(m_v), a(m_a);
+    Eigen::Vector3d lZMP;
+    for (unsigned int k = 0; k < NbCycles; k++) {
+      PinocchioRobot *aPR = m_Pool->acquire();
+      bool lAcquired;
+      {
+        lock_guard<mutex> lock(m_Mutex);
+        lAcquired = (aPR != 0) && m_InUse.insert(aPR).second;
+        if (!lAcquired)
+          m_NbErrors++;
+      }
+      if (!lAcquired)
+        continue;
+
+      aPR->computeInverseDynamics(q, v, a);
+      aPR->zeroMomentumPoint(lZMP);
+      bool lSameZMP = (lZMP - m_ZMP).cwiseAbs().maxCoeff() < 1e-12;
+
+      lock_guard<mutex> lock(m_Mutex);
+      if (!lSameZMP)
+        m_NbErrors++;
+      m_InUse.erase(aPR);
+      m_Pool->release(aPR);
+    }
+  }
+
+  void chooseTestProfile() {}
+  void generateEvent() {}
+
+  PinocchioRobotPool *m_Pool;
+  /*! State of the robots and ZMP of the prototype. */
+  Eigen::VectorXd m_q, m_v, m_a;
+  Eigen::Vector3d m_ZMP;
+  /*! Robots acquired and not released yet. */
+  set<PinocchioRobot *> m_InUse;
+  unsigned int m_NbErrors;
+  mutex m_Mutex;
+};
+
+int main(int argc, char *argv[]) {
+  string TestName("TestPinocchioRobotPool");
+  TestPinocchioRobotPool aTest(argc, argv, TestName);
+  if (!aTest.init())
+    return 1;
+  if (!aTest.doTest(cout)) {
+    cerr << "Pinocchio robot pool: fail" << endl;
+    return 1;
+  }
+  cout << "Pinocchio robot pool: ok" << endl;
+  return 0;
+}
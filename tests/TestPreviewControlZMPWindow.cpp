@@ -0,0 +1,105 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestPreviewControlZMPWindow.cpp
+  \brief Check that the preview control gives the same CoM trajectory
+  with the ZMP references loaded in a ZMPWindow as with the queue, and
+  that the rows left from a longer load are never read.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include <PreviewControl/PreviewControl.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+int main() {
+  bool ok = true;
+  SimplePluginManager aSPM;
+  PreviewControl aPC(&aSPM, OptimalControllerSolver::MODE_WITH_INITIALPOS);
+  aPC.SetSamplingPeriod(0.005);
+  aPC.SetPreviewControlTime(1.6);
+  aPC.SetHeightOfCoM(0.814);
+  aPC.ComputeOptimalWeights(OptimalControllerSolver::MODE_WITH_INITIALPOS);
+
+  // Steps of 20cm on x, swaying of 10cm on y.
+  std::size_t NL = 320, N = 2 * NL;
+  RingBuffer<ZMPPosition> ZMPPositions(N);
+  for (std::size_t i = 0; i < N; i++) {
+    ZMPPositions[i].px = 0.2 * floor((double)i / 160.0);
+    ZMPPositions[i].py = 0.1 * sin(M_PI * (double)i / 160.0);
+  }
+
+  // A longer window loaded before, with other references.
+  PreviewControl::ZMPWindow aZMPWindow(N + 100, 2);
+  aZMPWindow.setConstant(1.0);
+  PreviewControl::LoadZMPWindow(ZMPPositions, 0, N, aZMPWindow);
+  if (aZMPWindow.rows() != (Eigen::Index)(N + 100)) {
+    cerr << "LoadZMPWindow: window shrunk" << endl;
+    ok = false;
+  }
+
+  CartTable::state_t x, y, lx, ly;
+  x.setZero();
+  y.setZero();
+  lx.setZero();
+  ly.setZero();
+  double sxzmp = 0.0, syzmp = 0.0, lsxzmp = 0.0, lsyzmp = 0.0;
+  double zmpx, zmpy, lzmpx, lzmpy;
+  double lError = 0.0;
+  for (std::size_t i = 0; i + NL <= N; i++) {
+    aPC.OneIterationOfPreview(x, y, sxzmp, syzmp, ZMPPositions, i, zmpx, zmpy,
+                              false);
+    aPC.OneIterationOfPreview(lx, ly, lsxzmp, lsyzmp, aZMPWindow, N, i, lzmpx,
+                              lzmpy, false);
+    lError = std::max(lError, (x - lx).cwiseAbs().maxCoeff());
+    lError = std::max(lError, (y - ly).cwiseAbs().maxCoeff());
+    lError = std::max(lError, std::max(fabs(zmpx - lzmpx), fabs(zmpy - lzmpy)));
+  }
+  cout << "Largest difference between the queue and the window: " << lError
+       << endl;
+  if (lError > 1e-9) {
+    cerr << "OneIterationOfPreview: the window differs from the queue"
+         << endl;
+    ok = false;
+  }
+
+  // The preview would read the stale rows after the N loaded ones.
+  bool lThrown = false;
+  try {
+    aPC.OneIterationOfPreview(lx, ly, lsxzmp, lsyzmp, aZMPWindow, N,
+                              N - NL + 1, lzmpx, lzmpy, false);
+  } catch (std::exception &) {
+    lThrown = true;
+  }
+  if (!lThrown) {
+    cerr << "OneIterationOfPreview: stale rows read" << endl;
+    ok = false;
+  }
+
+  if (!ok)
+    return -1;
+  cout << "PreviewControl ZMPWindow: ok" << endl;
+  return 0;
+}
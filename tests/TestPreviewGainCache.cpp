@@ -0,0 +1,144 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestPreviewGainCache.cpp
+  \brief Check that the gains of the preview control are found with
+  the exact parameters only, and survive a round trip through a file
+  written when the table is flushed.
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include <PreviewControl/PreviewGainCache.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+PreviewGains makeGains(double Zc, int Nl) {
+  PreviewGains aGains;
+  aGains.Ks = -Zc;
+  aGains.Kx << Zc, 2 * Zc, 3 * Zc;
+  aGains.F.resize(Nl);
+  for (int i = 0; i < Nl; i++)
+    aGains.F(i) = Zc / (i + 1);
+  return aGains;
+}
+
+bool same(const PreviewGains &a, const PreviewGains &b) {
+  return (a.Ks == b.Ks) && (a.Kx == b.Kx) && (a.F.size() == b.F.size()) &&
+         (a.F == b.F);
+}
+
+int main() {
+  bool ok = true;
+  PreviewGainCache aCache;
+  PreviewGainKey aKey = {0.814, 0.005, 1.6, 1.0, 1e-6, 1, 0};
+  PreviewGainKey otherKey = aKey;
+  otherKey.Zc = 0.7;
+  otherKey.Solver = 1;
+
+  aCache.insert(aKey, makeGains(aKey.Zc, 320));
+  aCache.insert(otherKey, makeGains(otherKey.Zc, 320));
+
+  PreviewGains aGains;
+  if (!aCache.find(aKey, aGains) || !same(aGains, makeGains(aKey.Zc, 320))) {
+    cerr << "find: wrong gains" << endl;
+    ok = false;
+  }
+  PreviewGainKey missingKey = aKey;
+  missingKey.Mode = 0;
+  if (aCache.find(missingKey, aGains)) {
+    cerr << "find: gains found for another mode" << endl;
+    ok = false;
+  }
+  missingKey = aKey;
+  missingKey.Solver = 1;
+  if (aCache.find(missingKey, aGains)) {
+    cerr << "find: gains found for another solver" << endl;
+    ok = false;
+  }
+
+  // Round trip through a file.
+  string aFileName("/tmp/TestPreviewGainCache.bin");
+  if (!aCache.save(aFileName)) {
+    cerr << "save: unable to write " << aFileName << endl;
+    return -1;
+  }
+  PreviewGainCache otherCache;
+  if (!otherCache.load(aFileName) || (otherCache.size() != 2)) {
+    cerr << "load: unable to read " << aFileName << endl;
+    ok = false;
+  }
+  if (!otherCache.find(otherKey, aGains) ||
+      !same(aGains, makeGains(otherKey.Zc, 320))) {
+    cerr << "load: wrong gains" << endl;
+    ok = false;
+  }
+
+  // A truncated file leaves the table unchanged.
+  {
+    ifstream aif(aFileName.c_str(), ios::in | ios::binary);
+    string lContent((istreambuf_iterator<char>(aif)),
+                    istreambuf_iterator<char>());
+    aif.close();
+    ofstream aof(aFileName.c_str(), ios::out | ios::binary | ios::trunc);
+    aof.write(lContent.data(), (streamsize)lContent.size() - 8);
+  }
+  PreviewGainCache truncatedCache;
+  if (truncatedCache.load(aFileName) || (truncatedCache.size() != 0)) {
+    cerr << "load: truncated file accepted" << endl;
+    ok = false;
+  }
+  remove(aFileName.c_str());
+
+  // Inserting in a table attached to a file does not write it, flush
+  // does, through a temporary file.
+  {
+    PreviewGainCache attachedCache;
+    attachedCache.attach(aFileName);
+    attachedCache.insert(aKey, makeGains(aKey.Zc, 320));
+    if (ifstream(aFileName.c_str()).is_open()) {
+      cerr << "insert: file written" << endl;
+      ok = false;
+    }
+    if (!attachedCache.flush() || ifstream((aFileName + ".tmp").c_str())) {
+      cerr << "flush: unable to write " << aFileName << endl;
+      ok = false;
+    }
+    attachedCache.insert(otherKey, makeGains(otherKey.Zc, 320));
+  }
+  // The destructor flushes the last insertion.
+  PreviewGainCache flushedCache;
+  if (!flushedCache.load(aFileName) || (flushedCache.size() != 2)) {
+    cerr << "flush: gains not written at destruction" << endl;
+    ok = false;
+  }
+  remove(aFileName.c_str());
+
+  if (!ok)
+    return -1;
+  cout << "PreviewGainCache: ok" << endl;
+  return 0;
+}
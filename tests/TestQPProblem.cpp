@@ -0,0 +1,346 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestQPProblem.cpp
+  \brief Check that QPProblem gives QLD its storage without copy,
+  that the problem can be refilled through views, that QLD gives the
+  solution of a compact call when the last diagonal element of the
+  Hessian is null, and that the dual active-set solver agrees with QLD.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include <ZMPRefTrajectoryGeneration/qp-problem.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+bool check(const solution_t &Result, const Eigen::VectorXd &Expected,
+           const char *Name) {
+  double err = (Result.Solution_vec.head(Expected.size()) - Expected).norm();
+  if ((Result.Fail != 0) || (err > 1e-6)) {
+    cerr << Name << ": fail=" << Result.Fail << " error=" << err << endl
+         << Result.Solution_vec.transpose() << endl;
+    return false;
+  }
+  return true;
+}
+
+/// Fill a random feasible problem with Me equality and M inequality
+/// constraints on N variables.
+void random_problem(QPProblem &Pb, int N, int M, int Me) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(N, N);
+  Eigen::MatrixXd Q = A.transpose() * A + Eigen::MatrixXd::Identity(N, N);
+  Eigen::VectorXd D = 10.0 * Eigen::VectorXd::Random(N);
+  Eigen::MatrixXd DU = Eigen::MatrixXd::Random(Me + M, N);
+  Eigen::VectorXd DS = Eigen::VectorXd::Random(Me + M).cwiseAbs();
+  DS.head(Me).setZero();
+
+  Pb.reset();
+  Pb.add_term_to(MATRIX_Q, Q, 0, 0);
+  Pb.add_term_to(VECTOR_D, D, 0);
+  Pb.add_term_to(MATRIX_DU, DU, 0, 0);
+  Pb.add_term_to(VECTOR_DS, DS, 0);
+  // The first row of the problem is empty
+  Pb.NbEqConstraints(Me + 1);
+}
+
+/// Compare the dual active-set solver to QLD on random problems,
+/// with and without hot start.
+bool check_dual_active_set() {
+  bool ok = true;
+  srand(1);
+  for (int k = 0; k < 20; k++) {
+    QPProblem Pb;
+    solution_t Reference, Result;
+    int N = 5 + k, M = 3 * N, Me = k % 3;
+    random_problem(Pb, N, M, Me);
+    Pb.solve(QLD, Reference, NONE);
+    Pb.solve(DUAL_ACTIVE_SET, Result, NONE);
+    if (!check(Result, Reference.Solution_vec, "dual active set"))
+      ok = false;
+
+    // The multipliers of the solution give the exact active set.
+    Pb.MaxIterations(1);
+    Pb.solve(DUAL_ACTIVE_SET, Result, NONE);
+    if (!check(Result, Reference.Solution_vec, "hot start"))
+      ok = false;
+
+    // Without hot start, one iteration does not suffice.
+    Pb.MaxIterations(1);
+    Result.reset();
+    Pb.solve(DUAL_ACTIVE_SET, Result, NONE);
+    if ((Result.Fail != 1) &&
+        ((Result.Solution_vec - Reference.Solution_vec).norm() > 1e-6)) {
+      cerr << "iteration limit: fail=" << Result.Fail << endl;
+      ok = false;
+    }
+
+    // Only the trailing block changes: the factor of the leading one
+    // is kept and the Schur complement is updated.
+    Pb.MaxIterations(0);
+    Pb.nbInvariantRows(N / 2);
+    Pb.nbInvariantCols(N / 2);
+    for (int l = 0; l < 2; l++) {
+      Eigen::MatrixXd C = Eigen::MatrixXd::Identity(N - N / 2, N - N / 2);
+      Pb.add_term_to(MATRIX_Q, C, N / 2, N / 2);
+      Pb.solve(QLD, Reference, NONE);
+      Pb.solve(DUAL_ACTIVE_SET, Result, NONE);
+      if (!check(Result, Reference.Solution_vec, "schur complement"))
+        ok = false;
+    }
+  }
+  return ok;
+}
+
+/// Problem of a walk as built by GeneratorVelRef at a given cycle: the
+/// jerks of the CoM on N samples, then the positions of two previewed
+/// feet, for x and y. The second previewed step covers no sample: the
+/// last diagonal element of the Hessian is null.
+void herdt_problem(int Cycle, Eigen::MatrixXd &Q, Eigen::VectorXd &D,
+                   Eigen::MatrixXd &DU, Eigen::VectorXd &DS) {
+  const int N = 16, NbSteps = 2;
+  const double T = 0.1, h = 0.814, g = 9.81;
+  Eigen::MatrixXd Sv(N, 3), Sz(N, 3), Uv(N, N), Uz(N, N), V(N, NbSteps);
+  Sv.setZero();
+  Uv.setZero();
+  Uz.setZero();
+  V.setZero();
+  for (int i = 0; i < N; i++) {
+    double t = (i + 1) * T;
+    Sv.row(i) << 0.0, 1.0, t;
+    Sz.row(i) << 1.0, t, t * t / 2.0 - h / g;
+    for (int j = 0; j <= i; j++) {
+      double k = i - j;
+      Uv(i, j) = (1.0 + 2.0 * k) * T * T / 2.0;
+      Uz(i, j) = (1.0 + 3.0 * k + 3.0 * k * k) * T * T * T / 6.0 - h / g * T;
+    }
+    if (i >= 15 - Cycle % 8)
+      V(i, 0) = 1.0;
+  }
+
+  const double alpha = 1.0, beta = 0.00001, gamma = 0.000001;
+  const int n = 2 * (N + NbSteps);
+  Q.setZero(n, n);
+  D.setZero(n);
+  DU.setZero(2 * 2 * N + 2 * 2 * NbSteps, n);
+  DS.setZero(DU.rows());
+  Eigen::Vector3d CoM[2] = {
+      Eigen::Vector3d(0.02 * Cycle, 0.2, 0.1 * cos(Cycle)),
+      Eigen::Vector3d(-0.05 * cos(Cycle), 0.1 * sin(Cycle), 0.3 * cos(Cycle))};
+  double Support[2] = {0.0, -0.095}, Ref[2] = {0.2, 0.0};
+  double CoPBound[2] = {0.05, 0.03}, Spacing[2] = {0.0, 0.2};
+  for (int c = 0; c < 2; c++) {
+    int j = c * N, f = 2 * N + c * NbSteps;
+    Q.block(j, j, N, N) = alpha * Uv.transpose() * Uv +
+                          beta * Eigen::MatrixXd::Identity(N, N) +
+                          gamma * Uz.transpose() * Uz;
+    Q.block(j, f, N, NbSteps) = -gamma * Uz.transpose() * V;
+    Q.block(f, j, NbSteps, N) = -gamma * V.transpose() * Uz;
+    Q.block(f, f, NbSteps, NbSteps) = gamma * V.transpose() * V;
+
+    Eigen::VectorXd Vc = Support[c] * (Eigen::VectorXd::Ones(N) - V.col(0));
+    Eigen::VectorXd Z = Sz * CoM[c] - Vc;
+    D.segment(j, N) = alpha * Uv.transpose() *
+                          (Sv * CoM[c] - Ref[c] * Eigen::VectorXd::Ones(N)) +
+                      gamma * Uz.transpose() * Z;
+    D.segment(f, NbSteps) = -gamma * V.transpose() * Z;
+
+    // The CoP stays inside the support foot.
+    int r = 2 * c * N;
+    DU.block(r, j, N, N) = -Uz;
+    DU.block(r, f, N, NbSteps) = V;
+    DS.segment(r, N) = CoPBound[c] * Eigen::VectorXd::Ones(N) - Z;
+    DU.block(r + N, j, N, N) = Uz;
+    DU.block(r + N, f, N, NbSteps) = -V;
+    DS.segment(r + N, N) = CoPBound[c] * Eigen::VectorXd::Ones(N) + Z;
+
+    // Each foot lands at most 0.02 away from its nominal position.
+    r = 4 * N + 2 * c * NbSteps;
+    for (int k = 0; k < NbSteps; k++) {
+      double Nominal = Spacing[c] * ((k % 2) ? -1.0 : 1.0);
+      DU(r + 2 * k, f + k) = -1.0;
+      DU(r + 2 * k + 1, f + k) = 1.0;
+      if (k > 0) {
+        DU(r + 2 * k, f + k - 1) = 1.0;
+        DU(r + 2 * k + 1, f + k - 1) = -1.0;
+      } else
+        Nominal += Support[c];
+      DS(r + 2 * k) = 0.02 + Nominal;
+      DS(r + 2 * k + 1) = 0.02 - Nominal;
+    }
+  }
+}
+
+/// Solve with QLD on a compact copy of the problem, as before the
+/// storage of QPProblem was shared: nmax = n, and the first row of the
+/// constraints is empty.
+int compact_qld(const Eigen::MatrixXd &Q, const Eigen::VectorXd &D,
+                const Eigen::MatrixXd &DU, const Eigen::VectorXd &DS,
+                const Eigen::VectorXd &XL, const Eigen::VectorXd &XU,
+                Eigen::VectorXd &X) {
+  int n = (int)Q.rows(), m = (int)DU.rows() + 1, me = 0, mmax = m + 1,
+      nmax = n, mnn = m + 2 * n, iout = 0, ifail = 0, iprint = 0,
+      lwar = 2 * (3 * n * n / 2 + 10 * n + 2 * m + 20000),
+      liwar = 2 * n + 1000;
+  double eps = 1e-8;
+  Eigen::MatrixXd Qc = Q, DUc = Eigen::MatrixXd::Zero(mmax, n);
+  DUc.block(1, 0, DU.rows(), n) = DU;
+  Eigen::VectorXd Dc = D, DSc = Eigen::VectorXd::Zero(mmax), XLc = XL,
+                  XUc = XU, U = Eigen::VectorXd::Zero(mnn),
+                  war = Eigen::VectorXd::Zero(lwar);
+  DSc.segment(1, DS.size()) = DS;
+  Eigen::VectorXi iwar = Eigen::VectorXi::Zero(liwar);
+  iwar(0) = 1;
+  X.setZero(n);
+  ql0001_(&m, &me, &mmax, &n, &nmax, &mnn, Qc.data(), Dc.data(), DUc.data(),
+          DSc.data(), XLc.data(), XUc.data(), X.data(), U.data(), &iout,
+          &ifail, &iprint, war.data(), &lwar, iwar.data(), &liwar, &eps);
+  return ifail;
+}
+
+/// Solve the problem in a storage larger than the problem (nmax > n)
+/// twice, and compare with the compact call. The same computations are
+/// done: the solutions are expected to be identical.
+bool check_compact(QPProblem &Pb, const Eigen::MatrixXd &Q,
+                   const Eigen::VectorXd &D, const Eigen::MatrixXd &DU,
+                   const Eigen::VectorXd &DS, const char *Name) {
+  int n = (int)Q.rows();
+  Eigen::VectorXd XL = Eigen::VectorXd::Constant(n, -1e8),
+                  XU = Eigen::VectorXd::Constant(n, 1e8), X;
+  int ifail = compact_qld(Q, D, DU, DS, XL, XU, X);
+
+  bool ok = true;
+  solution_t Result;
+  // The regularization of the last diagonal element must not remain
+  // in the storage for the second solve.
+  for (int l = 0; l < 2; l++) {
+    Pb.reset();
+    Pb.add_term_to(MATRIX_Q, Q, 0, 0);
+    Pb.add_term_to(VECTOR_D, D, 0);
+    Pb.add_term_to(MATRIX_DU, DU, 0, 0);
+    Pb.add_term_to(VECTOR_DS, DS, 0);
+    Pb.add_term_to(VECTOR_XL, XL, 0);
+    Pb.add_term_to(VECTOR_XU, XU, 0);
+    Pb.solve(QLD, Result, NONE);
+    double err = (Result.Solution_vec - X).norm();
+    if ((ifail != 0) || (Result.Fail != 0) || (err > 1e-12)) {
+      cerr << Name << ": fail=" << ifail << "/" << Result.Fail
+           << " error=" << err << endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+/// Compare QLD on a shared storage with the compact call, on the
+/// problems of a walk and on random problems whose Hessian has a null
+/// last row.
+bool check_singular_hessian() {
+  QPProblem Pb;
+  solution_t Result;
+  random_problem(Pb, 50, 100, 0);
+  Pb.solve(QLD, Result, NONE);
+
+  bool ok = true;
+  Eigen::MatrixXd Q, DU;
+  Eigen::VectorXd D, DS;
+  for (int Cycle = 0; Cycle < 16; Cycle++) {
+    herdt_problem(Cycle, Q, D, DU, DS);
+    ok &= check_compact(Pb, Q, D, DU, DS, "walk");
+  }
+
+  srand(3);
+  for (int k = 0; k < 20; k++) {
+    int N = 6 + k % 7;
+    Eigen::MatrixXd A = Eigen::MatrixXd::Random(N, N);
+    Q = A.transpose() * A;
+    Q.row(N - 1).setZero();
+    Q.col(N - 1).setZero();
+    D = Eigen::VectorXd::Random(N);
+    DU = Eigen::MatrixXd::Random(2 * N, N);
+    DS = Eigen::VectorXd::Random(2 * N).cwiseAbs();
+    ok &= check_compact(Pb, Q, D, DU, DS, "null last row");
+  }
+  return ok;
+}
+
+int main() {
+  QPProblem Pb;
+  solution_t Result;
+  bool ok = true;
+  Eigen::MatrixXd I2 = Eigen::MatrixXd::Identity(2, 2);
+  Eigen::MatrixXd I3 = Eigen::MatrixXd::Identity(3, 3);
+  Eigen::MatrixXd I1 = Eigen::MatrixXd::Identity(1, 1);
+
+  // Invariant part: identity on the first two variables.
+  Pb.reset();
+  Pb.nbInvariantRows(2);
+  Pb.nbInvariantCols(2);
+  Pb.add_term_to(MATRIX_Q, I2, 0, 0);
+
+  // min 1/2 |x|^2 - (1,2,3).x  s.t.  x0+x1+x2 <= 3
+  Pb.reset_variant();
+  Pb.matrix_view(MATRIX_Q, 2, 2, 1, 1)(0, 0) = 1.0;
+  Pb.add_term_to(VECTOR_D, Eigen::Vector3d(-1.0, -2.0, -3.0), 0);
+  Pb.matrix_view(MATRIX_DU, 0, 0, 1, 3).setConstant(-1.0);
+  Pb.vector_view(VECTOR_DS, 0, 1)(0) = 3.0;
+  Pb.solve(QLD, Result, NONE);
+  ok &= check(Result, Eigen::Vector3d(0.0, 1.0, 2.0), "first problem");
+
+  // Bigger problem: the storage grows and keeps the invariant part.
+  // min 1/2 |x|^2 - (1,2,3,4,5).x  s.t.  x3 <= 1, x4 <= 2
+  Pb.reset_variant();
+  Pb.add_term_to(MATRIX_Q, I3, 2, 2);
+  Eigen::VectorXd D(5);
+  D << -1.0, -2.0, -3.0, -4.0, -5.0;
+  Pb.vector_view(VECTOR_D, 0, 5) = D;
+  Eigen::MatrixXd DU = Eigen::MatrixXd::Zero(2, 5);
+  DU(0, 3) = -1.0;
+  DU(1, 4) = -1.0;
+  Pb.add_term_to(MATRIX_DU, DU, 0, 0);
+  Pb.add_term_to(VECTOR_DS, Eigen::Vector2d(1.0, 2.0), 0);
+  Pb.solve(QLD, Result, NONE);
+  Eigen::VectorXd Expected(5);
+  Expected << 1.0, 2.0, 3.0, 1.0, 2.0;
+  ok &= check(Result, Expected, "second problem");
+
+  // Smaller problem again: nothing of the previous one may remain.
+  // min 1/2 |x|^2 - (1,2,3).x  s.t.  x2 <= 0.5
+  Pb.reset_variant();
+  Pb.add_term_to(MATRIX_Q, I1, 2, 2);
+  Pb.add_term_to(VECTOR_D, Eigen::Vector3d(-1.0, -2.0, -3.0), 0);
+  Pb.matrix_view(MATRIX_DU, 0, 2, 1, 1)(0, 0) = -1.0;
+  Pb.vector_view(VECTOR_DS, 0, 1)(0) = 0.5;
+  Pb.solve(QLD, Result, NONE);
+  ok &= check(Result, Eigen::Vector3d(1.0, 2.0, 0.5), "third problem");
+  Pb.solve(DUAL_ACTIVE_SET, Result, NONE);
+  ok &= check(Result, Eigen::Vector3d(1.0, 2.0, 0.5), "third problem (dual)");
+
+  ok &= check_dual_active_set();
+  ok &= check_singular_hessian();
+
+  if (!ok)
+    return -1;
+  return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestRealTime.cpp
+  \brief Check that in real-time mode the control loop of the
+  Herdt algorithm does not allocate once the walk is started.
+  The program is linked with AllocationHooks.cpp.
+*/
+
+#include <iostream>
+
+#include "TestObject.hh"
+#include <AllocationCheck.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+using namespace PatternGeneratorJRL::TestSuite;
+
+class TestRealTime : public TestObject {
+public:
+  TestRealTime(int argc, char *argv[], string &aString)
+      : TestObject(argc, argv, aString) {}
+
+  bool doTest(ostream &os) {
+    chooseTestProfile();
+
+    // The first seconds fill in the preview and the trajectory queues.
+    const unsigned int lNbWarmUpIterations = 4 * 200;
+    const unsigned int lNbIterations = 12 * 200;
+    bool ok = true;
+    for (unsigned int lNbIt = 0; lNbIt < lNbIterations; lNbIt++) {
+      // In debug builds, the real-time mode also makes Eigen assert on
+      // its first allocation.
+      if (lNbIt == lNbWarmUpIterations) {
+        istringstream strm(":realtime true");
+        m_PGI->ParseCmd(strm);
+      }
+      AllocationCheck aAllocationCheck(lNbIt >= lNbWarmUpIterations);
+      if (!m_PGI->RunOneStepOfTheControlLoop(
+              m_CurrentConfiguration, m_CurrentVelocity,
+              m_CurrentAcceleration, m_OneStep.m_ZMPTarget,
+              m_OneStep.m_finalCOMPosition, m_OneStep.m_LeftFootPosition,
+              m_OneStep.m_RightFootPosition)) {
+        os << "The walk stopped at iteration " << lNbIt << endl;
+        return false;
+      }
+      if (aAllocationCheck.NbAllocations() > 0) {
+        os << "Iteration " << lNbIt << ": "
+           << aAllocationCheck.NbAllocations() << " allocation(s)" << endl;
+        ok = false;
+      }
+    }
+    return ok;
+  }
+
+protected:
+  void chooseTestProfile() {
+    CommonInitialization(*m_PGI);
+    const unsigned int nbMethod = 5;
+    const char lBuffer[nbMethod][256] = {
+        ":SetAlgoForZmpTrajectory Herdt",
+        ":setfeetconstraint XY 0.09 0.06",
+        ":singlesupporttime 0.7",
+        ":doublesupporttime 0.1",
+        ":HerdtOnline 0.2 0.0 0.0"};
+    for (unsigned int i = 0; i < nbMethod; i++) {
+      istringstream strm(lBuffer[i]);
+      m_PGI->ParseCmd(strm);
+    }
+  }
+  void generateEvent() {}
+};
+
+int main(int argc, char *argv[]) {
+  string TestName("TestRealTime");
+  TestRealTime aTest(argc, argv, TestName);
+  if (!aTest.init())
+    return 1;
+  if (!aTest.doTest(cout)) {
+    cerr << "Real-time: fail" << endl;
+    return 1;
+  }
+  cout << "Real-time: ok" << endl;
+  return 0;
+}
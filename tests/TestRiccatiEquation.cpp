@@ -28,6 +28,7 @@
 #define NB_OF_FIELDS 1
 
 #include "PreviewControl/OptimalControllerSolver.hh"
+#include "PreviewControl/PreviewControl.hh"
 #include <Debug.hh>
 #include <fstream>
 #include <iostream>
@@ -125,6 +126,55 @@ bool compareDebugFiles(string fileName) {
   return finalreport;
 }
 
+/*! Check that the doubling algorithm gives the same weights
+  as the Schur method, up to a relative precision of 1e-6. */
+bool compareWithDoubling(PatternGeneratorJRL::OptimalControllerSolver *anOCS,
+                         unsigned int Mode, Eigen::MatrixXd &lF,
+                         Eigen::MatrixXd &lK) {
+  Eigen::MatrixXd lFd, lKd;
+  anOCS->ComputeWeights(
+      Mode, PatternGeneratorJRL::OptimalControllerSolver::SOLVER_DOUBLING);
+  anOCS->GetF(lFd);
+  anOCS->GetK(lKd);
+  double lErrorK = (lKd - lK).cwiseAbs().maxCoeff() / lK.cwiseAbs().maxCoeff();
+  double lErrorF = (lFd - lF).cwiseAbs().maxCoeff() / lF.cwiseAbs().maxCoeff();
+  cout << "Doubling algorithm, relative error on K: " << lErrorK
+       << " on F: " << lErrorF << endl;
+  return (lErrorK < 1e-6) && (lErrorF < 1e-6);
+}
+
+/*! Check that the gains interpolated from a schedule with a 2 cm step
+  are within 5e-5, relative, of the gains solved at the same height,
+  and that the schedule is not added to the shared table of gains.
+  The height is in the middle of a step, where the error is the
+  largest. */
+bool checkGainSchedule(unsigned int Mode) {
+  using namespace PatternGeneratorJRL;
+  SimplePluginManager aSPM;
+  PreviewControl aPC(&aSPM, Mode, false);
+  aPC.SetSamplingPeriod(0.005);
+  aPC.SetPreviewControlTime(1.6);
+  aPC.SetHeightOfCoM(0.81);
+  aPC.ComputeOptimalWeights(Mode);
+  PreviewGains lExact, lInterpolated;
+  aPC.GetGains(lExact);
+
+  std::size_t lNbGains = PreviewGainCache::shared().size();
+  aPC.ComputeGainSchedule(0.76, 0.86, 6, Mode);
+  aPC.SetHeightOfCoM(0.81);
+  aPC.GetGains(lInterpolated);
+
+  double lErrorKs = fabs(lInterpolated.Ks - lExact.Ks) / fabs(lExact.Ks);
+  double lErrorKx = (lInterpolated.Kx - lExact.Kx).cwiseAbs().maxCoeff() /
+                    lExact.Kx.cwiseAbs().maxCoeff();
+  double lErrorF = (lInterpolated.F - lExact.F).cwiseAbs().maxCoeff() /
+                   lExact.F.cwiseAbs().maxCoeff();
+  cout << "Gain schedule, relative error on Ks: " << lErrorKs
+       << " on Kx: " << lErrorKx << " on F: " << lErrorF << endl;
+  return (lErrorKs < 5e-5) && (lErrorKx < 5e-5) && (lErrorF < 5e-5) &&
+         (PreviewGainCache::shared().size() == lNbGains);
+}
+
 int main() {
   PatternGeneratorJRL::OptimalControllerSolver *anOCS;
 
@@ -218,6 +268,10 @@ int main() {
   aof.close();
   bool sameFile =
       compareDebugFiles("TestRiccatiEquationWeightsWithoutInitialPose.dat");
+  sameFile &= compareWithDoubling(
+      anOCS,
+      PatternGeneratorJRL::OptimalControllerSolver::MODE_WITHOUT_INITIALPOS,
+      lF, lK);
   delete anOCS;
 
   // Build the initial discrete system
@@ -273,9 +327,17 @@ int main() {
 
   bool sameFile2 =
       compareDebugFiles("TestRiccatiEquationWeightsWithInitialPose.dat");
+  sameFile2 &= compareWithDoubling(
+      anOCS, PatternGeneratorJRL::OptimalControllerSolver::MODE_WITH_INITIALPOS,
+      lF, lK);
   delete anOCS;
 
-  if (sameFile && sameFile2) {
+  bool lSchedule = checkGainSchedule(
+      PatternGeneratorJRL::OptimalControllerSolver::MODE_WITH_INITIALPOS);
+  lSchedule &= checkGainSchedule(
+      PatternGeneratorJRL::OptimalControllerSolver::MODE_WITHOUT_INITIALPOS);
+
+  if (sameFile && sameFile2 && lSchedule) {
     cout << "Passed test " << endl;
     return 0;
   } else {
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestRingBuffer.cpp
+  \brief Check that RingBuffer behaves as std::deque for the operations
+  used on the trajectories, and that it does not grow once reserved.
+*/
+
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+
+#include <RingBuffer.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+bool same(const RingBuffer<int> &aRB, const deque<int> &aDeque,
+          const char *Name) {
+  bool ok = (aRB.size() == aDeque.size());
+  for (unsigned int i = 0; ok && (i < aDeque.size()); i++)
+    ok = (aRB[i] == aDeque[i]);
+  if (!ok)
+    cerr << Name << ": RingBuffer and std::deque differ" << endl;
+  return ok;
+}
+
+int main() {
+  RingBuffer<int> aRB;
+  deque<int> aDeque;
+  bool ok = true;
+
+  // Queue used as a FIFO: the front moves around the storage.
+  aRB.reserve(64);
+  std::size_t lCapacity = aRB.capacity();
+  for (int i = 0; i < 1000; i++) {
+    aRB.push_back(i);
+    aDeque.push_back(i);
+    if (aRB.size() > 40) {
+      aRB.pop_front();
+      aDeque.pop_front();
+    }
+  }
+  ok &= same(aRB, aDeque, "fifo");
+  if (aRB.capacity() != lCapacity) {
+    cerr << "fifo: the storage grew from " << lCapacity << " to "
+         << aRB.capacity() << endl;
+    ok = false;
+  }
+
+  // Resizing keeps the elements in place.
+  aRB.resize(50, -1);
+  aDeque.resize(50, -1);
+  ok &= same(aRB, aDeque, "resize up");
+  aRB.resize(10);
+  aDeque.resize(10);
+  ok &= same(aRB, aDeque, "resize down");
+
+  // Both ends.
+  for (int i = 0; i < 100; i++) {
+    aRB.push_front(-i);
+    aDeque.push_front(-i);
+    aRB.push_back(i);
+    aDeque.push_back(i);
+  }
+  aRB.pop_back();
+  aDeque.pop_back();
+  ok &= same(aRB, aDeque, "push_front");
+
+  // Insertion and removal in the middle.
+  aRB.insert(aRB.begin() + 5, 3, 42);
+  aDeque.insert(aDeque.begin() + 5, 3, 42);
+  aRB.erase(aRB.begin() + 20, aRB.begin() + 30);
+  aDeque.erase(aDeque.begin() + 20, aDeque.begin() + 30);
+  aRB.erase(aRB.begin(), aRB.begin() + 7);
+  aDeque.erase(aDeque.begin(), aDeque.begin() + 7);
+  ok &= same(aRB, aDeque, "insert/erase");
+
+  deque<int> aTail(aDeque.begin() + 10, aDeque.end());
+  aRB.insert(aRB.end(), aTail.begin(), aTail.end());
+  aDeque.insert(aDeque.end(), aTail.begin(), aTail.end());
+  ok &= same(aRB, aDeque, "insert range");
+
+  // Copy and iterators.
+  RingBuffer<int> aCopy(aRB);
+  ok &= (aCopy == aRB);
+  long lSum = 0, lDequeSum = 0;
+  for (RingBuffer<int>::const_iterator it = aCopy.begin(); it != aCopy.end();
+       ++it)
+    lSum += *it;
+  for (deque<int>::const_iterator it = aDeque.begin(); it != aDeque.end(); ++it)
+    lDequeSum += *it;
+  if (lSum != lDequeSum) {
+    cerr << "iterators: " << lSum << " != " << lDequeSum << endl;
+    ok = false;
+  }
+
+  if (!ok)
+    return -1;
+  cout << "RingBuffer: ok" << endl;
+  return 0;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestSPSCQueue.cpp
+  \brief Check that SPSCQueue delivers the elements in order between
+  two threads, and that its slots are reused.
+*/
+
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <SPSCQueue.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+int main() {
+  bool ok = true;
+
+  // One thread: full and empty queues.
+  SPSCQueue<int> aQueue(3);
+  for (int i = 0; i < 3; i++) {
+    int *lSlot = aQueue.back();
+    ok &= (lSlot != 0);
+    *lSlot = i;
+    aQueue.push();
+  }
+  if (aQueue.back() != 0) {
+    cerr << "full: a slot is available" << endl;
+    ok = false;
+  }
+  for (int i = 0; i < 3; i++) {
+    int *lFront = aQueue.front();
+    if ((lFront == 0) || (*lFront != i)) {
+      cerr << "order: element " << i << " missing" << endl;
+      ok = false;
+      break;
+    }
+    aQueue.pop();
+  }
+  if (aQueue.front() != 0) {
+    cerr << "empty: an element is available" << endl;
+    ok = false;
+  }
+
+  // Two threads: the elements are vectors filled in place.
+  const int NbPackets = 10000;
+  SPSCQueue<vector<int> > aPackets(2);
+  std::thread aProducer([&aPackets] {
+    for (int i = 0; i < NbPackets; i++) {
+      vector<int> *lSlot;
+      while ((lSlot = aPackets.back()) == 0)
+        std::this_thread::yield();
+      lSlot->assign(16, i);
+      aPackets.push();
+    }
+  });
+  int lErrors = 0;
+  for (int i = 0; i < NbPackets; i++) {
+    vector<int> *lFront;
+    while ((lFront = aPackets.front()) == 0)
+      std::this_thread::yield();
+    for (unsigned int j = 0; j < lFront->size(); j++)
+      if ((*lFront)[j] != i)
+        lErrors++;
+    aPackets.pop();
+  }
+  aProducer.join();
+  if (lErrors != 0) {
+    cerr << "threads: " << lErrors << " wrong values" << endl;
+    ok = false;
+  }
+
+  if (!ok)
+    return -1;
+  cout << "SPSCQueue: ok" << endl;
+  return 0;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestTrajectoryBlock.cpp
+  \brief Check the transfers between a COMStateBlock and a queue of
+  COMState, field by field.
+*/
+
+#include <iostream>
+
+#include <RingBuffer.hh>
+#include <TrajectoryBlock.hh>
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+
+int main() {
+  RingBuffer<COMState> aQueue(10);
+  for (unsigned int i = 0; i < aQueue.size(); i++)
+    for (int j = 0; j < 3; j++) {
+      aQueue[i].x[j] = 10 * i + j;
+      aQueue[i].y[j] = -(10.0 * i + j);
+      aQueue[i].roll[j] = 0.5 * i;
+    }
+
+  COMStateBlock aBlock;
+  aBlock.resize(4);
+  aBlock.setZero();
+  bool ok = true;
+
+  // Only the selected fields are read.
+  aBlock.load(aQueue, 3, 4, COM_X | COM_ROLL);
+  ok &= (aBlock.x(1, 2) == 42.0) && (aBlock.roll(3, 0) == 3.0);
+  ok &= aBlock.y.isZero();
+
+  // Only the selected fields are written, starting at the given sample.
+  aBlock.x.setConstant(1.0);
+  aBlock.y.setConstant(2.0);
+  aBlock.addTo(aQueue, 5, 2, COM_XY);
+  ok &= (aQueue[5].x[0] == 51.0) && (aQueue[6].y[2] == -60.0);
+  ok &= (aQueue[7].x[0] == 70.0) && (aQueue[5].roll[0] == 2.5);
+
+  aBlock.store(aQueue, 0, 1, COM_Y);
+  ok &= (aQueue[0].y[1] == 2.0) && (aQueue[0].x[1] == 1.0);
+
+  // Conversions of a single sample.
+  COMState aCOMState = aBlock(2);
+  ok &= (aCOMState.x[0] == 1.0) && (aCOMState.roll[0] == 2.5);
+  aCOMState.z[1] = 7.0;
+  aBlock.set(0, aCOMState);
+  ok &= (aBlock.z(0, 1) == 7.0);
+
+  if (!ok) {
+    cerr << "COMStateBlock: wrong transfer" << endl;
+    return -1;
+  }
+  cout << "COMStateBlock: ok" << endl;
+  return 0;
+}
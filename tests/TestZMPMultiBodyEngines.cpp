@@ -0,0 +1,81 @@
+/*
+ * Copyright 2020,
+ *
+ * JRL, CNRS/AIST
+ *
+ * This file is part of walkGenJrl.
+ * walkGenJrl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * walkGenJrl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Lesser Public License for more details.
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with walkGenJrl.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Research carried out within the scope of the
+ *  Joint Japanese-French Robotics Laboratory (JRL)
+ */
+/*! \file TestZMPMultiBodyEngines.cpp
+  \brief Check that the multibody ZMP given by the centroidal dynamics
+  is the one given by the inverse dynamics, from the RPY state and from
+  the pinocchio state, on a set of states around the half sitting
+  posture.
+*/
+
+#include <cmath>
+#include <iostream>
+
+#include "TestObject.hh"
+
+using namespace std;
+using namespace PatternGeneratorJRL;
+using namespace PatternGeneratorJRL::TestSuite;
+
+class TestZMPMultiBodyEngines : public TestObject {
+public:
+  TestZMPMultiBodyEngines(int argc, char *argv[], string &aString)
+      : TestObject(argc, argv, aString) {}
+
+  bool doTest(ostream &os) {
+    Eigen::Index nv = m_DebugPR->numberVelDof();
+    Eigen::VectorXd q(nv), v(nv), a(nv);
+    for (unsigned int k = 0; k < 100; k++) {
+      // Free flyer near its half sitting height, joints around the
+      // half sitting posture, bounded velocities and accelerations.
+      for (Eigen::Index i = 0; i < nv; i++) {
+        double lPhase = 0.37 * (double)(k + 1) * (double)(i + 1);
+        v[i] = sin(lPhase);
+        a[i] = 5.0 * cos(1.3 * lPhase);
+        q[i] = 0.1 * sin(0.7 * lPhase);
+      }
+      q[2] += 1.0;
+      q.tail(nv - 6) += m_HalfSitting;
+      m_DebugPR->currentRPYConfiguration(q);
+      compareZMPMBEngines(q, v, a);
+    }
+
+    displayZMPMBEnginesComparison(os);
+    return (m_MaxZMPMBDistance < 1e-8) && (m_MaxPinoZMPMBDistance < 1e-8);
+  }
+
+protected:
+  void chooseTestProfile() {}
+  void generateEvent() {}
+};
+
+int main(int argc, char *argv[]) {
+  string TestName("TestZMPMultiBodyEngines");
+  TestZMPMultiBodyEngines aTest(argc, argv, TestName);
+  if (!aTest.init())
+    return 1;
+  if (!aTest.doTest(cout)) {
+    cerr << "Multibody ZMP engines: fail" << endl;
+    return 1;
+  }
+  cout << "Multibody ZMP engines: ok" << endl;
+  return 0;
+}